@@ -0,0 +1,110 @@
+/*
+ * DMX Capture and Replay Example
+ *
+ * Records what a console sends on 4 universes, saves it to flash and then
+ * plays it back on 4 outputs with the original frame timing, so the rig keeps
+ * running without the console.
+ *
+ * Features:
+ * - Timestamped, delta-encoded capture from the receive callbacks
+ * - "Last N seconds" RAM ring (oldest records are overwritten)
+ * - Saved to flash, so the capture survives a power cycle
+ * - Looped replay on DMXTransmitter outputs
+ *
+ * To stream a longer capture to the host instead, create the capture without
+ * overwrite and call capture.flush(telemetry) from the main loop; record it
+ * with `./dmx_capture_tool record /dev/ttyACM0 show.dmxr`.
+ *
+ * Hardware: DMX inputs on GPIO 1-4 (pio0), DMX outputs on GPIO 5-8 (pio1)
+ */
+
+#include "pico/stdlib.h"
+#include "dmx_multi_receiver.h"
+#include "dmx_transmitter.h"
+#include "dmx_capture.h"
+#include <stdio.h>
+
+#define NUM_UNIVERSES 4
+#define INPUT_START_PIN 1
+#define CAPTURE_MS 30000        // Capture for 30 seconds after start-up
+#define CAPTURE_RING_SIZE 98304 // 96 KB of RAM holds ~8-60 s depending on how busy the show is
+
+static uint8_t capture_ring[CAPTURE_RING_SIZE];
+static DMXCapture capture;
+
+// Runs in interrupt context: the capture only encodes into the ring
+void onUniverseDataReceived(DMXMultiReceiver* multi_rx, uint8_t universe_index) {
+    capture.captureFrame(universe_index, multi_rx->getUniverseBuffer(universe_index), time_us_32());
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);
+
+    printf("DMX Capture and Replay Example\n");
+
+    DMXCaptureReader reader;
+    if (!DMXReplay::openFlashCapture(reader)) {
+        // No capture in flash yet: record one
+        capture.begin(NUM_UNIVERSES, capture_ring, sizeof(capture_ring), true);
+
+        DMXMultiReceiver multi_rx;
+        if (!multi_rx.begin(INPUT_START_PIN, NUM_UNIVERSES, onUniverseDataReceived)) {
+            printf("Failed to initialize multi-universe receiver\n");
+            return 1;
+        }
+
+        printf("Capturing %d universes for %d s...\n", NUM_UNIVERSES, CAPTURE_MS / 1000);
+        capture.start();
+        sleep_ms(CAPTURE_MS);
+        capture.stop();
+        multi_rx.end();
+
+        DMXCapture::Stats stats = capture.getStats();
+        printf("Captured %lu frames (%lu overwritten), %u bytes, max %lu us per frame\n",
+               stats.frames_captured, stats.frames_dropped, (unsigned)capture.getBufferedBytes(),
+               stats.max_encode_us);
+
+        size_t saved = capture.saveToFlash();
+        printf("Saved %u bytes to flash\n", (unsigned)saved);
+        if (saved == 0 || !DMXReplay::openFlashCapture(reader)) {
+            printf("Failed to save the capture\n");
+            return 1;
+        }
+    } else {
+        printf("Found a capture in flash\n");
+    }
+
+    DMXTransmitter outputs[NUM_UNIVERSES] = {
+        DMXTransmitter(5, pio1),
+        DMXTransmitter(6, pio1),
+        DMXTransmitter(7, pio1),
+        DMXTransmitter(8, pio1)
+    };
+    for (uint8_t i = 0; i < NUM_UNIVERSES; i++) {
+        if (outputs[i].begin() != DmxOutput::SUCCESS) {
+            printf("Failed to initialize output %d\n", i + 1);
+            return 1;
+        }
+    }
+
+    DMXReplay replay;
+    replay.begin(&reader, outputs, NUM_UNIVERSES);
+    replay.start(time_us_64(), true);
+    printf("Replaying in a loop on GPIO 5-8\n");
+
+    uint32_t last_report = 0;
+    while (true) {
+        replay.poll(time_us_64());
+
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+        if (now - last_report >= 10000) {
+            DMXReplay::Stats stats = replay.getStats();
+            printf("Replay: %lu frames, %lu merged, %lu loops, max %lu us late\n",
+                   stats.frames_played, stats.frames_merged, stats.loops, stats.max_lateness_us);
+            last_report = now;
+        }
+    }
+
+    return 0;
+}
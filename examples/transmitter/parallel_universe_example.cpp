@@ -15,8 +15,8 @@
 
 #include "pico/stdlib.h"
 #include "dmx_transmitter.h"
+#include "dmx_effects.h"
 #include <stdio.h>
-#include <math.h>
 
 #define MAX_UNIVERSES 8
 #define UNIVERSE_SIZE 512
@@ -66,8 +66,8 @@ void setup_universe_patterns() {
             case 4: // Universe 5 - Sine wave
                 printf("Universe 5: Sine wave pattern\n");
                 for (int ch = 1; ch <= UNIVERSE_SIZE; ch++) {
-                    float sine_val = sinf((ch * 2.0f * M_PI) / UNIVERSE_SIZE);
-                    universe_data[universe][ch] = (uint8_t)((sine_val + 1.0f) * 127.5f);
+                    // One sine cycle across the universe from the 256-entry lookup table
+                    universe_data[universe][ch] = DMXEffects::sin8((uint8_t)((ch * 256) / UNIVERSE_SIZE));
                 }
                 break;
                 
@@ -0,0 +1,87 @@
+/*
+ * USB Streaming DMX Transmitter Example
+ * 
+ * This example receives universe data from a host over USB CDC using the
+ * binary stream protocol (include/dmx_stream_protocol.h) and transmits each
+ * completed frame on up to 8 parallel universes.
+ * 
+ * Host side: tools/dmx_stream_send.cpp
+ *   ./dmx_stream_send /dev/ttyACM0 --universes 8 --fps 44
+ * 
+ * Hardware: Connect DMX outputs to GPIO pins 1-8
+ */
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+#include "dmx_stream_input.h"
+#include <stdio.h>
+
+#define NUM_STREAM_UNIVERSES 8
+
+// Resend the last frame at least this often when the host is idle
+#define STREAM_REFRESH_INTERVAL_US 1000000
+
+int main() {
+    // Initialize stdio (USB CDC carries both the stream and status output)
+    stdio_init_all();
+    sleep_ms(2000);
+    
+    DMXTransmitter dmx_outputs[NUM_STREAM_UNIVERSES] = {
+        DMXTransmitter(1, pio0), DMXTransmitter(2, pio0),
+        DMXTransmitter(3, pio0), DMXTransmitter(4, pio0),
+        DMXTransmitter(5, pio1), DMXTransmitter(6, pio1),
+        DMXTransmitter(7, pio1), DMXTransmitter(8, pio1)
+    };
+    
+    for (uint8_t i = 0; i < NUM_STREAM_UNIVERSES; i++) {
+        DmxOutput::return_code result = dmx_outputs[i].begin();
+        if (result != DmxOutput::SUCCESS) {
+            printf("Failed to initialize DMX transmitter %d: %d\n", i + 1, result);
+            return 1;
+        }
+    }
+    
+    DMXStreamInput stream;
+    stream.begin(dmx_outputs, NUM_STREAM_UNIVERSES);
+    
+    bool frame_pending = false;
+    uint64_t last_transmit = 0;
+    uint32_t frames = 0;
+    
+    while (true) {
+        if (stream.poll()) {
+            frame_pending = true;
+        }
+        
+        uint64_t now = time_us_64();
+        bool refresh_due = now - last_transmit >= STREAM_REFRESH_INTERVAL_US;
+        if (!frame_pending && !refresh_due) {
+            continue;
+        }
+        
+        // Present the decoded back buffers once every output is idle
+        bool busy = false;
+        for (uint8_t i = 0; i < NUM_STREAM_UNIVERSES; i++) {
+            busy |= dmx_outputs[i].isBusy();
+        }
+        if (busy) {
+            continue;
+        }
+        
+        for (uint8_t i = 0; i < NUM_STREAM_UNIVERSES; i++) {
+            dmx_outputs[i].transmit();
+        }
+        last_transmit = now;
+        
+        if (frame_pending) {
+            frame_pending = false;
+            if (++frames % 1000 == 0) {
+                DMXStreamDecoder::Stats stats = stream.getStats();
+                printf("Stream: %lu frames, %lu packets, %lu checksum errors, %lu seq gaps\n",
+                       frames, stats.packets_ok, stats.checksum_errors, stats.seq_gaps);
+            }
+        }
+    }
+    
+    return 0;
+}
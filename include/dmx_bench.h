@@ -0,0 +1,44 @@
+#ifndef DMX_BENCH_H
+#define DMX_BENCH_H
+
+#include "pico/stdlib.h"
+
+#define DMX_BENCH_SAMPLES 15
+#define DMX_BENCH_SAMPLE_US 2000 // Calls per sample are calibrated to take about this long
+
+// Microbenchmark harness for hot paths.
+// run() calibrates how many calls of a function fill a sample, times
+// DMX_BENCH_SAMPLES samples and reports per-call min/median/max. On the RP2040
+// samples are counted in SysTick cycles at clk_sys; on the host they come from
+// the monotonic clock. Results are printed as a single JSON document between
+// begin() and end(), for tracking regressions across releases.
+class DMXBench {
+public:
+    typedef void (*Function)(void* context);
+
+    struct Result {
+        uint32_t iterations;   // Calls per sample
+        double min_ns;         // Per call
+        double median_ns;
+        double max_ns;
+        double min_cycles;     // Per call, 0 on the host
+        double median_cycles;
+    };
+
+    // Open the JSON document
+    static void begin(const char* suite);
+
+    // Benchmark one case; bytes is the data processed per call (0 if not
+    // meaningful), reported as throughput. items is the number of items
+    // (fixtures, frames...) per call, reported as items per ms.
+    static Result run(const char* name, Function function, void* context, uint32_t bytes = 0,
+                      uint32_t items = 0);
+
+    // Close the JSON document
+    static void end();
+
+private:
+    static uint32_t _num_results;
+};
+
+#endif // DMX_BENCH_H
@@ -0,0 +1,117 @@
+#ifndef DMX_CAPTURE_H
+#define DMX_CAPTURE_H
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+#include "dmx_telemetry.h"
+#include "dmx_capture_format.h"
+
+// Flash partition for a saved capture (default: the 512 KB below the cue show
+// partition of a 2 MB part). Read back with e.g.
+// `picotool save -r 0x10100000 0x10180000 capture.dmxr`
+#ifndef DMX_CAPTURE_FLASH_OFFSET
+#define DMX_CAPTURE_FLASH_OFFSET (1024 * 1024)
+#endif
+#ifndef DMX_CAPTURE_FLASH_SIZE
+#define DMX_CAPTURE_FLASH_SIZE (512 * 1024)
+#endif
+
+// Records received frames with microsecond timestamps into a RAM ring of
+// delta-encoded records. The ring can be streamed to the host while capturing
+// (tools/dmx_capture_tool.cpp record), or saved to flash once stopped.
+class DMXCapture {
+public:
+    struct Stats {
+        uint32_t frames_captured;
+        uint32_t frames_dropped;   // Ring full (or oldest records overwritten)
+        uint32_t bytes_captured;
+        uint32_t records_sent;
+        uint32_t last_encode_us;
+        uint32_t max_encode_us;
+    };
+
+    DMXCapture();
+
+    // buffer: RAM for the ring. With overwrite the oldest records make room for
+    // new ones (a "last N seconds" recorder); then do not flush() while capturing.
+    bool begin(uint8_t num_universes, uint8_t* buffer, size_t size, bool overwrite = false);
+
+    void start();
+    void stop();
+    bool isCapturing() const;
+
+    // Record one 512-slot frame. IRQ-safe, so it can run in receive callbacks.
+    bool captureFrame(uint8_t universe, const uint8_t* data, uint32_t timestamp_us);
+
+    // Queue up to max_records buffered records as CAPTURE packets (idle loop)
+    uint16_t flush(DMXTelemetry& telemetry, uint16_t max_records = 8);
+
+    // Move the buffered records to flash as a capture image (records that do
+    // not fit stay in the ring). Capture must be stopped and the other core
+    // must not be executing from flash. Returns the bytes written, 0 on failure.
+    size_t saveToFlash(uint32_t flash_offset = DMX_CAPTURE_FLASH_OFFSET,
+                       size_t max_size = DMX_CAPTURE_FLASH_SIZE);
+
+    size_t getBufferedBytes() const;
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    DMXCaptureEncoder _encoder;
+    DMXCaptureRing _ring;
+    uint8_t _num_universes;
+    bool _overwrite;
+    volatile bool _capturing;
+    Stats _stats;
+};
+
+// Drives DMXTransmitter outputs from a capture with its original frame timing
+class DMXReplay {
+public:
+    struct Stats {
+        uint32_t frames_played;
+        uint32_t frames_merged;    // Frames folded into the next because the output was still busy
+        uint32_t frames_skipped;   // Records before the first keyframe of their universe
+        uint32_t max_lateness_us;
+        uint32_t loops;
+    };
+
+    DMXReplay();
+
+    // Open the capture stored in the flash partition
+    static bool openFlashCapture(DMXCaptureReader& reader);
+
+    // Attach a capture and the transmitters it drives (universe i -> outputs[i])
+    bool begin(DMXCaptureReader* reader, DMXTransmitter outputs[], uint8_t num_outputs);
+
+    void start(uint64_t now_us, bool loop = false);
+    void stop();
+    bool isPlaying() const;
+
+    // Non-blocking: apply every record that is due and transmit the outputs it
+    // touched once they are idle; call as often as possible
+    void poll(uint64_t now_us);
+
+    Stats getStats() const;
+
+private:
+    DMXCaptureReader* _reader;
+    DMXTransmitter* _outputs;
+    uint8_t _num_outputs;
+
+    bool _playing;
+    bool _loop;
+    DMXCaptureRecord _next;
+    bool _have_next;
+    uint64_t _start_us;
+    uint64_t _position_us;      // Capture time of _next relative to the first record
+    uint32_t _last_timestamp_us;
+    uint8_t _synced;            // Universes that have seen a keyframe
+    uint8_t _pending;           // Universes with an applied frame waiting to go out
+    Stats _stats;
+
+    void rewind(uint64_t now_us);
+    void advance();
+};
+
+#endif // DMX_CAPTURE_H
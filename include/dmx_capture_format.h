@@ -0,0 +1,134 @@
+#ifndef DMX_CAPTURE_FORMAT_H
+#define DMX_CAPTURE_FORMAT_H
+
+// Timestamped DMX capture format shared by DMXCapture / DMXReplay and the host
+// tool (tools/dmx_capture_tool.cpp). Deliberately free of Pico SDK dependencies.
+//
+// Capture image (little-endian), as saved to flash or written by the host tool:
+//   Header   8 bytes   magic "DMXR", version u16, universe count u8, reserved u8
+//   Records  one per received frame:
+//     timestamp u32    Microseconds, free-running (wraps after ~71 minutes)
+//     universe  u8     0-based; 0xFF ends the capture (erased flash reads as 0xFF)
+//     flags     u8     DMX_CAPTURE_FLAG_KEYFRAME: ops are against all zeros
+//     length    u16    Length of the ops that follow
+//     ops              DMXCueCodec delta against the universe's previous frame
+//
+// A frame identical to the previous one is a record without ops, so the
+// original frame timing is kept. Keyframes are inserted periodically so a
+// capture can be decoded from any point after the oldest records were lost.
+
+#include "dmx_cue_format.h"
+
+#define DMX_CAPTURE_MAGIC 0x52584D44u // "DMXR"
+#define DMX_CAPTURE_VERSION 1
+#define DMX_CAPTURE_HEADER_SIZE 8
+#define DMX_CAPTURE_RECORD_HEADER_SIZE 8
+#define DMX_CAPTURE_MAX_UNIVERSES 8
+#define DMX_CAPTURE_END 0xFF
+
+// Worst-case ops length (all literal) and record size
+#define DMX_CAPTURE_MAX_OPS (DMX_CUE_MAX_BLOCK_SIZE - 3)
+#define DMX_CAPTURE_MAX_RECORD (DMX_CAPTURE_RECORD_HEADER_SIZE + DMX_CAPTURE_MAX_OPS)
+
+#define DMX_CAPTURE_FLAG_KEYFRAME 0x01
+
+#define DMX_CAPTURE_KEYFRAME_INTERVAL_US 1000000 // One keyframe per universe per second
+
+// One decoded record header; ops point into the capture data
+struct DMXCaptureRecord {
+    uint32_t timestamp_us;
+    uint8_t universe;
+    uint8_t flags;
+    uint16_t length;
+    const uint8_t* ops;
+};
+
+// Encodes received frames into records, keeping the previous frame of each universe
+class DMXCaptureEncoder {
+public:
+    DMXCaptureEncoder();
+
+    bool begin(uint8_t num_universes, uint32_t keyframe_interval_us = DMX_CAPTURE_KEYFRAME_INTERVAL_US);
+
+    // Make the next frame of every universe a keyframe (e.g. after records were lost)
+    void requestKeyframes();
+
+    // Encode one 512-slot frame into `out` (at least DMX_CAPTURE_MAX_RECORD bytes).
+    // Returns the record length, or 0 for an invalid universe.
+    uint16_t encodeFrame(uint8_t universe, const uint8_t* data, uint32_t timestamp_us, uint8_t* out);
+
+    uint8_t getNumUniverses() const;
+
+private:
+    uint8_t _prev[DMX_CAPTURE_MAX_UNIVERSES][DMX_UNIVERSE_SIZE];
+    uint32_t _last_keyframe_us[DMX_CAPTURE_MAX_UNIVERSES];
+    uint8_t _keyframe_pending; // One bit per universe
+    uint8_t _num_universes;
+    uint32_t _keyframe_interval_us;
+};
+
+// Byte ring of variable-length records, each stored contiguously. One producer
+// and one consumer may run concurrently on the same core (e.g. a receive IRQ
+// and the main loop); the indices are published after the data they cover.
+class DMXCaptureRing {
+public:
+    DMXCaptureRing();
+
+    // Use an external buffer; it must hold at least 2 * DMX_CAPTURE_MAX_RECORD bytes
+    bool begin(uint8_t* buffer, size_t size);
+
+    // Producer: room for one record of up to DMX_CAPTURE_MAX_RECORD bytes, or nullptr when full
+    uint8_t* reserve();
+    void commit(uint16_t length);
+
+    // Consumer: oldest record, or nullptr when empty
+    const uint8_t* peek(uint16_t* length);
+    void pop();
+
+    size_t getUsed() const;
+    size_t getSize() const;
+    void clear();
+
+private:
+    uint8_t* _buffer;
+    size_t _size;
+    volatile size_t _head;  // Next byte to write
+    volatile size_t _tail;  // Oldest record
+    volatile size_t _wrap;  // End of valid data when the head has wrapped past the tail
+    size_t _reserved;       // Offset returned by the last reserve()
+};
+
+// Sequential reader for a capture image (flash, file or RAM)
+class DMXCaptureReader {
+public:
+    DMXCaptureReader();
+
+    // Validate the header; returns false for a missing or corrupt capture
+    bool open(const uint8_t* data, size_t size);
+
+    bool isValid() const;
+    uint8_t getNumUniverses() const;
+
+    // Next record; false at the end marker, the end of the data or a truncated record
+    bool next(DMXCaptureRecord* record);
+
+    // Start again from the first record
+    void rewind();
+
+    // Parse one record (e.g. from a DMXCaptureRing or a CAPTURE stream packet)
+    static bool parseRecord(const uint8_t* data, size_t size, DMXCaptureRecord* record);
+
+    // Apply a record to a 512-byte universe; keyframes clear it first
+    static bool applyRecord(const DMXCaptureRecord& record, uint8_t* universe);
+
+private:
+    const uint8_t* _data;
+    size_t _size;
+    size_t _offset;
+    uint8_t _num_universes;
+};
+
+// Write a capture header; returns DMX_CAPTURE_HEADER_SIZE
+size_t dmxCaptureWriteHeader(uint8_t num_universes, uint8_t* out);
+
+#endif // DMX_CAPTURE_FORMAT_H
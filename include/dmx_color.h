@@ -0,0 +1,84 @@
+#ifndef DMX_COLOR_H
+#define DMX_COLOR_H
+
+#include "pico/stdlib.h"
+
+// Where a fixture's colour channels sit in its footprint, as 0-based slot
+// offsets; -1 for channels the fixture does not have
+struct DMXColorLayout {
+    uint8_t footprint;             // Slots per fixture
+    int8_t red;
+    int8_t green;
+    int8_t blue;
+    int8_t white;
+    int8_t amber;
+    int8_t warm_white;             // Tunable white: warm and cool emitters
+    int8_t cool_white;
+};
+
+// Batched fixed-point colour conversion for LED fixtures. Each render call
+// converts a packed array of count colours straight into count interleaved
+// fixtures at slots (e.g. a universe buffer or a DMXSlotSpan), one fixture
+// every layout.footprint slots; slots outside the layout are left alone.
+// Integer-only, with lookup tables for the hue and colour temperature curves.
+//
+// White and amber are extracted from the RGB colour: as much of each emitter
+// as the colour holds is moved onto its own channel (white first), by the
+// emitter's own colour, so a warm white LED takes out warm white.
+class DMXColorMixer {
+public:
+    static const DMXColorLayout RGB;
+    static const DMXColorLayout RGBW;
+    static const DMXColorLayout RGBA;
+    static const DMXColorLayout RGBAW;
+    static const DMXColorLayout TUNABLE_WHITE;  // Warm white, cool white
+
+    // Defaults: 6500 K white, amber 255/191/0, tunable white 2700 K - 6500 K
+    DMXColorMixer();
+
+    // What the white and amber emitters look like at full output, in RGB
+    void setWhiteKelvin(uint16_t kelvin);
+    void setWhiteRgb(const uint8_t* rgb);
+    void setAmberRgb(const uint8_t* rgb);
+    // Colour temperatures of a tunable-white fixture's two emitters, clamped
+    // to 1000 K - 12000 K; fails unless warm is below cool
+    bool setTunableWhite(uint16_t warm_kelvin, uint16_t cool_kelvin);
+
+    // rgb: 3 bytes per fixture
+    void renderRgb(const uint8_t* rgb, uint16_t count, uint8_t* slots, const DMXColorLayout& layout) const;
+    // hsv: hue, saturation, value per fixture (DMXEffects::hsvToRgb)
+    void renderHsv(const uint8_t* hsv, uint16_t count, uint8_t* slots, const DMXColorLayout& layout) const;
+    // hsi: hue, saturation, intensity per fixture; total output stays at the
+    // intensity across hues
+    void renderHsi(const uint8_t* hsi, uint16_t count, uint8_t* slots, const DMXColorLayout& layout) const;
+    // A colour temperature (clamped to 1000 K - 12000 K) and a level per
+    // fixture. Tunable-white fixtures mix their two emitters (linear in
+    // mireds) and have any colour channels zeroed; the others get the
+    // temperature's RGB, white and amber extracted.
+    void renderCct(const uint16_t* kelvin, const uint8_t* level, uint16_t count, uint8_t* slots,
+                   const DMXColorLayout& layout) const;
+
+    // Single conversions. hue: 256 = one full turn
+    static void hsiToRgb(uint8_t hue, uint8_t sat, uint8_t intensity, uint8_t* rgb);
+    // Black body colour at full brightness, 1000 K - 12000 K (clamped)
+    static void cctToRgb(uint16_t kelvin, uint8_t* rgb);
+
+private:
+    // An emitter's RGB at full output and 255 * 256 / component, so the
+    // amount a colour holds takes a multiply instead of a divide
+    struct Emitter {
+        uint8_t rgb[3];
+        uint16_t inverse[3];       // 0 for a component the emitter lacks
+    };
+
+    Emitter _white;
+    Emitter _amber;
+    uint16_t _warm_mired;          // In 1/16 mired
+    uint16_t _cool_mired;
+
+    static void makeEmitter(const uint8_t* rgb, Emitter* emitter);
+    static uint8_t extract(uint8_t* rgb, const Emitter& emitter);
+    void store(uint8_t* rgb, uint8_t* fixture, const DMXColorLayout& layout) const;
+};
+
+#endif // DMX_COLOR_H
@@ -0,0 +1,109 @@
+#ifndef DMX_CUE_FORMAT_H
+#define DMX_CUE_FORMAT_H
+
+// Binary cue/show format shared by the firmware player and the host packer
+// (tools/dmx_cue_pack.cpp). Deliberately free of Pico SDK dependencies.
+//
+// Layout (all integers little-endian):
+//   Header     16 bytes   magic "DMXC", version, cue count, universe count
+//   Cue index  16 bytes per cue: data offset, data length, fade time, cue number, flags
+//   Cue data   per changed universe: universe (u8), encoded length (u16), ops
+//
+// Each universe block is a delta against the same universe in the previous
+// cue (or against all zeros for a keyframe cue). Ops:
+//   bits 7-6  type: 0 = SKIP (slots unchanged), 1 = LITERAL (n bytes follow),
+//                   2 = RUN (one byte follows, repeated n times)
+//   bit 5     long count: count = ((op & 0x1F) << 8 | next byte) + 1
+//   bits 4-0  short count: count = (op & 0x1F) + 1
+// Slots after the last op are unchanged. Universes with no change are omitted.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef DMX_UNIVERSE_SIZE
+#define DMX_UNIVERSE_SIZE 512
+#endif
+
+#define DMX_CUE_MAGIC 0x43584D44u // "DMXC"
+#define DMX_CUE_VERSION 1
+#define DMX_CUE_HEADER_SIZE 16
+#define DMX_CUE_INDEX_ENTRY_SIZE 16
+#define DMX_CUE_MAX_UNIVERSES 8
+
+// Cue flags
+#define DMX_CUE_FLAG_KEYFRAME 0x0001 // Deltas are against all zeros, not the previous cue
+
+// Worst-case encoded size of one universe block (header + all-literal ops)
+#define DMX_CUE_MAX_BLOCK_SIZE (3 + DMX_UNIVERSE_SIZE + 2 * ((DMX_UNIVERSE_SIZE + 31) / 32))
+
+// Read-only view of a packed show (in XIP flash on target, in RAM on the host)
+class DMXCueShow {
+public:
+    struct CueInfo {
+        uint32_t data_offset;
+        uint32_t data_length;
+        uint32_t fade_ms;
+        uint16_t cue_number;
+        uint16_t flags;
+    };
+
+    DMXCueShow();
+
+    // Validate the header and index; returns false for a missing or corrupt show
+    bool open(const uint8_t* data, size_t size);
+
+    bool isValid() const;
+    uint16_t getNumCues() const;
+    uint8_t getNumUniverses() const;
+
+    // Index lookups
+    bool getCueInfo(uint16_t cue_index, CueInfo* info) const;
+    const uint8_t* getCueData(uint16_t cue_index) const;
+
+    // Index of the nearest keyframe at or before cue_index
+    uint16_t findKeyframe(uint16_t cue_index) const;
+
+    // Apply one cue's deltas to per-universe state buffers (512 bytes each).
+    // Keyframe cues clear the state first.
+    bool applyCue(uint16_t cue_index, uint8_t* const universes[], uint8_t num_universes) const;
+
+private:
+    const uint8_t* _data;
+    size_t _size;
+    uint16_t _num_cues;
+    uint8_t _num_universes;
+};
+
+// Delta/RLE codec for a single universe
+class DMXCueCodec {
+public:
+    // Encode `next` against `prev` (512 bytes each) into ops.
+    // Returns the encoded length, or 0 if nothing changed or `out` is too small.
+    static uint16_t encodeUniverse(const uint8_t* prev, const uint8_t* next, uint8_t* out, uint16_t out_capacity);
+
+    // Apply ops to a 512-byte universe in place. Returns false on malformed data.
+    static bool decodeUniverse(const uint8_t* ops, uint16_t length, uint8_t* universe);
+};
+
+// Little-endian helpers
+static inline uint16_t dmxCueReadU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t dmxCueReadU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void dmxCueWriteU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void dmxCueWriteU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+#endif // DMX_CUE_FORMAT_H
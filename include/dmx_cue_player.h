@@ -0,0 +1,63 @@
+#ifndef DMX_CUE_PLAYER_H
+#define DMX_CUE_PLAYER_H
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+#include "dmx_cue_format.h"
+
+// Flash partition holding the packed show (default: last 512 KB of a 2 MB part).
+// Load with e.g. `picotool load -o 0x10180000 show.bin`
+#ifndef DMX_CUE_FLASH_OFFSET
+#define DMX_CUE_FLASH_OFFSET (1536 * 1024)
+#endif
+#ifndef DMX_CUE_FLASH_SIZE
+#define DMX_CUE_FLASH_SIZE (512 * 1024)
+#endif
+
+// Plays a packed cue show into DMXTransmitter buffers with timed crossfades
+class DMXCuePlayer {
+public:
+    DMXCuePlayer();
+
+    // Open the show stored in the flash partition
+    static bool openFlashShow(DMXCueShow& show);
+
+    // Attach a show and the transmitters it drives (universe i -> outputs[i])
+    bool begin(const DMXCueShow* show, DMXTransmitter outputs[], uint8_t num_outputs);
+
+    // Start a crossfade from the current output to a cue, using the cue's fade time
+    bool go(uint16_t cue_index, uint32_t now_ms);
+
+    // Advance to the next cue
+    bool goNext(uint32_t now_ms);
+
+    // Render the crossfade into the transmitter buffers; call once per frame
+    void update(uint32_t now_ms);
+
+    // Status
+    bool isFading() const;
+    int32_t getCurrentCue() const;
+
+private:
+    const DMXCueShow* _show;
+    DMXTransmitter* _outputs;
+    uint8_t _num_universes;
+
+    // Output at the start of the fade, and the tracked state of _current_cue
+    // in _target[_live]. Cues decode into the other buffer, which becomes
+    // live only once the whole cue has decoded.
+    uint8_t _from[DMX_CUE_MAX_UNIVERSES][DMX_UNIVERSE_SIZE];
+    uint8_t _target[2][DMX_CUE_MAX_UNIVERSES][DMX_UNIVERSE_SIZE];
+    uint8_t _live;
+    int32_t _current_cue;
+
+    bool _fading;
+    uint32_t _fade_start_ms;
+    uint32_t _fade_ms;
+
+    // Bring _target to the state of cue_index, decoding incrementally when
+    // possible. On failure the live target and _current_cue are unchanged.
+    bool decodeTo(uint16_t cue_index);
+};
+
+#endif // DMX_CUE_PLAYER_H
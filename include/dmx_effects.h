@@ -0,0 +1,102 @@
+#ifndef DMX_EFFECTS_H
+#define DMX_EFFECTS_H
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+
+#define MAX_DMX_EFFECT_LAYERS 16
+
+// A run of identical fixtures inside one universe
+struct DMXFixtureRange {
+    uint8_t universe;             // 0-based universe index
+    uint16_t start_channel;       // 1-based first channel of the first fixture
+    uint16_t num_fixtures;
+    uint8_t channels_per_fixture; // Fixture footprint
+    uint8_t color_offset;         // Offset of the red channel (green, blue follow)
+};
+
+// Integer-only effect kernels. Phases are 8-bit (256 = one cycle), colours are
+// 8-bit RGB, and all waveforms come from lookup tables; no float math.
+// Kernels write whole fixture ranges straight into a 512-byte universe buffer.
+class DMXEffects {
+public:
+    // Lookup-table waveforms
+    static uint8_t sin8(uint8_t phase);
+    static void hsvToRgb(uint8_t hue, uint8_t sat, uint8_t val, uint8_t* rgb);
+    static uint8_t scale8(uint8_t value, uint8_t scale);
+
+    // Check that a fixture range fits in its universe
+    static bool isValidRange(const DMXFixtureRange& range);
+
+    // Batch renderers (range must be valid)
+    static void renderSolid(uint8_t* universe, const DMXFixtureRange& range, const uint8_t* rgb);
+    static void renderRainbow(uint8_t* universe, const DMXFixtureRange& range,
+                              uint8_t hue_start, uint8_t hue_step, uint8_t sat, uint8_t val);
+    static void renderSine(uint8_t* universe, const DMXFixtureRange& range,
+                           uint8_t phase, uint8_t phase_step, const uint8_t* rgb);
+    static void renderChase(uint8_t* universe, const DMXFixtureRange& range,
+                            uint16_t position, uint16_t width, const uint8_t* rgb);
+    static void renderStrobe(uint8_t* universe, const DMXFixtureRange& range, bool on, const uint8_t* rgb);
+    static void renderRamp(uint8_t* universe, const DMXFixtureRange& range,
+                           uint8_t phase, uint8_t phase_step, const uint8_t* rgb);
+    static void renderTwinkle(uint8_t* universe, const DMXFixtureRange& range,
+                              uint32_t* seed, uint8_t density, const uint8_t* rgb);
+};
+
+// Layered effects driven by 32-bit phase accumulators
+class DMXEffectEngine {
+public:
+    enum EffectType {
+        EFFECT_NONE = 0,
+        EFFECT_SOLID,
+        EFFECT_RAINBOW,
+        EFFECT_SINE,
+        EFFECT_CHASE,
+        EFFECT_STROBE,
+        EFFECT_RAMP,
+        EFFECT_TWINKLE
+    };
+
+    struct EffectParams {
+        EffectType type;
+        uint32_t rate_millihertz; // Effect cycles per second x 1000
+        uint8_t rgb[3];           // Base colour (rainbow uses saturation/value = rgb[1]/rgb[2])
+        uint8_t spread;           // Phase offset from one fixture to the next, in 1/256 of a cycle
+        uint8_t width;            // Chase width in fixtures, strobe duty (0-255), twinkle density
+    };
+
+    DMXEffectEngine();
+
+    // Add an effect layer in the lowest free slot; returns its index or -1 if the
+    // range is invalid or the engine is full
+    int8_t addEffect(const DMXFixtureRange& range, const EffectParams& params);
+    // Fails for a layer that has not been added
+    bool setParams(uint8_t layer, const EffectParams& params);
+    // Frees the slot; other layers keep their indices
+    void removeEffect(uint8_t layer);
+    void clear();
+
+    // Advance all phase accumulators to now_ms and render every layer in slot order
+    void render(DMXTransmitter outputs[], uint8_t num_outputs, uint32_t now_ms);
+
+    uint8_t getNumLayers() const;
+
+private:
+    struct Layer {
+        DMXFixtureRange range;
+        EffectParams params;
+        uint32_t phase;        // 2^32 = one cycle
+        uint32_t phase_per_ms; // Accumulator increment, derived from rate_millihertz
+        uint32_t seed;         // Twinkle PRNG state
+        bool in_use;
+    };
+
+    Layer _layers[MAX_DMX_EFFECT_LAYERS];
+    uint8_t _num_layers; // Slots in use
+    uint32_t _last_render_ms;
+    bool _started;
+
+    static uint32_t phaseIncrement(uint32_t rate_millihertz);
+};
+
+#endif // DMX_EFFECTS_H
@@ -0,0 +1,80 @@
+#ifndef DMX_FADE_ENGINE_H
+#define DMX_FADE_ENGINE_H
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+
+// Number of universes the fade engine reserves state for (~12 bytes per slot)
+#ifndef DMX_FADE_MAX_UNIVERSES
+#define DMX_FADE_MAX_UNIVERSES 8
+#endif
+
+#define DMX_FADE_MAX_SLOTS (DMX_FADE_MAX_UNIVERSES * DMX_UNIVERSE_SIZE)
+
+// Longer durations are clamped (about 24.8 days)
+#define DMX_FADE_MAX_DURATION_MS 0x7FFFFFFFu
+
+// Per-slot timed fades across all output universes.
+// Every slot can have its own target and duration. render() computes each
+// 16.16 value from the time remaining rather than accumulating a per-ms step,
+// so rounding never builds up however long the fade, and only touches slots
+// whose bit is set in the active-fade bitmap, scanning 32 slots per bitmap
+// word, so idle channels cost nothing. Slots fading together share one
+// division per render.
+class DMXFadeEngine {
+public:
+    DMXFadeEngine();
+
+    // Attach transmitters (universe i -> outputs[i]); current values are
+    // taken from their buffers so fades start from what is on the wire
+    bool begin(DMXTransmitter outputs[], uint8_t num_universes, uint32_t now_ms);
+
+    // Fade one channel (0-based universe, 1-based channel); duration 0 = snap.
+    // A fade already running on the channel restarts from its current value
+    bool fadeTo(uint8_t universe, uint16_t channel, uint8_t target, uint32_t duration_ms);
+
+    // Fade a range of channels to individual targets with one duration
+    bool fadeRangeTo(uint8_t universe, uint16_t start_channel, const uint8_t* targets,
+                     uint16_t length, uint32_t duration_ms);
+
+    // Fade an entire universe (512 targets)
+    bool fadeUniverseTo(uint8_t universe, const uint8_t* targets, uint32_t duration_ms);
+
+    // Freeze a channel (or everything) at its current value
+    void stop(uint8_t universe, uint16_t channel);
+    void stopAll();
+
+    // Advance all active fades to now_ms and write them into the transmitter buffers
+    void render(uint32_t now_ms);
+
+    // Status
+    uint8_t getValue(uint8_t universe, uint16_t channel) const;
+    bool isFading(uint8_t universe, uint16_t channel) const;
+    uint16_t getActiveFadeCount() const;
+
+private:
+    DMXTransmitter* _outputs;
+    uint8_t _num_universes;
+    uint32_t _last_render_ms;
+    uint16_t _active_count;
+
+    // Structure-of-arrays slot state, indexed by universe * 512 + (channel - 1)
+    uint32_t _from[DMX_FADE_MAX_SLOTS];      // 16.16 value the fade started at (current value when idle)
+    uint32_t _remaining[DMX_FADE_MAX_SLOTS]; // milliseconds left
+    uint16_t _duration[DMX_FADE_MAX_SLOTS];  // duration in units of 2^_shift ms, fits 16 bits
+    uint8_t _shift[DMX_FADE_MAX_SLOTS];
+    uint8_t _target[DMX_FADE_MAX_SLOTS];
+    uint32_t _active[DMX_FADE_MAX_SLOTS / 32];
+
+    struct Progress;
+
+    bool slotIndex(uint8_t universe, uint16_t channel, uint16_t* slot) const;
+    uint32_t progress(uint16_t slot) const;
+    uint32_t valueAt(uint16_t slot, uint32_t progress) const;
+    uint32_t currentValue(uint16_t slot) const;
+    void startFade(uint16_t slot, uint8_t target, uint32_t duration_ms);
+    void finishFade(uint16_t slot);
+    uint8_t renderSlot(uint16_t slot, uint32_t elapsed, Progress* last);
+};
+
+#endif // DMX_FADE_ENGINE_H
@@ -0,0 +1,22 @@
+#ifndef DMX_FRAME_CRC_H
+#define DMX_FRAME_CRC_H
+
+#include "pico/stdlib.h"
+
+// Frame fingerprints for change detection: CRC-32 as zlib's crc32(), over a
+// packet's start code and slots. A receiver holding the DMA sniffer
+// (DmxInput::enable_frame_crc()) gets this from the DMA while the frame
+// streams in; the others, and anything checking the sniffer, use compute().
+
+#define DMX_FRAME_CRC_SEED 0xFFFFFFFFu
+
+class DMXFrameCrc {
+public:
+    // Table-driven, about 8 cycles per byte
+    static uint32_t compute(const volatile uint8_t* data, size_t length);
+
+    // Continue a CRC returned by compute() (or update()) over more data
+    static uint32_t update(uint32_t crc, const volatile uint8_t* data, size_t length);
+};
+
+#endif // DMX_FRAME_CRC_H
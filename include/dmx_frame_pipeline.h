@@ -0,0 +1,70 @@
+#ifndef DMX_FRAME_PIPELINE_H
+#define DMX_FRAME_PIPELINE_H
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+#include "dmx_output_space.h"
+
+// Render callback: fill the back buffers of all outputs for the given frame.
+// Write through the transmitters (setChannel, getUniverseBuffer, effect engines);
+// the frame currently on the wire lives in the other buffer and is not touched.
+typedef void (*DMXRenderCallback)(DMXTransmitter outputs[], uint8_t num_outputs,
+                                  uint32_t frame_number, void* user_data);
+
+// Render-ahead frame pipeline.
+// At each frame boundary all outputs present their back buffers, and frame N+1
+// is rendered immediately while frame N is still being shifted out by DMA.
+// Frame N+1 must be rendered before the next boundary; late renders are counted.
+class DMXFramePipeline {
+public:
+    struct Stats {
+        uint32_t frames_sent;
+        uint32_t deadline_misses;  // Renders that finished after their frame was due
+        uint32_t last_render_us;
+        uint32_t max_render_us;
+        uint32_t late_starts;      // Frames started late because an output was still busy
+    };
+
+    DMXFramePipeline();
+
+    // Attach initialized transmitters; frame_period_us is the refresh period (e.g. 25000 for 40 Hz).
+    // Outputs that are not running are skipped, so between polls one can be
+    // begun, ended or remapped while the others keep their cadence.
+    bool begin(DMXTransmitter outputs[], uint8_t num_outputs, uint32_t frame_period_us,
+               DMXRenderCallback render = nullptr, void* user_data = nullptr);
+
+    // Present frames through a flat output space: at each boundary only its
+    // dirty universes are copied into the outputs, and the rest resend their
+    // last frame. Render into the space instead of the transmitters. nullptr
+    // goes back to transmitting every back buffer.
+    void setOutputSpace(DMXOutputSpace* space);
+
+    // Non-blocking: starts the next frame if it is due and all outputs are idle,
+    // then renders the following one. Returns true if a frame was started.
+    bool poll();
+
+    // Run the pipeline forever, sleeping (DMXLoad::idleUntil) between frames
+    void run();
+
+    Stats getStats() const;
+    void resetStats();
+    uint32_t getFramePeriodUs() const;
+
+    // When the next frame is due (time_us_64() scale), e.g. to idle until then
+    uint64_t getNextFrameUs() const;
+
+private:
+    DMXTransmitter* _outputs;
+    uint8_t _num_outputs;
+    uint32_t _frame_period_us;
+    DMXRenderCallback _render;
+    void* _user_data;
+    DMXOutputSpace* _space;
+    uint64_t _next_frame_us;
+    bool _started;
+    Stats _stats;
+
+    bool outputsBusy();
+};
+
+#endif // DMX_FRAME_PIPELINE_H
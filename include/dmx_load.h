@@ -0,0 +1,130 @@
+#ifndef DMX_LOAD_H
+#define DMX_LOAD_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+// Per-core CPU load accounting, compiled in with -DDMX_LOAD=ON (CMake option,
+// on by default). Every microsecond of a core is charged to one context:
+//   IDLE      sleeping in DMXLoad::idleUntil() / idleUs()
+//   RX_IRQ    dmxinput_dma_handler and DMXMultiReceiver's per-frame statistics
+//   TX        DMXFramePipeline frame starts and renders
+//   CALLBACK  user receive callbacks (DMXReceiver, DMXMultiReceiver)
+//   MAIN      everything else
+// Contexts nest: an interrupt that lands while a core idles charges its own
+// time to RX_IRQ and the rest of the sleep stays IDLE.
+//
+// The Cortex-M0+ cores have no cycle counter, so time comes from the 1 MHz
+// system timer. A context switch reads it and adds to one 64-bit total with
+// interrupts masked for a few instructions, as DMXLog::record() does; each
+// core only writes its own totals. Accounting for a core starts with its
+// first switch, so a core that never runs DMX code reads as unused.
+//
+// The idle waits are WFE-based and work with accounting compiled out too.
+
+#ifndef DMX_LOAD
+#define DMX_LOAD 0
+#endif
+
+#if DMX_LOAD
+#include "hardware/structs/timer.h"
+#endif
+
+#define DMX_LOAD_NUM_CORES 2
+
+enum DMXLoadContext {
+    DMX_LOAD_MAIN = 0,
+    DMX_LOAD_RX_IRQ = 1,
+    DMX_LOAD_TX = 2,
+    DMX_LOAD_CALLBACK = 3,
+    DMX_LOAD_IDLE = 4,
+    DMX_LOAD_CONTEXT_COUNT
+};
+
+class DMXTelemetry;
+
+class DMXLoad {
+public:
+    struct Usage {
+        uint64_t window_us;                         // Sum of time_us
+        uint64_t time_us[DMX_LOAD_CONTEXT_COUNT];
+        uint16_t load_permille;                     // Share of the window not IDLE
+    };
+
+    static constexpr bool isEnabled() {
+        return DMX_LOAD != 0;
+    }
+
+    static const char* getName(uint8_t context);
+
+    // Sleep until `until` or the next interrupt or event, whichever is first;
+    // returns true once `until` has been reached. For poll loops.
+    static bool idleUntil(absolute_time_t until);
+
+    // Sleep the full time, servicing interrupts (a sleep_us() that counts as idle)
+    static void idleUs(uint64_t us);
+
+    // Totals of one core since it started or reset() (all zero when compiled out).
+    // A core other than the caller's may be read in the middle of a switch.
+    static Usage getTotals(uint core);
+
+    // The live figure: totals since the previous sample() of the same core
+    static Usage sample(uint core);
+
+    static void reset();
+
+    // Sample both cores into the LOAD telemetry counters; nothing when compiled out
+    static void setCounters(DMXTelemetry& telemetry);
+
+#if DMX_LOAD
+    // Switch the calling core to context; returns the one to restore
+    static inline uint8_t enter(uint8_t context) {
+        uint32_t irq_state = save_and_disable_interrupts();
+        CoreState& core = _cores[get_core_num()];
+        uint8_t previous = core.context;
+        charge(core);
+        core.context = context;
+        restore_interrupts(irq_state);
+        return previous;
+    }
+
+    static inline void leave(uint8_t previous) {
+        uint32_t irq_state = save_and_disable_interrupts();
+        CoreState& core = _cores[get_core_num()];
+        charge(core);
+        core.context = previous;
+        restore_interrupts(irq_state);
+    }
+
+private:
+    struct CoreState {
+        uint8_t context;            // Zero-initialised: MAIN
+        bool started;
+        uint32_t since_us;          // Start of the current context
+        uint64_t time_us[DMX_LOAD_CONTEXT_COUNT];
+    };
+
+    // Close the current context's time up to now; interrupts masked
+    static inline void charge(CoreState& core) {
+        uint32_t now = timer_hw->timerawl;
+        if (core.started) {
+            core.time_us[core.context] += now - core.since_us;
+        }
+        core.started = true;
+        core.since_us = now;
+    }
+
+    static inline CoreState _cores[DMX_LOAD_NUM_CORES] = {};
+    static inline Usage _last_sample[DMX_LOAD_NUM_CORES] = {};
+#endif
+};
+
+#if DMX_LOAD
+#define DMX_LOAD_ENTER(var, context) uint8_t var = DMXLoad::enter(context)
+#define DMX_LOAD_LEAVE(var) DMXLoad::leave(var)
+#else
+#define DMX_LOAD_ENTER(var, context)
+#define DMX_LOAD_LEAVE(var)
+#endif
+
+#endif // DMX_LOAD_H
@@ -0,0 +1,80 @@
+#ifndef DMX_LOG_H
+#define DMX_LOG_H
+
+#include "pico/stdlib.h"
+#include <type_traits>
+
+// Deferred logging.
+// DMX_LOG(format, args...) only records the format string's ID and up to four
+// raw pointer-sized arguments into a per-core ring (interrupts are masked for the few
+// instructions of the copy), so it is safe in IRQ handlers and never blocks.
+// Formatting happens later: DMXLog::flush() prints pending records from the
+// idle loop, or DMXLog::flush(telemetry) ships them as binary LOG packets that
+// tools/dmx_telemetry_view.cpp formats on the host, matching IDs against the
+// DMX_LOG format strings it finds in the sources.
+//
+// Arguments must be integers, characters, enums or pointers no wider than a
+// pointer; %s is only valid for strings that outlive the flush (e.g.
+// literals). Floating point is rejected. flush() hands each conversion its
+// argument as the type the conversion names (int, long, char*, ...), so
+// the same format strings print correctly on the 64-bit host build. LOG
+// packets carry the low 32 bits of each argument.
+
+#define DMX_LOG_MAX_ARGS 4
+#define DMX_LOG_RING_SIZE 64 // Records per core, power of two
+
+static_assert((DMX_LOG_RING_SIZE & (DMX_LOG_RING_SIZE - 1)) == 0, "ring indices wrap with a mask");
+
+#define DMX_LOG(format, ...) \
+    DMXLog::write(std::integral_constant<uint32_t, DMXLog::hash(format)>::value, format, ##__VA_ARGS__)
+
+class DMXTelemetry;
+
+class DMXLog {
+public:
+    struct Record {
+        uint32_t id;
+        const char* format;
+        uint32_t timestamp_us;
+        uintptr_t args[DMX_LOG_MAX_ARGS];
+        uint8_t num_args;
+        uint8_t core;
+    };
+
+    // Format string ID (32-bit FNV-1a), evaluated at compile time by DMX_LOG
+    static constexpr uint32_t hash(const char* format) {
+        uint32_t h = 2166136261u;
+        while (*format) {
+            h = (h ^ (uint8_t)*format++) * 16777619u;
+        }
+        return h;
+    }
+
+    template <typename... Args>
+    static inline void write(uint32_t id, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= DMX_LOG_MAX_ARGS, "DMX_LOG takes at most 4 arguments");
+        const uintptr_t values[DMX_LOG_MAX_ARGS + 1] = {toArg(args)...};
+        record(id, format, values, (uint8_t)sizeof...(Args));
+    }
+
+    // Format and print up to max_records pending records (idle loop only)
+    static uint16_t flush(uint16_t max_records = 16);
+
+    // Queue up to max_records pending records as binary LOG packets
+    static uint16_t flush(DMXTelemetry& telemetry, uint16_t max_records = 16);
+
+    // Records lost because a ring was full (all cores)
+    static uint32_t getDropped();
+
+private:
+    static void record(uint32_t id, const char* format, const uintptr_t* args, uint8_t num_args);
+
+    template <typename T>
+    static inline uintptr_t toArg(T value) {
+        static_assert(!std::is_floating_point<T>::value, "DMX_LOG does not format floating point arguments");
+        static_assert(sizeof(T) <= sizeof(uintptr_t), "DMX_LOG arguments must fit in a pointer");
+        return (uintptr_t)value;
+    }
+};
+
+#endif // DMX_LOG_H
@@ -17,6 +17,8 @@ private:
     uint8_t _num_universes;
     bool _is_initialized;
     MultiDMXDataCallback _callback;
+    bool _change_detection;
+    bool _skip_unchanged;
     
     // Static callback handlers for each universe
     static void universe_callback_0(DMXReceiver* receiver);
@@ -37,6 +39,11 @@ private:
     // Handle callback from specific universe
     void handleUniverseDataReceived(uint8_t universe_index);
     
+    // Start or stop one universe's receiver, leaving its buffer in place
+    bool startUniverse(uint8_t universe_index, uint gpio_pin);
+    void stopUniverse(uint8_t universe_index);
+    void releaseUniverse(uint8_t universe_index);
+    
 public:
     DMXMultiReceiver();
     ~DMXMultiReceiver();
@@ -52,6 +59,19 @@ public:
     // Cleanup resources
     void end();
     
+    // Live reconfiguration: add, remove or move one universe while the others
+    // keep receiving. Only that universe's state machine and DMA channel are
+    // claimed or released, and the PIO program stays loaded while any other
+    // input uses it. Universe indices are fixed slots (pio0 for 0-3, pio1 for
+    // 4-7, as begin() assigns them), so removing one does not renumber the
+    // rest. A remapped universe keeps its buffer and statistics and picks up
+    // at the next break on the new pin; if it cannot restart there it is
+    // removed. Call from the main loop, not from the data callback.
+    bool addUniverse(uint8_t universe_index, uint gpio_pin);
+    bool removeUniverse(uint8_t universe_index);
+    bool remapUniverse(uint8_t universe_index, uint gpio_pin);
+    bool isUniverseActive(uint8_t universe_index) const;
+    
     // Get channel value from specific universe (0-based universe index, 1-based channel)
     uint8_t getChannel(uint8_t universe_index, uint16_t channel) const;
     
@@ -70,7 +90,18 @@ public:
     // Check if all universes have signals
     bool areAllSignalsPresent(unsigned long timeout_ms = 1000);
     
-    // Status getters
+    // Change detection on every universe (see DMXReceiver::enableChangeDetection()):
+    // the first universe gets the DMA sniffer, the others a software CRC. An
+    // identical frame skips the statistics scan, and with skip_unchanged the
+    // callback too.
+    bool enableChangeDetection(bool skip_unchanged = false);
+    void disableChangeDetection();
+    
+    // Whether the universe's latest frame differed from the one before, and its CRC
+    bool isUniverseChanged(uint8_t universe_index) const;
+    uint32_t getFrameCrc(uint8_t universe_index) const;
+    
+    // Status getters (the number of universes is one past the highest active index)
     uint8_t getNumUniverses() const;
     bool isInitialized() const;
     uint getGpioPin(uint8_t universe_index) const;
@@ -78,6 +109,8 @@ public:
     // Statistics
     struct UniverseStats {
         unsigned long frames_received;
+        unsigned long frames_changed;     // With change detection: frames that differed from the one before
+        unsigned long frames_identical;
         unsigned long last_frame_timestamp;
         uint16_t active_channels; // channels with non-zero values
         uint8_t max_value;
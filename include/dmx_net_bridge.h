@@ -0,0 +1,51 @@
+#ifndef DMX_NET_BRIDGE_H
+#define DMX_NET_BRIDGE_H
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+#include "dmx_multi_receiver.h"
+#include "dmx_net_protocol.h"
+
+// Art-Net / sACN gateway between a network stack and the DMX ports.
+// Feed it UDP payloads from whatever stack the board uses (lwIP on a Pico W,
+// an SPI Ethernet chip, ...); it owns no sockets itself.
+class DMXNetBridge {
+public:
+    DMXNetBridge();
+
+    // Attach initialized transmitters (network ingest -> DMX out)
+    bool begin(DMXTransmitter outputs[], uint8_t num_outputs);
+
+    // Map a network universe onto outputs[output]
+    bool setRoute(uint8_t output, uint8_t protocol, uint16_t universe);
+
+    // Route one UDP payload into the transmitter back buffers
+    void handlePacket(const uint8_t* buffer, size_t size);
+
+    // Non-blocking: transmit outputs with a completed frame once they are idle.
+    // Returns a bitmask of the outputs started.
+    uint8_t poll();
+
+    // Identity used for sACN egress
+    void setSource(const DMXNetSource& source);
+
+    // Encode a received universe (DMX in -> network egress). Returns the packet size.
+    // Each protocol keeps its own per-universe sequence counter.
+    size_t encodeArtDmx(const DMXMultiReceiver& rx, uint8_t universe_index, uint16_t port_address, uint8_t* out);
+    size_t encodeSACN(const DMXMultiReceiver& rx, uint8_t universe_index, uint16_t universe, uint8_t* out);
+
+    DMXNetRouter::Stats getStats() const;
+
+private:
+    DMXTransmitter* _outputs;
+    uint8_t _num_outputs;
+    DMXNetRouter _router;
+    uint8_t _ready;
+    DMXNetSource _source;
+    uint8_t _artnet_sequence[MAX_DMX_RECEIVERS];
+    uint8_t _sacn_sequence[MAX_DMX_RECEIVERS];
+
+    static uint8_t* resolveOutput(uint8_t output, void* context);
+};
+
+#endif // DMX_NET_BRIDGE_H
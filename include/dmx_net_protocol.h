@@ -0,0 +1,171 @@
+#ifndef DMX_NET_PROTOCOL_H
+#define DMX_NET_PROTOCOL_H
+
+// Art-Net (ArtDmx / ArtSync) and sACN / E1.31 (data / sync) packet codec and
+// universe router. Works on raw UDP payloads, so it is shared by the firmware
+// and the host tools (tools/dmx_net_bench.cpp); deliberately free of Pico SDK
+// dependencies.
+//
+// Parsing never copies: a parsed packet points into the caller's buffer, and
+// the router copies slot data exactly once, straight into the destination
+// universe buffer (normally a DMXTransmitter back buffer).
+//
+// Art-Net  UDP 6454. "Art-Net\0", opcode (LE), protocol version 14 (BE),
+//          sequence, physical, 15-bit port-address (LE), length (BE), data
+// sACN     UDP 5568. Root layer (38 bytes), framing layer (77 bytes),
+//          DMP layer (10 bytes + start code + data); all big-endian
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef DMX_UNIVERSE_SIZE
+#define DMX_UNIVERSE_SIZE 512
+#endif
+
+#define DMX_ARTNET_PORT 6454
+#define DMX_SACN_PORT 5568
+
+#define DMX_ARTNET_OP_DMX 0x5000
+#define DMX_ARTNET_OP_SYNC 0x5200
+#define DMX_ARTNET_PROTOCOL_VERSION 14
+#define DMX_ARTNET_DMX_HEADER_SIZE 18
+#define DMX_ARTNET_SYNC_SIZE 14
+
+#define DMX_SACN_DATA_HEADER_SIZE 126 // Up to and including the start code
+#define DMX_SACN_SYNC_SIZE 49
+#define DMX_SACN_CID_SIZE 16
+#define DMX_SACN_SOURCE_NAME_SIZE 64
+#define DMX_SACN_DEFAULT_PRIORITY 100
+#define DMX_SACN_MAX_PRIORITY 200
+#define DMX_SACN_MAX_UNIVERSE 63999
+
+// sACN framing options
+#define DMX_SACN_OPT_PREVIEW 0x80
+#define DMX_SACN_OPT_TERMINATED 0x40
+#define DMX_SACN_OPT_FORCE_SYNC 0x20
+
+#define DMX_NET_MAX_PACKET (DMX_SACN_DATA_HEADER_SIZE + DMX_UNIVERSE_SIZE)
+#define DMX_NET_MAX_OUTPUTS 8
+
+// A source is dropped if it sends nothing for this long (sACN network data loss)
+#define DMX_NET_SOURCE_TIMEOUT_MS 2500
+// Synchronised output is abandoned if no sync packet arrives for this long
+#define DMX_NET_SYNC_TIMEOUT_MS 4000
+
+enum DMXNetProtocol {
+    DMX_NET_NONE = 0,
+    DMX_NET_ARTNET = 1,
+    DMX_NET_SACN = 2
+};
+
+// Parsed view of one packet; data and cid point into the packet buffer
+struct DMXNetPacket {
+    enum Kind { DATA, SYNC };
+
+    uint8_t protocol;        // DMXNetProtocol
+    uint8_t kind;
+    uint16_t universe;       // Art-Net port-address or sACN universe
+    const uint8_t* data;     // Slot 1 onwards
+    uint16_t length;         // Number of slots
+    uint8_t sequence;
+    uint8_t priority;        // sACN only (Art-Net reports the default)
+    uint16_t sync_address;   // sACN: 0 = unsynchronised, or the sync packet's address
+    uint8_t options;         // sACN framing options
+    const uint8_t* cid;      // sACN component identifier, nullptr for Art-Net
+};
+
+// Identity used when encoding sACN
+struct DMXNetSource {
+    uint8_t cid[DMX_SACN_CID_SIZE];
+    char name[DMX_SACN_SOURCE_NAME_SIZE];
+    uint8_t priority;
+};
+
+class DMXNetCodec {
+public:
+    // Validate and parse a UDP payload. Returns false for anything that is not a
+    // well-formed ArtDmx/ArtSync or sACN data/sync packet (including non-zero
+    // start codes such as sACN per-slot priority).
+    static bool parse(const uint8_t* buffer, size_t size, DMXNetPacket* packet);
+    static bool parseArtNet(const uint8_t* buffer, size_t size, DMXNetPacket* packet);
+    static bool parseSACN(const uint8_t* buffer, size_t size, DMXNetPacket* packet);
+
+    // Encoders return the packet size written to `out` (DMX_NET_MAX_PACKET bytes
+    // is always enough), or 0 for invalid arguments. Art-Net lengths are padded
+    // to an even slot count as the specification requires.
+    static size_t encodeArtDmx(uint8_t* out, uint16_t port_address, uint8_t sequence,
+                               const uint8_t* data, uint16_t length);
+    static size_t encodeArtSync(uint8_t* out);
+    static size_t encodeSACN(uint8_t* out, const DMXNetSource& source, uint16_t universe,
+                             uint8_t sequence, uint16_t sync_address, uint8_t options,
+                             const uint8_t* data, uint16_t length);
+    static size_t encodeSACNSync(uint8_t* out, const DMXNetSource& source, uint8_t sequence,
+                                 uint16_t sync_address);
+};
+
+// Resolves an output index to its 512-byte destination buffer
+typedef uint8_t* (*DMXNetBufferResolver)(uint8_t output, void* context);
+
+// Routes network universes onto outputs.
+// sACN: the highest-priority live source owns an output; at equal priority the
+// first source keeps it until it terminates or times out. Out-of-order packets
+// are discarded. Data carrying a sync address (and all Art-Net data once
+// ArtSync has been seen) is written to the buffer but only reported ready when
+// the matching sync packet arrives.
+class DMXNetRouter {
+public:
+    struct Stats {
+        uint32_t packets;
+        uint32_t routed;
+        uint32_t invalid;
+        uint32_t unrouted;
+        uint32_t out_of_order;
+        uint32_t priority_rejects;
+        uint32_t syncs;
+    };
+
+    DMXNetRouter();
+
+    void begin(DMXNetBufferResolver resolver, void* context);
+
+    // Map a network universe onto an output index (one route per output)
+    bool setRoute(uint8_t output, uint8_t protocol, uint16_t universe);
+    void clearRoutes();
+
+    // Parse and route one UDP payload. Returns a bitmask of outputs whose
+    // buffers now hold a complete frame and should be transmitted.
+    uint8_t handlePacket(const uint8_t* buffer, size_t size, uint32_t now_ms);
+
+    // Route an already-parsed packet
+    uint8_t route(const DMXNetPacket& packet, uint32_t now_ms);
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    struct Output {
+        uint8_t protocol;
+        uint16_t universe;
+        bool has_source;
+        uint8_t cid[DMX_SACN_CID_SIZE];
+        uint8_t priority;
+        uint8_t last_sequence;
+        uint32_t last_packet_ms;
+        uint16_t sync_address;     // Sync address of the last data packet (sACN)
+        uint32_t last_sync_ms;
+        bool sync_seen;
+        bool pending;              // Written, waiting for a sync packet
+    };
+
+    DMXNetBufferResolver _resolver;
+    void* _context;
+    Output _outputs[DMX_NET_MAX_OUTPUTS];
+    uint32_t _artsync_ms;
+    bool _artsync_seen;
+    Stats _stats;
+
+    bool acceptSource(Output& output, const DMXNetPacket& packet, uint32_t now_ms);
+    uint8_t handleSync(const DMXNetPacket& packet, uint32_t now_ms);
+};
+
+#endif // DMX_NET_PROTOCOL_H
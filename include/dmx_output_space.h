@@ -0,0 +1,165 @@
+#ifndef DMX_OUTPUT_SPACE_H
+#define DMX_OUTPUT_SPACE_H
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+#include <cstring>
+
+#ifndef DMX_SPACE_MAX_UNIVERSES
+#define DMX_SPACE_MAX_UNIVERSES 8
+#endif
+#define DMX_SPACE_SIZE (DMX_SPACE_MAX_UNIVERSES * DMX_UNIVERSE_SIZE)
+
+static_assert(DMX_SPACE_MAX_UNIVERSES <= 32, "one dirty bit per universe in a uint32_t");
+
+class DMXOutputSpace;
+
+// Writable run of slots in a DMXOutputSpace. A pointer and a length, so
+// stores and copies through it compile to direct stores and memcpy; a run
+// may straddle universes.
+//
+// Taking a span marks its universes dirty for the next flush. A span kept
+// across frames calls commit() once after each frame's writes to mark them
+// dirty again; otherwise those writes wait in the space until something else
+// dirties their universes.
+class DMXSlotSpan {
+public:
+    DMXSlotSpan() : _space(nullptr), _data(nullptr), _address(0), _length(0) {}
+
+    uint8_t& operator[](uint16_t index) const { return _data[index]; }
+    uint8_t* data() const { return _data; }
+    uint8_t* begin() const { return _data; }
+    uint8_t* end() const { return _data + _length; }
+    uint16_t size() const { return _length; }
+    bool empty() const { return _length == 0; }
+
+    void fill(uint8_t value) const { memset(_data, value, _length); }
+    void copyFrom(const uint8_t* source) const { memcpy(_data, source, _length); }
+    // Empty if offset + length overruns the span
+    DMXSlotSpan subspan(uint16_t offset, uint16_t length) const {
+        if ((uint32_t)offset + length > _length) {
+            return DMXSlotSpan();
+        }
+        return DMXSlotSpan(_space, _data + offset, (uint16_t)(_address + offset), length);
+    }
+
+    // Mark the span's universes dirty again, for a span written after a flush
+    inline void commit() const;
+
+private:
+    friend class DMXOutputSpace;
+
+    DMXSlotSpan(DMXOutputSpace* space, uint8_t* data, uint16_t address, uint16_t length)
+        : _space(space), _data(data), _address(address), _length(length) {}
+
+    DMXOutputSpace* _space;
+    uint8_t* _data;
+    uint16_t _address;
+    uint16_t _length;
+};
+
+// Read-only run of slots in a DMXOutputSpace
+class DMXSlotView {
+public:
+    DMXSlotView() : _data(nullptr), _length(0) {}
+    DMXSlotView(const uint8_t* data, uint16_t length) : _data(data), _length(length) {}
+
+    uint8_t operator[](uint16_t index) const { return _data[index]; }
+    const uint8_t* data() const { return _data; }
+    const uint8_t* begin() const { return _data; }
+    const uint8_t* end() const { return _data + _length; }
+    uint16_t size() const { return _length; }
+    bool empty() const { return _length == 0; }
+
+    void copyTo(uint8_t* destination) const { memcpy(destination, _data, _length); }
+    DMXSlotView subview(uint16_t offset, uint16_t length) const {
+        return (uint32_t)offset + length <= _length ? DMXSlotView(_data + offset, length) : DMXSlotView();
+    }
+
+private:
+    const uint8_t* _data;
+    uint16_t _length;
+};
+
+// One flat, 0-based output address space over all universes: address =
+// universe * 512 + slot, with slot 0 being channel 1. Slots live in one
+// contiguous buffer, so fixtures that straddle a universe boundary are a
+// single span. Writes mark their universes dirty; at the frame boundary
+// transmit() copies each dirty universe once, straight into the transmitter
+// that sends it, and sends the others' last frame again without copying
+// anything.
+//
+// Outputs covered by the space should be written only through it: slots
+// written directly into a transmitter are overwritten by the next flush of
+// its universe, or not sent while the universe stays clean. Their back
+// buffers do not track the frame on the wire; read the space instead (e.g.
+// DMXStateStore::commit() from view()s).
+class DMXOutputSpace {
+public:
+    DMXOutputSpace();
+
+    // Cover universes 0..num_universes-1, all slots zero and dirty
+    bool begin(uint8_t num_universes);
+
+    uint8_t getNumUniverses() const;
+    uint16_t size() const;                       // num_universes * 512
+
+    // Address of a 1-based channel in a 0-based universe
+    static uint16_t address(uint8_t universe, uint16_t channel) {
+        return (uint16_t)(universe * DMX_UNIVERSE_SIZE + channel - 1);
+    }
+
+    // Single slots, unchecked: address must be below size()
+    void set(uint16_t address, uint8_t value) {
+        _slots[address] = value;
+        _dirty |= 1u << (address / DMX_UNIVERSE_SIZE);
+    }
+    uint8_t get(uint16_t address) const { return _slots[address]; }
+
+    // Bounds-checked once per call; marks the span's universes dirty, as the
+    // caller writes through it (see DMXSlotSpan::commit()). Empty if the
+    // range is out of bounds.
+    DMXSlotSpan span(uint16_t address, uint16_t length);
+    DMXSlotView view(uint16_t address, uint16_t length) const;
+    DMXSlotSpan universeSpan(uint8_t universe);
+
+    bool write(uint16_t address, const uint8_t* data, uint16_t length);
+    bool fill(uint16_t address, uint8_t value, uint16_t length);
+    bool read(uint16_t address, uint8_t* data, uint16_t length) const;
+    void clear();
+
+    // Dirty tracking, one bit per universe
+    void markDirty(uint16_t address, uint16_t length);
+    void markAllDirty();
+    bool isDirty(uint8_t universe) const;
+    uint32_t getDirtyMask() const;
+
+    // Copy the dirty universes into the back buffers of outputs[0..] and mark
+    // them clean; returns the number copied. Their next transmit() sends them.
+    uint8_t flush(DMXTransmitter outputs[], uint8_t num_outputs);
+
+    // Frame boundary: send the dirty universes with
+    // DMXTransmitter::transmitUniverse(), one copy each, those left in the
+    // back buffers by flush() with transmit(), and retransmit() the rest.
+    // Outputs beyond the space are transmit()ted as usual. Returns the number
+    // of universes that changed.
+    uint8_t transmit(DMXTransmitter outputs[], uint8_t num_outputs);
+
+    // Take the space's contents from the outputs' back buffers (e.g. after
+    // DMXStateStore::restore()), all dirty so the next transmit() sends them
+    void load(DMXTransmitter outputs[], uint8_t num_outputs);
+
+private:
+    uint8_t _slots[DMX_SPACE_SIZE];
+    uint8_t _num_universes;
+    uint32_t _dirty;
+    uint32_t _flushed;             // In the back buffer, not yet transmitted
+};
+
+inline void DMXSlotSpan::commit() const {
+    if (_space != nullptr) {
+        _space->markDirty(_address, _length);
+    }
+}
+
+#endif // DMX_OUTPUT_SPACE_H
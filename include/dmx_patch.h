@@ -0,0 +1,67 @@
+#ifndef DMX_PATCH_H
+#define DMX_PATCH_H
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+#include "dmx_multi_receiver.h"
+
+#define MAX_DMX_PATCH_RUNS 256
+
+// Soft-patch (routing matrix) from input universes to output universes.
+// A patch table is compiled once into a sorted list of coalesced contiguous
+// copy runs, which apply() then executes per frame with one memcpy per run.
+class DMXPatch {
+public:
+    // One patch table entry (0-based universe index, 1-based channels)
+    // e.g. {0, 1, 1, 101, 48}: input universe 1 slots 1-48 -> output universe 2 slots 101-148
+    struct PatchEntry {
+        uint8_t src_universe;
+        uint16_t src_channel;
+        uint8_t dst_universe;
+        uint16_t dst_channel;
+        uint16_t length;
+    };
+
+    // Compiled copy run (0-based slot offsets)
+    struct CopyRun {
+        uint8_t src_universe;
+        uint8_t dst_universe;
+        uint16_t src_offset;
+        uint16_t dst_offset;
+        uint16_t length;
+    };
+
+    DMXPatch();
+
+    // Compile a patch table into copy runs and make it the active patch.
+    // Fails (leaving the current patch active) if an entry is out of range,
+    // two entries write the same output slot, or the run table overflows.
+    // Safe to call while apply() runs on the other core or in an IRQ.
+    bool compile(const PatchEntry* entries, uint16_t count);
+
+    // Remove all routes
+    void clear();
+
+    // Execute the active patch from raw 512-byte input universes into transmitters
+    void apply(const uint8_t* const src_universes[], uint8_t num_src,
+               DMXTransmitter dst_outputs[], uint8_t num_dst);
+
+    // Execute the active patch from a multi-universe receiver into transmitters
+    void apply(const DMXMultiReceiver& rx, DMXTransmitter dst_outputs[], uint8_t num_dst);
+
+    // Compiled patch inspection
+    uint16_t getNumRuns() const;
+    uint16_t getNumPatchedSlots() const;
+    const CopyRun* getRuns() const;
+
+private:
+    // Double-buffered run tables: compile() fills the inactive table and then
+    // publishes it by swapping _active, so apply() never sees a half-built patch
+    CopyRun _runs[2][MAX_DMX_PATCH_RUNS];
+    uint16_t _num_runs[2];
+    uint16_t _num_slots[2];
+    volatile uint8_t _active;
+    volatile int8_t _busy_table; // table being read by apply(), -1 when idle
+};
+
+#endif // DMX_PATCH_H
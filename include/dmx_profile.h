@@ -0,0 +1,140 @@
+#ifndef DMX_PROFILE_H
+#define DMX_PROFILE_H
+
+#include "pico/stdlib.h"
+
+// Hot-path instrumentation, compiled in with -DDMX_PROFILE=ON (CMake option).
+// Each metric is a histogram of microsecond durations in power-of-two buckets:
+//   RX_IRQ_LATENCY    receive DMA completion -> dmxinput_dma_handler entry
+//   RX_IRQ_DURATION   dmxinput_dma_handler entry -> exit (all inputs serviced)
+//   RX_REARM_LATENCY  receive DMA completion -> DMA re-armed for the next frame
+//   TX_START_JITTER   DMXFramePipeline frame start behind its scheduled time
+//   CALLBACK_U0..U7   DMXMultiReceiver user callback, per universe
+//
+// DMA completion has no timestamp of its own, so every receive channel is
+// chained to one shared channel that copies the raw timer into memory the
+// moment a frame lands. That costs one DMA channel while profiling is on.
+// When several universes complete before the handler runs, the stamp is the
+// latest of them, so latency is understated, never overstated.
+//
+// Each metric has a single writer (an IRQ handler or the frame loop) and is
+// updated with plain 32-bit stores, so recording never masks interrupts or
+// takes a lock. getHistogram() copies the fields one by one; a copy taken
+// while the writer is active can be one sample out between fields.
+//
+// With DMX_PROFILE off the DMX_PROFILE_* macros expand to nothing and the
+// getters return empty histograms, so hot paths carry no overhead.
+
+#ifndef DMX_PROFILE
+#define DMX_PROFILE 0
+#endif
+
+#if DMX_PROFILE
+#include "hardware/dma.h"
+#include "hardware/structs/timer.h"
+#endif
+
+#define DMX_PROFILE_BUCKETS 16 // Bucket 0: 0 us, bucket b: [2^(b-1), 2^b) us, the last is open-ended
+#define DMX_PROFILE_UNIVERSES 8
+
+enum DMXProfileMetric {
+    DMX_PROFILE_RX_IRQ_LATENCY = 0,
+    DMX_PROFILE_RX_IRQ_DURATION = 1,
+    DMX_PROFILE_RX_REARM_LATENCY = 2,
+    DMX_PROFILE_TX_START_JITTER = 3,
+    DMX_PROFILE_CALLBACK_U0 = 4,
+    DMX_PROFILE_METRIC_COUNT = DMX_PROFILE_CALLBACK_U0 + DMX_PROFILE_UNIVERSES
+};
+
+class DMXTelemetry;
+
+class DMXProfile {
+public:
+    struct Histogram {
+        uint32_t count;
+        uint32_t total_us;   // Wraps after ~71 minutes of accumulated time
+        uint32_t max_us;
+        uint32_t buckets[DMX_PROFILE_BUCKETS];
+    };
+
+    static constexpr bool isEnabled() {
+        return DMX_PROFILE != 0;
+    }
+
+    static const char* getName(uint8_t metric);
+
+    // Snapshot of one metric (all zero when profiling is compiled out)
+    static Histogram getHistogram(uint8_t metric);
+
+    // Clear all metrics; samples recorded concurrently may survive
+    static void reset();
+
+    // Queue one PROFILE packet per metric that has samples; returns packets queued
+    static uint8_t flush(DMXTelemetry& telemetry);
+
+#if DMX_PROFILE
+    static inline void record(uint8_t metric, uint32_t us) {
+        volatile Histogram& h = _histograms[metric];
+        uint8_t bucket = us == 0 ? 0 : (uint8_t)(32 - __builtin_clz(us));
+        if (bucket >= DMX_PROFILE_BUCKETS) {
+            bucket = DMX_PROFILE_BUCKETS - 1;
+        }
+        h.buckets[bucket] = h.buckets[bucket] + 1;
+        h.total_us = h.total_us + us;
+        if (us > h.max_us) {
+            h.max_us = us;
+        }
+        h.count = h.count + 1;
+    }
+
+    static inline uint32_t nowUs() {
+        return timer_hw->timerawl;
+    }
+
+    // A start stamp that landed after the end counts as 0
+    static inline uint32_t elapsedUs(uint32_t start_us, uint32_t end_us) {
+        int32_t elapsed = (int32_t)(end_us - start_us);
+        return elapsed > 0 ? (uint32_t)elapsed : 0;
+    }
+
+    static inline uint32_t completionUs() {
+        return _completion_us;
+    }
+
+    // Shared channel that copies the timer into completionUs() when triggered;
+    // claimed on first use
+    static inline uint timestampChannel() {
+        if (_timestamp_channel < 0) {
+            _timestamp_channel = dma_claim_unused_channel(true);
+            dma_channel_config cfg = dma_channel_get_default_config(_timestamp_channel);
+            channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+            channel_config_set_read_increment(&cfg, false);
+            channel_config_set_write_increment(&cfg, false);
+            channel_config_set_dreq(&cfg, DREQ_FORCE);
+            channel_config_set_irq_quiet(&cfg, true);
+            dma_channel_configure(_timestamp_channel, &cfg, &_completion_us, &timer_hw->timerawl, 1, false);
+        }
+        return (uint)_timestamp_channel;
+    }
+
+private:
+    static inline volatile Histogram _histograms[DMX_PROFILE_METRIC_COUNT] = {};
+    static inline volatile uint32_t _completion_us = 0;
+    static inline int _timestamp_channel = -1;
+#endif
+};
+
+#if DMX_PROFILE
+#define DMX_PROFILE_STAMP(var) uint32_t var = DMXProfile::nowUs()
+#define DMX_PROFILE_SINCE(metric, var) DMXProfile::record((metric), DMXProfile::elapsedUs((var), DMXProfile::nowUs()))
+#define DMX_PROFILE_RECORD(metric, us) DMXProfile::record((metric), (us))
+// Chain a receive DMA channel config to the completion timestamp channel
+#define DMX_PROFILE_CHAIN_COMPLETION(cfg) channel_config_set_chain_to((cfg), DMXProfile::timestampChannel())
+#else
+#define DMX_PROFILE_STAMP(var)
+#define DMX_PROFILE_SINCE(metric, var)
+#define DMX_PROFILE_RECORD(metric, us)
+#define DMX_PROFILE_CHAIN_COMPLETION(cfg)
+#endif
+
+#endif // DMX_PROFILE_H
@@ -0,0 +1,203 @@
+#ifndef DMX_RDM_CONTROLLER_H
+#define DMX_RDM_CONTROLLER_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "dmx_transmitter.h"
+#include "dmx_rdm_protocol.h"
+
+#define DMX_RDM_MAX_DEVICES 256
+#define DMX_RDM_QUEUE_SIZE 8
+#define DMX_RDM_DISCOVERY_STACK 100   // Ranges pending; 2 per level of the 48-bit search
+#define DMX_RDM_RX_BUFFER_SIZE 300    // Longest response plus the break and some slack
+
+enum DMXRdmStatus {
+    DMX_RDM_STATUS_OK = 0,        // Valid response (check port_or_response for NACKs)
+    DMX_RDM_STATUS_TIMEOUT,       // No response started in time
+    DMX_RDM_STATUS_INVALID,       // Something arrived but was not the response
+    DMX_RDM_STATUS_BROADCAST      // Sent; broadcasts get no response
+};
+
+// Completion callback of a queued GET/SET. response is only set with
+// DMX_RDM_STATUS_OK and is valid for the duration of the call.
+typedef void (*DMXRdmCallback)(class DMXRdmController* controller, DMXRdmStatus status,
+                               const DMXRdmPacket* response, void* user_data);
+
+// RDM (E1.20) controller on the line of a DMXTransmitter.
+//
+// DmxOutput only drives the line, so responses come in through a second pin
+// (the RO side of the transceiver) on a receive state machine that runs the
+// DmxInput program from its byte loop: a plain 250 kbaud UART that reads a
+// responder's break as one 0x00 byte. enable_pin drives the transceiver's DE
+// high while the controller transmits.
+//
+// poll() is a non-blocking state machine: a null start code frame every
+// frame_period_us, and between two frames up to setTransactionsPerFrame() RDM
+// transactions (request, turnaround, response, E1.20 spacing). Each
+// transaction delays the next frame by at most ~8 ms (a discovery branch
+// without a response); 0 for frame_period_us sends no DMX and runs RDM
+// back to back.
+//
+// Discovery is a DISC_UNIQUE_BRANCH binary search. A range that collides is
+// split; when the lower half of a collided range turns out empty, the upper
+// half must hold the colliding devices and is split without asking it first.
+// Every decoded UID is confirmed with DISC_MUTE before it is listed.
+class DMXRdmController {
+public:
+    struct Stats {
+        uint32_t dmx_frames;
+        uint32_t transactions;          // RDM packets sent
+        uint32_t timeouts;              // Responses that never started
+        uint32_t invalid;               // Responses that did not decode or match
+        uint32_t discovery_branches;    // DISC_UNIQUE_BRANCH requests
+        uint32_t collisions;            // Branch responses that did not decode
+        uint32_t last_discovery_us;     // Duration of the last completed discovery
+    };
+
+    DMXRdmController();
+    ~DMXRdmController();
+
+    // transmitter must be initialized; uid is the controller's own UID
+    bool begin(DMXTransmitter* transmitter, uint rx_pin, int enable_pin, uint64_t uid,
+               PIO rx_pio = pio1, uint32_t frame_period_us = 25000);
+
+    // Release the receive state machine, its DMA channel and program and the
+    // enable pin. Queued requests and a discovery in progress are dropped
+    // without callbacks; the transmitter is left running.
+    void end();
+
+    // RDM transactions between two DMX frames (at least 1)
+    void setTransactionsPerFrame(uint8_t transactions);
+
+    // Full discovery unmutes everything and starts an empty device list;
+    // incremental keeps the list, re-mutes the known devices (dropping those
+    // that no longer answer) and searches for new ones
+    bool startDiscovery(bool incremental = false);
+    bool isDiscovering() const;
+    uint16_t getNumDevices() const;
+    uint64_t getDevice(uint16_t index) const;
+
+    // Queue a request; callback may be null. dest may be DMX_RDM_BROADCAST_UID.
+    bool sendRequest(uint64_t dest, uint8_t command_class, uint16_t pid, const uint8_t* pd, uint8_t pdl,
+                     DMXRdmCallback callback, void* user_data = nullptr,
+                     uint16_t sub_device = DMX_RDM_ROOT_DEVICE);
+    bool get(uint64_t dest, uint16_t pid, DMXRdmCallback callback, void* user_data = nullptr,
+             const uint8_t* pd = nullptr, uint8_t pdl = 0);
+    bool set(uint64_t dest, uint16_t pid, const uint8_t* pd, uint8_t pdl,
+             DMXRdmCallback callback = nullptr, void* user_data = nullptr);
+
+    // Nothing queued, no discovery and nothing in flight
+    bool isIdle() const;
+
+    // Advance the line; never blocks. Returns true if a packet or frame was started.
+    bool poll();
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    enum State : uint8_t {
+        STATE_IDLE,
+        STATE_SENDING_DMX,
+        STATE_SENDING,
+        STATE_LISTENING,
+        STATE_SPACING
+    };
+
+    enum Kind : uint8_t {
+        KIND_USER,
+        KIND_DISC_UN_MUTE,
+        KIND_DISC_BRANCH,
+        KIND_DISC_MUTE
+    };
+
+    enum DiscoveryPhase : uint8_t {
+        DISCOVERY_OFF,
+        DISCOVERY_UN_MUTE,
+        DISCOVERY_MUTE_KNOWN,       // Incremental: re-mute the listed devices
+        DISCOVERY_SEARCH
+    };
+
+    struct Request {
+        DMXRdmPacket packet;
+        DMXRdmCallback callback;
+        void* user_data;
+    };
+
+    struct Branch {
+        uint64_t lower;
+        uint64_t upper;
+        bool first_child;           // Lower half of a collided range
+        bool must_split;            // Known to hold two or more devices
+    };
+
+    DMXTransmitter* _transmitter;
+    PIO _rx_pio;
+    uint _rx_sm;
+    uint _rx_offset;
+    uint _rx_dma;
+    int _enable_pin;
+    uint64_t _uid;
+    uint32_t _frame_period_us;
+    uint8_t _transactions_per_frame;
+    bool _initialized;
+
+    State _state;
+    uint64_t _next_frame_us;
+    uint8_t _frame_transactions;    // Transactions since the last DMX frame
+    uint64_t _ready_us;             // End of the spacing after the last packet
+    uint64_t _tx_end_us;
+    uint64_t _last_rx_us;
+    uint16_t _last_rx_count;
+    uint8_t _transaction;
+
+    // Transaction in flight
+    Kind _kind;
+    bool _expect_response;
+    uint64_t _request_dest;
+    uint8_t _request_cc;
+    uint8_t _request_tn;
+    Request _current;
+    uint8_t _tx[DMX_RDM_MAX_PACKET];
+    uint16_t _tx_length;
+    uint8_t _rx[DMX_RDM_RX_BUFFER_SIZE];
+    DMXRdmPacket _response;
+
+    Request _queue[DMX_RDM_QUEUE_SIZE];
+    uint8_t _queue_head;
+    uint8_t _queue_count;
+
+    DiscoveryPhase _discovery;
+    bool _incremental;
+    uint64_t _discovery_start_us;
+    Branch _stack[DMX_RDM_DISCOVERY_STACK];
+    uint8_t _stack_depth;
+    Branch _branch;                 // Range of the branch request in flight
+    bool _mute_pending;             // A decoded UID waits for DISC_MUTE
+    bool _requery;                  // Its range is back on the stack
+    uint64_t _mute_uid;
+    uint16_t _mute_known_index;
+
+    uint64_t _devices[DMX_RDM_MAX_DEVICES];
+    uint16_t _num_devices;
+
+    Stats _stats;
+
+    bool startTransaction();
+    bool nextDiscoveryRequest();
+    void send(Kind kind, DMXRdmPacket& packet);
+    void setDriver(bool transmit);
+    void startListening();
+    uint16_t rxCount() const;
+    bool responseComplete(uint16_t count, uint64_t now) const;
+    void finishTransaction(uint16_t count, uint64_t now);
+    void onBranchResponse(DMXRdmStatus status, const uint8_t* data, uint16_t length);
+    void onMuteResponse(bool ok);
+    bool pushBranch(uint64_t lower, uint64_t upper, bool first_child, bool must_split);
+    void splitBranch(const Branch& branch);
+    void addDevice(uint64_t uid);
+    void removeDevice(uint16_t index);
+    void endDiscovery();
+};
+
+#endif // DMX_RDM_CONTROLLER_H
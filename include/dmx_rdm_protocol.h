@@ -0,0 +1,138 @@
+#ifndef DMX_RDM_PROTOCOL_H
+#define DMX_RDM_PROTOCOL_H
+
+// RDM (ANSI E1.20) packet codec. Shared by the controller, the responder and
+// the simulated responders of the host build; deliberately free of Pico SDK
+// dependencies.
+//
+// Packet (multi-byte fields big-endian):
+//   0xCC 0x01     Start code, sub start code
+//   length u8     Message length: start code to the end of the parameter data
+//   dest   uid    6 bytes: u16 manufacturer, u32 device
+//   source uid
+//   tn     u8     Transaction number, echoed in the response
+//   port   u8     Port ID in requests, response type in responses
+//   count  u8     Queued message count
+//   sub    u16    Sub-device
+//   cc     u8     Command class
+//   pid    u16    Parameter ID
+//   pdl    u8     Parameter data length, then pdl bytes
+//   check  u16    Sum of all bytes from the start code
+//
+// A DISC_UNIQUE_BRANCH response has no break and no start code: up to seven
+// 0xFE preamble bytes, a 0xAA separator, then the UID and checksum with every
+// byte sent twice (b | 0xAA, b | 0x55), so colliding responses rarely decode.
+//
+// UIDs are held in the low 48 bits of a uint64_t.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DMX_RDM_START_CODE 0xCC
+#define DMX_RDM_SUB_START_CODE 0x01
+#define DMX_RDM_HEADER_SIZE 24       // Start code to PDL
+#define DMX_RDM_CHECK_SIZE 2
+#define DMX_RDM_MAX_PDL 231
+#define DMX_RDM_MAX_PACKET (DMX_RDM_HEADER_SIZE + DMX_RDM_MAX_PDL + DMX_RDM_CHECK_SIZE)
+#define DMX_RDM_DISC_PREAMBLE 0xFE
+#define DMX_RDM_DISC_SEPARATOR 0xAA
+#define DMX_RDM_DISC_MAX_PREAMBLE 7
+#define DMX_RDM_DISC_ENCODED_SIZE 16 // After the separator
+#define DMX_RDM_DISC_MAX_RESPONSE (DMX_RDM_DISC_MAX_PREAMBLE + 1 + DMX_RDM_DISC_ENCODED_SIZE)
+
+#define DMX_RDM_UID_MASK 0xFFFFFFFFFFFFull
+#define DMX_RDM_BROADCAST_UID 0xFFFFFFFFFFFFull
+#define DMX_RDM_ROOT_DEVICE 0x0000
+
+// For the controller and responder: the transceiver switches direction by itself
+#define DMX_RDM_NO_ENABLE_PIN -1
+
+// Timing (E1.20 section 3), microseconds
+#define DMX_RDM_MIN_SPACING_US 176           // Any packet to the next
+#define DMX_RDM_RESPONDER_MIN_DELAY_US 176   // Request end to response start
+#define DMX_RDM_RESPONDER_MAX_DELAY_US 2000
+#define DMX_RDM_RESPONSE_TIMEOUT_US 2800     // Controller gives up on a response that has not started
+#define DMX_RDM_LOST_RESPONSE_SPACING_US 3000
+#define DMX_RDM_DISCOVERY_SPACING_US 5800    // DISC_UNIQUE_BRANCH without a response to the next packet
+#define DMX_RDM_MAX_INTERSLOT_US 2000        // Within a response
+
+enum DMXRdmCommandClass {
+    DMX_RDM_DISCOVERY_COMMAND = 0x10,
+    DMX_RDM_DISCOVERY_COMMAND_RESPONSE = 0x11,
+    DMX_RDM_GET_COMMAND = 0x20,
+    DMX_RDM_GET_COMMAND_RESPONSE = 0x21,
+    DMX_RDM_SET_COMMAND = 0x30,
+    DMX_RDM_SET_COMMAND_RESPONSE = 0x31
+};
+
+enum DMXRdmResponseType {
+    DMX_RDM_ACK = 0x00,
+    DMX_RDM_ACK_TIMER = 0x01,
+    DMX_RDM_NACK_REASON = 0x02,
+    DMX_RDM_ACK_OVERFLOW = 0x03
+};
+
+enum DMXRdmNackReason {
+    DMX_RDM_NR_UNKNOWN_PID = 0x0000,
+    DMX_RDM_NR_FORMAT_ERROR = 0x0001,
+    DMX_RDM_NR_HARDWARE_FAULT = 0x0002,
+    DMX_RDM_NR_WRITE_PROTECT = 0x0004,
+    DMX_RDM_NR_UNSUPPORTED_COMMAND_CLASS = 0x0005,
+    DMX_RDM_NR_DATA_OUT_OF_RANGE = 0x0006,
+    DMX_RDM_NR_SUB_DEVICE_OUT_OF_RANGE = 0x0009
+};
+
+// Parameter IDs used by this library
+enum DMXRdmPid {
+    DMX_RDM_PID_DISC_UNIQUE_BRANCH = 0x0001,
+    DMX_RDM_PID_DISC_MUTE = 0x0002,
+    DMX_RDM_PID_DISC_UN_MUTE = 0x0003,
+    DMX_RDM_PID_SUPPORTED_PARAMETERS = 0x0050,
+    DMX_RDM_PID_DEVICE_INFO = 0x0060,
+    DMX_RDM_PID_DEVICE_MODEL_DESCRIPTION = 0x0080,
+    DMX_RDM_PID_MANUFACTURER_LABEL = 0x0081,
+    DMX_RDM_PID_DEVICE_LABEL = 0x0082,
+    DMX_RDM_PID_SOFTWARE_VERSION_LABEL = 0x00C0,
+    DMX_RDM_PID_DMX_PERSONALITY = 0x00E0,
+    DMX_RDM_PID_DMX_START_ADDRESS = 0x00F0,
+    DMX_RDM_PID_IDENTIFY_DEVICE = 0x1000
+};
+
+#define DMX_RDM_DEVICE_INFO_SIZE 19
+
+struct DMXRdmPacket {
+    uint64_t dest;
+    uint64_t source;
+    uint8_t transaction;
+    uint8_t port_or_response;  // Port ID (request) or DMXRdmResponseType (response)
+    uint8_t message_count;
+    uint16_t sub_device;
+    uint8_t command_class;
+    uint16_t pid;
+    uint8_t pdl;
+    uint8_t pd[DMX_RDM_MAX_PDL];
+};
+
+void dmxRdmWriteUid(uint64_t uid, uint8_t* out);
+uint64_t dmxRdmReadUid(const uint8_t* in);
+
+// Serialize with checksum; returns the length on the wire (0 if pdl is too large)
+uint16_t dmxRdmWrite(const DMXRdmPacket& packet, uint8_t* out);
+
+// Bytes the packet starting at data occupies once its length byte is in (0 before)
+uint16_t dmxRdmPacketLength(const uint8_t* data, uint16_t available);
+
+// Parse and validate (start codes, length, checksum)
+bool dmxRdmRead(const uint8_t* data, uint16_t length, DMXRdmPacket* packet);
+
+// DISC_UNIQUE_BRANCH response with preamble_length (0-7) preamble bytes
+uint16_t dmxRdmWriteDiscoveryResponse(uint64_t uid, uint8_t preamble_length, uint8_t* out);
+
+// Bytes the discovery response starting at data occupies once its separator
+// is in (0 before, or if data does not look like one)
+uint16_t dmxRdmDiscoveryResponseLength(const uint8_t* data, uint16_t available);
+
+// Decode a discovery response; false if it is malformed or collided
+bool dmxRdmReadDiscoveryResponse(const uint8_t* data, uint16_t length, uint64_t* uid);
+
+#endif // DMX_RDM_PROTOCOL_H
@@ -0,0 +1,132 @@
+#ifndef DMX_RDM_RESPONDER_H
+#define DMX_RDM_RESPONDER_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "dmx_receiver.h"
+#include "dmx_rdm_protocol.h"
+
+#define DMX_RDM_LABEL_SIZE 32
+
+// Called after a controller changed a setting (pid is DMX_START_ADDRESS,
+// DEVICE_LABEL or IDENTIFY_DEVICE), e.g. to persist it. Runs inside poll().
+typedef void (*DMXRdmChangeCallback)(class DMXRdmResponder* responder, uint16_t pid, void* user_data);
+
+// RDM (E1.20) responder for a node built on DMXReceiver.
+//
+// A second receive state machine on the receiver's pin captures each packet
+// after a break; poll() drops null start code frames and, once an RDM packet
+// is complete, restarts the receiver's frame (so DMX reception resumes with
+// the next break instead of losing a frame to the RDM packet), validates the
+// checksum and answers. Responses go out on tx_pin through a DmxOutput
+// program state machine: break-led packets, or the discovery response
+// entered at the program's byte loop with no break. enable_pin drives the
+// transceiver's DE high only while responding.
+//
+// The response starts once DMX_RDM_RESPONDER_MIN_DELAY_US have passed since
+// the request was seen complete, and is dropped if poll() got to it too late
+// for DMX_RDM_RESPONDER_MAX_DELAY_US: call poll() at least every ~1.5 ms.
+//
+// Supported: discovery (DISC_UNIQUE_BRANCH, DISC_MUTE, DISC_UN_MUTE), GET
+// SUPPORTED_PARAMETERS, DEVICE_INFO, SOFTWARE_VERSION_LABEL, GET/SET
+// DEVICE_LABEL, DMX_START_ADDRESS, IDENTIFY_DEVICE. Anything else is NACKed.
+class DMXRdmResponder {
+public:
+    struct Stats {
+        uint32_t requests;              // Valid RDM packets seen, for us or not
+        uint32_t responses;             // Sent, including discovery responses
+        uint32_t discovery_responses;
+        uint32_t checksum_errors;       // Or otherwise malformed
+        uint32_t late;                  // Responses dropped: poll() ran past the window
+        uint32_t last_turnaround_us;    // Request complete to response start
+        uint32_t max_turnaround_us;
+    };
+
+    DMXRdmResponder();
+    ~DMXRdmResponder();
+
+    // receiver must be receiving asynchronously (non-inverted); uid is this
+    // device's UID. pio needs room for DmxInput and DmxOutput and two SMs.
+    bool begin(DMXReceiver* receiver, uint tx_pin, int enable_pin, uint64_t uid, PIO pio = pio1);
+
+    // Release both state machines, their DMA channels and program copies,
+    // tx_pin and the enable pin. A response in flight is cut off; the
+    // receiver keeps running.
+    void end();
+
+    // DEVICE_INFO contents; footprint 0 means no DMX start address
+    void setDeviceInfo(uint16_t model_id, uint16_t product_category, uint32_t software_version,
+                       uint16_t footprint);
+    void setSoftwareVersionLabel(const char* label);
+
+    bool setStartAddress(uint16_t address);
+    uint16_t getStartAddress() const;
+    void setDeviceLabel(const char* label);
+    const char* getDeviceLabel() const;
+    bool isIdentifying() const;
+    bool isMuted() const;
+    uint64_t getUid() const;
+
+    void setChangeCallback(DMXRdmChangeCallback callback, void* user_data = nullptr);
+
+    // Receive, answer and send; never blocks. Returns true if a response was started.
+    bool poll();
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    enum State : uint8_t {
+        STATE_LISTENING,
+        STATE_TURNAROUND,
+        STATE_SENDING
+    };
+
+    DMXReceiver* _receiver;
+    PIO _pio;
+    uint _rx_sm;
+    uint _rx_offset;
+    uint _rx_dma;
+    uint _tx_sm;
+    uint _tx_offset;
+    uint _tx_dma;
+    uint _tx_pin;
+    int _enable_pin;
+    uint64_t _uid;
+    bool _initialized;
+
+    State _state;
+    uint64_t _request_end_us;
+    uint8_t _rx[DMX_RDM_MAX_PACKET];
+    uint8_t _tx[DMX_RDM_MAX_PACKET];
+    uint16_t _tx_length;
+    bool _tx_break;                 // Discovery responses go out without one
+
+    bool _muted;
+    bool _identifying;
+    uint16_t _model_id;
+    uint16_t _product_category;
+    uint32_t _software_version;
+    uint16_t _footprint;
+    uint16_t _start_address;
+    char _device_label[DMX_RDM_LABEL_SIZE + 1];
+    char _software_label[DMX_RDM_LABEL_SIZE + 1];
+
+    DMXRdmChangeCallback _change_callback;
+    void* _change_user_data;
+    Stats _stats;
+
+    void rearm();
+    uint16_t rxCount() const;
+    bool handleRequest(const DMXRdmPacket& request);
+    bool handleDiscovery(const DMXRdmPacket& request, bool broadcast);
+    bool respond(const DMXRdmPacket& request, uint8_t response_type, const uint8_t* pd, uint8_t pdl);
+    bool nack(const DMXRdmPacket& request, uint16_t reason);
+    bool respondLabel(const DMXRdmPacket& request, const char* label);
+    void changed(uint16_t pid);
+    void transmit();
+    bool txBusy() const;
+    void setDriver(bool transmit);
+};
+
+#endif // DMX_RDM_RESPONDER_H
@@ -20,6 +20,17 @@ private:
     volatile uint8_t* _buffer;
     volatile uint8_t* _internal_buffer;
     DMXDataCallback _callback;
+    volatile uint32_t _frame_count;
+    volatile uint32_t _alternate_count;
+    
+    // Change detection
+    bool _change_detection;
+    bool _skip_unchanged;
+    bool _crc_valid;                    // _frame_crc belongs to an earlier frame
+    volatile uint32_t _frame_crc;
+    volatile bool _frame_changed;
+    volatile uint32_t _changed_count;
+    volatile uint32_t _identical_count;
     
 public:
     DMXReceiver(uint gpio_pin, uint16_t start_channel = 1, uint16_t num_channels = 512, PIO pio_instance = pio0);
@@ -62,6 +73,42 @@ public:
     // Get current buffer pointer (for advanced use)
     const volatile uint8_t* getBuffer() const;
     
+    // Streaming receive (see DMXSlotStream): the buffer the DMA writes each
+    // frame into (start code, then slots) and how many of its bytes have
+    // arrived so far, read from the DMA transfer count
+    const volatile uint8_t* getDmaBuffer() const;
+    uint16_t getBytesInProgress() const;
+    
+    // Packets completed since startAsync(), whatever their start code. Moves
+    // only once a null start code frame has been copied to the user buffer
+    uint32_t getFrameCount() const;
+    
+    // Packets with a non-zero start code (e.g. RDM). They never reach the
+    // user buffer or the callback, which only see null start code frames.
+    uint32_t getAlternateFrameCount() const;
+    
+    // End the packet in progress now and wait for the next break, e.g. once
+    // an RDM packet is complete (see DMXRdmResponder), so the next frame is
+    // received from its start. Counts as a completed alternate packet.
+    void restartFrame();
+    
+    // Change detection: fingerprint every null start code frame with a CRC-32
+    // (see DMXFrameCrc) and count it as changed or identical to the frame
+    // before. The CRC comes from the DMA sniffer if no other receiver holds
+    // it, otherwise from a software pass in the interrupt. With skip_unchanged,
+    // identical frames are neither copied to the user buffer nor passed to the
+    // callback. Only valid after startAsync().
+    bool enableChangeDetection(bool skip_unchanged = false);
+    void disableChangeDetection();
+    bool isUsingSniffer() const;
+    
+    // The latest frame's CRC (start code + slots), and whether it differed
+    // from the one before; the first frame after enabling always counts as changed
+    uint32_t getFrameCrc() const;
+    bool isFrameChanged() const;
+    uint32_t getChangedFrameCount() const;
+    uint32_t getIdenticalFrameCount() const;
+    
     // Internal method to handle received data (public for callback access)
     void handleDataReceived();
 };
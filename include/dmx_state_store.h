@@ -0,0 +1,83 @@
+#ifndef DMX_STATE_STORE_H
+#define DMX_STATE_STORE_H
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+
+// Flash partition for committed universe state (default: the 64 KB just below
+// the capture partition at 1 MB, so the firmware must stay under 960 KB)
+#ifndef DMX_STATE_FLASH_OFFSET
+#define DMX_STATE_FLASH_OFFSET (960 * 1024)
+#endif
+#ifndef DMX_STATE_FLASH_SIZE
+#define DMX_STATE_FLASH_SIZE (64 * 1024)
+#endif
+
+#ifndef DMX_UNIVERSE_SIZE
+#define DMX_UNIVERSE_SIZE 512
+#endif
+
+#define DMX_STATE_MAGIC 0x53584D44u  // "DMXS"
+#define DMX_STATE_HEADER_SIZE 16
+#define DMX_STATE_MAX_UNIVERSES 8
+
+// Last committed output state, kept in flash so a node can put its universes
+// back on the wire straight after reset, before USB or anything else is up.
+//
+// The partition is a ring of sector-aligned slots, one snapshot each:
+//   magic u32, sequence u32, num_universes u8, 3 reserved bytes,
+//   checksum u32 (FNV-1a of sequence through the last slot), then
+//   num_universes x 512 slots
+// begin() picks the valid snapshot with the highest sequence. commit() writes
+// the next slot in the ring, data pages first and the header page last, so a
+// commit cut short by a power loss leaves the previous snapshot in place.
+//
+// A commit erases and programs flash with interrupts masked (about 45 ms per
+// sector): running DMA keeps frames on the wire, but DMXFramePipeline starts
+// the next one late. Do not run code from flash on the other core meanwhile.
+class DMXStateStore {
+public:
+    struct Stats {
+        uint32_t commits;           // Snapshots written
+        uint32_t unchanged;         // Commits skipped: same as the stored snapshot
+        uint32_t invalid_slots;     // Slots with a header but a bad checksum, seen by begin()
+    };
+
+    DMXStateStore();
+
+    // Find the newest snapshot of num_universes universes in the partition;
+    // false on bad arguments (a partition without a snapshot is fine)
+    bool begin(uint8_t num_universes, uint32_t flash_offset = DMX_STATE_FLASH_OFFSET,
+               size_t flash_size = DMX_STATE_FLASH_SIZE);
+
+    bool hasState() const;
+    uint32_t getSequence() const;
+
+    // Stored slots 1-512 of a universe (memory-mapped flash), or nullptr
+    const uint8_t* getUniverse(uint8_t universe) const;
+
+    // Load the snapshot into the outputs' back buffers; false if there is none
+    bool restore(DMXTransmitter outputs[], uint8_t num_outputs) const;
+
+    // Store the outputs' back buffers (or plain 512-slot universes) as the new
+    // snapshot. Skipped, returning true, when they match the stored one.
+    bool commit(DMXTransmitter outputs[], uint8_t num_outputs);
+    bool commit(const uint8_t* const universes[], uint8_t num_universes);
+
+    Stats getStats() const;
+
+private:
+    uint32_t _flash_offset;
+    uint32_t _slot_size;
+    uint16_t _num_slots;
+    uint8_t _num_universes;
+    int32_t _current_slot;          // -1 without a snapshot
+    uint32_t _sequence;
+    Stats _stats;
+
+    const uint8_t* slotAddress(uint16_t slot) const;
+    bool slotValid(uint16_t slot, uint32_t* sequence) const;
+    bool matches(const uint8_t* const universes[]) const;
+};
+
+#endif // DMX_STATE_STORE_H
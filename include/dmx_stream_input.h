@@ -0,0 +1,35 @@
+#ifndef DMX_STREAM_INPUT_H
+#define DMX_STREAM_INPUT_H
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+#include "dmx_stream_protocol.h"
+
+// USB CDC ingest for the binary stream protocol (see dmx_stream_protocol.h).
+// Incoming packets are decoded straight into the transmitters' back buffers;
+// the application transmits when a frame marked with DMX_STREAM_FLAG_SYNC completes.
+class DMXStreamInput {
+public:
+    DMXStreamInput();
+
+    // Attach initialized transmitters; universe index N in the stream maps to outputs[N]
+    bool begin(DMXTransmitter outputs[], uint8_t num_outputs);
+
+    // Non-blocking: drains available USB bytes into the decoder.
+    // Returns true if a complete frame (sync packet) arrived since the last call.
+    bool poll();
+
+    DMXStreamDecoder::Stats getStats() const;
+    void resetStats();
+
+private:
+    DMXTransmitter* _outputs;
+    uint8_t _num_outputs;
+    DMXStreamDecoder _decoder;
+    volatile bool _frame_ready;
+
+    static uint8_t* resolveUniverse(uint8_t universe, void* context);
+    static void onSync(uint8_t last_seq, void* context);
+};
+
+#endif // DMX_STREAM_INPUT_H
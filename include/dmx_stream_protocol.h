@@ -0,0 +1,182 @@
+#ifndef DMX_STREAM_PROTOCOL_H
+#define DMX_STREAM_PROTOCOL_H
+
+// Binary universe streaming protocol (USB CDC). Carries live universes host ->
+// device (DMXStreamInput, tools/dmx_stream_send.cpp) and telemetry device ->
+// host (DMXTelemetry, tools/dmx_telemetry_view.cpp); deliberately free of Pico
+// SDK dependencies.
+//
+// Packet (little-endian):
+//   0xD5 0x58     Sync bytes
+//   type   u8     FULL, DELTA, RLE, STATS, COUNTERS, LOG, CAPTURE or PROFILE
+//   flags  u8     DMX_STREAM_FLAG_SYNC marks the last packet of a frame
+//   univ   u8     0-based universe index
+//   seq    u8     Incremented per packet; gaps are counted by the decoder
+//   length u16    Payload length
+//   payload
+//   check  u16    Fletcher-16 over type..payload
+//
+// Payloads:
+//   FULL   u16 start slot (0-based), then slot values
+//   DELTA  repeated { u16 start slot, u8 count (0 = 256), count values }
+//   RLE    repeated { u8 count (0 = 256), u8 value } from slot 0 onwards
+//   STATS     one DMXStreamUniverseStats record for the packet's universe
+//   COUNTERS  repeated { u8 counter id, u32 value }
+//   LOG       u32 format id, u32 timestamp (us), u8 argument count, u32 arguments
+//             (a DMXLog record; the universe byte carries the core number)
+//   CAPTURE   one DMXCapture record (see dmx_capture_format.h)
+//   PROFILE   u32 count, u32 total (us), u32 max (us), 16 x u32 bucket counts
+//             (a DMXProfile histogram; the universe byte carries the metric id)
+//
+// A corrupted packet is dropped whole and the decoder waits for the next sync
+// pair, which can also cost the packet after it. DELTA state does not heal by
+// itself, so hosts should resend FULL images periodically (the sender does so
+// once a second).
+//
+// 8 universes x 512 slots x 44 Hz as FULL packets is ~182 KB/s, well within
+// full-speed USB CDC (~1 MB/s); DELTA/RLE frames are usually far smaller.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef DMX_UNIVERSE_SIZE
+#define DMX_UNIVERSE_SIZE 512
+#endif
+
+#define DMX_STREAM_SYNC0 0xD5
+#define DMX_STREAM_SYNC1 0x58
+#define DMX_STREAM_HEADER_SIZE 8
+#define DMX_STREAM_CHECK_SIZE 2
+#define DMX_STREAM_MAX_PAYLOAD (2 + DMX_UNIVERSE_SIZE * 2)
+#define DMX_STREAM_MAX_PACKET (DMX_STREAM_HEADER_SIZE + DMX_STREAM_MAX_PAYLOAD + DMX_STREAM_CHECK_SIZE)
+#define DMX_STREAM_MAX_UNIVERSES 8
+
+#define DMX_STREAM_FLAG_SYNC 0x01
+
+enum DMXStreamPacketType {
+    DMX_STREAM_FULL = 1,
+    DMX_STREAM_DELTA = 2,
+    DMX_STREAM_RLE = 3,
+    DMX_STREAM_STATS = 4,
+    DMX_STREAM_COUNTERS = 5,
+    DMX_STREAM_LOG = 6,
+    DMX_STREAM_CAPTURE = 7,
+    DMX_STREAM_PROFILE = 8
+};
+
+// Telemetry counter ids (COUNTERS packets)
+enum DMXStreamCounter {
+    DMX_COUNTER_UPTIME_MS = 0,
+    DMX_COUNTER_FRAMES_RECEIVED = 1,
+    DMX_COUNTER_SIGNAL_LOSSES = 2,
+    DMX_COUNTER_CONFIG_MISMATCHES = 3,
+    DMX_COUNTER_TELEMETRY_BYTES = 4,
+    DMX_COUNTER_TELEMETRY_DROPS = 5,
+    DMX_COUNTER_LOG_DROPS = 6,
+    DMX_COUNTER_LOAD_CORE0 = 7,         // DMXLoad, permille: busy share of each core
+    DMX_COUNTER_LOAD_CORE1 = 8,
+    DMX_COUNTER_LOAD_RX_IRQ = 9,        // Per context, permille of one core, both cores summed
+    DMX_COUNTER_LOAD_TX = 10,
+    DMX_COUNTER_LOAD_CALLBACKS = 11,
+    DMX_COUNTER_LOAD_MAIN = 12,
+    DMX_COUNTER_FRAMES_CHANGED = 13,    // Change detection (DMXFrameCrc), all universes
+    DMX_COUNTER_FRAMES_IDENTICAL = 14,
+    DMX_COUNTER_COUNT
+};
+
+// STATS payload (serialized little-endian, DMX_STREAM_STATS_SIZE bytes)
+struct DMXStreamUniverseStats {
+    uint32_t frames_received;
+    uint32_t last_frame_ms;
+    uint16_t active_channels;
+    uint8_t max_value;
+    uint16_t max_value_channel;
+    uint8_t signal_present;
+};
+
+#define DMX_STREAM_STATS_SIZE 14
+#define DMX_STREAM_COUNTER_SIZE 5
+#define DMX_STREAM_LOG_HEADER_SIZE 9
+#define DMX_STREAM_CAPTURE_HEADER_SIZE 8
+#define DMX_STREAM_PROFILE_SIZE 76
+
+void dmxStreamWriteStats(const DMXStreamUniverseStats& stats, uint8_t* out);
+void dmxStreamReadStats(const uint8_t* in, DMXStreamUniverseStats* stats);
+
+// Resolves a universe index to its 512-byte destination buffer (nullptr = drop)
+typedef uint8_t* (*DMXStreamUniverseResolver)(uint8_t universe, void* context);
+
+// Called after a packet carrying DMX_STREAM_FLAG_SYNC has been applied
+typedef void (*DMXStreamSyncCallback)(uint8_t last_seq, void* context);
+
+// Called with the validated payload of STATS, COUNTERS, LOG, CAPTURE and PROFILE packets
+typedef void (*DMXStreamRecordCallback)(uint8_t type, uint8_t universe, const uint8_t* payload,
+                                        uint16_t length, void* context);
+
+// Non-blocking, byte-streaming decoder. Packets are validated before any slot
+// is written, then applied straight into the resolved universe buffer.
+class DMXStreamDecoder {
+public:
+    struct Stats {
+        uint32_t packets_ok;
+        uint32_t checksum_errors;
+        uint32_t format_errors;
+        uint32_t seq_gaps;
+        uint32_t syncs;
+        uint32_t bytes_in;
+    };
+
+    DMXStreamDecoder();
+
+    void begin(DMXStreamUniverseResolver resolver, DMXStreamSyncCallback on_sync, void* context);
+
+    // Receive STATS / COUNTERS / LOG / CAPTURE / PROFILE packets (otherwise they are counted and dropped)
+    void setRecordCallback(DMXStreamRecordCallback on_record);
+
+    // Consume any number of bytes; safe to call with partial packets
+    void feed(const uint8_t* data, size_t length);
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    enum State { WAIT_SYNC0, WAIT_SYNC1, READ_HEADER, READ_BODY };
+
+    DMXStreamUniverseResolver _resolver;
+    DMXStreamSyncCallback _on_sync;
+    DMXStreamRecordCallback _on_record;
+    void* _context;
+
+    State _state;
+    uint8_t _packet[DMX_STREAM_MAX_PACKET];
+    uint16_t _received;
+    uint16_t _expected;
+    bool _have_seq;
+    uint8_t _last_seq;
+    Stats _stats;
+
+    void handlePacket();
+    bool applyPayload(uint8_t type, const uint8_t* payload, uint16_t length, uint8_t* universe);
+};
+
+// Frame encoder: picks the smallest of FULL, DELTA and RLE per universe
+class DMXStreamEncoder {
+public:
+    DMXStreamEncoder();
+
+    // Encode one universe against its previous contents (prev may be nullptr to force a full image).
+    // Returns the packet length written to `out` (at least DMX_STREAM_MAX_PACKET bytes),
+    // or 0 if nothing changed and `sync` is false.
+    size_t encodeUniverse(uint8_t universe, const uint8_t* prev, const uint8_t* next, bool sync, uint8_t* out);
+
+    // Build a packet from an explicit type and payload
+    size_t buildPacket(uint8_t type, uint8_t flags, uint8_t universe,
+                       const uint8_t* payload, uint16_t length, uint8_t* out);
+
+private:
+    uint8_t _seq;
+};
+
+uint16_t dmxStreamFletcher16(const uint8_t* data, size_t length);
+
+#endif // DMX_STREAM_PROTOCOL_H
@@ -0,0 +1,75 @@
+#ifndef DMX_TELEMETRY_H
+#define DMX_TELEMETRY_H
+
+#include "pico/stdlib.h"
+#include "dmx_stream_protocol.h"
+
+#define DMX_TELEMETRY_RING_SIZE 4096             // Power of two
+#define DMX_TELEMETRY_SNAPSHOT_INTERVAL_MS 5000  // Full universe images for late-joining viewers
+
+// Binary telemetry over USB CDC, decoded by tools/dmx_telemetry_view.cpp.
+// Universes go out as rate-limited diffs against what was last sent (with a
+// periodic full snapshot), alongside per-universe stats and counters, in the
+// packet format of dmx_stream_protocol.h. Packets are queued in a bounded TX
+// ring and dropped (not waited for) when it is full; the viewer sees the drop
+// as a sequence gap and the next diff catches up.
+class DMXTelemetry {
+public:
+    DMXTelemetry();
+
+    // universe_interval_ms: minimum time between two updates of one universe
+    bool begin(uint8_t num_universes, uint32_t universe_interval_ms = 100);
+
+    // Queue changes to a universe if it is due. Never blocks.
+    bool publishUniverse(uint8_t universe, const uint8_t* data, uint32_t now_ms);
+
+    // As above, but no diff is computed while change_count (e.g.
+    // DMXReceiver::getChangedFrameCount()) is where it was at the last update
+    bool publishUniverse(uint8_t universe, const uint8_t* data, uint32_t now_ms, uint32_t change_count);
+
+    // Queue a stats record for a universe
+    bool publishStats(uint8_t universe, const DMXStreamUniverseStats& stats);
+
+    // Update a counter (DMXStreamCounter id); sent by publishCounters()
+    void setCounter(uint8_t id, uint32_t value);
+
+    // Queue all counters as the last packet of a telemetry frame
+    bool publishCounters();
+
+    // Queue any other record type (e.g. DMXLog's LOG packets)
+    bool publishRecord(uint8_t type, uint8_t universe, const uint8_t* payload, uint16_t length);
+
+    // Bytes that can currently be queued
+    uint16_t getFreeSpace() const;
+
+    // Drain the TX ring into USB without blocking; call from the main loop
+    void poll();
+
+    uint32_t getDroppedPackets() const;
+    uint32_t getBytesSent() const;
+
+private:
+    uint8_t _ring[DMX_TELEMETRY_RING_SIZE];
+    uint16_t _head;  // Next byte to write
+    uint16_t _tail;  // Next byte to send
+    uint8_t _packet[DMX_STREAM_MAX_PACKET];
+    DMXStreamEncoder _encoder;
+
+    uint8_t _num_universes;
+    uint32_t _universe_interval_ms;
+    uint8_t _shadow[DMX_STREAM_MAX_UNIVERSES][DMX_UNIVERSE_SIZE];  // What the viewer has
+    bool _have_shadow[DMX_STREAM_MAX_UNIVERSES];
+    uint32_t _last_publish_ms[DMX_STREAM_MAX_UNIVERSES];
+    uint32_t _last_snapshot_ms[DMX_STREAM_MAX_UNIVERSES];
+    uint32_t _published_changes[DMX_STREAM_MAX_UNIVERSES];
+
+    uint32_t _counters[DMX_COUNTER_COUNT];
+    uint32_t _dropped;
+    uint32_t _bytes_sent;
+
+    bool publish(uint8_t universe, const uint8_t* data, uint32_t now_ms, bool use_changes, uint32_t change_count);
+    uint16_t ringFree() const;
+    bool queue(const uint8_t* data, size_t length);
+};
+
+#endif // DMX_TELEMETRY_H
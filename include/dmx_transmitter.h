@@ -10,7 +10,9 @@ private:
     uint _gpio_pin;
     PIO _pio_instance;
     bool _is_initialized;
-    uint8_t _universe_data[DMX_UNIVERSE_SIZE + 1]; // +1 for start code
+    // Double-buffered universe: writes go to the back buffer while DMA reads the other one
+    uint8_t _universe_data[2][DMX_UNIVERSE_SIZE + 1]; // +1 for start code
+    uint8_t _back;
     
 public:
     DMXTransmitter(uint gpio_pin, PIO pio_instance = pio0);
@@ -22,6 +24,12 @@ public:
     // Cleanup resources
     void end();
     
+    // Move a running output to another pin: the frame on the wire finishes,
+    // then the output restarts there with the same PIO and universe buffers.
+    // Other outputs on the PIO keep running. A stopped output only takes the
+    // new pin for its next begin().
+    DmxOutput::return_code remap(uint gpio_pin);
+    
     // Set individual channel value (1-512)
     bool setChannel(uint16_t channel, uint8_t value);
     
@@ -37,10 +45,28 @@ public:
     // Clear all channels to 0
     void clearUniverse();
     
-    // Transmit the current universe
+    // Get writable universe buffer (channels 1-512, start code excluded) for bulk writes
+    uint8_t* getUniverseBuffer();
+    
+    // Transmit the current universe (swaps the back buffer onto the wire)
     // length: number of channels to transmit (0 = full universe)
     bool transmit(uint16_t length = 0);
     
+    // Copy a whole universe (channels 1-512) into the back buffer and transmit
+    // it, in one pass: unlike transmit(), the new back buffer is not seeded
+    // with the frame and keeps the one before, for callers that hold the
+    // universe themselves (DMXOutputSpace). A stopped output only takes the data.
+    bool transmitUniverse(const uint8_t* data);
+    
+    // Send the frame last presented by transmit() again, leaving the back
+    // buffer alone: no swap and no copy, for a universe that has not changed
+    bool retransmit(uint16_t length = 0);
+    
+    // Transmit a prebuilt frame (start code + channels) directly, e.g. a
+    // DMXUniverseImage in flash, without copying it into the universe buffer.
+    // The frame must stay valid until the transmission completes.
+    bool transmitFrame(const uint8_t* frame, uint16_t length = 0);
+    
     // Check if transmission is in progress
     bool isBusy();
     
@@ -0,0 +1,267 @@
+/*
+ * Fast-Start Boot Simulation (host build)
+ *
+ * Boots a transmitter node the way transmitter_main does, from a flash image
+ * that already holds a committed universe state, and watches the wire: the
+ * first frame out must carry the stored state, and the time from reset to its
+ * break is reported. Then exercises DMXStateStore across simulated reboots:
+ * committing a new state, skipping an identical commit, falling back to the
+ * previous snapshot when the newest one is corrupt, rotating through all
+ * slots, and booting with no stored state.
+ *
+ * Build:  cmake -S . -B build && cmake --build build   (host build, no pico-sdk)
+ * Usage:  ./build/dmx_boot_sim
+ *
+ * Outputs: GPIO 10-13 (pio1). The simulated CPU only spends the nominal costs
+ * of time reads and register polls, so the boot time shows the ordering of
+ * the boot path rather than hardware figures (on the RP2040 add the bootrom
+ * and boot2, which run before the timer starts, and the flash scan).
+ * Exits 1 if any check failed.
+ */
+
+#include "pico/stdlib.h"
+#include "dmx_sim.h"
+#include "dmx_transmitter.h"
+#include "dmx_frame_pipeline.h"
+#include "dmx_state_store.h"
+#include "dmx_load.h"
+#include "hardware/flash.h"
+#include <cstdio>
+#include <cstring>
+
+#define NUM_OUTPUTS 4
+#define OUTPUT_START_PIN 10
+#define FRAME_PERIOD_US 25000
+
+extern uint8_t dmx_sim_flash[];
+
+// Frames as seen on one output pin
+struct WireCapture {
+    uint8_t frame[1 + DMX_UNIVERSE_SIZE];
+    uint16_t length;
+    bool in_frame;
+    uint32_t frames;
+    uint64_t break_end_ns;              // Break opening the frame being read
+    uint64_t first_frame_break_end_ns;  // Break opening the first complete frame
+    uint8_t first_frame[1 + DMX_UNIVERSE_SIZE];
+    uint8_t last_frame[1 + DMX_UNIVERSE_SIZE];
+};
+
+static WireCapture wires[NUM_OUTPUTS];
+static uint32_t failures = 0;
+
+static void check(bool ok, const char* what) {
+    printf("  %-52s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok) {
+        failures++;
+    }
+}
+
+static void onSymbol(uint gpio, const DMXSim::Symbol& symbol, void*) {
+    if (gpio < OUTPUT_START_PIN || gpio >= OUTPUT_START_PIN + NUM_OUTPUTS) {
+        return;
+    }
+    WireCapture& wire = wires[gpio - OUTPUT_START_PIN];
+    if (symbol.type == DMXSim::SYMBOL_BREAK) {
+        if (wire.in_frame && wire.length == sizeof(wire.frame)) {
+            if (wire.frames == 0) {
+                memcpy(wire.first_frame, wire.frame, sizeof(wire.frame));
+                wire.first_frame_break_end_ns = wire.break_end_ns;
+            }
+            memcpy(wire.last_frame, wire.frame, sizeof(wire.frame));
+            wire.frames++;
+        }
+        wire.break_end_ns = symbol.end_ns;
+        wire.in_frame = true;
+        wire.length = 0;
+    } else if (wire.in_frame && wire.length < sizeof(wire.frame)) {
+        wire.frame[wire.length++] = symbol.value;
+    }
+}
+
+static inline uint8_t patternValue(uint8_t pattern, uint8_t universe, uint16_t slot) {
+    return (uint8_t)(pattern * 29 + slot * 13 + universe * 61);
+}
+
+static void fillPattern(uint8_t universes[][DMX_UNIVERSE_SIZE], uint8_t pattern) {
+    for (uint8_t u = 0; u < NUM_OUTPUTS; u++) {
+        for (uint16_t s = 0; s < DMX_UNIVERSE_SIZE; s++) {
+            universes[u][s] = patternValue(pattern, u, s);
+        }
+    }
+}
+
+static bool storeHolds(const DMXStateStore& store, uint8_t pattern) {
+    for (uint8_t u = 0; u < NUM_OUTPUTS; u++) {
+        const uint8_t* stored = store.getUniverse(u);
+        if (stored == nullptr) {
+            return false;
+        }
+        for (uint16_t s = 0; s < DMX_UNIVERSE_SIZE; s++) {
+            if (stored[s] != patternValue(pattern, u, s)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The wire's frame (start code + slots) against a pattern
+static bool frameHolds(const uint8_t* frame, uint8_t universe, uint8_t pattern) {
+    if (frame[0] != 0) {
+        return false;
+    }
+    for (uint16_t s = 0; s < DMX_UNIVERSE_SIZE; s++) {
+        if (frame[1 + s] != patternValue(pattern, universe, s)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void commitPattern(DMXStateStore& store, uint8_t pattern) {
+    static uint8_t universes[NUM_OUTPUTS][DMX_UNIVERSE_SIZE];
+    fillPattern(universes, pattern);
+    const uint8_t* pointers[NUM_OUTPUTS];
+    for (uint8_t u = 0; u < NUM_OUTPUTS; u++) {
+        pointers[u] = universes[u];
+    }
+    store.commit(pointers, NUM_OUTPUTS);
+}
+
+int main() {
+    printf("Fast-start boot simulation: %d outputs, state partition %u KB at 0x%06X\n\n",
+           NUM_OUTPUTS, DMX_STATE_FLASH_SIZE / 1024, DMX_STATE_FLASH_OFFSET);
+
+    // State left in flash by an earlier run (writes cost no virtual time)
+    {
+        DMXStateStore previous;
+        previous.begin(NUM_OUTPUTS);
+        commitPattern(previous, 1);
+    }
+    DMXSim::setWireMonitor(onSymbol);
+
+    printf("Boot with stored state\n");
+
+    // transmitter_main's boot path: outputs, restore, first frame, then stdio
+    uint64_t reset_us = time_us_64();
+    static DMXTransmitter outputs[NUM_OUTPUTS] = {
+        DMXTransmitter(OUTPUT_START_PIN + 0, pio1),
+        DMXTransmitter(OUTPUT_START_PIN + 1, pio1),
+        DMXTransmitter(OUTPUT_START_PIN + 2, pio1),
+        DMXTransmitter(OUTPUT_START_PIN + 3, pio1)
+    };
+    bool begun = true;
+    for (uint8_t i = 0; i < NUM_OUTPUTS; i++) {
+        begun = begun && outputs[i].begin() == DmxOutput::SUCCESS;
+    }
+    DMXStateStore state;
+    bool restored = state.begin(NUM_OUTPUTS) && state.restore(outputs, NUM_OUTPUTS);
+
+    DMXFramePipeline pipeline;
+    pipeline.begin(outputs, NUM_OUTPUTS, FRAME_PERIOD_US);
+    while (!pipeline.poll()) {
+    }
+    uint64_t first_frame_us = time_us_64();
+    stdio_init_all();
+
+    // Let a few frames go out
+    while (pipeline.getStats().frames_sent < 4) {
+        if (!pipeline.poll()) {
+            DMXLoad::idleUntil(pipeline.getNextFrameUs());
+        }
+    }
+
+    check(begun, "outputs started");
+    check(restored && state.getSequence() == 1, "state restored from flash (sequence 1)");
+    bool first_ok = true;
+    uint64_t first_frame_break_ns = 0;
+    for (uint8_t u = 0; u < NUM_OUTPUTS; u++) {
+        first_ok = first_ok && wires[u].frames > 0 && frameHolds(wires[u].first_frame, u, 1);
+        if (wires[u].first_frame_break_end_ns > first_frame_break_ns) {
+            first_frame_break_ns = wires[u].first_frame_break_end_ns;
+        }
+    }
+    check(first_ok, "first frame on every output carries the stored state");
+    check(first_frame_break_ns > 0 && first_frame_break_ns / 1000 - reset_us < 10000,
+          "stored state on the wire within 10 ms of reset");
+    printf("  reset to first frame (all outputs, end of break): %llu us\n",
+           (unsigned long long)(first_frame_break_ns / 1000 - reset_us));
+    printf("  reset to first frame start (as transmitter_main reports): %llu us\n",
+           (unsigned long long)(first_frame_us - reset_us));
+
+    // The application brings the stored state in line with its configuration
+    printf("\nCommit a new state while transmitting\n");
+    static uint8_t configured[NUM_OUTPUTS][DMX_UNIVERSE_SIZE];
+    fillPattern(configured, 2);
+    for (uint8_t u = 0; u < NUM_OUTPUTS; u++) {
+        outputs[u].setUniverse(configured[u], DMX_UNIVERSE_SIZE);
+    }
+    bool committed = state.commit(outputs, NUM_OUTPUTS);
+    uint32_t frames_before = pipeline.getStats().frames_sent;
+    while (pipeline.getStats().frames_sent < frames_before + 3) {
+        if (!pipeline.poll()) {
+            DMXLoad::idleUntil(pipeline.getNextFrameUs());
+        }
+    }
+    bool wire_ok = true;
+    for (uint8_t u = 0; u < NUM_OUTPUTS; u++) {
+        wire_ok = wire_ok && frameHolds(wires[u].last_frame, u, 2);
+    }
+    check(committed && state.getSequence() == 2 && state.getStats().commits == 1, "new state committed (sequence 2)");
+    check(wire_ok, "outputs carry the new state");
+    check(state.commit(outputs, NUM_OUTPUTS) && state.getStats().unchanged == 1 && state.getSequence() == 2,
+          "identical commit skipped");
+
+    printf("\nReboots\n");
+    {
+        DMXStateStore reboot;
+        check(reboot.begin(NUM_OUTPUTS) && reboot.hasState() && reboot.getSequence() == 2 && storeHolds(reboot, 2),
+              "reboot finds the newest state");
+        check(reboot.getStats().invalid_slots == 0, "no invalid slots");
+    }
+    {
+        // Flip a slot of the newest snapshot, as a torn or decayed write would
+        DMXStateStore damaged;
+        damaged.begin(NUM_OUTPUTS);
+        const uint8_t* slot = damaged.getUniverse(NUM_OUTPUTS - 1);
+        dmx_sim_flash[(slot - dmx_sim_flash) + 100] ^= 0x01;
+
+        DMXStateStore reboot;
+        check(reboot.begin(NUM_OUTPUTS) && reboot.getSequence() == 1 && storeHolds(reboot, 1),
+              "corrupt newest snapshot falls back to the previous one");
+        check(reboot.getStats().invalid_slots == 1, "corrupt snapshot counted");
+
+        // The next commit takes the slot after the fallback; the sequence
+        // still moves forward past it
+        commitPattern(reboot, 3);
+        DMXStateStore again;
+        check(again.begin(NUM_OUTPUTS) && again.getSequence() == 2 && storeHolds(again, 3),
+              "commit after fallback becomes the newest");
+    }
+    {
+        DMXStateStore ring;
+        ring.begin(NUM_OUTPUTS);
+        uint32_t start = ring.getSequence();
+        for (uint8_t p = 10; p < 30; p++) {
+            commitPattern(ring, p);
+        }
+        DMXStateStore reboot;
+        check(reboot.begin(NUM_OUTPUTS) && reboot.getSequence() == start + 20 && storeHolds(reboot, 29),
+              "20 commits rotate through every slot");
+    }
+    {
+        DMXStateStore other;
+        check(other.begin(2) && !other.hasState() && other.getStats().invalid_slots == 0,
+              "other universe count sees no state");
+    }
+    {
+        flash_range_erase(DMX_STATE_FLASH_OFFSET, DMX_STATE_FLASH_SIZE);
+        DMXStateStore blank;
+        check(blank.begin(NUM_OUTPUTS) && !blank.hasState() && !blank.restore(outputs, NUM_OUTPUTS),
+              "erased partition: no state, built-in configuration used");
+    }
+
+    printf("\n%s\n", failures == 0 ? "All checks passed" : "Some checks FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+/*
+ * Frame Change Detection Simulation (host build)
+ *
+ * Runs DMXTransmitter outputs under DMXFramePipeline into a DMXMultiReceiver
+ * with change detection on. Each look is held for several frames, as a
+ * console does between cues, so most frames repeat the one before. Universe 1
+ * holds the simulated DMA sniffer; the others use the software CRC. One
+ * universe changes only its last slot between looks.
+ *
+ * Build:  cmake -S . -B build && cmake --build build   (host build, no pico-sdk)
+ * Usage:  ./build/dmx_change_sim [--frames N] [--hold N]
+ *
+ * Outputs: GPIO 10-12 (pio1), inputs: GPIO 1-3 (pio0). Checks that every
+ * frame is classified as changed or identical exactly as the look sequence
+ * says, that every frame's CRC (sniffed or not) matches DMXFrameCrc over the
+ * received data, and that with skip_unchanged only changed frames reach the
+ * callback. Exits 1 if any check failed.
+ */
+
+#include "pico/stdlib.h"
+#include "dmx_sim.h"
+#include "dmx_transmitter.h"
+#include "dmx_multi_receiver.h"
+#include "dmx_frame_pipeline.h"
+#include "dmx_frame_crc.h"
+#include "dmx_load.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define NUM_UNIVERSES 3
+#define OUTPUT_START_PIN 10
+#define INPUT_START_PIN 1
+#define FRAME_PERIOD_US 25000
+#define LAST_SLOT_UNIVERSE 2  // Changes only slot 512 from look to look
+
+struct UniverseCheck {
+    uint32_t callbacks;
+    uint32_t expected_changes;
+    uint32_t misclassified;
+    uint32_t crc_mismatches;
+    int32_t last_look;
+};
+
+static UniverseCheck checks[NUM_UNIVERSES];
+static uint32_t hold_frames = 5;
+
+static inline uint8_t patternValue(uint32_t look, uint8_t universe, uint16_t slot) {
+    return (uint8_t)(look * 7 + slot * 13 + universe * 61);
+}
+
+// Look number: slots 1-2, or slot 512 alone for LAST_SLOT_UNIVERSE
+static void renderFrame(DMXTransmitter outputs[], uint8_t num_outputs, uint32_t frame_number, void*) {
+    uint32_t look = frame_number / hold_frames;
+    for (uint8_t u = 0; u < num_outputs; u++) {
+        uint8_t* buffer = outputs[u].getUniverseBuffer();
+        if (u == LAST_SLOT_UNIVERSE) {
+            for (uint16_t slot = 0; slot < DMX_UNIVERSE_SIZE - 1; slot++) {
+                buffer[slot] = patternValue(0, u, slot);
+            }
+            buffer[DMX_UNIVERSE_SIZE - 1] = (uint8_t)look;
+            continue;
+        }
+        buffer[0] = (uint8_t)look;
+        buffer[1] = (uint8_t)(look >> 8);
+        for (uint16_t slot = 2; slot < DMX_UNIVERSE_SIZE; slot++) {
+            buffer[slot] = patternValue(look, u, slot);
+        }
+    }
+}
+
+// Runs in the simulated DMA IRQ
+static void onUniverseReceived(DMXMultiReceiver* multi_rx, uint8_t universe_index) {
+    const uint8_t* buffer = multi_rx->getUniverseBuffer(universe_index);
+    UniverseCheck& check = checks[universe_index];
+    check.callbacks++;
+
+    int32_t look = universe_index == LAST_SLOT_UNIVERSE ? buffer[DMX_UNIVERSE_SIZE - 1]
+                                                        : (int32_t)(buffer[0] | (buffer[1] << 8));
+    bool expected_changed = look != check.last_look;
+    if (expected_changed) {
+        check.expected_changes++;
+    }
+    check.last_look = look;
+    if (multi_rx->isUniverseChanged(universe_index) != expected_changed) {
+        check.misclassified++;
+    }
+
+    // The fingerprint covers the start code and the slots
+    static const uint8_t start_code = 0;
+    uint32_t crc = DMXFrameCrc::update(DMXFrameCrc::compute(&start_code, 1), buffer, DMX_UNIVERSE_SIZE);
+    if (crc != multi_rx->getFrameCrc(universe_index)) {
+        check.crc_mismatches++;
+    }
+}
+
+static void runFrames(DMXFramePipeline& pipeline, uint32_t frames) {
+    uint32_t target = pipeline.getStats().frames_sent + frames;
+    while (pipeline.getStats().frames_sent < target) {
+        if (!pipeline.poll()) {
+            DMXLoad::idleUntil(pipeline.getNextFrameUs());
+        }
+    }
+}
+
+static void resetChecks() {
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        memset(&checks[u], 0, sizeof(checks[u]));
+        checks[u].last_look = -1;
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t num_frames = 200;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            num_frames = (uint32_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--hold") == 0 && i + 1 < argc) {
+            hold_frames = (uint32_t)atol(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--frames N] [--hold N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (num_frames == 0 || hold_frames == 0 || num_frames / hold_frames > 255) {
+        fprintf(stderr, "frames and hold must be non-zero, with at most 255 looks\n");
+        return 2;
+    }
+
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        DMXSim::connect(OUTPUT_START_PIN + u, INPUT_START_PIN + u);
+    }
+    DMXTransmitter outputs[NUM_UNIVERSES] = {
+        DMXTransmitter(OUTPUT_START_PIN + 0, pio1),
+        DMXTransmitter(OUTPUT_START_PIN + 1, pio1),
+        DMXTransmitter(OUTPUT_START_PIN + 2, pio1)
+    };
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        if (outputs[u].begin() != DmxOutput::SUCCESS) {
+            fprintf(stderr, "Failed to initialize output %d\n", u + 1);
+            return 1;
+        }
+    }
+
+    // Never ended: the multi-receiver stays up for the life of the program
+    DMXMultiReceiver* multi_rx = new DMXMultiReceiver();
+    if (!multi_rx->begin(INPUT_START_PIN, NUM_UNIVERSES, onUniverseReceived) || !multi_rx->enableChangeDetection()) {
+        fprintf(stderr, "Failed to initialize multi-universe receiver\n");
+        return 1;
+    }
+
+    DMXFramePipeline pipeline;
+    pipeline.begin(outputs, NUM_UNIVERSES, FRAME_PERIOD_US, renderFrame);
+
+    printf("Change detection: %d universes, %lu frames, each look held %lu frames\n", NUM_UNIVERSES,
+           (unsigned long)num_frames, (unsigned long)hold_frames);
+
+    bool ok = true;
+    for (int pass = 0; pass < 2; pass++) {
+        bool skip_unchanged = pass == 1;
+        resetChecks();
+        multi_rx->enableChangeDetection(skip_unchanged);
+        runFrames(pipeline, num_frames);
+        // Let the last frame arrive
+        for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+            outputs[u].waitForCompletion();
+        }
+        sleep_ms(1);
+
+        printf("%s\n", skip_unchanged ? "skip_unchanged: identical frames skip the callback"
+                                       : "every frame reaches the callback");
+        for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+            DMXMultiReceiver::UniverseStats stats = multi_rx->getUniverseStats(u);
+            const UniverseCheck& check = checks[u];
+            bool universe_ok = stats.frames_changed + stats.frames_identical >= num_frames &&
+                               check.misclassified == 0 && check.crc_mismatches == 0;
+            if (skip_unchanged) {
+                // Only changed frames arrive, and each carries a new look
+                universe_ok = universe_ok && check.callbacks == stats.frames_changed &&
+                              check.expected_changes == check.callbacks;
+            } else {
+                universe_ok = universe_ok && check.callbacks == stats.frames_changed + stats.frames_identical &&
+                              stats.frames_changed == check.expected_changes;
+            }
+            ok = ok && universe_ok;
+            printf("  universe %d (%s CRC): %lu changed, %lu identical, %lu callbacks, %lu misclassified, "
+                   "%lu CRC mismatches %s\n",
+                   u + 1, u == 0 ? "sniffer" : "software", (unsigned long)stats.frames_changed,
+                   (unsigned long)stats.frames_identical, (unsigned long)check.callbacks,
+                   (unsigned long)check.misclassified, (unsigned long)check.crc_mismatches,
+                   universe_ok ? "PASS" : "FAIL");
+        }
+    }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
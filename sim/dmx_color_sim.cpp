@@ -0,0 +1,340 @@
+/*
+ * Colour Conversion Kernel Check (host build)
+ *
+ * Compares DMXColorMixer's fixed-point kernels against straightforward
+ * floating-point references over their whole input range:
+ *   HSV   every hue, 16 saturations x 16 values     within 3 LSB per channel
+ *   HSI   every hue, 16 saturations x 16 intensities within 2 LSB, sum within 3
+ *   CCT   1000 K - 12000 K in 7 K steps (Helland)   within 2 LSB per channel,
+ *         except next to the fit's own step at 6600 K
+ *   white and amber extraction (RGBW, RGBAW)        within 2 LSB per channel
+ *   tunable white mix, linear in mireds             within 1 LSB per emitter
+ * and checks the exact cases: RGB fixtures pass through unchanged, slots
+ * outside the layout are left alone, and out-of-range temperatures clamp.
+ *
+ * Build:  cmake -S . -B build && cmake --build build   (host build, no pico-sdk)
+ * Usage:  ./build/dmx_color_sim
+ *
+ * Prints the worst error of each kernel. Exits 1 if any check failed.
+ */
+
+#include "pico/stdlib.h"
+#include "dmx_color.h"
+#include "dmx_effects.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define HSV_TOLERANCE 3
+#define HSI_TOLERANCE 2
+#define HSI_SUM_TOLERANCE 3
+#define CCT_TOLERANCE 2
+#define EXTRACT_TOLERANCE 2
+#define TUNABLE_TOLERANCE 1
+
+static uint32_t failures = 0;
+
+static void report(const char* what, int worst, int tolerance, uint32_t cases) {
+    bool ok = worst <= tolerance;
+    printf("  %-44s %8lu cases, worst %d LSB (limit %d) %s\n", what, (unsigned long)cases, worst, tolerance,
+           ok ? "ok" : "FAIL");
+    if (!ok) {
+        failures++;
+    }
+}
+
+static void check(bool ok, const char* what) {
+    printf("  %-44s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) {
+        failures++;
+    }
+}
+
+static int errorOf(const uint8_t* rgb, const double* reference, uint8_t count) {
+    int worst = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        int error = abs((int)rgb[i] - (int)lround(reference[i]));
+        if (error > worst) {
+            worst = error;
+        }
+    }
+    return worst;
+}
+
+static double clamp255(double value) {
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+// Hue 0-255 is one turn, as in the kernels
+static double hueDegrees(uint8_t hue) {
+    return hue * 360.0 / 256.0;
+}
+
+static void referenceHsv(uint8_t hue, uint8_t sat, uint8_t val, double* rgb) {
+    double h = hueDegrees(hue) / 60.0;
+    double s = sat / 255.0;
+    double v = val / 255.0;
+    int sector = (int)h;
+    double f = h - sector;
+    double p = v * (1 - s);
+    double q = v * (1 - s * f);
+    double t = v * (1 - s * (1 - f));
+    double r, g, b;
+    switch (sector) {
+        case 0: r = v; g = t; b = p; break;
+        case 1: r = q; g = v; b = p; break;
+        case 2: r = p; g = v; b = t; break;
+        case 3: r = p; g = q; b = v; break;
+        case 4: r = t; g = p; b = v; break;
+        default: r = v; g = p; b = q; break;
+    }
+    rgb[0] = r * 255;
+    rgb[1] = g * 255;
+    rgb[2] = b * 255;
+}
+
+// HSI with the intensity as the sum of the three channels
+static void referenceHsi(uint8_t hue, uint8_t sat, uint8_t intensity, double* rgb) {
+    double h = hueDegrees(hue);
+    int sector = (int)(h / 120.0);
+    double angle = (h - sector * 120.0) * M_PI / 180.0;
+    double s = sat / 255.0;
+    double third = intensity / 3.0;
+    double lead = third * (1 + s * cos(angle) / cos(M_PI / 3 - angle));
+    double low = third * (1 - s);
+    double next = intensity - lead - low;
+    rgb[sector] = lead;
+    rgb[(sector + 1) % 3] = next;
+    rgb[(sector + 2) % 3] = low;
+}
+
+// Tanner Helland's black body fit
+static void referenceCct(double kelvin, double* rgb) {
+    double t = kelvin / 100.0;
+    double r, g, b;
+    if (t <= 66) {
+        r = 255;
+        g = 99.4708025861 * log(t) - 161.1195681661;
+    } else {
+        r = 329.698727446 * pow(t - 60, -0.1332047592);
+        g = 288.1221695283 * pow(t - 60, -0.0755148492);
+    }
+    if (t >= 66) {
+        b = 255;
+    } else if (t <= 19) {
+        b = 0;
+    } else {
+        b = 138.5177312231 * log(t - 10) - 305.0447927307;
+    }
+    rgb[0] = clamp255(r);
+    rgb[1] = clamp255(g);
+    rgb[2] = clamp255(b);
+}
+
+// Move as much of the emitter as rgb holds onto its own channel
+static double referenceExtract(double* rgb, const uint8_t* emitter) {
+    double amount = 255;
+    bool any = false;
+    for (uint8_t i = 0; i < 3; i++) {
+        if (emitter[i]) {
+            amount = fmin(amount, rgb[i] * 255.0 / emitter[i]);
+            any = true;
+        }
+    }
+    if (!any) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+        rgb[i] = fmax(0, rgb[i] - amount * emitter[i] / 255.0);
+    }
+    return amount;
+}
+
+static void checkHsv() {
+    int worst = 0;
+    uint32_t cases = 0;
+    for (uint16_t hue = 0; hue < 256; hue++) {
+        for (uint16_t sat = 0; sat < 256; sat += 17) {
+            for (uint16_t val = 0; val < 256; val += 17) {
+                uint8_t rgb[3];
+                double reference[3];
+                DMXEffects::hsvToRgb((uint8_t)hue, (uint8_t)sat, (uint8_t)val, rgb);
+                referenceHsv((uint8_t)hue, (uint8_t)sat, (uint8_t)val, reference);
+                int error = errorOf(rgb, reference, 3);
+                worst = error > worst ? error : worst;
+                cases++;
+            }
+        }
+    }
+    report("HSV (DMXEffects::hsvToRgb)", worst, HSV_TOLERANCE, cases);
+}
+
+static void checkHsi() {
+    int worst = 0;
+    int worst_sum = 0;
+    uint32_t cases = 0;
+    for (uint16_t hue = 0; hue < 256; hue++) {
+        for (uint16_t sat = 0; sat < 256; sat += 17) {
+            for (uint16_t intensity = 0; intensity < 256; intensity += 17) {
+                uint8_t rgb[3];
+                double reference[3];
+                DMXColorMixer::hsiToRgb((uint8_t)hue, (uint8_t)sat, (uint8_t)intensity, rgb);
+                referenceHsi((uint8_t)hue, (uint8_t)sat, (uint8_t)intensity, reference);
+                int error = errorOf(rgb, reference, 3);
+                worst = error > worst ? error : worst;
+                int sum_error = abs(rgb[0] + rgb[1] + rgb[2] - (int)intensity);
+                worst_sum = sum_error > worst_sum ? sum_error : worst_sum;
+                cases++;
+            }
+        }
+    }
+    report("HSI", worst, HSI_TOLERANCE, cases);
+    report("HSI channel sum vs intensity", worst_sum, HSI_SUM_TOLERANCE, cases);
+}
+
+static void checkCct() {
+    int worst = 0;
+    uint32_t cases = 0;
+    for (uint32_t kelvin = 1000; kelvin <= 12000; kelvin += 7) {
+        // The fit itself jumps at 6600 K (green ~255 -> 251, blue ~252 -> 255);
+        // the table interpolates across that one step
+        if (kelvin > 6500 && kelvin < 6700) {
+            continue;
+        }
+        uint8_t rgb[3];
+        double reference[3];
+        DMXColorMixer::cctToRgb((uint16_t)kelvin, rgb);
+        referenceCct(kelvin, reference);
+        int error = errorOf(rgb, reference, 3);
+        worst = error > worst ? error : worst;
+        cases++;
+    }
+    report("CCT", worst, CCT_TOLERANCE, cases);
+
+    uint8_t low[3], high[3], rgb[3];
+    DMXColorMixer::cctToRgb(1000, low);
+    DMXColorMixer::cctToRgb(12000, high);
+    bool clamped = true;
+    const uint16_t below[] = {0, 1, 15, 16, 999};
+    for (uint16_t kelvin : below) {
+        DMXColorMixer::cctToRgb(kelvin, rgb);
+        clamped = clamped && memcmp(rgb, low, 3) == 0;
+    }
+    const uint16_t above[] = {12001, 40000, 65535};
+    for (uint16_t kelvin : above) {
+        DMXColorMixer::cctToRgb(kelvin, rgb);
+        clamped = clamped && memcmp(rgb, high, 3) == 0;
+    }
+    check(clamped, "CCT out of range clamps to 1000/12000 K");
+}
+
+static void checkExtraction() {
+    static const uint8_t white[3] = {255, 244, 229};
+    static const uint8_t amber[3] = {255, 191, 0};
+    DMXColorMixer mixer;
+    mixer.setWhiteRgb(white);
+    mixer.setAmberRgb(amber);
+
+    int worst_rgbw = 0;
+    int worst_rgbaw = 0;
+    uint32_t cases = 0;
+    for (uint16_t r = 0; r < 256; r += 15) {
+        for (uint16_t g = 0; g < 256; g += 15) {
+            for (uint16_t b = 0; b < 256; b += 15) {
+                const uint8_t rgb[3] = {(uint8_t)r, (uint8_t)g, (uint8_t)b};
+                uint8_t slots[5];
+
+                mixer.renderRgb(rgb, 1, slots, DMXColorMixer::RGBW);
+                double reference[5] = {(double)r, (double)g, (double)b, 0, 0};
+                reference[3] = referenceExtract(reference, white);
+                int error = errorOf(slots, reference, 4);
+                worst_rgbw = error > worst_rgbw ? error : worst_rgbw;
+
+                // RGBAW slot order: R, G, B, amber, white
+                mixer.renderRgb(rgb, 1, slots, DMXColorMixer::RGBAW);
+                double remaining[3] = {(double)r, (double)g, (double)b};
+                reference[4] = referenceExtract(remaining, white);
+                reference[3] = referenceExtract(remaining, amber);
+                memcpy(reference, remaining, sizeof(remaining));
+                error = errorOf(slots, reference, 5);
+                worst_rgbaw = error > worst_rgbaw ? error : worst_rgbaw;
+                cases++;
+            }
+        }
+    }
+    report("white extraction (RGBW)", worst_rgbw, EXTRACT_TOLERANCE, cases);
+    report("white + amber extraction (RGBAW)", worst_rgbaw, EXTRACT_TOLERANCE, cases);
+}
+
+static void checkTunableWhite() {
+    DMXColorMixer mixer;
+    bool ok = mixer.setTunableWhite(2700, 6500);
+    double warm_mired = 1e6 / 2700;
+    double cool_mired = 1e6 / 6500;
+
+    int worst = 0;
+    uint32_t cases = 0;
+    for (uint32_t kelvin = 1000; kelvin <= 12000; kelvin += 11) {
+        for (uint16_t level = 0; level < 256; level += 51) {
+            uint16_t k = (uint16_t)kelvin;
+            uint8_t l = (uint8_t)level;
+            uint8_t slots[2];
+            mixer.renderCct(&k, &l, 1, slots, DMXColorMixer::TUNABLE_WHITE);
+            double mix = (warm_mired - 1e6 / kelvin) / (warm_mired - cool_mired);
+            mix = mix < 0 ? 0 : (mix > 1 ? 1 : mix);
+            double reference[2] = {level * (1 - mix), level * mix};
+            int error = errorOf(slots, reference, 2);
+            worst = error > worst ? error : worst;
+            cases++;
+        }
+    }
+    report("tunable white mix", worst, TUNABLE_TOLERANCE, cases);
+
+    // Temperatures that would overflow a 16-bit mired clamp instead
+    const uint16_t extremes[] = {0, 1, 15, 65535};
+    const uint8_t levels[] = {200, 200, 200, 200};
+    uint8_t slots[8];
+    mixer.renderCct(extremes, levels, 4, slots, DMXColorMixer::TUNABLE_WHITE);
+    ok = ok && slots[0] == 200 && slots[1] == 0 && slots[2] == 200 && slots[4] == 200 && slots[6] == 0 &&
+         slots[7] == 200;
+    ok = ok && !mixer.setTunableWhite(6500, 2700) && !mixer.setTunableWhite(13000, 20000) &&
+         !mixer.setTunableWhite(0, 500);
+    check(ok, "tunable white clamps and range checks");
+}
+
+static void checkLayouts() {
+    DMXColorMixer mixer;
+
+    // RGB fixtures take the colour as it is
+    uint8_t rgb[64 * 3];
+    uint8_t slots[64 * 3];
+    for (uint16_t i = 0; i < sizeof(rgb); i++) {
+        rgb[i] = (uint8_t)(i * 37 + 11);
+    }
+    mixer.renderRgb(rgb, 64, slots, DMXColorMixer::RGB);
+    check(memcmp(rgb, slots, sizeof(rgb)) == 0, "RGB passes through unchanged");
+
+    // A dimmer, RGBW and a strobe channel: slots 0 and 5 are not ours
+    static const DMXColorLayout DIMMER_RGBW_STROBE = {6, 1, 2, 3, 4, -1, -1, -1};
+    uint8_t fixtures[4 * 6];
+    memset(fixtures, 0x5A, sizeof(fixtures));
+    mixer.renderHsi(rgb, 4, fixtures, DIMMER_RGBW_STROBE);
+    bool untouched = true;
+    for (uint8_t f = 0; f < 4; f++) {
+        untouched = untouched && fixtures[f * 6] == 0x5A && fixtures[f * 6 + 5] == 0x5A;
+    }
+    check(untouched, "slots outside the layout left alone");
+}
+
+int main() {
+    printf("Colour kernels against floating-point references:\n");
+    checkHsv();
+    checkHsi();
+    checkCct();
+    checkExtraction();
+    checkTunableWhite();
+    checkLayouts();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,363 @@
+/*
+ * Cue Show Codec and Player Simulation (host build)
+ *
+ * Packs a generated show with DMXCueCodec (keyframes every few cues, cues
+ * that leave universes unchanged, long runs, skips and literals) and checks
+ * that DMXCueShow decodes every cue in sequence and from its keyframe, and
+ * that DMXCuePlayer reaches every cue in order and out of order. Then
+ * corrupts and truncates records: decoding must fail cleanly, and a failed
+ * go() must leave the player's current cue, its target and any fade in
+ * progress untouched.
+ *
+ * Build:  cmake -S . -B build && cmake --build build   (host build, no pico-sdk)
+ * Usage:  ./build/dmx_cue_sim [--cues N] [--seed N]
+ *
+ * Exits 1 if any check failed.
+ */
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+#include "dmx_cue_format.h"
+#include "dmx_cue_player.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define NUM_UNIVERSES 3
+#define KEYFRAME_INTERVAL 8
+#define FADE_MS 1000
+
+struct CueState {
+    uint8_t universes[NUM_UNIVERSES][DMX_UNIVERSE_SIZE];
+};
+
+static uint32_t failures = 0;
+
+static void check(bool ok, const char* what) {
+    printf("  %-60s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) {
+        failures++;
+    }
+}
+
+static uint32_t nextRandom(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Each cue changes scattered slots, one run of identical values and, on odd
+// cues, nothing at all in the last universe
+static void generateShow(std::vector<CueState>& cues, uint16_t num_cues, uint32_t seed) {
+    cues.resize(num_cues);
+    memset(&cues[0], 0, sizeof(CueState));
+    for (uint16_t i = 0; i < num_cues; i++) {
+        if (i > 0) {
+            cues[i] = cues[i - 1];
+        }
+        for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+            if (u == NUM_UNIVERSES - 1 && (i & 1)) {
+                continue;
+            }
+            uint16_t changes = (uint16_t)(nextRandom(&seed) % 64);
+            for (uint16_t c = 0; c < changes; c++) {
+                cues[i].universes[u][nextRandom(&seed) % DMX_UNIVERSE_SIZE] = (uint8_t)nextRandom(&seed);
+            }
+            uint16_t run_start = (uint16_t)(nextRandom(&seed) % (DMX_UNIVERSE_SIZE - 100));
+            memset(&cues[i].universes[u][run_start], (uint8_t)(i * 17 + u), 40 + nextRandom(&seed) % 60);
+        }
+    }
+}
+
+// Same layout as tools/dmx_cue_pack.cpp
+static std::vector<uint8_t> packShow(const std::vector<CueState>& cues) {
+    std::vector<uint8_t> out(DMX_CUE_HEADER_SIZE + cues.size() * DMX_CUE_INDEX_ENTRY_SIZE, 0);
+    dmxCueWriteU32(&out[0], DMX_CUE_MAGIC);
+    dmxCueWriteU16(&out[4], DMX_CUE_VERSION);
+    dmxCueWriteU16(&out[6], (uint16_t)cues.size());
+    out[8] = NUM_UNIVERSES;
+
+    static const uint8_t zeros[DMX_UNIVERSE_SIZE] = {0};
+    uint8_t block[DMX_CUE_MAX_BLOCK_SIZE];
+    for (size_t i = 0; i < cues.size(); i++) {
+        bool keyframe = i % KEYFRAME_INTERVAL == 0;
+        uint32_t offset = (uint32_t)out.size();
+        for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+            const uint8_t* prev = keyframe ? zeros : cues[i - 1].universes[u];
+            uint16_t length = DMXCueCodec::encodeUniverse(prev, cues[i].universes[u], block, sizeof(block));
+            if (length == 0) {
+                continue;
+            }
+            out.push_back(u);
+            out.push_back((uint8_t)length);
+            out.push_back((uint8_t)(length >> 8));
+            out.insert(out.end(), block, block + length);
+        }
+        uint8_t* entry = &out[DMX_CUE_HEADER_SIZE + i * DMX_CUE_INDEX_ENTRY_SIZE];
+        dmxCueWriteU32(&entry[0], offset);
+        dmxCueWriteU32(&entry[4], (uint32_t)out.size() - offset);
+        dmxCueWriteU32(&entry[8], FADE_MS);
+        dmxCueWriteU16(&entry[12], (uint16_t)(i + 1));
+        dmxCueWriteU16(&entry[14], keyframe ? DMX_CUE_FLAG_KEYFRAME : 0);
+    }
+    return out;
+}
+
+// Offset of a universe block's header in a cue, or 0 if the cue omits it
+static size_t findBlock(const std::vector<uint8_t>& image, uint16_t cue_index, uint8_t universe) {
+    const uint8_t* entry = &image[DMX_CUE_HEADER_SIZE + cue_index * DMX_CUE_INDEX_ENTRY_SIZE];
+    size_t pos = dmxCueReadU32(&entry[0]);
+    size_t end = pos + dmxCueReadU32(&entry[4]);
+    while (pos + 3 <= end) {
+        if (image[pos] == universe) {
+            return pos;
+        }
+        pos += 3 + dmxCueReadU16(&image[pos + 1]);
+    }
+    return 0;
+}
+
+static bool matches(uint8_t* const universes[], const CueState& expected) {
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        if (memcmp(universes[u], expected.universes[u], DMX_UNIVERSE_SIZE) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool outputsMatch(DMXTransmitter outputs[], const CueState& expected) {
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        if (memcmp(outputs[u].getUniverseBuffer(), expected.universes[u], DMX_UNIVERSE_SIZE) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void checkCodec(uint32_t seed) {
+    printf("Codec:\n");
+    static uint8_t prev[DMX_UNIVERSE_SIZE], next[DMX_UNIVERSE_SIZE], decoded[DMX_UNIVERSE_SIZE];
+    uint8_t ops[DMX_CUE_MAX_BLOCK_SIZE];
+
+    for (uint16_t i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+        prev[i] = (uint8_t)nextRandom(&seed);
+    }
+    check(DMXCueCodec::encodeUniverse(prev, prev, ops, sizeof(ops)) == 0, "unchanged universe encodes to nothing");
+
+    // Every slot changed, no runs: the worst case must fit the bound
+    for (uint16_t i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+        next[i] = (uint8_t)(prev[i] + 1 + (i & 1));
+    }
+    uint16_t length = DMXCueCodec::encodeUniverse(prev, next, ops, sizeof(ops));
+    memcpy(decoded, prev, sizeof(decoded));
+    check(length > 0 && DMXCueCodec::decodeUniverse(ops, length, decoded) &&
+              memcmp(decoded, next, sizeof(next)) == 0,
+          "all slots changed: literal round trip");
+
+    // Long skip, long run, short literal, trailing unchanged slots
+    memcpy(next, prev, sizeof(next));
+    memset(&next[100], prev[100] + 1, 300);
+    next[450] = (uint8_t)(prev[450] + 1);
+    next[452] = (uint8_t)(prev[452] + 1);
+    length = DMXCueCodec::encodeUniverse(prev, next, ops, sizeof(ops));
+    memcpy(decoded, prev, sizeof(decoded));
+    check(length > 0 && length < 16 && DMXCueCodec::decodeUniverse(ops, length, decoded) &&
+              memcmp(decoded, next, sizeof(next)) == 0,
+          "skip + 300-slot run + literals round trip, compact");
+
+    check(DMXCueCodec::encodeUniverse(prev, next, ops, 4) == 0, "encode into a too-small buffer fails");
+
+    // Malformed ops
+    const uint8_t bad_type[] = {0xC0};
+    const uint8_t literal_short[] = {0x44, 1, 2, 3};            // LITERAL of 5, 3 bytes follow
+    const uint8_t run_no_value[] = {0x85};                      // RUN of 6, value missing
+    const uint8_t long_no_count[] = {0x20};                     // SKIP, long count byte missing
+    const uint8_t overrun[] = {0x21, 0xFF, 0x80 | 0x02, 7};     // SKIP 512, then RUN past the end
+    memcpy(decoded, prev, sizeof(decoded));
+    check(!DMXCueCodec::decodeUniverse(bad_type, sizeof(bad_type), decoded), "reserved op type rejected");
+    check(!DMXCueCodec::decodeUniverse(literal_short, sizeof(literal_short), decoded), "truncated literal rejected");
+    check(!DMXCueCodec::decodeUniverse(run_no_value, sizeof(run_no_value), decoded), "run without a value rejected");
+    check(!DMXCueCodec::decodeUniverse(long_no_count, sizeof(long_no_count), decoded), "long op without count rejected");
+    check(!DMXCueCodec::decodeUniverse(overrun, sizeof(overrun), decoded), "ops past slot 512 rejected");
+}
+
+static void checkShow(const std::vector<CueState>& cues, const std::vector<uint8_t>& image) {
+    printf("Show (%u cues, keyframe every %d):\n", (unsigned)cues.size(), KEYFRAME_INTERVAL);
+    DMXCueShow show;
+    check(show.open(image.data(), image.size()) && show.getNumCues() == cues.size() &&
+              show.getNumUniverses() == NUM_UNIVERSES,
+          "packed show opens");
+
+    static uint8_t state[NUM_UNIVERSES][DMX_UNIVERSE_SIZE];
+    uint8_t* universes[NUM_UNIVERSES] = {state[0], state[1], state[2]};
+
+    bool sequential = true;
+    for (uint16_t i = 0; i < show.getNumCues(); i++) {
+        sequential = sequential && show.applyCue(i, universes, NUM_UNIVERSES) && matches(universes, cues[i]);
+    }
+    check(sequential, "keyframes and deltas decode in sequence");
+
+    bool from_keyframe = true;
+    for (uint16_t i = 0; i < show.getNumCues(); i++) {
+        memset(state, 0xAA, sizeof(state));
+        uint16_t first = show.findKeyframe(i);
+        from_keyframe = from_keyframe && first == i - i % KEYFRAME_INTERVAL;
+        for (uint16_t c = first; c <= i; c++) {
+            from_keyframe = from_keyframe && show.applyCue(c, universes, NUM_UNIVERSES);
+        }
+        from_keyframe = from_keyframe && matches(universes, cues[i]);
+    }
+    check(from_keyframe, "every cue decodes from its keyframe");
+
+    check(!show.applyCue(show.getNumCues(), universes, NUM_UNIVERSES), "cue past the end rejected");
+
+    std::vector<uint8_t> truncated(image.begin(), image.end() - 1);
+    DMXCueShow truncated_show;
+    check(!truncated_show.open(truncated.data(), truncated.size()), "image missing its last byte does not open");
+    std::vector<uint8_t> bad_magic = image;
+    bad_magic[0] ^= 0xFF;
+    check(!truncated_show.open(bad_magic.data(), bad_magic.size()), "bad magic does not open");
+}
+
+static void checkPlayer(const std::vector<CueState>& cues, const std::vector<uint8_t>& image) {
+    printf("Player:\n");
+    static DMXTransmitter outputs[NUM_UNIVERSES] = {DMXTransmitter(10, pio1), DMXTransmitter(11, pio1),
+                                                    DMXTransmitter(12, pio1)};
+    DMXCueShow show;
+    show.open(image.data(), image.size());
+    static DMXCuePlayer player;
+    player.begin(&show, outputs, NUM_UNIVERSES);
+
+    uint32_t now = 0;
+    bool in_order = player.go(0, now);
+    for (uint16_t i = 0; i < show.getNumCues() && in_order; i++) {
+        if (i > 0) {
+            in_order = player.goNext(now);
+        }
+        now += FADE_MS;
+        player.update(now);
+        in_order = in_order && player.getCurrentCue() == i && outputsMatch(outputs, cues[i]);
+    }
+    check(in_order, "goNext through the show, outputs at every cue");
+
+    bool jumps = true;
+    uint32_t seed = 12345;
+    for (uint16_t n = 0; n < 50 && jumps; n++) {
+        uint16_t cue = (uint16_t)(nextRandom(&seed) % show.getNumCues());
+        jumps = player.go(cue, now);
+        now += FADE_MS;
+        player.update(now);
+        jumps = jumps && player.getCurrentCue() == cue && outputsMatch(outputs, cues[cue]);
+    }
+    check(jumps, "go to random cues, outputs at every cue");
+
+    // Half-way through a fade, 1 -> 2, the crossfade output
+    player.go(1, now);
+    player.update(now + FADE_MS);
+    player.go(2, now + FADE_MS);
+    player.update(now + FADE_MS + FADE_MS / 2);
+    bool halfway = true;
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        const uint8_t* out = outputs[u].getUniverseBuffer();
+        for (uint16_t s = 0; s < DMX_UNIVERSE_SIZE; s++) {
+            int32_t expected = cues[1].universes[u][s] + (cues[2].universes[u][s] - cues[1].universes[u][s]) / 2;
+            halfway = halfway && abs((int32_t)out[s] - expected) <= 1;
+        }
+    }
+    check(halfway, "crossfade half-way between two cues");
+}
+
+// Corrupt cue `bad` so that its first universe decodes and a later one fails,
+// then check that go() fails without disturbing the player
+static void checkFailedGo(const std::vector<CueState>& cues, std::vector<uint8_t> image, const char* what,
+                          bool truncate) {
+    static DMXTransmitter outputs[NUM_UNIVERSES] = {DMXTransmitter(10, pio1), DMXTransmitter(11, pio1),
+                                                    DMXTransmitter(12, pio1)};
+    const uint16_t good = 4;
+    const uint16_t bad = 6;
+    size_t block = findBlock(image, bad, 1);
+    if (findBlock(image, bad, 0) == 0 || block == 0) {
+        check(false, what);
+        return;
+    }
+    if (truncate) {
+        // Block length runs one byte past the end of the cue's data
+        const uint8_t* entry = &image[DMX_CUE_HEADER_SIZE + bad * DMX_CUE_INDEX_ENTRY_SIZE];
+        size_t end = dmxCueReadU32(&entry[0]) + dmxCueReadU32(&entry[4]);
+        dmxCueWriteU16(&image[block + 1], (uint16_t)(end - (block + 3) + 1));
+    } else {
+        image[block + 3] = 0xC0; // Reserved op type
+    }
+
+    DMXCueShow show;
+    static DMXCuePlayer player;
+    bool ok = show.open(image.data(), image.size()) && player.begin(&show, outputs, NUM_UNIVERSES);
+
+    static uint8_t state[NUM_UNIVERSES][DMX_UNIVERSE_SIZE];
+    uint8_t* universes[NUM_UNIVERSES] = {state[0], state[1], state[2]};
+    memcpy(state, cues[bad - 1].universes, sizeof(state));
+    ok = ok && !show.applyCue(bad, universes, NUM_UNIVERSES);
+
+    // At cue 4, jumping to cue 6 replays from its keyframe and fails
+    uint32_t now = 0;
+    ok = ok && player.go(good, now);
+    player.update(now += FADE_MS);
+    ok = ok && !player.go(bad, now) && player.getCurrentCue() == good && !player.isFading();
+    player.update(now += FADE_MS);
+    ok = ok && outputsMatch(outputs, cues[good]);
+
+    // Half-way into a fade to cue 5, the one-delta step to cue 6 fails and
+    // the fade to cue 5 runs on unchanged
+    ok = ok && player.goNext(now);
+    player.update(now + FADE_MS / 2);
+    ok = ok && !player.goNext(now + FADE_MS / 2);
+    ok = ok && player.getCurrentCue() == good + 1 && player.isFading();
+    player.update(now + FADE_MS);
+    ok = ok && outputsMatch(outputs, cues[good + 1]);
+    now += FADE_MS;
+
+    // Cues after the bad one still play from their keyframe
+    ok = ok && player.go(KEYFRAME_INTERVAL + 1, now);
+    player.update(now += FADE_MS);
+    ok = ok && outputsMatch(outputs, cues[KEYFRAME_INTERVAL + 1]);
+    check(ok, what);
+}
+
+int main(int argc, char** argv) {
+    uint16_t num_cues = 40;
+    uint32_t seed = 0x5EED1234u;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cues") == 0 && i + 1 < argc) {
+            num_cues = (uint16_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 0);
+        } else {
+            printf("Usage: %s [--cues N] [--seed N]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (num_cues < 2 * KEYFRAME_INTERVAL || seed == 0) {
+        printf("Need at least %d cues and a non-zero seed\n", 2 * KEYFRAME_INTERVAL);
+        return 2;
+    }
+
+    std::vector<CueState> cues;
+    generateShow(cues, num_cues, seed);
+    std::vector<uint8_t> image = packShow(cues);
+    printf("Cue show: %u cues x %d universes, %u bytes packed (%u raw)\n", num_cues, NUM_UNIVERSES,
+           (unsigned)image.size(), (unsigned)(num_cues * NUM_UNIVERSES * DMX_UNIVERSE_SIZE));
+
+    checkCodec(seed);
+    checkShow(cues, image);
+    checkPlayer(cues, image);
+    printf("Damaged records:\n");
+    checkFailedGo(cues, image, "corrupted op: go() fails, cue and fade kept", false);
+    checkFailedGo(cues, image, "truncated block: go() fails, cue and fade kept", true);
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
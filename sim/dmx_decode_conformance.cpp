@@ -0,0 +1,682 @@
+/*
+ * DMX Decoder Conformance Corpus (host build)
+ *
+ * Generates DMX512 waveforms with DMXWaveformGen from a corpus of cases at
+ * and beyond the ANSI E1.11 (DMX512-A) limits, and decodes each with:
+ *   DmxInput  the Pico-DMX PIO program on the cycle-accurate PIO emulator,
+ *             re-armed after every 513-byte transfer as its DMA handler is
+ *   edges     a reference UART decoder over the edge timestamps
+ *   samples   an oversampling UART decoder over the raw sample stream
+ *
+ * Build:  cmake -S . -B build && cmake --build build   (host build, no pico-sdk)
+ * Usage:  ./build/dmx_decode_conformance [--sys-hz N] [--sample-hz N] [--seed N] [--frames N]
+ *         ./build/dmx_decode_conformance --list
+ *         ./build/dmx_decode_conformance --dump CASE PREFIX   (writes PREFIX.vcd and PREFIX.bin)
+ *
+ * Each case sends a good frame, the frame under test, then two more good
+ * frames. A decoder meets a case when it delivers the good frames, and the
+ * frame under test intact (or not at all) as E1.11 requires; "lost" marks a
+ * case where a good frame after the one under test was lost too. Where E1.11
+ * leaves the outcome open, it is reported but not judged. The reference
+ * decoders, edges and samples, read a packet as ending at the next break or
+ * after 513 slots, drop it on a framing error, and ignore spikes shorter
+ * than half a bit.
+ *
+ * Throughput: every decoder decodes --frames back-to-back full frames,
+ * reported in frames per second of wall time.
+ *
+ * Exits 1 if a reference decoder misses a case, or DmxInput misses one with
+ * in-spec timing. DmxInput's results on short packets and bad input are
+ * reported only: it always transfers 513 bytes and does not check framing.
+ */
+
+#include "dmx_pio_emulator.h"
+#include "dmx_waveform_gen.h"
+#include "DmxInput.pio.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define DMX_FRAME_SLOTS 513        // Start code + 512 slots
+#define MAX_CASE_SLOTS 601         // The overlong case
+#define DMX_BIT_NS 4000
+#define DMX_SM_HZ 1000000
+#define RX_PIN 1
+#define RX_BREAK_MIN_NS 88000      // Receivers shall accept a break this short
+#define RX_MAB_MIN_NS 8000         // ... and a MAB this short
+#define LEAD_IDLE_NS 200000
+#define HANDLER_STEP_NS 4000       // DmxInput DMA IRQ latency
+#define GLITCH_SLOT 100            // Slot that carries a framing error or a glitch
+
+static uint32_t sys_hz = 125000000;
+static uint32_t sample_hz = 4000000;  // 16 samples per bit
+static uint32_t seed = 1;
+
+typedef std::vector<std::vector<uint8_t>> Packets;
+
+enum CaseClass { CLASS_TIMING, CLASS_PACKET, CLASS_ERROR };
+enum Expect { EXPECT_INTACT, EXPECT_DROPPED, EXPECT_ANY };
+enum GlitchAt { GLITCH_NONE, GLITCH_BREAK, GLITCH_MAB, GLITCH_SLOT_GAP };
+enum Result { RESULT_INTACT, RESULT_DROPPED, RESULT_CORRUPT };
+
+struct CorpusCase {
+    const char* name;
+    const char* limit;             // What it probes
+    CaseClass case_class;
+    Expect expect;
+    DMXWaveformGen::Timing timing;  // Of the frame under test
+    uint16_t length;               // Slots including the start code
+    uint8_t start_code;
+    bool framing_error;            // In GLITCH_SLOT
+    GlitchAt glitch;
+    uint32_t glitch_ns;
+    uint32_t noise_spikes;         // Random spikes of up to noise_ns across the frame under test
+    uint32_t noise_ns;
+    uint32_t flip_ppm;             // Noise in the sample stream only
+};
+
+struct Decoder {
+    const char* name;
+    bool reference;
+    void (*decode)(const DMXWaveform& wave, const DMXSampleStream& samples, Packets* packets);
+};
+
+struct Outcome {
+    Result result;                 // Of the frame under test
+    bool lead_ok;
+    bool recovered;                // Both good frames after it delivered
+    uint32_t good_delivered;       // Of the frames that had to be
+    uint32_t good_total;
+    uint32_t corrupt;              // Packets matching no frame sent
+};
+
+// Corpus
+
+static CorpusCase& addCase(std::vector<CorpusCase>& corpus, const char* name, const char* limit,
+                           CaseClass case_class, Expect expect) {
+    CorpusCase c;
+    memset(&c, 0, sizeof(c));
+    c.name = name;
+    c.limit = limit;
+    c.case_class = case_class;
+    c.expect = expect;
+    c.timing = DMXWaveformGen::nominal();
+    c.length = DMX_FRAME_SLOTS;
+    corpus.push_back(c);
+    return corpus.back();
+}
+
+static std::vector<CorpusCase> buildCorpus() {
+    std::vector<CorpusCase> corpus;
+    addCase(corpus, "nominal", "176 us break, 12 us MAB, 4 us bits, 2 stop bits", CLASS_TIMING, EXPECT_INTACT);
+    addCase(corpus, "break 88 us", "receivers shall accept a break of 88 us", CLASS_TIMING, EXPECT_INTACT)
+        .timing.break_ns = 88000;
+    addCase(corpus, "break 1 ms", "long break", CLASS_TIMING, EXPECT_INTACT).timing.break_ns = 1000000;
+    addCase(corpus, "MAB 8 us", "receivers shall accept a MAB of 8 us", CLASS_TIMING, EXPECT_INTACT)
+        .timing.mab_ns = 8000;
+    addCase(corpus, "MAB 1 ms", "long MAB, within the 1 s limit", CLASS_TIMING, EXPECT_INTACT).timing.mab_ns = 1000000;
+    addCase(corpus, "bit 3.92 us", "bit time 4 us -2%", CLASS_TIMING, EXPECT_INTACT).timing.bit_ns = 3920;
+    addCase(corpus, "bit 4.08 us", "bit time 4 us +2%", CLASS_TIMING, EXPECT_INTACT).timing.bit_ns = 4080;
+    addCase(corpus, "inter-slot 100 us", "mark between slots, within the 1 s limit", CLASS_TIMING, EXPECT_INTACT)
+        .timing.slot_gap_ns = 100000;
+    addCase(corpus, "inter-slot 1 ms", "mark between slots, within the 1 s limit", CLASS_TIMING, EXPECT_INTACT)
+        .timing.slot_gap_ns = 1000000;
+    addCase(corpus, "back to back", "break straight after the last stop bit", CLASS_TIMING, EXPECT_INTACT)
+        .timing.frame_gap_ns = 0;
+    addCase(corpus, "mark before break 1 ms", "long idle between packets", CLASS_TIMING, EXPECT_INTACT)
+        .timing.frame_gap_ns = 1000000;
+    addCase(corpus, "jitter 80 ns", "every bit 4 us +/-80 ns at random", CLASS_TIMING, EXPECT_INTACT)
+        .timing.jitter_ns = 80;
+    CorpusCase& worst = addCase(corpus, "worst case in spec", "88 us break, 8 us MAB and 4.08 us bits at once",
+                                CLASS_TIMING, EXPECT_INTACT);
+    worst.timing.break_ns = 88000;
+    worst.timing.mab_ns = 8000;
+    worst.timing.bit_ns = 4080;
+
+    addCase(corpus, "start code 0xCC", "alternate start codes are passed on", CLASS_PACKET, EXPECT_INTACT)
+        .start_code = 0xCC;
+    addCase(corpus, "24 slots", "packets may be shorter than 512 slots", CLASS_PACKET, EXPECT_INTACT).length = 25;
+    addCase(corpus, "1 slot", "the shortest packet", CLASS_PACKET, EXPECT_INTACT).length = 2;
+
+    addCase(corpus, "break 60 us", "below the 88 us minimum: not a break", CLASS_ERROR, EXPECT_DROPPED)
+        .timing.break_ns = 60000;
+    addCase(corpus, "MAB 4 us", "below the 8 us minimum", CLASS_ERROR, EXPECT_ANY).timing.mab_ns = 4000;
+    addCase(corpus, "bit 3.6 us", "bit time 4 us -10%", CLASS_ERROR, EXPECT_ANY).timing.bit_ns = 3600;
+    addCase(corpus, "bit 4.4 us", "bit time 4 us +10%", CLASS_ERROR, EXPECT_ANY).timing.bit_ns = 4400;
+    addCase(corpus, "one stop bit", "transmitters send two", CLASS_ERROR, EXPECT_ANY).timing.stop_bits = 1;
+    addCase(corpus, "framing error", "space where slot 100's first stop bit belongs", CLASS_ERROR, EXPECT_DROPPED)
+        .framing_error = true;
+    CorpusCase& gap = addCase(corpus, "glitch between slots", "1 us space in a 20 us mark after slot 100",
+                              CLASS_ERROR, EXPECT_ANY);
+    gap.timing.slot_gap_ns = 20000;
+    gap.glitch = GLITCH_SLOT_GAP;
+    gap.glitch_ns = 1000;
+    CorpusCase& in_break = addCase(corpus, "glitch in break", "2 us mark halfway through the break",
+                                   CLASS_ERROR, EXPECT_ANY);
+    in_break.glitch = GLITCH_BREAK;
+    in_break.glitch_ns = 2000;
+    CorpusCase& in_mab = addCase(corpus, "glitch in MAB", "1 us space halfway through the MAB", CLASS_ERROR, EXPECT_ANY);
+    in_mab.glitch = GLITCH_MAB;
+    in_mab.glitch_ns = 1000;
+    CorpusCase& noise = addCase(corpus, "line noise", "20 spikes of up to 500 ns across the packet",
+                                CLASS_ERROR, EXPECT_ANY);
+    noise.noise_spikes = 20;
+    noise.noise_ns = 500;
+    addCase(corpus, "sampling noise", "100 samples per million flipped in the capture", CLASS_ERROR, EXPECT_ANY)
+        .flip_ppm = 100;
+    addCase(corpus, "600 slots", "longer than the 512 slot maximum", CLASS_ERROR, EXPECT_ANY).length = 601;
+    return corpus;
+}
+
+static const char* className(CaseClass case_class) {
+    switch (case_class) {
+        case CLASS_TIMING: return "in-spec timing";
+        case CLASS_PACKET: return "in-spec packets";
+        default: return "out of spec";
+    }
+}
+
+static const char* expectName(Expect expect) {
+    switch (expect) {
+        case EXPECT_INTACT: return "intact";
+        case EXPECT_DROPPED: return "dropped";
+        default: return "any";
+    }
+}
+
+static const char* resultName(Result result) {
+    switch (result) {
+        case RESULT_INTACT: return "intact";
+        case RESULT_DROPPED: return "dropped";
+        default: return "corrupt";
+    }
+}
+
+// Waveforms
+
+static void fillFrame(uint8_t* frame, uint16_t length, uint8_t start_code, uint32_t frame_seed) {
+    frame[0] = start_code;
+    for (uint16_t i = 1; i < length; i++) {
+        frame_seed = frame_seed * 1103515245 + 12345;
+        frame[i] = (uint8_t)(frame_seed >> 16);
+    }
+}
+
+// The lead frame, the frame under test, and the two good frames after it
+struct CaseFrames {
+    uint8_t data[4][MAX_CASE_SLOTS];
+    uint16_t lengths[4];
+};
+
+static DMXWaveform makeCaseWave(const CorpusCase& c, uint32_t case_seed, CaseFrames* frames) {
+    const DMXWaveformGen::Timing nominal = DMXWaveformGen::nominal();
+    for (int i = 0; i < 4; i++) {
+        frames->lengths[i] = i == 1 ? c.length : DMX_FRAME_SLOTS;
+        fillFrame(frames->data[i], frames->lengths[i], i == 1 ? c.start_code : 0, case_seed * 4 + i);
+    }
+
+    DMXWaveform wave;
+    DMXWaveformGen gen(&wave, case_seed);
+    gen.mark(LEAD_IDLE_NS);
+    gen.frame(frames->data[0], frames->lengths[0], nominal);
+    uint64_t test_start_ns = gen.nowNs();
+    gen.frame(frames->data[1], frames->lengths[1], c.timing, c.framing_error ? GLITCH_SLOT : -1);
+    uint64_t test_end_ns = gen.nowNs();
+    gen.frame(frames->data[2], frames->lengths[2], nominal);
+    gen.frame(frames->data[3], frames->lengths[3], nominal);
+    gen.mark(LEAD_IDLE_NS);
+
+    const DMXWaveformGen::Timing& t = c.timing;
+    uint64_t slots_start_ns = test_start_ns + t.break_ns + t.mab_ns;
+    uint64_t slot_ns = (uint64_t)(9 + t.stop_bits) * t.bit_ns + t.slot_gap_ns;
+    uint64_t glitch_ns = 0;
+    switch (c.glitch) {
+        case GLITCH_BREAK: glitch_ns = test_start_ns + t.break_ns / 2 - c.glitch_ns / 2; break;
+        case GLITCH_MAB: glitch_ns = test_start_ns + t.break_ns + t.mab_ns / 2 - c.glitch_ns / 2; break;
+        case GLITCH_SLOT_GAP:
+            glitch_ns = slots_start_ns + GLITCH_SLOT * slot_ns + (9 + t.stop_bits) * t.bit_ns + t.slot_gap_ns / 2 -
+                        c.glitch_ns / 2;
+            break;
+        default: break;
+    }
+    if (c.glitch != GLITCH_NONE) {
+        wave = DMXWaveformGen::withGlitch(wave, glitch_ns, c.glitch_ns);
+    }
+    if (c.noise_spikes) {
+        wave = DMXWaveformGen::withNoise(wave, test_start_ns, test_end_ns, c.noise_spikes, c.noise_ns, case_seed);
+    }
+    return wave;
+}
+
+// Decoders
+
+// DmxInput::begin() + read_async(), then the DMA IRQ handler's re-arm after
+// each 513-byte transfer
+static int beginInput(DMXPioEmulator& emu, uint sm, uint pin) {
+    int offset = emu.addProgram(&DmxInput_program);
+    emu.setPindirs(0, 1u << pin);
+    pio_sm_config config = DmxInput_program_get_default_config(offset);
+    sm_config_set_in_pins(&config, pin);
+    sm_config_set_jmp_pin(&config, pin);
+    sm_config_set_in_shift(&config, true, false, 8);
+    sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_RX);
+    sm_config_set_clkdiv(&config, (float)(sys_hz / DMX_SM_HZ));
+    emu.initSm(sm, offset, config);
+    return offset;
+}
+
+static void armInput(DMXPioEmulator& emu, uint sm, int offset, uint8_t* buffer, uint16_t length) {
+    emu.setEnabled(sm, false);
+    emu.restart(sm);
+    emu.streamRx(sm, buffer, length);
+    emu.exec(sm, pio_encode_jmp(offset));
+    emu.clearFifos(sm);
+    emu.setEnabled(sm, true);
+}
+
+static void decodeDmxInput(const DMXWaveform& wave, const DMXSampleStream&, Packets* packets) {
+    DMXPioEmulator emu(sys_hz);
+    emu.setInput(RX_PIN, &wave);
+    int offset = beginInput(emu, 0, RX_PIN);
+    uint8_t buffer[DMX_FRAME_SLOTS];
+    armInput(emu, 0, offset, buffer, DMX_FRAME_SLOTS);
+    for (uint64_t now_ns = 0; now_ns < wave.getEndNs();) {
+        now_ns = std::min(now_ns + HANDLER_STEP_NS, wave.getEndNs());
+        emu.run(now_ns);
+        if (emu.getRxStreamed(0) == DMX_FRAME_SLOTS) {
+            packets->push_back(std::vector<uint8_t>(buffer, buffer + DMX_FRAME_SLOTS));
+            armInput(emu, 0, offset, buffer, DMX_FRAME_SLOTS);
+        }
+    }
+}
+
+// Packet assembly shared by the reference decoders
+struct PacketBuilder {
+    Packets* packets;
+    std::vector<uint8_t> packet;
+    bool open;
+
+    void onBreak(bool valid_mab) {
+        close();
+        open = valid_mab;
+    }
+    void onSlot(uint8_t value) {
+        packet.push_back(value);
+        if (packet.size() == DMX_FRAME_SLOTS) {
+            close();
+        }
+    }
+    void onFramingError() {
+        packet.clear();
+        open = false;
+    }
+    void close() {
+        if (open && !packet.empty()) {
+            packets->push_back(packet);
+        }
+        packet.clear();
+        open = false;
+    }
+};
+
+static void decodeEdges(const DMXWaveform& wave, const DMXSampleStream&, Packets* packets) {
+    PacketBuilder builder = {packets, {}, false};
+    size_t edges = wave.getNumEdges();
+    uint64_t resume_ns = 0;
+    for (size_t i = 0; i < edges; i++) {
+        // Breaks and start bits begin on falling edges
+        bool high_after = wave.getInitialLevel() ^ ((i + 1) & 1);
+        uint64_t fall_ns = wave.getEdgeNs(i);
+        if (high_after || fall_ns < resume_ns) {
+            continue;
+        }
+        uint64_t rise_ns = i + 1 < edges ? wave.getEdgeNs(i + 1) : wave.getEndNs();
+        if (rise_ns - fall_ns >= RX_BREAK_MIN_NS) {
+            uint64_t mab_end_ns = i + 2 < edges ? wave.getEdgeNs(i + 2) : wave.getEndNs();
+            builder.onBreak(i + 1 < edges && mab_end_ns - rise_ns >= RX_MAB_MIN_NS);
+            continue;
+        }
+        // A start bit is still low halfway through, or it was a spike
+        if (!builder.open || wave.levelAt(fall_ns + DMX_BIT_NS / 2)) {
+            continue;
+        }
+        uint8_t value = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            if (wave.levelAt(fall_ns + DMX_BIT_NS * bit + DMX_BIT_NS * 3 / 2)) {
+                value |= 1u << bit;
+            }
+        }
+        uint64_t stop_ns = fall_ns + DMX_BIT_NS * 9 + DMX_BIT_NS / 2;
+        if (!wave.levelAt(stop_ns)) {
+            builder.onFramingError();
+            continue;
+        }
+        builder.onSlot(value);
+        resume_ns = stop_ns;
+    }
+    builder.close();
+}
+
+// 3-sample majority vote against single-sample noise
+static inline bool filteredAt(const DMXSampleStream& samples, uint64_t index) {
+    if (index == 0 || index + 1 >= samples.size()) {
+        return samples.get(index < samples.size() ? index : samples.size() - 1);
+    }
+    return (samples.get(index - 1) + samples.get(index) + samples.get(index + 1)) >= 2;
+}
+
+static void decodeSamples(const DMXWaveform&, const DMXSampleStream& samples, Packets* packets) {
+    PacketBuilder builder = {packets, {}, false};
+    uint64_t count = samples.size();
+    double per_bit = samples.getSampleHz() * (DMX_BIT_NS / 1e9);
+    // One sample of slack for the quantisation of the edges
+    uint64_t break_min = (uint64_t)(samples.getSampleHz() * (RX_BREAK_MIN_NS / 1e9)) - 1;
+    uint64_t mab_min = (uint64_t)(samples.getSampleHz() * (RX_MAB_MIN_NS / 1e9)) - 1;
+
+    uint64_t index = 0;
+    while (index < count) {
+        while (index < count && filteredAt(samples, index)) {
+            index++;
+        }
+        uint64_t fall = index;
+        while (index < count && !filteredAt(samples, index)) {
+            index++;
+        }
+        if (fall >= count) {
+            break;
+        }
+        if (index - fall >= break_min) {
+            uint64_t rise = index;
+            while (index < count && filteredAt(samples, index)) {
+                index++;
+            }
+            builder.onBreak(index < count && index - rise >= mab_min);
+            continue;
+        }
+        uint64_t stop = fall + (uint64_t)(per_bit * 9.5);
+        if (!builder.open || filteredAt(samples, fall + (uint64_t)(per_bit / 2)) || stop >= count) {
+            continue;
+        }
+        uint8_t value = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            if (filteredAt(samples, fall + (uint64_t)(per_bit * (bit + 1.5)))) {
+                value |= 1u << bit;
+            }
+        }
+        if (!filteredAt(samples, stop)) {
+            builder.onFramingError();
+            continue;
+        }
+        builder.onSlot(value);
+        index = stop;
+    }
+    builder.close();
+}
+
+static const Decoder decoders[] = {
+    {"DmxInput", false, decodeDmxInput},
+    {"edges", true, decodeEdges},
+    {"samples", true, decodeSamples},
+};
+#define NUM_DECODERS (sizeof(decoders) / sizeof(decoders[0]))
+
+// Scoring
+
+static bool packetIs(const std::vector<uint8_t>& packet, const uint8_t* data, uint16_t length) {
+    return packet.size() == length && memcmp(packet.data(), data, length) == 0;
+}
+
+static Outcome score(const CorpusCase& c, const CaseFrames& frames, const Packets& packets) {
+    bool delivered[4] = {};
+    Outcome outcome;
+    memset(&outcome, 0, sizeof(outcome));
+    for (const std::vector<uint8_t>& packet : packets) {
+        bool known = false;
+        for (int i = 0; i < 4; i++) {
+            if (packetIs(packet, frames.data[i], frames.lengths[i])) {
+                delivered[i] = known = true;
+            }
+        }
+        if (!known) {
+            outcome.corrupt++;
+        }
+    }
+    outcome.result = delivered[1] ? RESULT_INTACT : outcome.corrupt ? RESULT_CORRUPT : RESULT_DROPPED;
+    outcome.lead_ok = delivered[0];
+    outcome.recovered = delivered[2] && delivered[3];
+    outcome.good_delivered = delivered[0] + delivered[2] + delivered[3];
+    outcome.good_total = 3;
+    if (c.expect == EXPECT_INTACT) {
+        outcome.good_delivered += delivered[1];
+        outcome.good_total++;
+    }
+    return outcome;
+}
+
+static bool meets(const CorpusCase& c, const Outcome& outcome) {
+    if (!outcome.lead_ok || !outcome.recovered) {
+        return false;
+    }
+    switch (c.expect) {
+        case EXPECT_INTACT: return outcome.result == RESULT_INTACT && outcome.corrupt == 0;
+        case EXPECT_DROPPED: return outcome.result == RESULT_DROPPED;
+        default: return true;
+    }
+}
+
+static const CorpusCase* findCase(const std::vector<CorpusCase>& corpus, const char* name) {
+    for (const CorpusCase& c : corpus) {
+        if (strcmp(c.name, name) == 0) {
+            return &c;
+        }
+    }
+    return nullptr;
+}
+
+static int runCorpus(const std::vector<CorpusCase>& corpus) {
+    struct Totals {
+        uint32_t met;
+        uint32_t judged;
+        uint32_t good_delivered;
+        uint32_t good_total;
+        uint32_t corrupt;
+        uint32_t missed[3];        // Per class
+    } totals[NUM_DECODERS];
+    memset(totals, 0, sizeof(totals));
+
+    printf("Conformance corpus: %u cases, sys %lu Hz, samples at %lu Hz, seed %lu\n", (unsigned)corpus.size(),
+           (unsigned long)sys_hz, (unsigned long)sample_hz, (unsigned long)seed);
+    printf("  %-24s %-8s", "case", "expect");
+    for (size_t d = 0; d < NUM_DECODERS; d++) {
+        printf(" %-15s", decoders[d].name);
+    }
+    printf(" probes\n");
+
+    bool ok = true;
+    CaseClass last_class = CLASS_ERROR;
+    for (size_t i = 0; i < corpus.size(); i++) {
+        const CorpusCase& c = corpus[i];
+        if (i == 0 || c.case_class != last_class) {
+            printf(" %s\n", className(c.case_class));
+            last_class = c.case_class;
+        }
+        CaseFrames frames;
+        DMXWaveform wave = makeCaseWave(c, seed * 1000 + (uint32_t)i, &frames);
+        DMXSampleStream samples;
+        DMXWaveformGen::sample(wave, sample_hz, &samples, c.flip_ppm, seed + (uint32_t)i);
+
+        printf("  %-24s %-8s", c.name, expectName(c.expect));
+        for (size_t d = 0; d < NUM_DECODERS; d++) {
+            Packets packets;
+            decoders[d].decode(wave, samples, &packets);
+            Outcome outcome = score(c, frames, packets);
+            bool met = meets(c, outcome);
+            Totals& total = totals[d];
+            total.good_delivered += outcome.good_delivered;
+            total.good_total += outcome.good_total;
+            total.corrupt += outcome.corrupt;
+            if (c.expect != EXPECT_ANY || !met) {
+                total.judged++;
+                total.met += met;
+            }
+            if (!met) {
+                total.missed[c.case_class]++;
+            }
+            // DmxInput is held to the in-spec timing cases only
+            if (!met && (decoders[d].reference || c.case_class == CLASS_TIMING)) {
+                ok = false;
+            }
+
+            char cell[32];
+            snprintf(cell, sizeof(cell), "%s%s%s", met ? "" : "*", resultName(outcome.result),
+                     outcome.lead_ok && outcome.recovered ? "" : ",lost");
+            printf(" %-15s", cell);
+        }
+        printf(" %s\n", c.limit);
+    }
+
+    printf("Accuracy (* = missed; any = not judged unless frames after it were lost)\n");
+    for (size_t d = 0; d < NUM_DECODERS; d++) {
+        const Totals& total = totals[d];
+        printf("  %-9s %2lu/%-2lu cases met (missed: %lu timing, %lu packet, %lu out of spec), "
+               "%lu/%lu good frames delivered, %lu corrupt packets\n",
+               decoders[d].name, (unsigned long)total.met, (unsigned long)total.judged,
+               (unsigned long)total.missed[CLASS_TIMING], (unsigned long)total.missed[CLASS_PACKET],
+               (unsigned long)total.missed[CLASS_ERROR], (unsigned long)total.good_delivered,
+               (unsigned long)total.good_total, (unsigned long)total.corrupt);
+    }
+    return ok ? 0 : 1;
+}
+
+static int runThroughput(uint32_t frames) {
+    const DMXWaveformGen::Timing timing = DMXWaveformGen::nominal();
+    std::vector<std::vector<uint8_t>> sent(frames, std::vector<uint8_t>(DMX_FRAME_SLOTS));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    DMXWaveform wave;
+    DMXWaveformGen gen(&wave, seed);
+    DMXWaveformGen::Timing back_to_back = timing;
+    back_to_back.frame_gap_ns = 0;
+    gen.mark(LEAD_IDLE_NS);
+    for (uint32_t f = 0; f < frames; f++) {
+        fillFrame(sent[f].data(), DMX_FRAME_SLOTS, 0, seed + f);
+        gen.frame(sent[f].data(), DMX_FRAME_SLOTS, back_to_back);
+    }
+    gen.mark(LEAD_IDLE_NS);
+    double gen_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    DMXSampleStream samples;
+    DMXWaveformGen::sample(wave, sample_hz, &samples);
+    double sample_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double wave_s = wave.getEndNs() / 1e9;
+
+    printf("Throughput: %lu back-to-back frames, %.2f s of signal\n", (unsigned long)frames, wave_s);
+    printf("  generator %12.0f frames/s, sampling %.1f M samples/s\n", frames / gen_s, samples.size() / sample_s / 1e6);
+    bool ok = true;
+    for (size_t d = 0; d < NUM_DECODERS; d++) {
+        Packets packets;
+        start = std::chrono::steady_clock::now();
+        decoders[d].decode(wave, samples, &packets);
+        double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint32_t intact = 0;
+        for (uint32_t f = 0; f < frames && f < packets.size(); f++) {
+            intact += packets[f] == sent[f];
+        }
+        bool decoder_ok = intact == frames && packets.size() == frames;
+        ok = ok && decoder_ok;
+        printf("  %-9s %12.0f frames/s, %8.1fx real time, %lu/%lu intact  %s\n", decoders[d].name, frames / wall_s,
+               wave_s / wall_s, (unsigned long)intact, (unsigned long)frames, decoder_ok ? "PASS" : "FAIL");
+    }
+    return ok ? 0 : 1;
+}
+
+static int dumpCase(const std::vector<CorpusCase>& corpus, const char* name, const char* prefix) {
+    const CorpusCase* c = findCase(corpus, name);
+    if (!c) {
+        fprintf(stderr, "No case '%s' (see --list)\n", name);
+        return 2;
+    }
+    CaseFrames frames;
+    DMXWaveform wave = makeCaseWave(*c, seed * 1000 + (uint32_t)(c - corpus.data()), &frames);
+    DMXSampleStream samples;
+    DMXWaveformGen::sample(wave, sample_hz, &samples, c->flip_ppm, seed + (uint32_t)(c - corpus.data()));
+
+    std::string vcd_path = std::string(prefix) + ".vcd";
+    std::string bin_path = std::string(prefix) + ".bin";
+    FILE* file = fopen(bin_path.c_str(), "wb");
+    bool ok = DMXWaveformGen::writeVcd(wave, vcd_path.c_str()) && file &&
+              fwrite(samples.getBytes().data(), 1, samples.getBytes().size(), file) == samples.getBytes().size();
+    if (file) {
+        fclose(file);
+    }
+    if (!ok) {
+        fprintf(stderr, "Cannot write %s / %s\n", vcd_path.c_str(), bin_path.c_str());
+        return 1;
+    }
+    printf("%s: %lu edges, %.3f ms -> %s; %llu samples at %lu Hz, LSB first -> %s\n", c->name,
+           (unsigned long)wave.getNumEdges(), wave.getEndNs() / 1e6, vcd_path.c_str(),
+           (unsigned long long)samples.size(), (unsigned long)sample_hz, bin_path.c_str());
+    return 0;
+}
+
+static int usage(const char* name) {
+    fprintf(stderr, "Usage: %s [--sys-hz N] [--sample-hz N] [--seed N] [--frames N] [--list] [--dump CASE PREFIX]\n",
+            name);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = 100;
+    bool list = false;
+    const char* dump_case = nullptr;
+    const char* dump_prefix = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sys-hz") == 0 && i + 1 < argc) {
+            sys_hz = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--sample-hz") == 0 && i + 1 < argc) {
+            sample_hz = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (uint32_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--list") == 0) {
+            list = true;
+        } else if (strcmp(argv[i], "--dump") == 0 && i + 2 < argc) {
+            dump_case = argv[++i];
+            dump_prefix = argv[++i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (sys_hz < DMX_SM_HZ) {
+        fprintf(stderr, "--sys-hz must be at least %d\n", DMX_SM_HZ);
+        return 2;
+    }
+    // The majority vote needs a few samples per bit
+    if (sample_hz < 1000000) {
+        fprintf(stderr, "--sample-hz must be at least 1000000\n");
+        return 2;
+    }
+
+    std::vector<CorpusCase> corpus = buildCorpus();
+    if (list) {
+        for (const CorpusCase& c : corpus) {
+            printf("%-24s %-16s %-8s %s\n", c.name, className(c.case_class), expectName(c.expect), c.limit);
+        }
+        return 0;
+    }
+    if (dump_case) {
+        return dumpCase(corpus, dump_case, dump_prefix);
+    }
+
+    int result = runCorpus(corpus);
+    if (frames > 0 && runThroughput(frames) != 0) {
+        result = 1;
+    }
+    printf("%s\n", result == 0 ? "PASS" : "FAIL");
+    return result;
+}
@@ -0,0 +1,249 @@
+/*
+ * Fade Engine Check (host build)
+ *
+ * Drives DMXFadeEngine over 8 universes with a virtual millisecond clock and
+ * compares every rendered value against the ideal linear fade:
+ *   fades from 1 s to 1 hour, up and down, rendered every 1-25 ms:
+ *   within 1 level of ideal throughout, monotonic, exactly on target at the
+ *   end with no jump on the last render
+ * and checks snaps, stop() and stopAll(), range and universe fades against
+ * their own targets, retargeting a fade in progress, durations past
+ * DMX_FADE_MAX_DURATION_MS and the argument checks.
+ *
+ * Build:  cmake -S . -B build && cmake --build build   (host build, no pico-sdk)
+ * Usage:  ./build/dmx_fade_sim
+ *
+ * Exits 1 if any check failed.
+ */
+
+#include "pico/stdlib.h"
+#include "dmx_transmitter.h"
+#include "dmx_fade_engine.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define NUM_UNIVERSES 8
+
+static DMXTransmitter outputs[NUM_UNIVERSES] = {
+    DMXTransmitter(10, pio1), DMXTransmitter(11, pio1), DMXTransmitter(12, pio1), DMXTransmitter(13, pio1),
+    DMXTransmitter(14, pio1), DMXTransmitter(15, pio1), DMXTransmitter(16, pio1), DMXTransmitter(17, pio1)
+};
+static DMXFadeEngine engine;
+static uint32_t now_ms;
+static uint32_t failures = 0;
+
+static void check(bool ok, const char* what) {
+    printf("  %-60s %s\n", what, ok ? "ok" : "FAIL");
+    if (!ok) {
+        failures++;
+    }
+}
+
+static void reset() {
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        memset(outputs[u].getUniverseBuffer(), 0, DMX_UNIVERSE_SIZE);
+    }
+    now_ms = 1000;
+    engine.begin(outputs, NUM_UNIVERSES, now_ms);
+}
+
+static uint8_t output(uint8_t universe, uint16_t channel) {
+    return outputs[universe].getUniverseBuffer()[channel - 1];
+}
+
+// Linear fade position at elapsed ms, in levels
+static double ideal(uint8_t from, uint8_t to, uint64_t elapsed, uint64_t duration) {
+    return from + ((double)to - from) * (double)elapsed / (double)duration;
+}
+
+// One channel faded from -> to, rendered every interval_ms; true if it stayed
+// within a level of ideal, never reversed and ended exactly on target
+static bool runFade(uint8_t from, uint8_t to, uint32_t duration_ms, uint32_t interval_ms, double* worst_error,
+                    uint8_t* last_step) {
+    reset();
+    engine.fadeTo(3, 100, from, 0);
+    engine.render(now_ms);
+    uint32_t start = now_ms;
+    engine.fadeTo(3, 100, to, duration_ms);
+
+    bool ok = true;
+    uint8_t previous = from;
+    *worst_error = 0;
+    *last_step = 0;
+    while (now_ms - start < duration_ms) {
+        now_ms += interval_ms;
+        engine.render(now_ms);
+        uint8_t value = output(3, 100);
+        uint32_t elapsed = now_ms - start < duration_ms ? now_ms - start : duration_ms;
+        double error = value - ideal(from, to, elapsed, duration_ms);
+        error = error < 0 ? -error : error;
+        if (error > *worst_error) {
+            *worst_error = error;
+        }
+        ok = ok && error <= 1.0 && (to >= from ? value >= previous : value <= previous);
+        *last_step = (uint8_t)abs((int)value - (int)previous);
+        previous = value;
+    }
+    return ok && previous == to && !engine.isFading(3, 100) && engine.getValue(3, 100) == to &&
+           engine.getActiveFadeCount() == 0;
+}
+
+static void checkLinearFades() {
+    printf("Linear fades:\n");
+    struct Case {
+        const char* name;
+        uint8_t from, to;
+        uint32_t duration_ms, interval_ms;
+    };
+    static const Case cases[] = {
+        {"0 -> 255 over 1 s, every ms", 0, 255, 1000, 1},
+        {"255 -> 0 over 1 s, every ms", 255, 0, 1000, 1},
+        {"0 -> 255 over 3 s, every 23 ms", 0, 255, 3000, 23},
+        {"200 -> 13 over 7 s, every 23 ms", 200, 13, 7000, 23},
+        {"0 -> 255 over 10 min, every 25 ms", 0, 255, 600000, 25},
+        {"255 -> 0 over 10 min, every 25 ms", 255, 0, 600000, 25},
+        {"0 -> 255 over 1 hour, every 25 ms", 0, 255, 3600000, 25},
+        {"17 -> 18 over 1 hour, every 25 ms", 17, 18, 3600000, 25},
+        {"0 -> 255 over 200 ms, every 23 ms", 0, 255, 200, 23},
+    };
+    for (const Case& c : cases) {
+        double worst_error;
+        uint8_t last_step;
+        bool ok = runFade(c.from, c.to, c.duration_ms, c.interval_ms, &worst_error, &last_step);
+        // Renders far apart move far; otherwise the last step is one level
+        bool no_snap = c.interval_ms * 255u > c.duration_ms || last_step <= 1;
+        char what[96];
+        snprintf(what, sizeof(what), "%s (worst %.2f)", c.name, worst_error);
+        check(ok && no_snap, what);
+    }
+}
+
+static void checkSnapAndStop() {
+    printf("Snaps and stops:\n");
+    reset();
+    engine.fadeTo(0, 1, 200, 0);
+    check(engine.isFading(0, 1) && output(0, 1) == 0, "snap waits for render()");
+    engine.render(now_ms);
+    check(output(0, 1) == 200 && !engine.isFading(0, 1) && engine.getActiveFadeCount() == 0,
+          "snap lands on render()");
+
+    reset();
+    engine.fadeTo(1, 5, 255, 1000);
+    now_ms += 400;
+    engine.render(now_ms);
+    uint8_t held = output(1, 5);
+    engine.stop(1, 5);
+    now_ms += 1000;
+    engine.render(now_ms);
+    check(held >= 101 && held <= 102 && output(1, 5) == held && engine.getValue(1, 5) == held &&
+              !engine.isFading(1, 5) && engine.getActiveFadeCount() == 0,
+          "stop() holds the value reached");
+
+    reset();
+    for (uint16_t channel = 1; channel <= 40; channel++) {
+        engine.fadeTo(2, channel, 255, 2000);
+    }
+    engine.fadeTo(7, 512, 255, 2000);
+    now_ms += 1000;
+    engine.render(now_ms);
+    engine.stopAll();
+    now_ms += 2000;
+    engine.render(now_ms);
+    check(engine.getActiveFadeCount() == 0 && output(2, 1) == 128 && output(2, 40) == 128 && output(7, 512) == 128,
+          "stopAll() holds every channel");
+}
+
+static void checkRangeFades() {
+    printf("Range and universe fades:\n");
+    uint8_t targets[DMX_UNIVERSE_SIZE];
+    for (uint16_t i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+        targets[i] = (uint8_t)(i * 7 + 3);
+    }
+
+    reset();
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        engine.fadeUniverseTo(u, targets, 5000 + u * 1000);
+    }
+    check(engine.getActiveFadeCount() == NUM_UNIVERSES * DMX_UNIVERSE_SIZE, "8 universes fading");
+    uint32_t start = now_ms;
+    bool within = true;
+    while (now_ms - start < 12000) {
+        now_ms += 23;
+        engine.render(now_ms);
+        for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+            uint32_t duration = 5000 + u * 1000;
+            uint32_t elapsed = now_ms - start < duration ? now_ms - start : duration;
+            for (uint16_t i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+                double error = outputs[u].getUniverseBuffer()[i] - ideal(0, targets[i], elapsed, duration);
+                within = within && error <= 1.0 && error >= -1.0;
+            }
+        }
+    }
+    bool landed = engine.getActiveFadeCount() == 0;
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        landed = landed && memcmp(outputs[u].getUniverseBuffer(), targets, DMX_UNIVERSE_SIZE) == 0;
+    }
+    check(within, "every slot within 1 level of ideal");
+    check(landed, "every slot on its own target");
+
+    reset();
+    engine.fadeRangeTo(4, 100, targets, 50, 1000);
+    now_ms += 1000;
+    engine.render(now_ms);
+    bool outside = true;
+    for (uint16_t channel = 1; channel <= DMX_UNIVERSE_SIZE; channel++) {
+        if (channel < 100 || channel >= 150) {
+            outside = outside && output(4, channel) == 0;
+        }
+    }
+    check(memcmp(&outputs[4].getUniverseBuffer()[99], targets, 50) == 0 && outside,
+          "range fade touches its channels only");
+
+    check(!engine.fadeRangeTo(4, 500, targets, 14, 1000) && !engine.fadeTo(4, 0, 1, 1000) &&
+              !engine.fadeTo(4, 513, 1, 1000) && !engine.fadeTo(NUM_UNIVERSES, 1, 1, 1000) &&
+              !engine.fadeRangeTo(0, 1, nullptr, 1, 1000) && engine.getActiveFadeCount() == 0,
+          "out-of-range channels and universes rejected");
+}
+
+static void checkRetargetAndLimits() {
+    printf("Retargeting and long durations:\n");
+    reset();
+    engine.fadeTo(0, 10, 255, 1000);
+    now_ms += 500;
+    engine.render(now_ms);
+    uint8_t midway = output(0, 10);
+    engine.fadeTo(0, 10, 0, 1000);
+    now_ms += 1;
+    engine.render(now_ms);
+    uint8_t after = output(0, 10);
+    now_ms += 500;
+    engine.render(now_ms);
+    uint8_t half_back = output(0, 10);
+    check(midway == 128 && (after == midway || after == midway - 1) && half_back >= 63 && half_back <= 64 &&
+              engine.getActiveFadeCount() == 1,
+          "retarget continues from the value reached");
+
+    // Beyond DMX_FADE_MAX_DURATION_MS: clamped, not wrapped
+    reset();
+    engine.fadeTo(0, 1, 255, 0xFFFFFFFFu);
+    now_ms += 1000;
+    engine.render(now_ms);
+    uint8_t start = output(0, 1);
+    now_ms += DMX_FADE_MAX_DURATION_MS / 2 - 1000;
+    engine.render(now_ms);
+    uint8_t half = output(0, 1);
+    now_ms += DMX_FADE_MAX_DURATION_MS / 2 + 1;
+    engine.render(now_ms);
+    check(start == 0 && half >= 127 && half <= 128 && output(0, 1) == 255 && engine.getActiveFadeCount() == 0,
+          "0xFFFFFFFF ms clamped to DMX_FADE_MAX_DURATION_MS");
+}
+
+int main() {
+    checkLinearFades();
+    checkSnapAndStop();
+    checkRangeFades();
+    checkRetargetAndLimits();
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? 0 : 1;
+}
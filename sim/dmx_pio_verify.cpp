@@ -0,0 +1,502 @@
+/*
+ * DMX PIO Program Verifier (host build)
+ *
+ * Runs the Pico-DMX PIO programs instruction by instruction on the
+ * cycle-accurate PIO emulator and checks the resulting wire timing against
+ * ANSI E1.11 (DMX512-A), independently of the byte-level model the simulated
+ * HAL uses.
+ *
+ * Build:  cmake -S . -B build && cmake --build build   (host build, no pico-sdk)
+ * Usage:  ./build/dmx_pio_verify timing   [--sys-hz N] [--clkdiv D] [--vcd out.vcd]
+ *         ./build/dmx_pio_verify input    [--sys-hz N]
+ *         ./build/dmx_pio_verify loopback [--sys-hz N] [--frames N]
+ *         ./build/dmx_pio_verify bench    [--sys-hz N]
+ *
+ * timing:   DmxOutput sends a full frame; break, MAB and bit times are measured
+ *           from the emitted edges and the frame is decoded by a separate
+ *           UART decoder. Default divider is Pico-DMX's integer sys_hz / 1 MHz;
+ *           --clkdiv tries others, including fractional ones.
+ * input:    sweeps synthetic waveforms (break, MAB, bit time, inter-slot gap)
+ *           into DmxInput and DmxInputInverted to find what they accept,
+ *           against E1.11 receiver requirements.
+ * loopback: DmxOutput wired into DmxInput on one PIO block, random frames.
+ * bench:    emulator speed, and worst-case back-to-back frame throughput.
+ *
+ * Exits 1 if a check fails.
+ */
+
+#include "dmx_pio_emulator.h"
+#include "DmxOutput.pio.h"
+#include "DmxInput.pio.h"
+#include "DmxInputInverted.pio.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define DMX_FRAME_SLOTS 513        // Start code + 512 slots
+#define SWEEP_FRAME_SLOTS 25       // Start code + 24 slots, enough for every bit pattern below
+#define DMX_BIT_NS 4000
+#define TX_PIN 0
+#define RX_PIN 1
+#define DMX_SM_HZ 1000000
+
+// ANSI E1.11 timing limits
+#define TX_BREAK_MIN_NS 92000
+#define TX_MAB_MIN_NS 12000
+#define BIT_MIN_NS 3920
+#define BIT_MAX_NS 4080
+#define RX_BREAK_MIN_NS 88000      // Receivers shall accept a break this short
+#define RX_MAB_MIN_NS 8000         // ... and a MAB this short
+
+static uint32_t sys_hz = 125000000;
+
+struct DecodedFrame {
+    uint64_t break_ns;
+    uint64_t mab_ns;
+    uint64_t bit_min_ns;
+    uint64_t bit_max_ns;
+    uint64_t slot_min_ns;          // Start bit to next start bit
+    uint64_t slot_max_ns;
+    uint64_t end_ns;               // End of the last stop bit
+    uint32_t framing_errors;
+    std::vector<uint8_t> slots;
+};
+
+// Level after edge i of a waveform
+static bool levelAfter(const DMXWaveform& wave, size_t edge) {
+    return wave.getInitialLevel() ^ !(edge & 1);
+}
+
+// UART decoder for a DMX line, working from edge timestamps alone: finds the
+// first break starting at or after from_ns and decodes the frame after it
+static bool decodeFrame(const DMXWaveform& wave, uint64_t from_ns, DecodedFrame* frame) {
+    size_t num_edges = wave.getNumEdges();
+    size_t i = 0;
+    while (i < num_edges && (wave.getEdgeNs(i) < from_ns || levelAfter(wave, i))) {
+        i++;
+    }
+    if (i + 2 >= num_edges) {
+        return false;
+    }
+
+    *frame = DecodedFrame();
+    frame->bit_min_ns = UINT64_MAX;
+    frame->slot_min_ns = UINT64_MAX;
+    frame->break_ns = wave.getEdgeNs(i + 1) - wave.getEdgeNs(i);
+    frame->mab_ns = wave.getEdgeNs(i + 2) - wave.getEdgeNs(i + 1);
+
+    size_t start = i + 2;
+    while (start < num_edges) {
+        uint64_t t0 = wave.getEdgeNs(start);
+        // A low longer than a whole slot is the next break
+        if (start + 1 < num_edges && wave.getEdgeNs(start + 1) - t0 > 11 * DMX_BIT_NS) {
+            break;
+        }
+
+        uint8_t value = 0;
+        for (int bit = 0; bit < 8; bit++) {
+            value |= (uint8_t)(wave.levelAt(t0 + DMX_BIT_NS * 3 / 2 + bit * DMX_BIT_NS) << bit);
+        }
+        if (!wave.levelAt(t0 + DMX_BIT_NS * 19 / 2)) {
+            frame->framing_errors++;
+        }
+        frame->slots.push_back(value);
+
+        // Bit times from every pulse inside the slot
+        size_t next = start;
+        while (next + 1 < num_edges && wave.getEdgeNs(next + 1) < t0 + 9 * DMX_BIT_NS) {
+            uint64_t width = wave.getEdgeNs(next + 1) - wave.getEdgeNs(next);
+            uint64_t bits = (width + DMX_BIT_NS / 2) / DMX_BIT_NS;
+            if (bits > 0) {
+                uint64_t bit_ns = width / bits;
+                frame->bit_min_ns = bit_ns < frame->bit_min_ns ? bit_ns : frame->bit_min_ns;
+                frame->bit_max_ns = bit_ns > frame->bit_max_ns ? bit_ns : frame->bit_max_ns;
+            }
+            next++;
+        }
+        uint64_t stop_ns = next < num_edges ? wave.getEdgeNs(next) : t0;
+        frame->end_ns = stop_ns > t0 + 9 * DMX_BIT_NS ? stop_ns : t0 + 9 * DMX_BIT_NS;
+
+        // Next start bit: the next falling edge after this slot's data
+        while (next < num_edges && (wave.getEdgeNs(next) < t0 + 10 * DMX_BIT_NS || levelAfter(wave, next))) {
+            next++;
+        }
+        if (next >= num_edges) {
+            frame->end_ns = wave.getEndNs();
+            break;
+        }
+        uint64_t slot_ns = wave.getEdgeNs(next) - t0;
+        if (next + 1 >= num_edges || wave.getEdgeNs(next + 1) - wave.getEdgeNs(next) <= 11 * DMX_BIT_NS) {
+            frame->slot_min_ns = slot_ns < frame->slot_min_ns ? slot_ns : frame->slot_min_ns;
+            frame->slot_max_ns = slot_ns > frame->slot_max_ns ? slot_ns : frame->slot_max_ns;
+        }
+        start = next;
+    }
+    return true;
+}
+
+static void writeVcd(const char* path, const DMXWaveform& wave) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return;
+    }
+    fprintf(file, "$timescale 1ns $end\n$scope module pio $end\n$var wire 1 ! dmx_tx $end\n$upscope $end\n$enddefinitions $end\n");
+    fprintf(file, "#0\n%d!\n", wave.getInitialLevel() ? 1 : 0);
+    for (size_t i = 0; i < wave.getNumEdges(); i++) {
+        fprintf(file, "#%llu\n%d!\n", (unsigned long long)wave.getEdgeNs(i), levelAfter(wave, i) ? 1 : 0);
+    }
+    fclose(file);
+}
+
+static void fillFrame(uint8_t* frame, uint16_t length, uint32_t seed) {
+    frame[0] = 0;  // Null start code
+    for (uint16_t i = 1; i < length; i++) {
+        seed = seed * 1103515245 + 12345;
+        frame[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+// DmxOutput::begin(): pin idle high, SM running, stalled on the pull until the first write
+static int beginOutput(DMXPioEmulator& emu, uint pin, float clkdiv) {
+    int offset = emu.addProgram(&DmxOutput_program);
+    int sm = 0;
+    emu.setPins(1u << pin, 1u << pin);
+    emu.setPindirs(1u << pin, 1u << pin);
+    pio_sm_config config = DmxOutput_program_get_default_config(offset);
+    sm_config_set_out_pins(&config, pin, 1);
+    sm_config_set_sideset_pins(&config, pin);
+    sm_config_set_clkdiv(&config, clkdiv);
+    emu.initSm(sm, offset + DmxOutput_wrap_target, config);
+    emu.setEnabled(sm, true);
+    return offset;
+}
+
+// DmxOutput::write()
+static void writeOutput(DMXPioEmulator& emu, uint sm, int offset, const uint8_t* frame, uint16_t length) {
+    emu.setEnabled(sm, false);
+    emu.restart(sm);
+    emu.exec(sm, pio_encode_jmp(offset));
+    emu.clearFdebug(1u << (PIO_FDEBUG_TXSTALL_LSB + sm));
+    emu.setEnabled(sm, true);
+    emu.streamTx(sm, frame, length);
+}
+
+// DmxInput::begin() + read_async()
+static int beginInput(DMXPioEmulator& emu, uint sm, uint pin, bool inverted) {
+    const pio_program_t* program = inverted ? &DmxInputInverted_program : &DmxInput_program;
+    int offset = emu.addProgram(program);
+    emu.setPindirs(0, 1u << pin);
+    pio_sm_config config = inverted ? DmxInputInverted_program_get_default_config(offset)
+                                    : DmxInput_program_get_default_config(offset);
+    sm_config_set_in_pins(&config, pin);
+    sm_config_set_jmp_pin(&config, pin);
+    sm_config_set_in_shift(&config, true, false, 8);
+    sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_RX);
+    sm_config_set_clkdiv(&config, (float)(sys_hz / DMX_SM_HZ));
+    emu.initSm(sm, offset, config);
+    return offset;
+}
+
+static void armInput(DMXPioEmulator& emu, uint sm, int offset, uint8_t* buffer, uint16_t length) {
+    emu.setEnabled(sm, false);
+    emu.restart(sm);
+    emu.streamRx(sm, buffer, length);
+    emu.exec(sm, pio_encode_jmp(offset));
+    emu.clearFifos(sm);
+    emu.setEnabled(sm, true);
+}
+
+static const char* verdict(bool pass) {
+    return pass ? "PASS" : "FAIL";
+}
+
+static int runTiming(double clkdiv, const char* vcd_path) {
+    static uint8_t frame[DMX_FRAME_SLOTS];
+    fillFrame(frame, DMX_FRAME_SLOTS, 1);
+    // Include every bit pattern edge case up front
+    const uint8_t patterns[] = {0x00, 0xFF, 0x55, 0xAA, 0x01, 0x80, 0x7F, 0xFE};
+    memcpy(frame + 1, patterns, sizeof(patterns));
+
+    DMXPioEmulator emu(sys_hz);
+    int offset = beginOutput(emu, TX_PIN, (float)clkdiv);
+    emu.run(1000000);
+    uint64_t write_ns = emu.nowNs();
+    writeOutput(emu, 0, offset, frame, DMX_FRAME_SLOTS);
+    emu.run(write_ns + 30000000);
+
+    DecodedFrame decoded;
+    if (!decodeFrame(emu.getOutput(TX_PIN), write_ns, &decoded)) {
+        printf("No frame on the wire\n");
+        return 1;
+    }
+    if (vcd_path) {
+        writeVcd(vcd_path, emu.getOutput(TX_PIN));
+    }
+
+    bool data_ok = decoded.slots.size() == DMX_FRAME_SLOTS &&
+                   memcmp(decoded.slots.data(), frame, DMX_FRAME_SLOTS) == 0;
+    bool break_ok = decoded.break_ns >= TX_BREAK_MIN_NS;
+    bool mab_ok = decoded.mab_ns >= TX_MAB_MIN_NS;
+    bool bit_ok = decoded.bit_min_ns >= BIT_MIN_NS && decoded.bit_max_ns <= BIT_MAX_NS;
+    uint64_t frame_ns = decoded.end_ns - write_ns;
+
+    printf("DmxOutput at %lu Hz, clkdiv %.4f\n", (unsigned long)sys_hz, clkdiv);
+    printf("  break       %8.3f us  (>= 92 us)         %s\n", decoded.break_ns / 1000.0, verdict(break_ok));
+    printf("  MAB         %8.3f us  (>= 12 us)         %s\n", decoded.mab_ns / 1000.0, verdict(mab_ok));
+    printf("  bit         %.3f-%.3f us  (3.92-4.08 us) %s\n",
+           decoded.bit_min_ns / 1000.0, decoded.bit_max_ns / 1000.0, verdict(bit_ok));
+    printf("  slot        %.3f-%.3f us (11 bits + MBB)\n", decoded.slot_min_ns / 1000.0, decoded.slot_max_ns / 1000.0);
+    printf("  decoded     %zu slots, %lu framing errors, data %s  %s\n", decoded.slots.size(),
+           (unsigned long)decoded.framing_errors, data_ok ? "matches" : "differs",
+           verdict(data_ok && decoded.framing_errors == 0));
+    printf("  frame       %.1f us from write() to last stop bit (%.2f frames/s back to back)\n",
+           frame_ns / 1000.0, 1e9 / frame_ns);
+
+    bool ok = data_ok && decoded.framing_errors == 0 && break_ok && mab_ok && bit_ok;
+    printf("%s\n", verdict(ok));
+    return ok ? 0 : 1;
+}
+
+struct InputShape {
+    uint32_t break_ns;
+    uint32_t mab_ns;
+    uint32_t bit_ns;
+    uint32_t gap_ns;               // Idle between the end of the start bit + 8 data bits and the next start bit
+};
+
+static DMXWaveform makeFrameWave(const InputShape& shape, const uint8_t* frame, uint16_t length, bool inverted) {
+    bool idle = !inverted;
+    DMXWaveform wave(idle);
+    wave.append(idle, 500000);     // Idle before, so the receiver is waiting
+    wave.append(!idle, shape.break_ns);
+    wave.append(idle, shape.mab_ns);
+    for (uint16_t i = 0; i < length; i++) {
+        wave.append(!idle, shape.bit_ns);
+        for (int bit = 0; bit < 8; bit++) {
+            bool level = (frame[i] >> bit) & 1;
+            wave.append(inverted ? !level : level, shape.bit_ns);
+        }
+        wave.append(idle, shape.gap_ns);
+    }
+    wave.append(idle, 100000);
+    return wave;
+}
+
+static bool inputAccepts(bool inverted, const InputShape& shape) {
+    uint8_t frame[SWEEP_FRAME_SLOTS];
+    fillFrame(frame, SWEEP_FRAME_SLOTS, shape.bit_ns ^ shape.break_ns);
+    const uint8_t patterns[] = {0x00, 0xFF, 0x55, 0xAA, 0x01, 0x80, 0x7F, 0xFE};
+    memcpy(frame + 1, patterns, sizeof(patterns));
+
+    DMXWaveform wave = makeFrameWave(shape, frame, SWEEP_FRAME_SLOTS, inverted);
+    DMXPioEmulator emu(sys_hz);
+    emu.setInput(RX_PIN, &wave);
+    int offset = beginInput(emu, 0, RX_PIN, inverted);
+    uint8_t buffer[SWEEP_FRAME_SLOTS] = {};
+    armInput(emu, 0, offset, buffer, SWEEP_FRAME_SLOTS);
+    emu.run(wave.getEndNs());
+    return emu.getRxStreamed(0) == SWEEP_FRAME_SLOTS && memcmp(buffer, frame, SWEEP_FRAME_SLOTS) == 0;
+}
+
+// Smallest value of field in [from, to] (step) accepted, with every larger
+// value up to 'to' also accepted; 0 if none
+static uint32_t sweepMin(bool inverted, InputShape shape, uint32_t InputShape::*field,
+                         uint32_t from, uint32_t to, uint32_t step) {
+    uint32_t result = 0;
+    for (uint32_t value = to; value >= from && value <= to; value -= step) {
+        shape.*field = value;
+        if (!inputAccepts(inverted, shape)) {
+            break;
+        }
+        result = value;
+    }
+    return result;
+}
+
+static int runInput() {
+    const InputShape nominal = {176000, 12000, DMX_BIT_NS, 2 * DMX_BIT_NS};
+    bool ok = true;
+
+    for (int variant = 0; variant < 2; variant++) {
+        bool inverted = variant == 1;
+        const char* name = inverted ? "DmxInputInverted" : "DmxInput";
+        printf("%s at %lu Hz\n", name, (unsigned long)sys_hz);
+
+        bool nominal_ok = inputAccepts(inverted, nominal);
+        printf("  nominal frame                                        %s\n", verdict(nominal_ok));
+
+        uint32_t min_break = sweepMin(inverted, nominal, &InputShape::break_ns, 40000, 200000, 250);
+        bool break_ok = min_break != 0 && min_break <= RX_BREAK_MIN_NS;
+        printf("  break    accepted from %7.2f us   (must accept 88 us)   %s\n", min_break / 1000.0, verdict(break_ok));
+
+        uint32_t min_mab = sweepMin(inverted, nominal, &InputShape::mab_ns, 250, 20000, 250);
+        bool mab_ok = min_mab != 0 && min_mab <= RX_MAB_MIN_NS;
+        printf("  MAB      accepted from %7.2f us   (must accept 8 us)    %s\n", min_mab / 1000.0, verdict(mab_ok));
+
+        uint32_t min_gap = sweepMin(inverted, nominal, &InputShape::gap_ns, 0, 20000, 250);
+        // E1.11 requires two stop bits; anything down to one is margin
+        bool gap_ok = min_gap <= 2 * DMX_BIT_NS;
+        printf("  stop+MBB accepted from %7.2f us   (must accept 8 us)    %s\n", min_gap / 1000.0, verdict(gap_ok));
+
+        InputShape long_gap = nominal;
+        long_gap.gap_ns = 100000;
+        bool long_gap_ok = inputAccepts(inverted, long_gap);
+        printf("  100 us between slots                                 %s\n", verdict(long_gap_ok));
+
+        // Bit time window: both directions from nominal
+        uint32_t bit_lo = 0;
+        uint32_t bit_hi = 0;
+        InputShape shape = nominal;
+        for (uint32_t bit = DMX_BIT_NS; bit >= 3000; bit -= 10) {
+            shape.bit_ns = bit;
+            if (!inputAccepts(inverted, shape)) {
+                break;
+            }
+            bit_lo = bit;
+        }
+        for (uint32_t bit = DMX_BIT_NS; bit <= 5000; bit += 10) {
+            shape.bit_ns = bit;
+            if (!inputAccepts(inverted, shape)) {
+                break;
+            }
+            bit_hi = bit;
+        }
+        bool bit_ok = bit_lo != 0 && bit_lo <= BIT_MIN_NS && bit_hi >= BIT_MAX_NS;
+        printf("  bit      accepted %.2f-%.2f us     (must accept 3.92-4.08) %s\n",
+               bit_lo / 1000.0, bit_hi / 1000.0, verdict(bit_ok));
+
+        ok = ok && nominal_ok && break_ok && mab_ok && gap_ok && long_gap_ok && bit_ok;
+    }
+    printf("%s\n", verdict(ok));
+    return ok ? 0 : 1;
+}
+
+// Output wired into input; returns frames received intact
+static uint32_t loopback(DMXPioEmulator& emu, uint32_t frames, uint64_t* end_ns) {
+    static uint8_t frame[DMX_FRAME_SLOTS];
+    static uint8_t buffer[DMX_FRAME_SLOTS];
+    int out_offset = beginOutput(emu, TX_PIN, (float)(sys_hz / DMX_SM_HZ));
+    emu.connect(TX_PIN, RX_PIN);
+    int in_offset = beginInput(emu, 1, RX_PIN, false);
+    emu.run(emu.nowNs() + 1000000);
+
+    uint32_t intact = 0;
+    for (uint32_t n = 0; n < frames; n++) {
+        fillFrame(frame, DMX_FRAME_SLOTS, n + 1);
+        memset(buffer, 0, sizeof(buffer));
+        armInput(emu, 1, in_offset, buffer, DMX_FRAME_SLOTS);
+        writeOutput(emu, 0, out_offset, frame, DMX_FRAME_SLOTS);
+
+        uint64_t deadline = emu.nowNs() + 50000000;
+        while (emu.getRxStreamed(1) < DMX_FRAME_SLOTS && emu.nowNs() < deadline) {
+            emu.run(emu.nowNs() + 10000);
+        }
+        if (emu.getRxStreamed(1) == DMX_FRAME_SLOTS && memcmp(buffer, frame, DMX_FRAME_SLOTS) == 0) {
+            intact++;
+        }
+        // Let the last stop bits out before the next break
+        while (!(emu.getFdebug() & (1u << PIO_FDEBUG_TXSTALL_LSB)) && emu.nowNs() < deadline) {
+            emu.run(emu.nowNs() + 1000);
+        }
+    }
+    *end_ns = emu.nowNs();
+    return intact;
+}
+
+static int runLoopback(uint32_t frames) {
+    DMXPioEmulator emu(sys_hz);
+    uint64_t end_ns;
+    uint32_t intact = loopback(emu, frames, &end_ns);
+    bool ok = intact == frames;
+    printf("DmxOutput -> DmxInput at %lu Hz: %lu/%lu frames intact in %.1f ms\n",
+           (unsigned long)sys_hz, (unsigned long)intact, (unsigned long)frames, end_ns / 1e6);
+    printf("%s\n", verdict(ok));
+    return ok ? 0 : 1;
+}
+
+static int runBench() {
+    // Emulator speed on the loopback: two SMs busy every cycle
+    DMXPioEmulator emu(sys_hz);
+    std::chrono::steady_clock::time_point wall_start = std::chrono::steady_clock::now();
+    uint64_t end_ns;
+    const uint32_t frames = 40;
+    uint32_t intact = loopback(emu, frames, &end_ns);
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    uint64_t sm_cycles = emu.getStats(0).cycles + emu.getStats(1).cycles;
+    uint64_t instructions = emu.getStats(0).instructions + emu.getStats(1).instructions;
+    printf("Emulator: %.1f ms of 2-SM loopback in %.3f s: %.1f M SM cycles/s, %.1f M instructions/s, %.2fx real time\n",
+           end_ns / 1e6, wall_s, sm_cycles / wall_s / 1e6, instructions / wall_s / 1e6, end_ns / 1e9 / wall_s);
+
+    // Worst-case throughput: back-to-back frames with the FIFO always full
+    bool ok = intact == frames;
+    const uint16_t lengths[] = {DMX_FRAME_SLOTS, 25};
+    for (uint16_t length : lengths) {
+        static uint8_t frame[DMX_FRAME_SLOTS];
+        fillFrame(frame, length, length);
+        DMXPioEmulator tx(sys_hz);
+        int offset = beginOutput(tx, TX_PIN, (float)(sys_hz / DMX_SM_HZ));
+        tx.run(1000000);
+        uint64_t start_ns = tx.nowNs();
+        writeOutput(tx, 0, offset, frame, length);
+        while (!(tx.getFdebug() & (1u << PIO_FDEBUG_TXSTALL_LSB))) {
+            tx.run(tx.nowNs() + 100);
+        }
+        uint64_t frame_ns = tx.nowNs() - start_ns;
+        DecodedFrame decoded;
+        bool decoded_ok = decodeFrame(tx.getOutput(TX_PIN), start_ns, &decoded) && decoded.slots.size() == length;
+        ok = ok && decoded_ok;
+        printf("Back to back, %3u slots: %.1f us per frame, %.2f frames/s, %.0f slots/s  %s\n",
+               length - 1, frame_ns / 1000.0, 1e9 / frame_ns, (length - 1) * 1e9 / frame_ns, verdict(decoded_ok));
+    }
+    printf("%s\n", verdict(ok));
+    return ok ? 0 : 1;
+}
+
+static int usage(const char* name) {
+    fprintf(stderr, "Usage: %s timing|input|loopback|bench [--sys-hz N] [--clkdiv D] [--vcd file] [--frames N]\n", name);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return usage(argv[0]);
+    }
+    const char* mode = argv[1];
+    double clkdiv = 0;
+    const char* vcd_path = nullptr;
+    uint32_t frames = 20;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--sys-hz") == 0 && i + 1 < argc) {
+            sys_hz = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--clkdiv") == 0 && i + 1 < argc) {
+            clkdiv = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--vcd") == 0 && i + 1 < argc) {
+            vcd_path = argv[++i];
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (uint32_t)atol(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (sys_hz < DMX_SM_HZ) {
+        fprintf(stderr, "--sys-hz must be at least %d\n", DMX_SM_HZ);
+        return 2;
+    }
+    if (clkdiv == 0) {
+        clkdiv = sys_hz / DMX_SM_HZ;  // Integer, as DmxOutput::begin() computes it
+    }
+
+    if (strcmp(mode, "timing") == 0) {
+        return runTiming(clkdiv, vcd_path);
+    } else if (strcmp(mode, "input") == 0) {
+        return runInput();
+    } else if (strcmp(mode, "loopback") == 0) {
+        return runLoopback(frames);
+    } else if (strcmp(mode, "bench") == 0) {
+        return runBench();
+    }
+    return usage(argv[0]);
+}
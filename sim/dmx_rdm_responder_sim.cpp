@@ -0,0 +1,423 @@
+/*
+ * RDM Responder Simulation (host build)
+ *
+ * Runs a DMXRdmController and a DMXRdmResponder node against each other on
+ * the simulated HAL. The node is a DMXReceiver taking a frame-numbered test
+ * pattern from the controller's transmitter, with the responder sharing its
+ * pin; the responder's output goes back to the controller's receive pin.
+ *
+ * Build:  cmake -S . -B build && cmake --build build   (host build, no pico-sdk)
+ * Usage:  ./build/dmx_rdm_responder_sim
+ *
+ * Controller TX: GPIO 10, RX: GPIO 11 (pio0). Node RX: GPIO 2, responder TX:
+ * GPIO 3, DE: GPIO 4 (pio1). The responder's output is also wired into the
+ * node's own receive pin, as on a half-duplex line.
+ *
+ * Checks discovery, GET/SET of the supported parameters, NACKs and
+ * broadcasts; that every null start code frame reaches the receiver intact
+ * while RDM runs between frames; that a packet with a bad checksum is
+ * dropped without an answer; and that every response starts between
+ * DMX_RDM_RESPONDER_MIN_DELAY_US and DMX_RDM_RESPONDER_MAX_DELAY_US after the
+ * end of its request, measured on the wire; and that end() gives back
+ * everything begin() claimed. Exits 1 if any check failed.
+ */
+
+#include "pico/stdlib.h"
+#include "dmx_sim.h"
+#include "dmx_transmitter.h"
+#include "dmx_receiver.h"
+#include "dmx_rdm_controller.h"
+#include "dmx_rdm_responder.h"
+#include <cstdio>
+#include <cstring>
+
+#define CONTROLLER_TX_PIN 10
+#define CONTROLLER_RX_PIN 11
+#define NODE_RX_PIN 2
+#define RESPONDER_TX_PIN 3
+#define RESPONDER_ENABLE_PIN 4
+#define CONTROLLER_UID 0x7FF000000001ull
+#define RESPONDER_UID 0x7FF100A0B0C1ull
+#define FOOTPRINT 12
+#define PATTERN_STEP 7
+
+// An RDM packet being read off one pin
+struct PacketReader {
+    uint8_t packet[DMX_RDM_MAX_PACKET];
+    uint16_t length;
+    bool in_packet;
+};
+
+// Wire-level view: request to response turnaround and DMX frames
+struct LineCheck {
+    PacketReader controller;            // CONTROLLER_TX_PIN
+    PacketReader injected;              // NODE_RX_PIN, only what this program injects
+    uint64_t request_end_ns;
+    bool awaiting_response;
+    uint32_t responses;
+    uint32_t timing_violations;
+    uint32_t min_turnaround_us;
+    uint32_t max_turnaround_us;
+    uint32_t dmx_frames;
+};
+
+struct NodeCheck {
+    uint32_t frames;
+    uint32_t corrupt;
+    uint32_t changes;
+    uint16_t last_change_pid;
+};
+
+struct RequestResult {
+    bool done;
+    DMXRdmStatus status;
+    uint8_t response_type;
+    uint8_t pdl;
+    uint8_t pd[DMX_RDM_MAX_PDL];
+};
+
+static LineCheck line;
+static NodeCheck node;
+static uint8_t node_buffer[DMX_UNIVERSE_SIZE];
+
+static void readPacket(PacketReader& reader, const DMXSim::Symbol& symbol) {
+    if (symbol.type == DMXSim::SYMBOL_BREAK) {
+        reader.in_packet = true;
+        reader.length = 0;
+        return;
+    }
+    if (!reader.in_packet) {
+        return;
+    }
+    reader.packet[reader.length++] = symbol.value;
+    if (reader.length == 1 && symbol.value != DMX_RDM_START_CODE) {
+        if (symbol.value == 0x00 && &reader == &line.controller) {
+            line.dmx_frames++;
+        }
+        reader.in_packet = false;
+        return;
+    }
+    uint16_t expected = dmxRdmPacketLength(reader.packet, reader.length);
+    if (expected == 0 || reader.length < expected) {
+        if (reader.length >= DMX_RDM_MAX_PACKET) {
+            reader.in_packet = false;
+        }
+        return;
+    }
+    reader.in_packet = false;
+    line.request_end_ns = symbol.end_ns;
+    line.awaiting_response = true;
+}
+
+// Runs for every symbol on the simulated wires
+static void onSymbol(uint gpio, const DMXSim::Symbol& symbol, void* user_data) {
+    (void)user_data;
+    if (gpio == CONTROLLER_TX_PIN) {
+        readPacket(line.controller, symbol);
+    } else if (gpio == NODE_RX_PIN) {
+        readPacket(line.injected, symbol);
+    } else if (gpio == RESPONDER_TX_PIN && line.awaiting_response) {
+        // First symbol of the response: its start against the request's end
+        line.awaiting_response = false;
+        uint64_t start_ns = symbol.end_ns - symbol.duration_ns;
+        uint32_t turnaround_us =
+            start_ns > line.request_end_ns ? (uint32_t)((start_ns - line.request_end_ns) / 1000) : 0;
+        if (turnaround_us < DMX_RDM_RESPONDER_MIN_DELAY_US || turnaround_us > DMX_RDM_RESPONDER_MAX_DELAY_US) {
+            line.timing_violations++;
+        }
+        if (turnaround_us < line.min_turnaround_us) {
+            line.min_turnaround_us = turnaround_us;
+        }
+        if (turnaround_us > line.max_turnaround_us) {
+            line.max_turnaround_us = turnaround_us;
+        }
+        line.responses++;
+    }
+}
+
+static void fillPattern(uint8_t seed, uint8_t* out) {
+    for (uint16_t i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+        out[i] = (uint8_t)(seed + i * PATTERN_STEP);
+    }
+}
+
+static void onFrame(DMXReceiver* receiver) {
+    (void)receiver;
+    uint8_t expected[DMX_UNIVERSE_SIZE];
+    fillPattern(node_buffer[0], expected);
+    node.frames++;
+    if (memcmp(node_buffer, expected, sizeof(expected)) != 0) {
+        node.corrupt++;
+    }
+}
+
+static void onChange(DMXRdmResponder* responder, uint16_t pid, void* user_data) {
+    (void)responder;
+    (void)user_data;
+    node.changes++;
+    node.last_change_pid = pid;
+}
+
+static void onResponse(DMXRdmController* controller, DMXRdmStatus status, const DMXRdmPacket* response,
+                       void* user_data) {
+    (void)controller;
+    RequestResult* result = (RequestResult*)user_data;
+    result->done = true;
+    result->status = status;
+    if (response != nullptr) {
+        result->response_type = response->port_or_response;
+        result->pdl = response->pdl;
+        memcpy(result->pd, response->pd, response->pdl);
+    }
+}
+
+struct Rig {
+    DMXTransmitter* transmitter;
+    DMXRdmController* controller;
+    DMXRdmResponder* responder;
+    uint32_t frames_seen;
+    uint8_t seed;
+};
+
+// One pass of both main loops; a fresh pattern for every frame sent
+static void step(Rig& rig) {
+    bool busy = rig.controller->poll();
+    busy = rig.responder->poll() || busy;
+    if (line.dmx_frames != rig.frames_seen) {
+        rig.frames_seen = line.dmx_frames;
+        uint8_t universe[DMX_UNIVERSE_SIZE];
+        fillPattern(++rig.seed, universe);
+        rig.transmitter->setUniverse(universe);
+    }
+    if (!busy) {
+        tight_loop_contents();
+    }
+}
+
+static void runUntilIdle(Rig& rig) {
+    uint64_t deadline = time_us_64() + 10 * 1000000ull;
+    while ((!rig.controller->isIdle() || rig.controller->isDiscovering()) && time_us_64() < deadline) {
+        step(rig);
+    }
+}
+
+static void runFor(Rig& rig, uint32_t us) {
+    uint64_t end = time_us_64() + us;
+    while (time_us_64() < end) {
+        step(rig);
+    }
+}
+
+static bool acked(const RequestResult& result) {
+    return result.done && result.status == DMX_RDM_STATUS_OK && result.response_type == DMX_RDM_ACK;
+}
+
+static bool nacked(const RequestResult& result, uint16_t reason) {
+    return result.done && result.status == DMX_RDM_STATUS_OK && result.response_type == DMX_RDM_NACK_REASON &&
+           result.pdl == 2 && ((result.pd[0] << 8) | result.pd[1]) == reason;
+}
+
+static uint32_t claimedResources() {
+    uint32_t count = 0;
+    for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+        count += pio_sm_is_claimed(pio0, s) + pio_sm_is_claimed(pio1, s);
+    }
+    for (uint c = 0; c < NUM_DMA_CHANNELS; c++) {
+        count += dma_channel_is_claimed(c);
+    }
+    return count;
+}
+
+static bool check(const char* name, bool ok) {
+    printf("  %-44s %s\n", name, ok ? "OK" : "FAILED");
+    return ok;
+}
+
+static void injectRequest(uint8_t command_class, uint16_t pid, bool corrupt) {
+    DMXRdmPacket request = {};
+    request.dest = RESPONDER_UID;
+    request.source = CONTROLLER_UID;
+    request.transaction = 0x42;
+    request.port_or_response = 1;
+    request.sub_device = DMX_RDM_ROOT_DEVICE;
+    request.command_class = command_class;
+    request.pid = pid;
+    uint8_t wire[DMX_RDM_MAX_PACKET];
+    uint16_t length = dmxRdmWrite(request, wire);
+    if (corrupt) {
+        wire[length - 1] ^= 0x01;
+    }
+    DMXSim::injectFrame(NODE_RX_PIN, wire, length);
+}
+
+int main() {
+    line.min_turnaround_us = UINT32_MAX;
+    DMXSim::setWireMonitor(onSymbol);
+    DMXSim::connect(CONTROLLER_TX_PIN, NODE_RX_PIN);
+    DMXSim::connect(RESPONDER_TX_PIN, CONTROLLER_RX_PIN);
+    DMXSim::connect(RESPONDER_TX_PIN, NODE_RX_PIN);
+
+    // Never ended, except the responder at the end: the rest stays up for
+    // the life of the program
+    Rig rig = {};
+    rig.transmitter = new DMXTransmitter(CONTROLLER_TX_PIN, pio0);
+    if (rig.transmitter->begin() != DmxOutput::SUCCESS) {
+        fprintf(stderr, "Failed to initialize transmitter\n");
+        return 1;
+    }
+    uint8_t universe[DMX_UNIVERSE_SIZE];
+    fillPattern(rig.seed, universe);
+    rig.transmitter->setUniverse(universe);
+
+    // After the break DmxOutput::begin() sends, or the receiver would take
+    // the first real break for the first slot of a frame
+    sleep_ms(1);
+    DMXReceiver* receiver = new DMXReceiver(NODE_RX_PIN, 1, DMX_UNIVERSE_SIZE, pio1);
+    if (receiver->begin() != DmxInput::SUCCESS || !receiver->startAsync(node_buffer, onFrame)) {
+        fprintf(stderr, "Failed to initialize receiver\n");
+        return 1;
+    }
+    rig.controller = new DMXRdmController();
+    if (!rig.controller->begin(rig.transmitter, CONTROLLER_RX_PIN, DMX_RDM_NO_ENABLE_PIN, CONTROLLER_UID, pio0)) {
+        fprintf(stderr, "Failed to initialize RDM controller\n");
+        return 1;
+    }
+    uint32_t resources_without_responder = claimedResources();
+    rig.responder = new DMXRdmResponder();
+    if (!rig.responder->begin(receiver, RESPONDER_TX_PIN, RESPONDER_ENABLE_PIN, RESPONDER_UID, pio1)) {
+        fprintf(stderr, "Failed to initialize RDM responder\n");
+        return 1;
+    }
+    rig.responder->setDeviceInfo(0x1234, 0x0101, 0x00010002, FOOTPRINT);
+    rig.responder->setSoftwareVersionLabel("1.2 sim");
+    rig.responder->setStartAddress(1);
+    rig.responder->setChangeCallback(onChange);
+    rig.controller->setTransactionsPerFrame(4);
+
+    printf("RDM responder: controller and DMXReceiver node, DMX every 25 ms\n");
+    runFor(rig, 100000);
+    uint32_t frames_before = node.frames;
+    uint32_t wire_frames_before = line.dmx_frames;
+    bool ok = true;
+
+    // Discovery
+    rig.controller->startDiscovery();
+    runUntilIdle(rig);
+    ok &= check("discovery finds the responder",
+                rig.controller->getNumDevices() == 1 && rig.controller->getDevice(0) == RESPONDER_UID &&
+                    rig.responder->isMuted());
+
+    // GETs
+    RequestResult info = {}, version = {}, supported = {};
+    rig.controller->get(RESPONDER_UID, DMX_RDM_PID_DEVICE_INFO, onResponse, &info);
+    rig.controller->get(RESPONDER_UID, DMX_RDM_PID_SOFTWARE_VERSION_LABEL, onResponse, &version);
+    rig.controller->get(RESPONDER_UID, DMX_RDM_PID_SUPPORTED_PARAMETERS, onResponse, &supported);
+    runUntilIdle(rig);
+    ok &= check("GET DEVICE_INFO", acked(info) && info.pdl == DMX_RDM_DEVICE_INFO_SIZE && info.pd[2] == 0x12 &&
+                                     info.pd[3] == 0x34 && info.pd[11] == FOOTPRINT && info.pd[15] == 1);
+    ok &= check("GET SOFTWARE_VERSION_LABEL",
+                acked(version) && version.pdl == 7 && memcmp(version.pd, "1.2 sim", 7) == 0);
+    ok &= check("GET SUPPORTED_PARAMETERS", acked(supported) && supported.pdl == 2);
+
+    // SETs, read back
+    uint8_t address[2] = {0, 100};
+    uint8_t bad_address[2] = {0x01, 0xFE};     // 510: footprint runs past the universe
+    const char* label = "Stage left wash";
+    uint8_t identify_on = 1;
+    RequestResult set_address = {}, get_address = {}, set_bad = {}, set_label = {}, get_label = {};
+    RequestResult set_identify = {};
+    rig.controller->set(RESPONDER_UID, DMX_RDM_PID_DMX_START_ADDRESS, address, 2, onResponse, &set_address);
+    rig.controller->get(RESPONDER_UID, DMX_RDM_PID_DMX_START_ADDRESS, onResponse, &get_address);
+    rig.controller->set(RESPONDER_UID, DMX_RDM_PID_DMX_START_ADDRESS, bad_address, 2, onResponse, &set_bad);
+    rig.controller->set(RESPONDER_UID, DMX_RDM_PID_DEVICE_LABEL, (const uint8_t*)label, (uint8_t)strlen(label),
+                        onResponse, &set_label);
+    rig.controller->get(RESPONDER_UID, DMX_RDM_PID_DEVICE_LABEL, onResponse, &get_label);
+    rig.controller->set(RESPONDER_UID, DMX_RDM_PID_IDENTIFY_DEVICE, &identify_on, 1, onResponse, &set_identify);
+    runUntilIdle(rig);
+    ok &= check("SET/GET DMX_START_ADDRESS", acked(set_address) && acked(get_address) && get_address.pdl == 2 &&
+                                               get_address.pd[1] == 100 && rig.responder->getStartAddress() == 100);
+    ok &= check("SET DMX_START_ADDRESS out of range", nacked(set_bad, DMX_RDM_NR_DATA_OUT_OF_RANGE));
+    ok &= check("SET/GET DEVICE_LABEL", acked(set_label) && acked(get_label) && get_label.pdl == strlen(label) &&
+                                          strcmp(rig.responder->getDeviceLabel(), label) == 0);
+    ok &= check("SET IDENTIFY_DEVICE", acked(set_identify) && rig.responder->isIdentifying() &&
+                                         node.changes == 3 && node.last_change_pid == DMX_RDM_PID_IDENTIFY_DEVICE);
+
+    // NACKs, then a broadcast that must change the setting without an answer
+    RequestResult unknown = {}, sub_device = {}, broadcast = {};
+    uint8_t identify_off = 0;
+    uint32_t responses_before = rig.responder->getStats().responses;
+    rig.controller->get(RESPONDER_UID, DMX_RDM_PID_DMX_PERSONALITY, onResponse, &unknown);
+    rig.controller->sendRequest(RESPONDER_UID, DMX_RDM_GET_COMMAND, DMX_RDM_PID_DEVICE_INFO, nullptr, 0, onResponse,
+                                &sub_device, 5);
+    rig.controller->set(DMX_RDM_BROADCAST_UID, DMX_RDM_PID_IDENTIFY_DEVICE, &identify_off, 1, onResponse,
+                        &broadcast);
+    runUntilIdle(rig);
+    ok &= check("unknown PID NACKed", nacked(unknown, DMX_RDM_NR_UNKNOWN_PID));
+    ok &= check("sub-device NACKed", nacked(sub_device, DMX_RDM_NR_SUB_DEVICE_OUT_OF_RANGE));
+    ok &= check("broadcast SET applied without a response",
+                broadcast.done && broadcast.status == DMX_RDM_STATUS_BROADCAST && !rig.responder->isIdentifying() &&
+                    rig.responder->getStats().responses == responses_before + 2);
+
+    // DMX reception while all of the above ran between frames
+    runFor(rig, 60000);
+    uint32_t frames = node.frames - frames_before;
+    uint32_t wire_frames = line.dmx_frames - wire_frames_before;
+    ok &= check("DMX frames received intact during RDM",
+                node.corrupt == 0 && frames + 1 >= wire_frames && frames <= wire_frames);
+
+    // Straight onto the node's pin, with the controller off the line
+    DMXSim::disconnect(CONTROLLER_TX_PIN, NODE_RX_PIN);
+    DMXSim::disconnect(RESPONDER_TX_PIN, CONTROLLER_RX_PIN);
+    runFor(rig, 30000);
+    DMXRdmResponder::Stats before = rig.responder->getStats();
+    injectRequest(DMX_RDM_GET_COMMAND, DMX_RDM_PID_IDENTIFY_DEVICE, true);
+    runFor(rig, 5000);
+    DMXRdmResponder::Stats after = rig.responder->getStats();
+    ok &= check("bad checksum dropped without a response",
+                after.checksum_errors == before.checksum_errors + 1 && after.responses == before.responses);
+    injectRequest(DMX_RDM_GET_COMMAND, DMX_RDM_PID_IDENTIFY_DEVICE, false);
+    runFor(rig, 5000);
+    after = rig.responder->getStats();
+    ok &= check("injected GET answered", after.responses == before.responses + 1);
+    uint8_t frame[DMX_UNIVERSE_SIZE + 1];
+    frame[0] = 0x00;
+    fillPattern(0x80, &frame[1]);
+    frames_before = node.frames;
+    DMXSim::injectFrame(NODE_RX_PIN, frame, sizeof(frame));
+    runFor(rig, 30000);
+    ok &= check("DMX frame received after injected RDM",
+                node.frames == frames_before + 1 && node_buffer[0] == 0x80 && node.corrupt == 0);
+
+    DMXRdmResponder::Stats stats = rig.responder->getStats();
+    printf("  receiver: %lu DMX frames, %lu corrupt, %lu RDM packets\n", (unsigned long)node.frames,
+           (unsigned long)node.corrupt, (unsigned long)receiver->getAlternateFrameCount());
+    printf("  responder: %lu requests, %lu responses (%lu discovery), %lu checksum errors, %lu late\n",
+           (unsigned long)stats.requests, (unsigned long)stats.responses, (unsigned long)stats.discovery_responses,
+           (unsigned long)stats.checksum_errors, (unsigned long)stats.late);
+    printf("  turnaround on the wire: %lu responses, %lu-%lu us (limits %d-%d), %lu violations\n",
+           (unsigned long)line.responses, (unsigned long)line.min_turnaround_us,
+           (unsigned long)line.max_turnaround_us, DMX_RDM_RESPONDER_MIN_DELAY_US, DMX_RDM_RESPONDER_MAX_DELAY_US,
+           (unsigned long)line.timing_violations);
+    ok &= line.responses > 0 && line.timing_violations == 0 && stats.late == 0 && line.responses == stats.responses;
+
+    // end() gives back both state machines, both DMA channels and both
+    // programs, so begin() succeeds again and the node answers as before; a
+    // second end() is harmless
+    bool released = true;
+    for (uint8_t i = 0; i < 4 && released; i++) {
+        rig.responder->end();
+        rig.responder->end();
+        released = claimedResources() == resources_without_responder &&
+                   rig.responder->begin(receiver, RESPONDER_TX_PIN, RESPONDER_ENABLE_PIN, RESPONDER_UID, pio1);
+    }
+    before = rig.responder->getStats();
+    injectRequest(DMX_RDM_GET_COMMAND, DMX_RDM_PID_IDENTIFY_DEVICE, false);
+    runFor(rig, 5000);
+    ok &= check("end() releases everything, begin() again answers",
+                released && rig.responder->getStats().responses == before.responses + 1);
+    delete rig.responder;
+    ok &= check("destructor releases everything", claimedResources() == resources_without_responder);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,498 @@
+/*
+ * RDM Discovery Simulation (host build)
+ *
+ * Runs DMXRdmController on the simulated HAL against a line of simulated
+ * E1.20 responders. The responders decode the controller's packets off the
+ * wire and answer on its receive pin after a turnaround delay of their own:
+ * DISC_UNIQUE_BRANCH responses from every unmuted responder in range are
+ * wire-ANDed together (each with its own preamble length, so collisions
+ * garble as on a real line), GET/SET answers are break-led packets.
+ *
+ * Build:  cmake -S . -B build && cmake --build build   (host build, no pico-sdk)
+ * Usage:  ./build/dmx_rdm_sim [--devices N] [--per-frame N] [--period-us N]
+ *                             [--clustered] [--seed N]
+ *
+ * --clustered gives the responders consecutive serial numbers under one
+ * manufacturer (a rig of identical fixtures), the deepest case for the binary
+ * search; otherwise device IDs are random. --period-us 0 runs RDM without DMX.
+ *
+ * Controller TX: GPIO 10 (pio0), RX: GPIO 11 (pio1), DE: GPIO 12. Reports the
+ * discovery time, the DMX refresh rate during discovery and any packet
+ * spacing below the E1.20 minimums, then checks GET DEVICE_INFO, SET
+ * DMX_START_ADDRESS, an incremental discovery after one responder leaves
+ * the line and another joins, and that end() gives back everything begin()
+ * claimed. Exits 1 if a device was missed or any check failed.
+ */
+
+#include "pico/stdlib.h"
+#include "dmx_sim.h"
+#include "dmx_transmitter.h"
+#include "dmx_rdm_controller.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define TX_PIN 10
+#define RX_PIN 11
+#define ENABLE_PIN 12
+#define CONTROLLER_UID 0x7FF000000001ull
+#define RESPONDER_MANUFACTURER 0x7FF1ull   // Prototype manufacturer IDs
+#define MAX_SIM_DEVICES DMX_RDM_MAX_DEVICES
+#define FOOTPRINT 12
+
+struct Responder {
+    uint64_t uid;
+    bool present;
+    bool muted;
+    uint16_t start_address;
+    uint32_t delay_us;          // Request end to response start
+    uint8_t preamble;           // Discovery response preamble bytes
+};
+
+// Line timing as seen on the controller's TX pin
+struct LineCheck {
+    uint8_t packet[DMX_RDM_MAX_PACKET];
+    uint16_t length;
+    bool in_packet;
+    uint64_t packet_end_ns;
+    uint64_t response_end_ns;     // Last symbol on the RX pin
+    uint64_t required_gap_ns;     // Before the next controller packet, if unanswered
+    bool answered;
+    uint32_t spacing_violations;
+    uint32_t min_gap_us;
+    uint32_t dmx_frames;
+};
+
+static std::vector<Responder> responders;
+static LineCheck line;
+static uint32_t lcg_state = 1;
+
+static uint32_t nextRandom() {
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return lcg_state;
+}
+
+static void respond(Responder& responder, const DMXRdmPacket& request, uint8_t response_type,
+                    const uint8_t* pd, uint8_t pdl) {
+    DMXRdmPacket response;
+    response.dest = request.source;
+    response.source = responder.uid;
+    response.transaction = request.transaction;
+    response.port_or_response = response_type;
+    response.message_count = 0;
+    response.sub_device = request.sub_device;
+    response.command_class = request.command_class + 1;
+    response.pid = request.pid;
+    response.pdl = pdl;
+    memcpy(response.pd, pd, pdl);
+
+    uint8_t wire[DMX_RDM_MAX_PACKET];
+    uint16_t length = dmxRdmWrite(response, wire);
+    DMXSim::injectIdle(RX_PIN, responder.delay_us);
+    DMXSim::injectFrame(RX_PIN, wire, length);
+}
+
+static void nack(Responder& responder, const DMXRdmPacket& request, uint16_t reason) {
+    uint8_t pd[2] = {(uint8_t)(reason >> 8), (uint8_t)reason};
+    respond(responder, request, DMX_RDM_NACK_REASON, pd, sizeof(pd));
+}
+
+static void handleDiscoveryBranch(const DMXRdmPacket& request) {
+    if (request.pdl != 12) {
+        return;
+    }
+    uint64_t lower = dmxRdmReadUid(&request.pd[0]);
+    uint64_t upper = dmxRdmReadUid(&request.pd[6]);
+
+    // Every responder in range answers at once; the line ANDs their bytes
+    uint8_t combined[DMX_RDM_DISC_MAX_RESPONSE];
+    uint16_t combined_length = 0;
+    uint32_t delay_us = DMX_RDM_RESPONDER_MAX_DELAY_US;
+    for (Responder& responder : responders) {
+        if (!responder.present || responder.muted || responder.uid < lower || responder.uid > upper) {
+            continue;
+        }
+        uint8_t response[DMX_RDM_DISC_MAX_RESPONSE];
+        uint16_t length = dmxRdmWriteDiscoveryResponse(responder.uid, responder.preamble, response);
+        for (uint16_t i = 0; i < length; i++) {
+            combined[i] = i < combined_length ? combined[i] & response[i] : response[i];
+        }
+        if (length > combined_length) {
+            combined_length = length;
+        }
+        if (responder.delay_us < delay_us) {
+            delay_us = responder.delay_us;
+        }
+    }
+    if (combined_length > 0) {
+        DMXSim::injectIdle(RX_PIN, delay_us);
+        DMXSim::injectSlots(RX_PIN, combined, combined_length);
+    }
+}
+
+static void handleRequest(const DMXRdmPacket& request) {
+    bool broadcast = (request.dest & 0xFFFFFFFFull) == 0xFFFFFFFFull;
+    if (request.command_class == DMX_RDM_DISCOVERY_COMMAND && request.pid == DMX_RDM_PID_DISC_UNIQUE_BRANCH) {
+        handleDiscoveryBranch(request);
+        return;
+    }
+
+    for (Responder& responder : responders) {
+        if (!responder.present || (!broadcast && request.dest != responder.uid)) {
+            continue;
+        }
+
+        if (request.command_class == DMX_RDM_DISCOVERY_COMMAND) {
+            if (request.pid == DMX_RDM_PID_DISC_MUTE || request.pid == DMX_RDM_PID_DISC_UN_MUTE) {
+                responder.muted = request.pid == DMX_RDM_PID_DISC_MUTE;
+                if (!broadcast) {
+                    uint8_t control[2] = {0, 0};
+                    respond(responder, request, DMX_RDM_ACK, control, sizeof(control));
+                }
+            }
+            continue;
+        }
+        if (broadcast) {
+            continue;
+        }
+
+        if (request.command_class == DMX_RDM_GET_COMMAND && request.pid == DMX_RDM_PID_DEVICE_INFO) {
+            uint8_t info[DMX_RDM_DEVICE_INFO_SIZE] = {
+                0x01, 0x00,                                     // RDM protocol 1.0
+                0x12, 0x34,                                     // Model
+                0x01, 0x01,                                     // Product category: fixture
+                0x00, 0x00, 0x00, 0x01,                         // Software version
+                0x00, FOOTPRINT,
+                0x01, 0x01,                                     // Personality 1 of 1
+                (uint8_t)(responder.start_address >> 8), (uint8_t)responder.start_address,
+                0x00, 0x00,                                     // Sub-devices
+                0x00                                            // Sensors
+            };
+            respond(responder, request, DMX_RDM_ACK, info, sizeof(info));
+        } else if (request.command_class == DMX_RDM_SET_COMMAND && request.pid == DMX_RDM_PID_DMX_START_ADDRESS) {
+            uint16_t address = request.pdl == 2 ? (uint16_t)((request.pd[0] << 8) | request.pd[1]) : 0;
+            if (request.pdl != 2) {
+                nack(responder, request, DMX_RDM_NR_FORMAT_ERROR);
+            } else if (address < 1 || address + FOOTPRINT - 1 > DMX_UNIVERSE_SIZE) {
+                nack(responder, request, DMX_RDM_NR_DATA_OUT_OF_RANGE);
+            } else {
+                responder.start_address = address;
+                respond(responder, request, DMX_RDM_ACK, nullptr, 0);
+            }
+        } else {
+            nack(responder, request, DMX_RDM_NR_UNKNOWN_PID);
+        }
+    }
+}
+
+// Runs for every symbol on the simulated wires
+static void onSymbol(uint gpio, const DMXSim::Symbol& symbol, void* user_data) {
+    (void)user_data;
+    if (gpio == RX_PIN) {
+        line.response_end_ns = symbol.end_ns;
+        line.answered = true;
+        return;
+    }
+    if (gpio != TX_PIN) {
+        return;
+    }
+
+    if (symbol.type == DMXSim::SYMBOL_BREAK) {
+        // A new controller packet: check its distance to whatever came last
+        uint64_t start_ns = symbol.end_ns - symbol.duration_ns;
+        if (line.packet_end_ns > 0) {
+            uint64_t last_ns = line.response_end_ns > line.packet_end_ns ? line.response_end_ns : line.packet_end_ns;
+            uint64_t required_ns = DMX_RDM_MIN_SPACING_US * 1000ull;
+            if (!line.answered && line.required_gap_ns > required_ns) {
+                required_ns = line.required_gap_ns;
+            }
+            uint64_t gap_ns = start_ns > last_ns ? start_ns - last_ns : 0;
+            if (gap_ns < required_ns) {
+                line.spacing_violations++;
+            }
+            if (gap_ns / 1000 < line.min_gap_us) {
+                line.min_gap_us = (uint32_t)(gap_ns / 1000);
+            }
+        }
+        line.in_packet = true;
+        line.length = 0;
+        line.answered = false;
+        line.required_gap_ns = 0;
+        return;
+    }
+    if (!line.in_packet) {
+        return;
+    }
+
+    line.packet_end_ns = symbol.end_ns;
+    if (line.length == 0 && symbol.value == 0x00) {
+        line.dmx_frames++;
+        line.in_packet = false;
+        return;
+    }
+    line.packet[line.length++] = symbol.value;
+    uint16_t expected = dmxRdmPacketLength(line.packet, line.length);
+    if (expected == 0 || line.length < expected) {
+        if (line.length >= DMX_RDM_MAX_PACKET) {
+            line.in_packet = false;
+        }
+        return;
+    }
+    line.in_packet = false;
+
+    DMXRdmPacket request;
+    if (!dmxRdmRead(line.packet, line.length, &request)) {
+        return;
+    }
+    bool broadcast = (request.dest & 0xFFFFFFFFull) == 0xFFFFFFFFull;
+    if (request.pid == DMX_RDM_PID_DISC_UNIQUE_BRANCH) {
+        line.required_gap_ns = DMX_RDM_DISCOVERY_SPACING_US * 1000ull;
+    } else if (!broadcast) {
+        line.required_gap_ns = DMX_RDM_LOST_RESPONSE_SPACING_US * 1000ull;
+    }
+    handleRequest(request);
+}
+
+static uint64_t makeUid(bool clustered, uint16_t index) {
+    if (clustered) {
+        return (RESPONDER_MANUFACTURER << 32) | (0x00100000u + index);
+    }
+    uint64_t manufacturer = RESPONDER_MANUFACTURER + (nextRandom() >> 29);
+    return (manufacturer << 32) | nextRandom();
+}
+
+static Responder* findResponder(uint64_t uid) {
+    for (Responder& responder : responders) {
+        if (responder.uid == uid) {
+            return &responder;
+        }
+    }
+    return nullptr;
+}
+
+// Every present responder listed, and nothing else
+static uint32_t claimedResources() {
+    uint32_t count = 0;
+    for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+        count += pio_sm_is_claimed(pio0, s) + pio_sm_is_claimed(pio1, s);
+    }
+    for (uint c = 0; c < NUM_DMA_CHANNELS; c++) {
+        count += dma_channel_is_claimed(c);
+    }
+    return count;
+}
+
+static bool checkDevices(const DMXRdmController& controller, uint16_t* missing, uint16_t* extra) {
+    *missing = 0;
+    *extra = 0;
+    for (const Responder& responder : responders) {
+        bool found = false;
+        for (uint16_t i = 0; i < controller.getNumDevices() && !found; i++) {
+            found = controller.getDevice(i) == responder.uid;
+        }
+        if (responder.present && !found) {
+            (*missing)++;
+        } else if (!responder.present && found) {
+            (*extra)++;
+        }
+    }
+    for (uint16_t i = 0; i < controller.getNumDevices(); i++) {
+        if (findResponder(controller.getDevice(i)) == nullptr) {
+            (*extra)++;
+        }
+    }
+    return *missing == 0 && *extra == 0;
+}
+
+static bool runDiscovery(DMXRdmController& controller, bool incremental) {
+    controller.startDiscovery(incremental);
+    uint64_t deadline = time_us_64() + 300 * 1000000ull;
+    while (controller.isDiscovering() && time_us_64() < deadline) {
+        if (!controller.poll()) {
+            tight_loop_contents();
+        }
+    }
+    return !controller.isDiscovering();
+}
+
+struct RequestResult {
+    bool done;
+    DMXRdmStatus status;
+    uint8_t response_type;
+    uint16_t start_address;
+};
+
+static void onResponse(DMXRdmController* controller, DMXRdmStatus status, const DMXRdmPacket* response,
+                       void* user_data) {
+    (void)controller;
+    RequestResult* result = (RequestResult*)user_data;
+    result->done = true;
+    result->status = status;
+    if (response != nullptr) {
+        result->response_type = response->port_or_response;
+        if (response->pid == DMX_RDM_PID_DEVICE_INFO && response->pdl == DMX_RDM_DEVICE_INFO_SIZE) {
+            result->start_address = (uint16_t)((response->pd[14] << 8) | response->pd[15]);
+        }
+    }
+}
+
+static void runUntilIdle(DMXRdmController& controller) {
+    while (!controller.isIdle()) {
+        if (!controller.poll()) {
+            tight_loop_contents();
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    uint16_t num_devices = 120;
+    uint8_t per_frame = 4;
+    uint32_t period_us = 25000;
+    bool clustered = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--devices") == 0 && i + 1 < argc) {
+            num_devices = (uint16_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--per-frame") == 0 && i + 1 < argc) {
+            per_frame = (uint8_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--period-us") == 0 && i + 1 < argc) {
+            period_us = (uint32_t)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--clustered") == 0) {
+            clustered = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            lcg_state = (uint32_t)atol(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--devices 1-%d] [--per-frame N] [--period-us N] [--clustered] [--seed N]\n",
+                    argv[0], MAX_SIM_DEVICES - 1);
+            return 2;
+        }
+    }
+    if (num_devices == 0 || num_devices >= MAX_SIM_DEVICES || per_frame == 0) {
+        fprintf(stderr, "devices must be 1-%d and per-frame at least 1\n", MAX_SIM_DEVICES - 1);
+        return 2;
+    }
+
+    // One spare responder joins the line for the incremental discovery
+    for (uint16_t i = 0; i <= num_devices; i++) {
+        Responder responder;
+        do {
+            responder.uid = makeUid(clustered, i);
+        } while (findResponder(responder.uid) != nullptr);
+        responder.present = i < num_devices;
+        responder.muted = false;
+        responder.start_address = 1 + (i * FOOTPRINT) % (DMX_UNIVERSE_SIZE - FOOTPRINT);
+        responder.delay_us = DMX_RDM_RESPONDER_MIN_DELAY_US + nextRandom() % 400;
+        responder.preamble = (uint8_t)(nextRandom() % (DMX_RDM_DISC_MAX_PREAMBLE + 1));
+        responders.push_back(responder);
+    }
+    line.min_gap_us = UINT32_MAX;
+    DMXSim::setWireMonitor(onSymbol);
+
+    // Never ended: the transmitter stays up for the life of the program
+    DMXTransmitter* transmitter = new DMXTransmitter(TX_PIN, pio0);
+    if (transmitter->begin() != DmxOutput::SUCCESS) {
+        fprintf(stderr, "Failed to initialize transmitter\n");
+        return 1;
+    }
+    sleep_ms(1);
+    uint32_t idle_resources = claimedResources();
+    DMXRdmController* controller = new DMXRdmController();
+    if (!controller->begin(transmitter, RX_PIN, ENABLE_PIN, CONTROLLER_UID, pio1, period_us)) {
+        fprintf(stderr, "Failed to initialize RDM controller\n");
+        return 1;
+    }
+    controller->setTransactionsPerFrame(per_frame);
+
+    printf("RDM discovery: %d %s responders, %d transactions per frame, DMX every %lu us\n",
+           num_devices, clustered ? "clustered" : "random", per_frame, (unsigned long)period_us);
+
+    // Full discovery
+    std::chrono::steady_clock::time_point wall_start = std::chrono::steady_clock::now();
+    uint32_t frames_before = line.dmx_frames;
+    bool finished = runDiscovery(*controller, false);
+    DMXRdmController::Stats stats = controller->getStats();
+    double discovery_s = stats.last_discovery_us / 1e6;
+    uint16_t missing, extra;
+    bool ok = checkDevices(*controller, &missing, &extra) && finished;
+
+    printf("  discovery: %s, %d/%d found, %d missing, %d extra, %.3f s\n", finished ? "done" : "TIMED OUT",
+           controller->getNumDevices(), num_devices, missing, extra, discovery_s);
+    printf("  transactions: %lu (%lu branches, %lu collisions, %lu timeouts, %lu invalid), %.1f ms per device\n",
+           (unsigned long)stats.transactions, (unsigned long)stats.discovery_branches,
+           (unsigned long)stats.collisions, (unsigned long)stats.timeouts, (unsigned long)stats.invalid,
+           discovery_s * 1000 / num_devices);
+    if (period_us > 0 && discovery_s > 0) {
+        printf("  DMX refresh during discovery: %.1f Hz (%.1f Hz without RDM)\n",
+               (line.dmx_frames - frames_before) / discovery_s, 1e6 / period_us);
+    }
+
+    // GET DEVICE_INFO and SET DMX_START_ADDRESS on a few devices
+    uint16_t checks = controller->getNumDevices() < 8 ? controller->getNumDevices() : 8;
+    uint16_t failed_requests = 0;
+    for (uint16_t i = 0; i < checks; i++) {
+        uint64_t uid = controller->getDevice(i);
+        Responder* responder = findResponder(uid);
+        uint16_t address = (uint16_t)(100 + i * FOOTPRINT);
+        uint8_t pd[2] = {(uint8_t)(address >> 8), (uint8_t)address};
+        RequestResult before = {}, set = {}, after = {}, bad = {};
+        uint8_t bad_pd[2] = {0x02, 0x00};   // 512: footprint runs past the universe
+
+        controller->get(uid, DMX_RDM_PID_DEVICE_INFO, onResponse, &before);
+        controller->set(uid, DMX_RDM_PID_DMX_START_ADDRESS, pd, sizeof(pd), onResponse, &set);
+        controller->get(uid, DMX_RDM_PID_DEVICE_INFO, onResponse, &after);
+        controller->set(uid, DMX_RDM_PID_DMX_START_ADDRESS, bad_pd, sizeof(bad_pd), onResponse, &bad);
+        runUntilIdle(*controller);
+
+        bool good = responder != nullptr && before.status == DMX_RDM_STATUS_OK &&
+                    before.start_address == 1 + (uint16_t)((responder - &responders[0]) * FOOTPRINT) %
+                                                    (DMX_UNIVERSE_SIZE - FOOTPRINT) &&
+                    set.status == DMX_RDM_STATUS_OK && set.response_type == DMX_RDM_ACK &&
+                    after.status == DMX_RDM_STATUS_OK && after.start_address == address &&
+                    bad.status == DMX_RDM_STATUS_OK && bad.response_type == DMX_RDM_NACK_REASON &&
+                    responder->start_address == address;
+        if (!good) {
+            failed_requests++;
+        }
+    }
+    printf("  GET/SET: %d/%d devices checked OK\n", checks - failed_requests, checks);
+    ok = ok && failed_requests == 0;
+
+    // One responder leaves, another joins; incremental discovery fixes up the list
+    responders[0].present = false;
+    responders[num_devices].present = true;
+    for (Responder& responder : responders) {
+        responder.muted = false;
+    }
+    controller->resetStats();
+    finished = runDiscovery(*controller, true);
+    stats = controller->getStats();
+    bool incremental_ok = checkDevices(*controller, &missing, &extra) && finished;
+    printf("  incremental discovery: %s, %d devices, %d missing, %d extra, %.3f s, %lu transactions\n",
+           incremental_ok ? "OK" : "FAILED", controller->getNumDevices(), missing, extra,
+           stats.last_discovery_us / 1e6, (unsigned long)stats.transactions);
+    ok = ok && incremental_ok;
+
+    double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    printf("  line: %lu spacing violations, min gap %lu us; simulated %.2f s in %.2f s\n",
+           (unsigned long)line.spacing_violations, (unsigned long)line.min_gap_us,
+           DMXSim::nowNs() / 1e9, wall_s);
+    ok = ok && line.spacing_violations == 0;
+
+    // end() gives back the state machine, DMA channel and PIO program, so
+    // begin() succeeds again as often as it is asked; a second end() is harmless
+    bool released = true;
+    for (uint8_t i = 0; i < 8 && released; i++) {
+        controller->end();
+        controller->end();
+        released = claimedResources() == idle_resources &&
+                   controller->begin(transmitter, RX_PIN, ENABLE_PIN, CONTROLLER_UID, pio1, period_us);
+    }
+    delete controller;
+    released = released && claimedResources() == idle_resources;
+    printf("  end(): %s\n", released ? "state machine, DMA channel and program released" : "LEAKED");
+    ok = ok && released;
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,316 @@
+/*
+ * Live Reconfiguration Simulation (host build)
+ *
+ * Runs DMXTransmitter outputs under DMXFramePipeline into a DMXMultiReceiver
+ * and reconfigures single universes between frames while the rest keep
+ * running: adding a transmit and a receive universe, moving a receive
+ * universe to another pin, moving a transmit output to another pin, removing
+ * them again, and cycling add/remove to show that every state machine, DMA
+ * channel and PIO program is given back.
+ *
+ * Build:  cmake -S . -B build && cmake --build build   (host build, no pico-sdk)
+ * Usage:  ./build/dmx_reconfig_sim [--cycles N]
+ *
+ * Outputs: GPIO 10-12 (pio1), plus 13 when added and 14 for the moved one.
+ * Inputs: GPIO 1-3 (pio0), plus 4 when added and 5 for the moved one. Every
+ * frame carries its frame number, so a receiver that misses one sees a gap.
+ * Reports how long each operation takes and how long until the reconfigured
+ * universe delivers its first frame, and checks that the universes not being
+ * reconfigured miss no frame and that the untouched output pins keep the
+ * frame period. The simulated CPU only spends the nominal costs of time reads
+ * and register polls, so latencies show the work done, not hardware figures.
+ * Exits 1 if any check failed.
+ */
+
+#include "pico/stdlib.h"
+#include "dmx_sim.h"
+#include "dmx_transmitter.h"
+#include "dmx_multi_receiver.h"
+#include "dmx_frame_pipeline.h"
+#include "dmx_load.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define NUM_OUTPUTS 4           // Output 3 starts stopped and is added later
+#define NUM_UNIVERSES 3
+#define OUTPUT_START_PIN 10
+#define INPUT_START_PIN 1
+#define ADDED_OUTPUT_PIN 13
+#define ADDED_INPUT_PIN 4
+#define MOVED_OUTPUT_PIN 14     // Output 2 moves here, still wired to input 3
+#define MOVED_INPUT_PIN 5       // Universe 0 moves here, also wired to output 0
+#define FRAME_PERIOD_US 25000
+
+struct UniverseCheck {
+    uint32_t frames;
+    uint32_t missed;            // Gaps in the frame numbers
+    int32_t last_frame;
+    uint64_t first_frame_ns;    // First frame after the last operation on this universe
+};
+
+static UniverseCheck checks[MAX_DMX_RECEIVERS];
+static uint64_t last_break_ns[2];   // Untouched output pins 10 and 11
+static uint64_t max_gap_ns[2];
+static uint32_t failures = 0;
+
+static void check(bool ok, const char* what) {
+    printf("  %-60s %s\n", what, ok ? "PASS" : "FAIL");
+    if (!ok) {
+        failures++;
+    }
+}
+
+// Frame number in slots 1-2 of every output
+static void renderFrame(DMXTransmitter outputs[], uint8_t num_outputs, uint32_t frame_number, void*) {
+    for (uint8_t u = 0; u < num_outputs; u++) {
+        uint8_t* buffer = outputs[u].getUniverseBuffer();
+        buffer[0] = (uint8_t)frame_number;
+        buffer[1] = (uint8_t)(frame_number >> 8);
+        buffer[2] = u;
+    }
+}
+
+// Runs in the simulated DMA IRQ
+static void onUniverseReceived(DMXMultiReceiver* multi_rx, uint8_t universe_index) {
+    const uint8_t* buffer = multi_rx->getUniverseBuffer(universe_index);
+    UniverseCheck& check = checks[universe_index];
+    int32_t frame = buffer[0] | (buffer[1] << 8);
+    if (check.frames == 0) {
+        check.first_frame_ns = DMXSim::nowNs();
+    } else if (frame != check.last_frame + 1) {
+        check.missed++;
+    }
+    check.last_frame = frame;
+    check.frames++;
+}
+
+static void onSymbol(uint gpio, const DMXSim::Symbol& symbol, void*) {
+    if (symbol.type != DMXSim::SYMBOL_BREAK || gpio < OUTPUT_START_PIN || gpio > OUTPUT_START_PIN + 1) {
+        return;
+    }
+    uint8_t pin = gpio - OUTPUT_START_PIN;
+    if (last_break_ns[pin] != 0 && symbol.end_ns - last_break_ns[pin] > max_gap_ns[pin]) {
+        max_gap_ns[pin] = symbol.end_ns - last_break_ns[pin];
+    }
+    last_break_ns[pin] = symbol.end_ns;
+}
+
+// Send frames and let the last one arrive
+static void runFrames(DMXFramePipeline& pipeline, uint32_t frames) {
+    uint32_t target = pipeline.getStats().frames_sent + frames;
+    while (pipeline.getStats().frames_sent < target) {
+        if (!pipeline.poll()) {
+            DMXLoad::idleUntil(pipeline.getNextFrameUs());
+        }
+    }
+    while (!DMXLoad::idleUntil(pipeline.getNextFrameUs() - 1000)) {
+    }
+}
+
+// Reconfigure between frames: once the frame on the wire has finished
+static void waitForIdle(DMXTransmitter outputs[]) {
+    for (uint8_t i = 0; i < NUM_OUTPUTS; i++) {
+        outputs[i].waitForCompletion();
+    }
+}
+
+// A universe being reconfigured starts counting afresh; the others must not miss a frame
+static void resetChecks(int8_t affected) {
+    for (uint8_t u = 0; u < MAX_DMX_RECEIVERS; u++) {
+        if (u == affected) {
+            memset(&checks[u], 0, sizeof(checks[u]));
+        } else {
+            checks[u].missed = 0;
+        }
+    }
+}
+
+static bool othersContinuous(DMXMultiReceiver* multi_rx, int8_t affected) {
+    for (uint8_t u = 0; u < MAX_DMX_RECEIVERS; u++) {
+        if (u != affected && multi_rx->isUniverseActive(u) && checks[u].missed != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// From the end of an operation to the universe's first frame
+static uint64_t firstFrameUs(uint8_t universe, uint64_t op_end_ns) {
+    return (checks[universe].first_frame_ns - op_end_ns) / 1000;
+}
+
+static uint32_t claimedResources() {
+    uint32_t count = 0;
+    for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+        count += pio_sm_is_claimed(pio0, s) + pio_sm_is_claimed(pio1, s);
+    }
+    for (uint c = 0; c < NUM_DMA_CHANNELS; c++) {
+        count += dma_channel_is_claimed(c);
+    }
+    return count;
+}
+
+int main(int argc, char** argv) {
+    uint32_t cycles = 50;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cycles") == 0 && i + 1 < argc) {
+            cycles = (uint32_t)atol(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--cycles N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        DMXSim::connect(OUTPUT_START_PIN + u, INPUT_START_PIN + u);
+    }
+    DMXSim::connect(ADDED_OUTPUT_PIN, ADDED_INPUT_PIN);
+    DMXSim::connect(OUTPUT_START_PIN + 0, MOVED_INPUT_PIN);
+    DMXSim::connect(MOVED_OUTPUT_PIN, INPUT_START_PIN + 2);
+    DMXSim::setWireMonitor(onSymbol);
+
+    static DMXTransmitter outputs[NUM_OUTPUTS] = {
+        DMXTransmitter(OUTPUT_START_PIN + 0, pio1),
+        DMXTransmitter(OUTPUT_START_PIN + 1, pio1),
+        DMXTransmitter(OUTPUT_START_PIN + 2, pio1),
+        DMXTransmitter(ADDED_OUTPUT_PIN, pio1)
+    };
+    uint32_t idle_resources = claimedResources();
+    for (uint8_t u = 0; u < NUM_UNIVERSES; u++) {
+        if (outputs[u].begin() != DmxOutput::SUCCESS) {
+            fprintf(stderr, "Failed to initialize output %d\n", u + 1);
+            return 1;
+        }
+    }
+
+    DMXMultiReceiver* multi_rx = new DMXMultiReceiver();
+    if (!multi_rx->begin(INPUT_START_PIN, NUM_UNIVERSES, onUniverseReceived)) {
+        fprintf(stderr, "Failed to initialize multi-universe receiver\n");
+        return 1;
+    }
+
+    // The stopped output is skipped until it is begun
+    DMXFramePipeline pipeline;
+    pipeline.begin(outputs, NUM_OUTPUTS, FRAME_PERIOD_US, renderFrame);
+
+    printf("Live reconfiguration: %d outputs and %d universes running, frame period %d us\n\n",
+           NUM_UNIVERSES, NUM_UNIVERSES, FRAME_PERIOD_US);
+    runFrames(pipeline, 10);
+    uint32_t running_resources = claimedResources();
+
+    // First frame on a reconfigured universe: after the next break, so
+    // within two frame periods of the operation
+    const uint64_t first_frame_limit_us = 2 * FRAME_PERIOD_US;
+
+    printf("Add output 4 (GPIO %d) and universe 4 (GPIO %d)\n", ADDED_OUTPUT_PIN, ADDED_INPUT_PIN);
+    waitForIdle(outputs);
+    resetChecks(3);
+    uint64_t start_ns = DMXSim::nowNs();
+    bool added = outputs[3].begin() == DmxOutput::SUCCESS;
+    uint64_t tx_ns = DMXSim::nowNs() - start_ns;
+    start_ns = DMXSim::nowNs();
+    added = multi_rx->addUniverse(3, ADDED_INPUT_PIN) && added;
+    uint64_t op_end_ns = DMXSim::nowNs();
+    runFrames(pipeline, 10);
+    printf("  output begin %llu ns, addUniverse %llu ns, first frame after %llu us\n", (unsigned long long)tx_ns,
+           (unsigned long long)(op_end_ns - start_ns), (unsigned long long)firstFrameUs(3, op_end_ns));
+    check(added && multi_rx->getNumUniverses() == 4, "output and universe added");
+    check(checks[3].frames == 10 && checks[3].missed == 0 && firstFrameUs(3, op_end_ns) < first_frame_limit_us,
+          "added universe receives every frame from the next break");
+    check(othersContinuous(multi_rx, 3), "other universes missed no frame");
+
+    printf("\nMove universe 1 from GPIO %d to GPIO %d\n", INPUT_START_PIN, MOVED_INPUT_PIN);
+    waitForIdle(outputs);
+    uint32_t frames_before = multi_rx->getUniverseStats(0).frames_received;
+    resetChecks(0);
+    start_ns = DMXSim::nowNs();
+    bool moved = multi_rx->remapUniverse(0, MOVED_INPUT_PIN);
+    op_end_ns = DMXSim::nowNs();
+    runFrames(pipeline, 10);
+    printf("  remapUniverse %llu ns, first frame after %llu us\n", (unsigned long long)(op_end_ns - start_ns),
+           (unsigned long long)firstFrameUs(0, op_end_ns));
+    check(moved && multi_rx->getGpioPin(0) == MOVED_INPUT_PIN, "universe moved");
+    check(checks[0].frames == 10 && checks[0].missed == 0 && firstFrameUs(0, op_end_ns) < first_frame_limit_us,
+          "moved universe receives every frame from the next break");
+    check(multi_rx->getUniverseStats(0).frames_received == frames_before + checks[0].frames,
+          "moved universe keeps its statistics");
+    check(othersContinuous(multi_rx, 0), "other universes missed no frame");
+
+    printf("\nMove output 3 from GPIO %d to GPIO %d\n", OUTPUT_START_PIN + 2, MOVED_OUTPUT_PIN);
+    waitForIdle(outputs);
+    resetChecks(2);
+    start_ns = DMXSim::nowNs();
+    moved = outputs[2].remap(MOVED_OUTPUT_PIN) == DmxOutput::SUCCESS;
+    op_end_ns = DMXSim::nowNs();
+    runFrames(pipeline, 10);
+    printf("  remap %llu ns, first frame after %llu us\n", (unsigned long long)(op_end_ns - start_ns),
+           (unsigned long long)firstFrameUs(2, op_end_ns));
+    check(moved && outputs[2].getGpioPin() == MOVED_OUTPUT_PIN, "output moved");
+    check(checks[2].frames == 10 && checks[2].missed == 0 && firstFrameUs(2, op_end_ns) < first_frame_limit_us,
+          "its universe receives every frame from the new pin");
+    check(othersContinuous(multi_rx, 2), "other universes missed no frame");
+
+    printf("\nRemove output 4 and universe 4\n");
+    waitForIdle(outputs);
+    resetChecks(-1);
+    start_ns = DMXSim::nowNs();
+    outputs[3].end();
+    tx_ns = DMXSim::nowNs() - start_ns;
+    start_ns = DMXSim::nowNs();
+    bool removed = multi_rx->removeUniverse(3);
+    op_end_ns = DMXSim::nowNs();
+    uint32_t removed_frames = checks[3].frames;
+    runFrames(pipeline, 10);
+    printf("  output end %llu ns, removeUniverse %llu ns\n", (unsigned long long)tx_ns,
+           (unsigned long long)(op_end_ns - start_ns));
+    check(removed && !multi_rx->isUniverseActive(3) && multi_rx->getNumUniverses() == 3,
+          "output and universe removed");
+    check(checks[3].frames == removed_frames, "removed universe delivers nothing more");
+    check(claimedResources() == running_resources, "state machines and DMA channels released");
+    check(othersContinuous(multi_rx, -1), "other universes missed no frame");
+
+    printf("\nAdd and remove output 4 and universe 4, %lu times\n", (unsigned long)cycles);
+    resetChecks(-1);
+    bool cycled = true;
+    uint32_t cycle_frames = 0;
+    for (uint32_t i = 0; i < cycles && cycled; i++) {
+        waitForIdle(outputs);
+        checks[3].frames = 0;
+        cycled = outputs[3].begin() == DmxOutput::SUCCESS && multi_rx->addUniverse(3, ADDED_INPUT_PIN);
+        runFrames(pipeline, 3);
+        cycle_frames += checks[3].frames;
+        waitForIdle(outputs);
+        outputs[3].end();
+        cycled = multi_rx->removeUniverse(3) && cycled && claimedResources() == running_resources;
+    }
+    check(cycled, "every cycle gives back what it claimed");
+    check(cycle_frames == 3 * cycles, "added universe receives frames in every cycle");
+    check(othersContinuous(multi_rx, 3), "other universes missed no frame");
+
+    printf("\nCadence on the untouched outputs\n");
+    DMXFramePipeline::Stats stats = pipeline.getStats();
+    printf("  %lu frames, largest gap between breaks: GPIO %d %llu us, GPIO %d %llu us\n",
+           (unsigned long)stats.frames_sent, OUTPUT_START_PIN, (unsigned long long)(max_gap_ns[0] / 1000),
+           OUTPUT_START_PIN + 1, (unsigned long long)(max_gap_ns[1] / 1000));
+    check(stats.late_starts == 0, "no frame started late");
+    check(max_gap_ns[0] / 1000 <= FRAME_PERIOD_US + FRAME_PERIOD_US / 10 &&
+          max_gap_ns[1] / 1000 <= FRAME_PERIOD_US + FRAME_PERIOD_US / 10,
+          "no gap longer than a frame period on GPIO 10 and 11");
+
+    printf("\nTear down\n");
+    waitForIdle(outputs);
+    multi_rx->end();
+    delete multi_rx;
+    for (uint8_t i = 0; i < NUM_OUTPUTS; i++) {
+        outputs[i].end();
+    }
+    static const uint16_t full_memory[PIO_INSTRUCTION_COUNT] = {};
+    static const pio_program_t full_program = {full_memory, PIO_INSTRUCTION_COUNT, -1};
+    check(claimedResources() == idle_resources, "every state machine and DMA channel released");
+    check(pio_can_add_program(pio0, &full_program) && pio_can_add_program(pio1, &full_program),
+          "PIO program memory empty once the last user ends");
+
+    printf("\n%s\n", failures == 0 ? "All checks passed" : "Some checks FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+#ifndef DMX_PIO_EMULATOR_H
+#define DMX_PIO_EMULATOR_H
+
+#include "hardware/pio.h"
+#include <vector>
+
+// Levels of one pin over time: an initial level, then a toggle at each edge
+class DMXWaveform {
+public:
+    explicit DMXWaveform(bool initial_level = true);
+
+    void clear(bool initial_level);
+
+    // Drive the pin to level from time_ns on; times must not go backwards
+    void set(uint64_t time_ns, bool level);
+
+    // Hold level for duration_ns after the end of the waveform
+    void append(bool level, uint64_t duration_ns);
+
+    bool levelAt(uint64_t time_ns) const;
+    bool getInitialLevel() const;
+    bool getFinalLevel() const;
+    uint64_t getEndNs() const;          // Last edge, or the end of appended content
+    size_t getNumEdges() const;
+    uint64_t getEdgeNs(size_t index) const;
+
+private:
+    bool _initial_level;
+    std::vector<uint64_t> _edges_ns;
+    uint64_t _end_ns;
+};
+
+// Cycle-accurate emulator of one PIO block: 32 instructions of program
+// memory and 4 state machines, clocked from the system clock through each
+// SM's fractional divider.
+//
+// Implements the RP2040 instruction set as used by PIO programs: jmp (all
+// conditions), wait (gpio/pin/irq), in, out, push, pull, mov (incl. invert,
+// bit-reverse, STATUS, EXEC), irq, set, side-set (optional, pindirs),
+// delays, wrap, autopush/autopull and FIFO joins. Inputs pass through the
+// 2-cycle GPIO synchroniser. Not modelled: OUT sticky / inline OUT enable,
+// and DMA bus latency (streams move data in the cycle a FIFO has room).
+//
+// Pins see synthetic input waveforms, constant levels or the emulator's own
+// outputs (connect()), and every level the PIO drives is recorded as a
+// timestamped waveform. streamTx()/streamRx() stand in for DMA channels.
+class DMXPioEmulator {
+public:
+    struct SmStats {
+        uint64_t cycles;           // SM clock ticks while enabled
+        uint64_t instructions;     // Instructions completed
+        uint64_t stall_cycles;
+        uint64_t delay_cycles;
+    };
+
+    explicit DMXPioEmulator(uint32_t sys_hz = 125000000);
+
+    // Load a program as pio_add_program() would (relocated, highest free offset
+    // unless the program has an origin); returns the offset or -1
+    int addProgram(const pio_program_t* program);
+    void clearPrograms();
+    uint16_t getInstruction(uint offset) const;
+
+    // As pio_sm_init(): apply config, clear FIFOs, restart and jump to
+    // initial_pc; the SM is left disabled
+    void initSm(uint sm, uint initial_pc, const pio_sm_config& config);
+    void setConfig(uint sm, const pio_sm_config& config);
+    void setEnabled(uint sm, bool enabled);
+    void restart(uint sm);
+    // Execute an instruction immediately, as pio_sm_exec()
+    void exec(uint sm, uint16_t instr);
+
+    // FIFOs, as seen from the CPU
+    bool put(uint sm, uint32_t value);
+    bool get(uint sm, uint32_t* value);
+    uint getTxLevel(uint sm) const;
+    uint getRxLevel(uint sm) const;
+    void clearFifos(uint sm);
+
+    // DMA stand-ins: keep the TX FIFO topped up from data (8-bit transfers),
+    // and drain the RX FIFO's low bytes into buffer
+    void streamTx(uint sm, const uint8_t* data, size_t length);
+    void streamRx(uint sm, uint8_t* buffer, size_t capacity);
+    size_t getTxStreamed(uint sm) const;
+    size_t getRxStreamed(uint sm) const;
+
+    // Pins
+    void setInput(uint gpio, const DMXWaveform* waveform);  // nullptr: constant level
+    void setInputLevel(uint gpio, bool level);
+    void connect(uint out_gpio, uint in_gpio);                // in_gpio reads out_gpio's PIO output
+    void setPins(uint32_t values, uint32_t mask);
+    void setPindirs(uint32_t dirs, uint32_t mask);
+    bool getOutputLevel(uint gpio) const;
+    const DMXWaveform& getOutput(uint gpio) const;          // Every level driven since construction
+
+    // Run every enabled SM up to time_ns (system clock resolution)
+    void run(uint64_t time_ns);
+    uint64_t nowNs() const;
+    uint64_t getSysCycles() const;
+    uint32_t getSysHz() const;
+
+    // Inspection
+    uint getPc(uint sm) const;
+    uint32_t getX(uint sm) const;
+    uint32_t getY(uint sm) const;
+    bool isStalled(uint sm) const;
+    uint32_t getFdebug() const;
+    void clearFdebug(uint32_t mask);
+    uint8_t getIrqFlags() const;
+    SmStats getStats(uint sm) const;
+
+private:
+    struct Fifo {
+        uint32_t entries[8];
+        uint8_t head;
+        uint8_t count;
+    };
+
+    struct StateMachine {
+        pio_sm_config config;
+        bool enabled;
+        uint8_t pc;
+        uint32_t x;
+        uint32_t y;
+        uint32_t isr;
+        uint32_t osr;
+        uint8_t isr_count;         // Bits shifted in
+        uint8_t osr_count;         // Bits shifted out (32 = empty)
+        uint8_t delay;
+        bool stalled;
+        bool irq_waiting;          // irq set + wait, flag already raised
+        bool exec_pending;         // OUT/MOV EXEC: run exec_instr next cycle
+        uint16_t exec_instr;
+        uint64_t tick_base;        // Divider phase: tick k fires at tick_base + k * div / 256
+        uint64_t tick_index;
+        uint64_t next_tick;
+        Fifo tx;
+        Fifo rx;
+        const uint8_t* tx_stream;
+        size_t tx_stream_length;
+        size_t tx_streamed;
+        uint8_t* rx_stream;
+        size_t rx_stream_capacity;
+        size_t rx_streamed;
+        SmStats stats;
+    };
+
+    uint32_t _sys_hz;
+    uint64_t _now;                 // System clock cycles
+    uint16_t _instructions[PIO_INSTRUCTION_COUNT];
+    uint32_t _used_mask;
+    StateMachine _sm[NUM_PIO_STATE_MACHINES];
+    uint32_t _fdebug;
+    uint8_t _irq_flags;
+
+    uint32_t _pin_values;
+    uint32_t _pin_dirs;
+    DMXWaveform _outputs[32];
+    const DMXWaveform* _inputs[32];
+    bool _input_levels[32];
+    int8_t _input_source[32];      // connect(): output pin feeding this input, or -1
+
+    uint64_t cyclesToNs(uint64_t cycles) const;
+    uint64_t div256(const StateMachine& sm) const;
+    void rebaseClock(StateMachine& sm);
+    uint8_t txDepth(const StateMachine& sm) const;
+    uint8_t rxDepth(const StateMachine& sm) const;
+    static bool fifoPush(Fifo& fifo, uint8_t depth, uint32_t value);
+    static uint32_t fifoPop(Fifo& fifo);
+    void serviceStreams(StateMachine& sm);
+
+    bool readPin(uint gpio);
+    uint32_t readInPins(const StateMachine& sm);
+    void writePins(uint base, uint count, uint32_t values);
+    void writePindirs(uint base, uint count, uint32_t dirs);
+    void recordOutputs(uint32_t old_values);
+
+    void step(uint index);
+    bool execute(uint index, uint16_t instr, bool* jumped);
+};
+
+#endif // DMX_PIO_EMULATOR_H
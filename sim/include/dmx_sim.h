@@ -0,0 +1,81 @@
+#ifndef DMX_SIM_H
+#define DMX_SIM_H
+
+#include "pico/types.h"
+
+// Simulated RP2040 HAL for host builds (DMX_HOST_BUILD in CMakeLists.txt).
+//
+// The headers next to this one stand in for the Pico SDK, so the core library
+// and Pico-DMX compile unchanged on Linux. Behind them:
+// - Virtual time in nanoseconds. Time reads, tight_loop_contents() and sleeps
+//   advance it; simulated peripherals run up to the new time on every advance.
+// - PIO: program memory, SM claims, configuration and FIFOs as on the chip.
+//   The Pico-DMX programs are recognised when loaded and run as byte-level
+//   models with the programs' cycle timing at the configured clock divider
+//   (break 177 cycles, MAB 8, 44 cycles per slot for DmxOutput; a break of at
+//   least 91 cycles arms DmxInput). Entering either program at its byte loop
+//   skips the break: DmxInput receives every start bit as a byte and
+//   DmxOutput sends slots straight away, as RDM turnaround needs.
+// - DMA: channels paced by PIO DREQs, with live transfer counts and
+//   completion interrupts on DMA_IRQ_0 / DMA_IRQ_1.
+// - IRQs: handlers run on the host thread between simulated events, unless
+//   interrupts are masked; a handler is never interrupted.
+// - Wires: connect() routes a transmitting pin into a receiving pin, so
+//   DMXTransmitter output can be looped back into DMXReceiver input.
+class DMXSim {
+public:
+    enum SymbolType : uint8_t {
+        SYMBOL_BREAK = 0,
+        SYMBOL_SLOT = 1
+    };
+
+    // One unit of DMX on a wire, reported when it ends
+    struct Symbol {
+        SymbolType type;
+        uint8_t value;          // Slot value; for a break, the byte a receiver in mid-frame reads (normally 0)
+        uint32_t duration_ns;
+        uint64_t end_ns;
+    };
+
+    typedef void (*WireMonitor)(uint gpio, const Symbol& symbol, void* user_data);
+
+    struct Stats {
+        uint32_t breaks_sent;
+        uint64_t slots_sent;
+        uint64_t slots_received;     // Pushed into a receiving SM's RX FIFO
+        uint32_t rx_overflows;       // Slots lost to a full RX FIFO
+        uint32_t dma_completions;
+        uint32_t irqs_dispatched;
+        uint32_t max_irq_latency_ns; // Raised to handler entry
+    };
+
+    // Virtual time since boot
+    static uint64_t nowNs();
+
+    // Run the simulation forward without any CPU activity
+    static void advanceUs(uint64_t us);
+
+    // Route tx_gpio into rx_gpio (inverted models an inverting transceiver)
+    static bool connect(uint tx_gpio, uint rx_gpio, bool inverted = false);
+    static void disconnect(uint tx_gpio, uint rx_gpio);
+
+    // Observe every symbol driven onto a pin
+    static void setWireMonitor(WireMonitor monitor, void* user_data = nullptr);
+
+    // Drive a frame (start code + slots) into gpio as an external transmitter
+    // would, after any frame still queued on that pin
+    static bool injectFrame(uint gpio, const uint8_t* frame, uint16_t length,
+                            uint32_t break_us = 176, uint32_t mab_us = 12, uint32_t slot_us = 44);
+
+    // Drive slots without a break (e.g. an RDM discovery response)
+    static bool injectSlots(uint gpio, const uint8_t* slots, uint16_t length, uint32_t slot_us = 44);
+
+    // Hold the line idle before whatever is injected next on gpio (from now,
+    // or from the end of anything still queued)
+    static void injectIdle(uint gpio, uint32_t idle_us);
+
+    static Stats getStats();
+    static void resetStats();
+};
+
+#endif // DMX_SIM_H
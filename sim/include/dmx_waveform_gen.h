@@ -0,0 +1,85 @@
+#ifndef DMX_WAVEFORM_GEN_H
+#define DMX_WAVEFORM_GEN_H
+
+#include "dmx_pio_emulator.h"
+#include <vector>
+
+// A line sampled at a fixed rate, one bit per sample packed LSB first, as a
+// logic analyser or an oversampling UART sees it
+class DMXSampleStream {
+public:
+    DMXSampleStream();
+
+    void clear(uint32_t sample_hz);
+    void push(bool level);
+
+    bool get(uint64_t index) const;
+    uint64_t size() const;
+    uint32_t getSampleHz() const;
+    const std::vector<uint8_t>& getBytes() const;
+
+private:
+    uint32_t _sample_hz;
+    uint64_t _count;
+    std::vector<uint8_t> _bytes;
+};
+
+// Synthetic DMX512 waveforms for driving receivers in emulation. Builds the
+// line onto a DMXWaveform segment by segment with configurable timing and
+// per-segment jitter; levels are as the receiver's pin sees them (idle high,
+// or low when inverted). Times are in nanoseconds.
+class DMXWaveformGen {
+public:
+    struct Timing {
+        uint32_t break_ns;
+        uint32_t mab_ns;
+        uint32_t bit_ns;
+        uint8_t stop_bits;
+        uint32_t slot_gap_ns;      // Idle after each slot's stop bits (inter-slot time)
+        uint32_t frame_gap_ns;     // Idle after the last slot, before the next break
+        uint32_t jitter_ns;        // Each segment is stretched or shrunk by up to this much
+    };
+
+    // E1.11 transmitter nominals: 176 us break, 12 us MAB, 4 us bits, two
+    // stop bits, no inter-slot time, 100 us before the next break
+    static Timing nominal();
+
+    explicit DMXWaveformGen(DMXWaveform* wave, uint32_t seed = 1, bool inverted = false);
+
+    // Hold the line at mark (idle) or space for duration_ns, plus jitter
+    void mark(uint32_t duration_ns, uint32_t jitter_ns = 0);
+    void space(uint32_t duration_ns, uint32_t jitter_ns = 0);
+
+    void breakAndMab(const Timing& timing);
+    // One start bit, 8 data bits LSB first, stop bits; a framing error sends
+    // the first stop bit as space
+    void slot(uint8_t value, const Timing& timing, bool framing_error = false);
+    // Break, MAB, then length slots; framing_error_slot < 0 for none
+    void frame(const uint8_t* data, uint16_t length, const Timing& timing, int framing_error_slot = -1);
+
+    uint64_t nowNs() const;        // End of the waveform so far
+
+    // Copy of wave with the level inverted for width_ns from at_ns: a spike
+    // on a steady line, or a gap in a pulse
+    static DMXWaveform withGlitch(const DMXWaveform& wave, uint64_t at_ns, uint32_t width_ns);
+    // count glitches of 1 to max_width_ns at random times in [from_ns, to_ns)
+    static DMXWaveform withNoise(const DMXWaveform& wave, uint64_t from_ns, uint64_t to_ns, uint32_t count,
+                                 uint32_t max_width_ns, uint32_t seed);
+
+    // Sample wave at sample_hz from 0 to its end; flip_ppm flips that many
+    // samples per million at random, as noise in the capture would
+    static void sample(const DMXWaveform& wave, uint32_t sample_hz, DMXSampleStream* samples,
+                       uint32_t flip_ppm = 0, uint32_t seed = 1);
+
+    static bool writeVcd(const DMXWaveform& wave, const char* path);
+
+private:
+    DMXWaveform* _wave;
+    uint32_t _rng;
+    bool _inverted;
+
+    uint32_t random();
+    uint32_t jitter(uint32_t duration_ns, uint32_t jitter_ns);
+};
+
+#endif // DMX_WAVEFORM_GEN_H
@@ -0,0 +1,22 @@
+#ifndef DMX_SIM_HARDWARE_ADDRESS_MAPPED_H
+#define DMX_SIM_HARDWARE_ADDRESS_MAPPED_H
+
+// Host stand-in for the Pico SDK's hardware/address_mapped.h
+
+#include "pico/platform.h"
+
+// Write-1-to-clear status register: reads return the flags the simulator
+// set, writing 1s clears them, as on the chip
+struct dmx_sim_w1c_reg {
+    uint32_t value;
+
+    operator uint32_t() const {
+        return value;
+    }
+    dmx_sim_w1c_reg& operator=(uint32_t clear_mask) {
+        value &= ~clear_mask;
+        return *this;
+    }
+};
+
+#endif // DMX_SIM_HARDWARE_ADDRESS_MAPPED_H
@@ -0,0 +1,173 @@
+#ifndef DMX_SIM_HARDWARE_DMA_H
+#define DMX_SIM_HARDWARE_DMA_H
+
+// Host stand-in for the Pico SDK's hardware/dma.h (simulated HAL, see dmx_sim.h).
+// Channels move data between memory and simulated PIO FIFOs, paced by DREQ,
+// and raise DMA_IRQ_0 / DMA_IRQ_1 on completion. The sniffer computes CRC-32
+// (either bit order) over what one channel moves; its other modes are not
+// modelled.
+
+#include "pico/platform.h"
+#include "hardware/address_mapped.h"
+
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+#define DREQ_PIO0_TX0 0
+#define DREQ_PIO0_RX0 4
+#define DREQ_PIO1_TX0 8
+#define DREQ_PIO1_RX0 12
+#define DREQ_FORCE 0x3f
+
+typedef struct {
+    enum dma_channel_transfer_size data_size;
+    bool read_increment;
+    bool write_increment;
+    uint dreq;
+    uint chain_to;
+    bool irq_quiet;
+    bool enable;
+    bool sniff_enable;
+} dma_channel_config;
+
+// Live channel state, updated as the simulated transfer progresses
+typedef struct {
+    volatile uintptr_t read_addr;
+    volatile uintptr_t write_addr;
+    volatile uint32_t transfer_count;  // Remaining transfers
+} dma_channel_hw_t;
+
+#define DMA_SNIFF_CTRL_CALC_VALUE_CRC32 0x0
+#define DMA_SNIFF_CTRL_CALC_VALUE_CRC32R 0x1
+
+// Sniffer accumulator: writes set it, reads see it through the output
+// reverse / invert options, as on the chip
+struct dmx_sim_sniff_reg {
+    uint32_t value;
+    bool out_rev;
+    bool out_inv;
+
+    operator uint32_t() const {
+        uint32_t v = value;
+        if (out_rev) {
+            uint32_t r = 0;
+            for (int i = 0; i < 32; i++) {
+                r = (r << 1) | ((v >> i) & 1u);
+            }
+            v = r;
+        }
+        return out_inv ? ~v : v;
+    }
+    dmx_sim_sniff_reg& operator=(uint32_t data) {
+        value = data;
+        return *this;
+    }
+};
+
+typedef struct {
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+    uint32_t inte0;
+    uint32_t inte1;
+    dmx_sim_w1c_reg ints0;   // Pending channels, write 1 to clear
+    dmx_sim_w1c_reg ints1;
+    uint32_t sniff_ctrl;     // EN bit 0, DMACH bits 1-4, CALC bits 5-8
+    dmx_sim_sniff_reg sniff_data;
+} dma_hw_t;
+
+extern dma_hw_t dmx_sim_dma_hw;
+
+#define dma_hw (&dmx_sim_dma_hw)
+
+static inline dma_channel_hw_t* dma_channel_hw_addr(uint channel) {
+    return &dma_hw->ch[channel];
+}
+
+// Channel claims
+void dma_channel_claim(uint channel);
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+bool dma_channel_is_claimed(uint channel);
+
+// Configuration
+dma_channel_config dma_channel_get_default_config(uint channel);
+dma_channel_config dma_get_channel_config(uint channel);
+
+static inline void channel_config_set_read_increment(dma_channel_config* c, bool incr) {
+    c->read_increment = incr;
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config* c, bool incr) {
+    c->write_increment = incr;
+}
+
+static inline void channel_config_set_dreq(dma_channel_config* c, uint dreq) {
+    c->dreq = dreq;
+}
+
+static inline void channel_config_set_chain_to(dma_channel_config* c, uint chain_to) {
+    c->chain_to = chain_to;
+}
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size) {
+    c->data_size = size;
+}
+
+static inline void channel_config_set_irq_quiet(dma_channel_config* c, bool irq_quiet) {
+    c->irq_quiet = irq_quiet;
+}
+
+static inline void channel_config_set_enable(dma_channel_config* c, bool enable) {
+    c->enable = enable;
+}
+
+static inline void channel_config_set_sniff_enable(dma_channel_config* c, bool sniff_enable) {
+    c->sniff_enable = sniff_enable;
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config* config, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void* write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger);
+
+// Transfers
+void dma_channel_start(uint channel);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void* read_addr, uint32_t transfer_count);
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void* write_addr, uint32_t transfer_count);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+void dma_channel_abort(uint channel);
+
+// Interrupts
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+
+// Sniffer
+void dma_sniffer_enable(uint channel, uint mode, bool force_channel_enable);
+void dma_sniffer_disable();
+
+static inline void dma_sniffer_set_output_invert_enabled(bool invert) {
+    dma_hw->sniff_data.out_inv = invert;
+}
+
+static inline void dma_sniffer_set_output_reverse_enabled(bool reverse) {
+    dma_hw->sniff_data.out_rev = reverse;
+}
+
+static inline void dma_sniffer_set_data_accumulator(uint32_t seed_value) {
+    dma_hw->sniff_data = seed_value;
+}
+
+static inline uint32_t dma_sniffer_get_data_accumulator() {
+    return dma_hw->sniff_data;
+}
+
+#endif // DMX_SIM_HARDWARE_DMA_H
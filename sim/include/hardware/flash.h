@@ -0,0 +1,16 @@
+#ifndef DMX_SIM_HARDWARE_FLASH_H
+#define DMX_SIM_HARDWARE_FLASH_H
+
+// Host stand-in for the Pico SDK's hardware/flash.h, backed by the simulated
+// flash image that XIP_BASE points at
+
+#include "pico/platform.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#define FLASH_BLOCK_SIZE (1u << 16)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count);
+
+#endif // DMX_SIM_HARDWARE_FLASH_H
@@ -0,0 +1,31 @@
+#ifndef DMX_SIM_HARDWARE_GPIO_H
+#define DMX_SIM_HARDWARE_GPIO_H
+
+// Host stand-in for the Pico SDK's hardware/gpio.h. Pins driven by a PIO
+// state machine are modelled on the simulated wire (dmx_sim.h); these calls
+// only track software-controlled levels.
+
+#include "pico/platform.h"
+
+#define NUM_BANK0_GPIOS 30
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+enum gpio_function {
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_NULL = 0x1f
+};
+
+void gpio_init(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+
+#endif // DMX_SIM_HARDWARE_GPIO_H
@@ -0,0 +1,33 @@
+#ifndef DMX_SIM_HARDWARE_IRQ_H
+#define DMX_SIM_HARDWARE_IRQ_H
+
+// Host stand-in for the Pico SDK's hardware/irq.h. Handlers run on the host
+// thread whenever the simulation advances past the event that raised them.
+
+#include "pico/platform.h"
+
+typedef void (*irq_handler_t)();
+
+enum irq_num_rp2040 {
+    TIMER_IRQ_0 = 0,
+    TIMER_IRQ_1 = 1,
+    TIMER_IRQ_2 = 2,
+    TIMER_IRQ_3 = 3,
+    PIO0_IRQ_0 = 7,
+    PIO0_IRQ_1 = 8,
+    PIO1_IRQ_0 = 9,
+    PIO1_IRQ_1 = 10,
+    DMA_IRQ_0 = 11,
+    DMA_IRQ_1 = 12,
+    NUM_IRQS = 32
+};
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+irq_handler_t irq_get_exclusive_handler(uint num);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+bool irq_is_enabled(uint num);
+void irq_set_priority(uint num, uint8_t hardware_priority);
+void irq_set_pending(uint num);
+
+#endif // DMX_SIM_HARDWARE_IRQ_H
@@ -0,0 +1,209 @@
+#ifndef DMX_SIM_HARDWARE_PIO_H
+#define DMX_SIM_HARDWARE_PIO_H
+
+// Host stand-in for the Pico SDK's hardware/pio.h (simulated HAL, see dmx_sim.h).
+// Program memory, state machine claims and configuration behave as on the
+// RP2040. Execution is modelled per program: the simulator recognises the
+// Pico-DMX programs and reproduces their wire timing at the configured clock.
+
+#include "pico/platform.h"
+#include "hardware/address_mapped.h"
+#include "hardware/gpio.h"
+
+#define NUM_PIOS 2
+#define NUM_PIO_STATE_MACHINES 4
+#define PIO_INSTRUCTION_COUNT 32
+
+#define PIO_FDEBUG_TXSTALL_LSB 24
+#define PIO_FDEBUG_TXOVER_LSB 16
+#define PIO_FDEBUG_RXUNDER_LSB 8
+#define PIO_FDEBUG_RXSTALL_LSB 0
+
+// FIFOs are only addressable as DMA targets; CPU access goes through
+// pio_sm_put() / pio_sm_get()
+typedef struct {
+    dmx_sim_w1c_reg fdebug;
+    volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+    volatile uint32_t rxf[NUM_PIO_STATE_MACHINES];
+} pio_hw_t;
+
+typedef pio_hw_t* PIO;
+
+extern pio_hw_t dmx_sim_pio_hw[NUM_PIOS];
+
+#define pio0 (&dmx_sim_pio_hw[0])
+#define pio1 (&dmx_sim_pio_hw[1])
+
+typedef struct pio_program {
+    const uint16_t* instructions;
+    uint8_t length;
+    int8_t origin; // -1 = relocatable
+} pio_program_t;
+
+enum pio_fifo_join {
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX = 1,
+    PIO_FIFO_JOIN_RX = 2
+};
+
+enum pio_mov_status_type {
+    STATUS_TX_LESSTHAN = 0,
+    STATUS_RX_LESSTHAN = 1
+};
+
+// Unpacked SM configuration (the SDK packs the same fields into registers)
+typedef struct {
+    uint16_t clkdiv_int;
+    uint8_t clkdiv_frac;
+    uint8_t wrap_target;
+    uint8_t wrap;
+    uint8_t out_base;
+    uint8_t out_count;
+    uint8_t set_base;
+    uint8_t set_count;
+    uint8_t in_base;
+    uint8_t sideset_base;
+    uint8_t sideset_bit_count; // Including the enable bit when optional
+    bool sideset_optional;
+    bool sideset_pindirs;
+    uint8_t jmp_pin;
+    bool in_shift_right;
+    bool autopush;
+    uint8_t push_threshold;
+    bool out_shift_right;
+    bool autopull;
+    uint8_t pull_threshold;
+    enum pio_fifo_join fifo_join;
+    enum pio_mov_status_type mov_status_sel;
+    uint8_t mov_status_n;
+} pio_sm_config;
+
+static inline pio_sm_config pio_get_default_sm_config() {
+    pio_sm_config c = {};
+    c.clkdiv_int = 1;
+    c.wrap_target = 0;
+    c.wrap = 31;
+    c.set_count = 0;
+    c.out_count = 32;
+    c.in_shift_right = true;
+    c.out_shift_right = true;
+    c.push_threshold = 32;
+    c.pull_threshold = 32;
+    return c;
+}
+
+static inline void sm_config_set_out_pins(pio_sm_config* c, uint out_base, uint out_count) {
+    c->out_base = (uint8_t)out_base;
+    c->out_count = (uint8_t)out_count;
+}
+
+static inline void sm_config_set_set_pins(pio_sm_config* c, uint set_base, uint set_count) {
+    c->set_base = (uint8_t)set_base;
+    c->set_count = (uint8_t)set_count;
+}
+
+static inline void sm_config_set_in_pins(pio_sm_config* c, uint in_base) {
+    c->in_base = (uint8_t)in_base;
+}
+
+static inline void sm_config_set_sideset_pins(pio_sm_config* c, uint sideset_base) {
+    c->sideset_base = (uint8_t)sideset_base;
+}
+
+static inline void sm_config_set_sideset(pio_sm_config* c, uint bit_count, bool optional, bool pindirs) {
+    c->sideset_bit_count = (uint8_t)bit_count;
+    c->sideset_optional = optional;
+    c->sideset_pindirs = pindirs;
+}
+
+static inline void sm_config_set_clkdiv_int_frac(pio_sm_config* c, uint16_t div_int, uint8_t div_frac) {
+    c->clkdiv_int = div_int;
+    c->clkdiv_frac = div_frac;
+}
+
+static inline void sm_config_set_clkdiv(pio_sm_config* c, float div) {
+    uint16_t div_int = (uint16_t)div;
+    sm_config_set_clkdiv_int_frac(c, div_int, (uint8_t)((div - div_int) * 256));
+}
+
+static inline void sm_config_set_wrap(pio_sm_config* c, uint wrap_target, uint wrap) {
+    c->wrap_target = (uint8_t)wrap_target;
+    c->wrap = (uint8_t)wrap;
+}
+
+static inline void sm_config_set_jmp_pin(pio_sm_config* c, uint pin) {
+    c->jmp_pin = (uint8_t)pin;
+}
+
+static inline void sm_config_set_in_shift(pio_sm_config* c, bool shift_right, bool autopush, uint push_threshold) {
+    c->in_shift_right = shift_right;
+    c->autopush = autopush;
+    c->push_threshold = (uint8_t)push_threshold;
+}
+
+static inline void sm_config_set_out_shift(pio_sm_config* c, bool shift_right, bool autopull, uint pull_threshold) {
+    c->out_shift_right = shift_right;
+    c->autopull = autopull;
+    c->pull_threshold = (uint8_t)pull_threshold;
+}
+
+static inline void sm_config_set_fifo_join(pio_sm_config* c, enum pio_fifo_join join) {
+    c->fifo_join = join;
+}
+
+static inline void sm_config_set_mov_status(pio_sm_config* c, enum pio_mov_status_type status_sel, uint status_n) {
+    c->mov_status_sel = status_sel;
+    c->mov_status_n = (uint8_t)status_n;
+}
+
+static inline uint pio_get_index(PIO pio) {
+    return (uint)(pio - dmx_sim_pio_hw);
+}
+
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+    return pio_get_index(pio) * 8 + (is_tx ? 0 : 4) + sm;
+}
+
+// Instruction encoding (only what the C++ side issues through pio_sm_exec)
+static inline uint pio_encode_jmp(uint addr) {
+    return addr & 0x1f;
+}
+
+// Program memory
+bool pio_can_add_program(PIO pio, const pio_program_t* program);
+uint pio_add_program(PIO pio, const pio_program_t* program);
+void pio_remove_program(PIO pio, const pio_program_t* program, uint loaded_offset);
+void pio_clear_instruction_memory(PIO pio);
+
+// State machine claims
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_claim(PIO pio, uint sm);
+void pio_sm_unclaim(PIO pio, uint sm);
+bool pio_sm_is_claimed(PIO pio, uint sm);
+
+// State machine control
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config);
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config* config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac);
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask);
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+
+// FIFOs
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+
+#endif // DMX_SIM_HARDWARE_PIO_H
@@ -0,0 +1,14 @@
+#ifndef DMX_SIM_HARDWARE_REGS_ADDRESSMAP_H
+#define DMX_SIM_HARDWARE_REGS_ADDRESSMAP_H
+
+// Host stand-in: XIP flash reads come from the simulated flash image
+
+#include <stdint.h>
+
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+
+extern uint8_t dmx_sim_flash[PICO_FLASH_SIZE_BYTES];
+
+#define XIP_BASE ((uintptr_t)dmx_sim_flash)
+
+#endif // DMX_SIM_HARDWARE_REGS_ADDRESSMAP_H
@@ -0,0 +1,19 @@
+#ifndef DMX_SIM_HARDWARE_STRUCTS_TIMER_H
+#define DMX_SIM_HARDWARE_STRUCTS_TIMER_H
+
+// Host stand-in for the Pico SDK's hardware/structs/timer.h. Only the raw
+// microsecond counter is modelled; it follows the simulated clock, so a DMA
+// channel reading &timer_hw->timerawl copies the time of its transfer.
+
+#include "pico/platform.h"
+
+typedef struct {
+    volatile uint32_t timerawh;
+    volatile uint32_t timerawl;
+} timer_hw_t;
+
+extern timer_hw_t dmx_sim_timer_hw;
+
+#define timer_hw (&dmx_sim_timer_hw)
+
+#endif // DMX_SIM_HARDWARE_STRUCTS_TIMER_H
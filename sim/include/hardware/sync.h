@@ -0,0 +1,31 @@
+#ifndef DMX_SIM_HARDWARE_SYNC_H
+#define DMX_SIM_HARDWARE_SYNC_H
+
+// Host stand-in for the Pico SDK's hardware/sync.h. The simulated CPU has a
+// single core; masking interrupts holds back simulated IRQ handlers until
+// they are restored.
+
+#include "pico/platform.h"
+#include <atomic>
+
+uint32_t save_and_disable_interrupts();
+void restore_interrupts(uint32_t status);
+
+static inline void __dmb() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+static inline void __dsb() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+// Sleep until the next simulated event or interrupt
+void __wfe();
+void __wfi();
+void __sev();
+
+static inline uint get_core_num() {
+    return 0;
+}
+
+#endif // DMX_SIM_HARDWARE_SYNC_H
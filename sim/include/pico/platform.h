@@ -0,0 +1,17 @@
+#ifndef DMX_SIM_PICO_PLATFORM_H
+#define DMX_SIM_PICO_PLATFORM_H
+
+// Host stand-in for the Pico SDK's pico/platform.h; included by every
+// hardware header, as in the SDK
+
+#include "pico/types.h"
+
+#define PICO_ON_DEVICE 0
+
+#define __not_in_flash_func(func_name) func_name
+#define __time_critical_func(func_name) func_name
+
+// Busy-wait loop body; advances the virtual clock
+void tight_loop_contents();
+
+#endif // DMX_SIM_PICO_PLATFORM_H
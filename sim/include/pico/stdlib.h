@@ -0,0 +1,16 @@
+#ifndef DMX_SIM_PICO_STDLIB_H
+#define DMX_SIM_PICO_STDLIB_H
+
+// Host stand-in for the Pico SDK's pico/stdlib.h (simulated HAL, see dmx_sim.h).
+// stdio goes to the host's stdin/stdout.
+
+#include "pico/platform.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+#include <stdio.h>
+
+bool stdio_init_all();
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+
+#endif // DMX_SIM_PICO_STDLIB_H
@@ -0,0 +1,59 @@
+#ifndef DMX_SIM_PICO_TIME_H
+#define DMX_SIM_PICO_TIME_H
+
+// Host stand-in for the Pico SDK's pico/time.h, running on the simulator's
+// virtual clock. Every time query and busy-wait iteration advances the clock
+// a little, so polling loops make progress and simulated peripherals keep running.
+
+#include "pico/types.h"
+
+uint64_t time_us_64();
+uint32_t time_us_32();
+
+static inline absolute_time_t get_absolute_time() {
+    return time_us_64();
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) {
+    return t + us;
+}
+
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) {
+    return t + (uint64_t)ms * 1000;
+}
+
+static inline absolute_time_t make_timeout_time_us(uint64_t us) {
+    return time_us_64() + us;
+}
+
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return time_us_64() + (uint64_t)ms * 1000;
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+static inline bool time_reached(absolute_time_t t) {
+    return time_us_64() >= t;
+}
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+
+// Sleep (WFE) until the next event or interrupt, or the timeout; true once it has passed
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp);
+void busy_wait_us(uint64_t us);
+void busy_wait_us_32(uint32_t us);
+void busy_wait_ms(uint32_t ms);
+
+#endif // DMX_SIM_PICO_TIME_H
@@ -0,0 +1,19 @@
+#ifndef DMX_SIM_PICO_TYPES_H
+#define DMX_SIM_PICO_TYPES_H
+
+// Host stand-in for the Pico SDK's pico/types.h (simulated HAL, see dmx_sim.h)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+
+// Microseconds since boot, as in the SDK's non-debug builds
+typedef uint64_t absolute_time_t;
+
+#define PICO_OK 0
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+
+#endif // DMX_SIM_PICO_TYPES_H
@@ -0,0 +1,761 @@
+#include "dmx_pio_emulator.h"
+#include <algorithm>
+#include <cstring>
+
+#define PIO_INPUT_SYNC_CYCLES 2  // GPIO input synchroniser delay
+
+// Instruction fields
+#define OP_JMP 0
+#define OP_WAIT 1
+#define OP_IN 2
+#define OP_OUT 3
+#define OP_PUSH_PULL 4
+#define OP_MOV 5
+#define OP_IRQ 6
+#define OP_SET 7
+
+#define SRC_DST_PINS 0
+#define SRC_DST_X 1
+#define SRC_DST_Y 2
+#define SRC_DST_NULL 3
+#define SRC_DST_PINDIRS 4
+#define SRC_DST_STATUS 5
+#define SRC_DST_PC 5
+#define SRC_DST_ISR 6
+#define SRC_DST_OSR 7
+#define SRC_DST_EXEC 7
+#define MOV_DST_EXEC 4
+
+static inline uint32_t bitMask(uint count) {
+    return count >= 32 ? 0xFFFFFFFFu : (1u << count) - 1;
+}
+
+static inline uint32_t bitReverse(uint32_t value) {
+    uint32_t result = 0;
+    for (int i = 0; i < 32; i++) {
+        result = (result << 1) | (value & 1);
+        value >>= 1;
+    }
+    return result;
+}
+
+// DMXWaveform
+
+DMXWaveform::DMXWaveform(bool initial_level) {
+    clear(initial_level);
+}
+
+void DMXWaveform::clear(bool initial_level) {
+    _initial_level = initial_level;
+    _edges_ns.clear();
+    _end_ns = 0;
+}
+
+void DMXWaveform::set(uint64_t time_ns, bool level) {
+    if (time_ns > _end_ns) {
+        _end_ns = time_ns;
+    }
+    if (level == getFinalLevel()) {
+        return;
+    }
+    // Two edges at the same instant cancel out
+    if (!_edges_ns.empty() && _edges_ns.back() == time_ns) {
+        _edges_ns.pop_back();
+    } else {
+        _edges_ns.push_back(time_ns);
+    }
+}
+
+void DMXWaveform::append(bool level, uint64_t duration_ns) {
+    set(_end_ns, level);
+    _end_ns += duration_ns;
+}
+
+bool DMXWaveform::levelAt(uint64_t time_ns) const {
+    size_t edges = std::upper_bound(_edges_ns.begin(), _edges_ns.end(), time_ns) - _edges_ns.begin();
+    return _initial_level ^ (edges & 1);
+}
+
+bool DMXWaveform::getInitialLevel() const {
+    return _initial_level;
+}
+
+bool DMXWaveform::getFinalLevel() const {
+    return _initial_level ^ (_edges_ns.size() & 1);
+}
+
+uint64_t DMXWaveform::getEndNs() const {
+    return _end_ns;
+}
+
+size_t DMXWaveform::getNumEdges() const {
+    return _edges_ns.size();
+}
+
+uint64_t DMXWaveform::getEdgeNs(size_t index) const {
+    return _edges_ns[index];
+}
+
+// DMXPioEmulator
+
+DMXPioEmulator::DMXPioEmulator(uint32_t sys_hz)
+    : _sys_hz(sys_hz), _now(0), _used_mask(0), _fdebug(0), _irq_flags(0),
+      _pin_values(0), _pin_dirs(0) {
+    memset(_instructions, 0, sizeof(_instructions));
+    for (uint i = 0; i < NUM_PIO_STATE_MACHINES; i++) {
+        StateMachine& sm = _sm[i];
+        memset(&sm, 0, sizeof(sm));
+        sm.config = pio_get_default_sm_config();
+        sm.osr_count = 32;
+        rebaseClock(sm);
+    }
+    for (uint gpio = 0; gpio < 32; gpio++) {
+        _outputs[gpio].clear(false);
+        _inputs[gpio] = nullptr;
+        _input_levels[gpio] = true;  // Pulled up
+        _input_source[gpio] = -1;
+    }
+}
+
+int DMXPioEmulator::addProgram(const pio_program_t* program) {
+    uint32_t program_mask = bitMask(program->length);
+    int offset = -1;
+    if (program->origin >= 0) {
+        if (program->origin + program->length <= PIO_INSTRUCTION_COUNT &&
+            !(_used_mask & (program_mask << program->origin))) {
+            offset = program->origin;
+        }
+    } else {
+        for (int candidate = PIO_INSTRUCTION_COUNT - program->length; candidate >= 0; candidate--) {
+            if (!(_used_mask & (program_mask << candidate))) {
+                offset = candidate;
+                break;
+            }
+        }
+    }
+    if (offset < 0) {
+        return -1;
+    }
+
+    for (uint i = 0; i < program->length; i++) {
+        uint16_t instr = program->instructions[i];
+        // Relocate JMP targets
+        if ((instr >> 13) == OP_JMP) {
+            instr = (uint16_t)((instr & ~0x1f) | ((instr + offset) & 0x1f));
+        }
+        _instructions[offset + i] = instr;
+    }
+    _used_mask |= program_mask << offset;
+    return offset;
+}
+
+void DMXPioEmulator::clearPrograms() {
+    memset(_instructions, 0, sizeof(_instructions));
+    _used_mask = 0;
+}
+
+uint16_t DMXPioEmulator::getInstruction(uint offset) const {
+    return _instructions[offset & 0x1f];
+}
+
+void DMXPioEmulator::initSm(uint sm, uint initial_pc, const pio_sm_config& config) {
+    setEnabled(sm, false);
+    setConfig(sm, config);
+    clearFifos(sm);
+    clearFdebug((1u << (PIO_FDEBUG_TXSTALL_LSB + sm)) | (1u << (PIO_FDEBUG_TXOVER_LSB + sm)) |
+                (1u << (PIO_FDEBUG_RXUNDER_LSB + sm)) | (1u << (PIO_FDEBUG_RXSTALL_LSB + sm)));
+    restart(sm);
+    exec(sm, (uint16_t)(initial_pc & 0x1f));
+}
+
+void DMXPioEmulator::setConfig(uint sm, const pio_sm_config& config) {
+    StateMachine& state = _sm[sm];
+    bool join_changed = config.fifo_join != state.config.fifo_join;
+    state.config = config;
+    if (join_changed) {
+        clearFifos(sm);
+    }
+    rebaseClock(state);
+}
+
+void DMXPioEmulator::setEnabled(uint sm, bool enabled) {
+    StateMachine& state = _sm[sm];
+    if (enabled && !state.enabled) {
+        rebaseClock(state);
+    }
+    state.enabled = enabled;
+}
+
+void DMXPioEmulator::restart(uint sm) {
+    StateMachine& state = _sm[sm];
+    state.isr = 0;
+    state.isr_count = 0;
+    state.osr_count = 32;
+    state.delay = 0;
+    state.stalled = false;
+    state.irq_waiting = false;
+    state.exec_pending = false;
+}
+
+void DMXPioEmulator::exec(uint sm, uint16_t instr) {
+    StateMachine& state = _sm[sm];
+    bool jumped = false;
+    state.exec_pending = false;
+    state.stalled = false;
+    if (!execute(sm, instr, &jumped)) {
+        // Latched until it can complete, as on the chip
+        state.exec_pending = true;
+        state.exec_instr = instr;
+        state.stalled = true;
+    }
+}
+
+bool DMXPioEmulator::put(uint sm, uint32_t value) {
+    StateMachine& state = _sm[sm];
+    if (!fifoPush(state.tx, txDepth(state), value)) {
+        _fdebug |= 1u << (PIO_FDEBUG_TXOVER_LSB + sm);
+        return false;
+    }
+    return true;
+}
+
+bool DMXPioEmulator::get(uint sm, uint32_t* value) {
+    StateMachine& state = _sm[sm];
+    if (state.rx.count == 0) {
+        _fdebug |= 1u << (PIO_FDEBUG_RXUNDER_LSB + sm);
+        return false;
+    }
+    *value = fifoPop(state.rx);
+    return true;
+}
+
+uint DMXPioEmulator::getTxLevel(uint sm) const {
+    return _sm[sm].tx.count;
+}
+
+uint DMXPioEmulator::getRxLevel(uint sm) const {
+    return _sm[sm].rx.count;
+}
+
+void DMXPioEmulator::clearFifos(uint sm) {
+    StateMachine& state = _sm[sm];
+    state.tx.head = state.tx.count = 0;
+    state.rx.head = state.rx.count = 0;
+}
+
+void DMXPioEmulator::streamTx(uint sm, const uint8_t* data, size_t length) {
+    StateMachine& state = _sm[sm];
+    state.tx_stream = data;
+    state.tx_stream_length = length;
+    state.tx_streamed = 0;
+    serviceStreams(state);
+}
+
+void DMXPioEmulator::streamRx(uint sm, uint8_t* buffer, size_t capacity) {
+    StateMachine& state = _sm[sm];
+    state.rx_stream = buffer;
+    state.rx_stream_capacity = capacity;
+    state.rx_streamed = 0;
+    serviceStreams(state);
+}
+
+size_t DMXPioEmulator::getTxStreamed(uint sm) const {
+    return _sm[sm].tx_streamed;
+}
+
+size_t DMXPioEmulator::getRxStreamed(uint sm) const {
+    return _sm[sm].rx_streamed;
+}
+
+void DMXPioEmulator::setInput(uint gpio, const DMXWaveform* waveform) {
+    _inputs[gpio] = waveform;
+    _input_source[gpio] = -1;
+}
+
+void DMXPioEmulator::setInputLevel(uint gpio, bool level) {
+    _inputs[gpio] = nullptr;
+    _input_source[gpio] = -1;
+    _input_levels[gpio] = level;
+}
+
+void DMXPioEmulator::connect(uint out_gpio, uint in_gpio) {
+    _inputs[in_gpio] = nullptr;
+    _input_source[in_gpio] = (int8_t)out_gpio;
+}
+
+void DMXPioEmulator::setPins(uint32_t values, uint32_t mask) {
+    uint32_t old_values = _pin_values;
+    _pin_values = (_pin_values & ~mask) | (values & mask);
+    recordOutputs(old_values);
+}
+
+void DMXPioEmulator::setPindirs(uint32_t dirs, uint32_t mask) {
+    _pin_dirs = (_pin_dirs & ~mask) | (dirs & mask);
+}
+
+bool DMXPioEmulator::getOutputLevel(uint gpio) const {
+    return (_pin_values >> gpio) & 1;
+}
+
+const DMXWaveform& DMXPioEmulator::getOutput(uint gpio) const {
+    return _outputs[gpio];
+}
+
+void DMXPioEmulator::run(uint64_t time_ns) {
+    uint64_t target = (time_ns / 1000000000ull) * _sys_hz +
+                      (time_ns % 1000000000ull) * _sys_hz / 1000000000ull;
+    while (true) {
+        uint64_t next = UINT64_MAX;
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; i++) {
+            if (_sm[i].enabled && _sm[i].next_tick < next) {
+                next = _sm[i].next_tick;
+            }
+        }
+        if (next > target) {
+            break;
+        }
+
+        // State machines clocked on the same cycle run in index order
+        _now = next;
+        for (uint i = 0; i < NUM_PIO_STATE_MACHINES; i++) {
+            if (_sm[i].enabled && _sm[i].next_tick == next) {
+                step(i);
+            }
+        }
+    }
+    if (target > _now) {
+        _now = target;
+    }
+}
+
+uint64_t DMXPioEmulator::nowNs() const {
+    return cyclesToNs(_now);
+}
+
+uint64_t DMXPioEmulator::getSysCycles() const {
+    return _now;
+}
+
+uint32_t DMXPioEmulator::getSysHz() const {
+    return _sys_hz;
+}
+
+uint DMXPioEmulator::getPc(uint sm) const {
+    return _sm[sm].pc;
+}
+
+uint32_t DMXPioEmulator::getX(uint sm) const {
+    return _sm[sm].x;
+}
+
+uint32_t DMXPioEmulator::getY(uint sm) const {
+    return _sm[sm].y;
+}
+
+bool DMXPioEmulator::isStalled(uint sm) const {
+    return _sm[sm].stalled;
+}
+
+uint32_t DMXPioEmulator::getFdebug() const {
+    return _fdebug;
+}
+
+void DMXPioEmulator::clearFdebug(uint32_t mask) {
+    _fdebug &= ~mask;
+}
+
+uint8_t DMXPioEmulator::getIrqFlags() const {
+    return _irq_flags;
+}
+
+DMXPioEmulator::SmStats DMXPioEmulator::getStats(uint sm) const {
+    return _sm[sm].stats;
+}
+
+uint64_t DMXPioEmulator::cyclesToNs(uint64_t cycles) const {
+    return (cycles / _sys_hz) * 1000000000ull + (cycles % _sys_hz) * 1000000000ull / _sys_hz;
+}
+
+uint64_t DMXPioEmulator::div256(const StateMachine& sm) const {
+    uint64_t div_int = sm.config.clkdiv_int ? sm.config.clkdiv_int : 65536;
+    return (div_int << 8) | sm.config.clkdiv_frac;
+}
+
+void DMXPioEmulator::rebaseClock(StateMachine& sm) {
+    // First tick on the cycle after the divider restarts
+    sm.tick_base = _now + 1;
+    sm.tick_index = 0;
+    sm.next_tick = sm.tick_base;
+}
+
+uint8_t DMXPioEmulator::txDepth(const StateMachine& sm) const {
+    return sm.config.fifo_join == PIO_FIFO_JOIN_TX ? 8 : sm.config.fifo_join == PIO_FIFO_JOIN_RX ? 0 : 4;
+}
+
+uint8_t DMXPioEmulator::rxDepth(const StateMachine& sm) const {
+    return sm.config.fifo_join == PIO_FIFO_JOIN_RX ? 8 : sm.config.fifo_join == PIO_FIFO_JOIN_TX ? 0 : 4;
+}
+
+bool DMXPioEmulator::fifoPush(Fifo& fifo, uint8_t depth, uint32_t value) {
+    if (fifo.count >= depth) {
+        return false;
+    }
+    fifo.entries[(fifo.head + fifo.count) & 7] = value;
+    fifo.count++;
+    return true;
+}
+
+uint32_t DMXPioEmulator::fifoPop(Fifo& fifo) {
+    uint32_t value = fifo.entries[fifo.head];
+    fifo.head = (fifo.head + 1) & 7;
+    fifo.count--;
+    return value;
+}
+
+void DMXPioEmulator::serviceStreams(StateMachine& sm) {
+    while (sm.tx_stream && sm.tx_streamed < sm.tx_stream_length) {
+        // 8-bit DMA writes are replicated across the 32-bit bus
+        uint32_t value = sm.tx_stream[sm.tx_streamed] * 0x01010101u;
+        if (!fifoPush(sm.tx, txDepth(sm), value)) {
+            break;
+        }
+        sm.tx_streamed++;
+    }
+    while (sm.rx_stream && sm.rx_streamed < sm.rx_stream_capacity && sm.rx.count > 0) {
+        sm.rx_stream[sm.rx_streamed++] = (uint8_t)fifoPop(sm.rx);
+    }
+}
+
+bool DMXPioEmulator::readPin(uint gpio) {
+    gpio &= 31;
+    uint64_t sample_ns = cyclesToNs(_now >= PIO_INPUT_SYNC_CYCLES ? _now - PIO_INPUT_SYNC_CYCLES : 0);
+    if ((_pin_dirs >> gpio) & 1) {
+        return _outputs[gpio].levelAt(sample_ns);
+    }
+    if (_input_source[gpio] >= 0) {
+        return _outputs[_input_source[gpio]].levelAt(sample_ns);
+    }
+    if (_inputs[gpio]) {
+        return _inputs[gpio]->levelAt(sample_ns);
+    }
+    return _input_levels[gpio];
+}
+
+uint32_t DMXPioEmulator::readInPins(const StateMachine& sm) {
+    uint32_t value = 0;
+    for (uint i = 0; i < 32; i++) {
+        value |= (uint32_t)readPin(sm.config.in_base + i) << i;
+    }
+    return value;
+}
+
+void DMXPioEmulator::writePins(uint base, uint count, uint32_t values) {
+    uint32_t old_values = _pin_values;
+    for (uint i = 0; i < count; i++) {
+        uint gpio = (base + i) & 31;
+        _pin_values = (_pin_values & ~(1u << gpio)) | (((values >> i) & 1) << gpio);
+    }
+    recordOutputs(old_values);
+}
+
+void DMXPioEmulator::writePindirs(uint base, uint count, uint32_t dirs) {
+    for (uint i = 0; i < count; i++) {
+        uint gpio = (base + i) & 31;
+        _pin_dirs = (_pin_dirs & ~(1u << gpio)) | (((dirs >> i) & 1) << gpio);
+    }
+}
+
+void DMXPioEmulator::recordOutputs(uint32_t old_values) {
+    uint32_t changed = old_values ^ _pin_values;
+    uint64_t now_ns = nowNs();
+    for (uint gpio = 0; changed; gpio++, changed >>= 1) {
+        if (changed & 1) {
+            _outputs[gpio].set(now_ns, (_pin_values >> gpio) & 1);
+        }
+    }
+}
+
+void DMXPioEmulator::step(uint index) {
+    StateMachine& sm = _sm[index];
+    sm.stats.cycles++;
+    sm.tick_index++;
+    sm.next_tick = sm.tick_base + ((sm.tick_index * div256(sm)) >> 8);
+
+    serviceStreams(sm);
+    if (sm.delay > 0) {
+        sm.delay--;
+        sm.stats.delay_cycles++;
+        return;
+    }
+
+    bool from_exec = sm.exec_pending;
+    uint16_t instr = from_exec ? sm.exec_instr : _instructions[sm.pc];
+    bool retrying = sm.stalled;
+    bool jumped = false;
+    sm.exec_pending = false;
+    bool completed = execute(index, instr, &jumped);
+
+    // Side-set is asserted when the instruction issues, stalled or not, and
+    // wins over an OUT/SET to the same pin
+    uint sideset_bits = sm.config.sideset_bit_count;
+    uint field = (instr >> 8) & 0x1f;
+    if (!retrying && sideset_bits > 0) {
+        uint value_bits = sideset_bits - (sm.config.sideset_optional ? 1 : 0);
+        bool enabled = !sm.config.sideset_optional || (field & 0x10);
+        if (enabled && value_bits > 0) {
+            uint32_t value = (field >> (5 - sideset_bits)) & bitMask(value_bits);
+            if (sm.config.sideset_pindirs) {
+                writePindirs(sm.config.sideset_base, value_bits, value);
+            } else {
+                writePins(sm.config.sideset_base, value_bits, value);
+            }
+        }
+    }
+
+    if (!completed) {
+        if (from_exec && !sm.exec_pending) {
+            sm.exec_pending = true;
+            sm.exec_instr = instr;
+        }
+        sm.stalled = true;
+        sm.stats.stall_cycles++;
+        return;
+    }
+
+    sm.stalled = false;
+    sm.stats.instructions++;
+    sm.delay = (uint8_t)(field & bitMask(5 - sideset_bits));
+    // An exec'd instruction leaves the PC alone unless it jumps
+    if (!jumped && !from_exec) {
+        sm.pc = sm.pc == sm.config.wrap ? sm.config.wrap_target : (uint8_t)((sm.pc + 1) & 0x1f);
+    }
+    serviceStreams(sm);
+}
+
+bool DMXPioEmulator::execute(uint index, uint16_t instr, bool* jumped) {
+    StateMachine& sm = _sm[index];
+    uint opcode = instr >> 13;
+    uint arg1 = (instr >> 5) & 7;
+    uint arg2 = instr & 0x1f;
+    uint bit_count = arg2 ? arg2 : 32;
+
+    switch (opcode) {
+    case OP_JMP: {
+        bool take = false;
+        switch (arg1) {
+        case 0: take = true; break;
+        case 1: take = sm.x == 0; break;
+        case 2: take = sm.x != 0; sm.x--; break;
+        case 3: take = sm.y == 0; break;
+        case 4: take = sm.y != 0; sm.y--; break;
+        case 5: take = sm.x != sm.y; break;
+        case 6: take = readPin(sm.config.jmp_pin); break;
+        case 7: take = sm.osr_count < sm.config.pull_threshold; break;
+        }
+        if (take) {
+            sm.pc = (uint8_t)arg2;
+            *jumped = true;
+        }
+        return true;
+    }
+
+    case OP_WAIT: {
+        bool polarity = (instr >> 7) & 1;
+        uint source = (instr >> 5) & 3;
+        bool level;
+        if (source == 0) {
+            level = readPin(arg2);
+        } else if (source == 1) {
+            level = readPin(sm.config.in_base + arg2);
+        } else if (source == 2) {
+            uint irq = (arg2 & 0x10) ? ((arg2 & 4) | ((arg2 + index) & 3)) : (arg2 & 7);
+            level = (_irq_flags >> irq) & 1;
+            if (level == polarity && polarity) {
+                _irq_flags &= (uint8_t)~(1u << irq);
+            }
+        } else {
+            return true;  // Reserved
+        }
+        return level == polarity;
+    }
+
+    case OP_IN: {
+        bool push_due = sm.config.autopush && sm.isr_count + bit_count >= sm.config.push_threshold;
+        if (push_due && sm.rx.count >= rxDepth(sm)) {
+            _fdebug |= 1u << (PIO_FDEBUG_RXSTALL_LSB + index);
+            return false;
+        }
+
+        uint32_t data;
+        switch (arg1) {
+        case SRC_DST_PINS: data = readInPins(sm); break;
+        case SRC_DST_X: data = sm.x; break;
+        case SRC_DST_Y: data = sm.y; break;
+        case SRC_DST_ISR: data = sm.isr; break;
+        case SRC_DST_OSR: data = sm.osr; break;
+        default: data = 0; break;
+        }
+        data &= bitMask(bit_count);
+        if (bit_count == 32) {
+            sm.isr = data;
+        } else if (sm.config.in_shift_right) {
+            sm.isr = (sm.isr >> bit_count) | (data << (32 - bit_count));
+        } else {
+            sm.isr = (sm.isr << bit_count) | data;
+        }
+        sm.isr_count = (uint8_t)std::min<uint>(32, sm.isr_count + bit_count);
+
+        if (push_due) {
+            fifoPush(sm.rx, rxDepth(sm), sm.isr);
+            sm.isr = 0;
+            sm.isr_count = 0;
+        }
+        return true;
+    }
+
+    case OP_OUT: {
+        if (sm.config.autopull && sm.osr_count >= sm.config.pull_threshold) {
+            if (sm.tx.count == 0) {
+                _fdebug |= 1u << (PIO_FDEBUG_TXSTALL_LSB + index);
+                return false;
+            }
+            sm.osr = fifoPop(sm.tx);
+            sm.osr_count = 0;
+        }
+
+        uint32_t data;
+        if (bit_count == 32) {
+            data = sm.osr;
+            sm.osr = 0;
+        } else if (sm.config.out_shift_right) {
+            data = sm.osr & bitMask(bit_count);
+            sm.osr >>= bit_count;
+        } else {
+            data = sm.osr >> (32 - bit_count);
+            sm.osr <<= bit_count;
+        }
+        sm.osr_count = (uint8_t)std::min<uint>(32, sm.osr_count + bit_count);
+
+        switch (arg1) {
+        case SRC_DST_PINS: writePins(sm.config.out_base, sm.config.out_count, data); break;
+        case SRC_DST_X: sm.x = data; break;
+        case SRC_DST_Y: sm.y = data; break;
+        case SRC_DST_PINDIRS: writePindirs(sm.config.out_base, sm.config.out_count, data); break;
+        case SRC_DST_PC: sm.pc = (uint8_t)(data & 0x1f); *jumped = true; break;
+        case SRC_DST_ISR: sm.isr = data; sm.isr_count = (uint8_t)bit_count; break;
+        case SRC_DST_EXEC: sm.exec_pending = true; sm.exec_instr = (uint16_t)data; break;
+        default: break;
+        }
+
+        // Background refill once the threshold is reached
+        if (sm.config.autopull && sm.osr_count >= sm.config.pull_threshold && sm.tx.count > 0) {
+            sm.osr = fifoPop(sm.tx);
+            sm.osr_count = 0;
+        }
+        return true;
+    }
+
+    case OP_PUSH_PULL: {
+        bool conditional = (instr >> 6) & 1;
+        bool block = (instr >> 5) & 1;
+        if ((instr >> 7) & 1) {
+            // PULL
+            if ((conditional || sm.config.autopull) && sm.osr_count < sm.config.pull_threshold) {
+                return true;
+            }
+            if (sm.tx.count == 0) {
+                if (block) {
+                    _fdebug |= 1u << (PIO_FDEBUG_TXSTALL_LSB + index);
+                    return false;
+                }
+                sm.osr = sm.x;
+            } else {
+                sm.osr = fifoPop(sm.tx);
+            }
+            sm.osr_count = 0;
+        } else {
+            // PUSH
+            if (conditional && sm.isr_count < sm.config.push_threshold) {
+                return true;
+            }
+            if (sm.rx.count >= rxDepth(sm) && block) {
+                _fdebug |= 1u << (PIO_FDEBUG_RXSTALL_LSB + index);
+                return false;
+            }
+            fifoPush(sm.rx, rxDepth(sm), sm.isr);  // Lost if the FIFO is full
+            sm.isr = 0;
+            sm.isr_count = 0;
+        }
+        return true;
+    }
+
+    case OP_MOV: {
+        uint op = (instr >> 3) & 3;
+        uint32_t data;
+        switch (instr & 7) {
+        case SRC_DST_PINS: data = readInPins(sm); break;
+        case SRC_DST_X: data = sm.x; break;
+        case SRC_DST_Y: data = sm.y; break;
+        case SRC_DST_STATUS: {
+            uint level = sm.config.mov_status_sel == STATUS_TX_LESSTHAN ? sm.tx.count : sm.rx.count;
+            data = level < sm.config.mov_status_n ? 0xFFFFFFFFu : 0;
+            break;
+        }
+        case SRC_DST_ISR: data = sm.isr; break;
+        case SRC_DST_OSR: data = sm.osr; break;
+        default: data = 0; break;
+        }
+        if (op == 1) {
+            data = ~data;
+        } else if (op == 2) {
+            data = bitReverse(data);
+        }
+
+        switch (arg1) {
+        case SRC_DST_PINS: writePins(sm.config.out_base, sm.config.out_count, data); break;
+        case SRC_DST_X: sm.x = data; break;
+        case SRC_DST_Y: sm.y = data; break;
+        case MOV_DST_EXEC: sm.exec_pending = true; sm.exec_instr = (uint16_t)data; break;
+        case SRC_DST_PC: sm.pc = (uint8_t)(data & 0x1f); *jumped = true; break;
+        case SRC_DST_ISR: sm.isr = data; sm.isr_count = 0; break;
+        case SRC_DST_OSR: sm.osr = data; sm.osr_count = 0; break;
+        default: break;
+        }
+        return true;
+    }
+
+    case OP_IRQ: {
+        bool clear = (instr >> 6) & 1;
+        bool wait = (instr >> 5) & 1;
+        uint irq = (arg2 & 0x10) ? ((arg2 & 4) | ((arg2 + index) & 3)) : (arg2 & 7);
+        if (clear) {
+            _irq_flags &= (uint8_t)~(1u << irq);
+            return true;
+        }
+        if (!sm.irq_waiting) {
+            _irq_flags |= (uint8_t)(1u << irq);
+            if (!wait) {
+                return true;
+            }
+            sm.irq_waiting = true;
+            return false;
+        }
+        if ((_irq_flags >> irq) & 1) {
+            return false;
+        }
+        sm.irq_waiting = false;
+        return true;
+    }
+
+    case OP_SET:
+    default:
+        switch (arg1) {
+        case SRC_DST_PINS: writePins(sm.config.set_base, sm.config.set_count, arg2); break;
+        case SRC_DST_X: sm.x = arg2; break;
+        case SRC_DST_Y: sm.y = arg2; break;
+        case SRC_DST_PINDIRS: writePindirs(sm.config.set_base, sm.config.set_count, arg2); break;
+        default: break;
+        }
+        return true;
+    }
+}
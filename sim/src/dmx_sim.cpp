@@ -0,0 +1,1334 @@
+#include "dmx_sim.h"
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "hardware/structs/timer.h"
+#include "hardware/regs/addressmap.h"
+#include "DmxOutput.pio.h"
+#include "DmxInput.pio.h"
+#include "DmxInputInverted.pio.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <vector>
+
+#define SIM_SYS_CLOCK_HZ 125000000u
+#define SIM_TIME_READ_NS 100     // CPU time charged per time query
+#define SIM_REG_POLL_NS 20       // ... per peripheral status poll
+#define SIM_LOOP_NS 1000         // ... per tight_loop_contents() / busy-wait iteration
+#define SIM_WFE_MAX_NS 1000000   // __wfe() sleeps at most this long without an event
+#define SIM_MAX_WIRES 32
+#define SIM_MAX_IRQ_DISPATCH 64  // Per advance, so a stuck level IRQ cannot hang the host
+
+// Pico-DMX program timing in SM cycles
+#define TX_BREAK_CYCLES 177      // set x, 21 + 22 x 8-cycle loop
+#define TX_MAB_CYCLES 8          // nop [7]; the stop bits of the first pull add 8 more
+#define TX_SLOT_CYCLES 44        // 8 stop bit cycles, 4 start, 8 x 4 data
+#define RX_BREAK_CYCLES 91       // set x, 29 + 30 x 3-cycle loop
+
+pio_hw_t dmx_sim_pio_hw[NUM_PIOS];
+dma_hw_t dmx_sim_dma_hw;
+timer_hw_t dmx_sim_timer_hw;
+uint8_t dmx_sim_flash[PICO_FLASH_SIZE_BYTES];
+
+namespace {
+
+enum ProgramKind : uint8_t {
+    PROGRAM_NONE,
+    PROGRAM_DMX_OUTPUT,
+    PROGRAM_DMX_INPUT,
+    PROGRAM_DMX_INPUT_INVERTED
+};
+
+enum SmPhase : uint8_t {
+    PHASE_IDLE,            // Not started, or a program the simulator does not model
+    PHASE_TX_BREAK,        // Break until event_ns
+    PHASE_TX_PULL,         // Pulling from event_ns on, stalled while the FIFO is empty
+    PHASE_TX_SLOT,         // Shifting out slot_value until event_ns
+    PHASE_RX_WAIT_BREAK,
+    PHASE_RX_RECEIVING
+};
+
+struct FifoEntry {
+    uint32_t value;
+    uint64_t time_ns;
+};
+
+struct Fifo {
+    FifoEntry entries[8];
+    uint8_t head;
+    uint8_t count;
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+    void push(uint32_t value, uint64_t time_ns) {
+        entries[(head + count) & 7] = {value, time_ns};
+        count++;
+    }
+    FifoEntry pop() {
+        FifoEntry entry = entries[head];
+        head = (head + 1) & 7;
+        count--;
+        return entry;
+    }
+};
+
+struct LoadedProgram {
+    uint8_t offset;
+    uint8_t length;
+    ProgramKind kind;
+};
+
+struct StateMachine {
+    bool claimed;
+    bool enabled;
+    pio_sm_config config;
+    ProgramKind kind;
+    uint8_t program_offset;
+    uint8_t index;         // PIO index * 4 + SM
+    bool at_start;         // PC at the first instruction of the program, not yet running
+    bool stalled;          // Stall on the empty TX FIFO reported in FDEBUG
+    SmPhase phase;
+    uint64_t event_ns;
+    uint64_t phase_start_ns;
+    uint64_t disabled_ns;
+    uint8_t slot_value;
+    uint8_t break_value;   // What a receiver in mid-frame reads from the next break
+    Fifo tx;
+    Fifo rx;
+};
+
+struct Pio {
+    uint16_t instructions[PIO_INSTRUCTION_COUNT];
+    uint32_t used_mask;
+    std::vector<LoadedProgram> programs;
+    StateMachine sm[NUM_PIO_STATE_MACHINES];
+};
+
+struct DmaChannel {
+    bool claimed;
+    bool busy;
+    dma_channel_config config;
+    uint32_t reload_count;
+};
+
+struct Wire {
+    bool used;
+    uint8_t tx_gpio;
+    uint8_t rx_gpio;
+    bool inverted;
+};
+
+struct InjectedSymbol {
+    uint64_t seq;
+    uint8_t gpio;
+    DMXSim::Symbol symbol;
+
+    bool operator>(const InjectedSymbol& other) const {
+        if (symbol.end_ns != other.symbol.end_ns) {
+            return symbol.end_ns > other.symbol.end_ns;
+        }
+        return seq > other.seq;
+    }
+};
+
+uint64_t g_now_ns = 0;
+Pio g_pio[NUM_PIOS];
+DmaChannel g_dma[NUM_DMA_CHANNELS];
+Wire g_wires[SIM_MAX_WIRES];
+bool g_gpio_levels[NUM_BANK0_GPIOS];
+
+std::priority_queue<InjectedSymbol, std::vector<InjectedSymbol>, std::greater<InjectedSymbol>> g_injected;
+uint64_t g_inject_seq = 0;
+uint64_t g_inject_free_ns[NUM_BANK0_GPIOS];
+
+irq_handler_t g_irq_handlers[NUM_IRQS];
+uint32_t g_irq_enabled = 0;
+uint32_t g_irq_pending = 0;
+uint64_t g_irq_raised_ns[NUM_IRQS];
+bool g_irq_masked = false;
+bool g_in_handler = false;
+
+DMXSim::WireMonitor g_monitor = nullptr;
+void* g_monitor_data = nullptr;
+DMXSim::Stats g_stats;
+
+// Erased flash reads as 0xFF; SMs know their own position
+struct SimInit {
+    SimInit() {
+        memset(dmx_sim_flash, 0xFF, sizeof(dmx_sim_flash));
+        for (uint i = 0; i < NUM_PIOS * NUM_PIO_STATE_MACHINES; i++) {
+            g_pio[i / NUM_PIO_STATE_MACHINES].sm[i % NUM_PIO_STATE_MACHINES].index = (uint8_t)i;
+        }
+    }
+} g_sim_init;
+
+[[noreturn]] void simPanic(const char* message) {
+    fprintf(stderr, "dmx_sim: %s\n", message);
+    abort();
+}
+
+uint64_t cycleNs(const StateMachine& sm) {
+    uint64_t div256 = ((uint64_t)sm.config.clkdiv_int << 8) | sm.config.clkdiv_frac;
+    if (sm.config.clkdiv_int == 0) {
+        div256 = 65536ull << 8;
+    }
+    return div256 * 1000000000ull / (256ull * SIM_SYS_CLOCK_HZ);
+}
+
+uint8_t txDepth(const StateMachine& sm) {
+    return sm.config.fifo_join == PIO_FIFO_JOIN_TX ? 8 : (sm.config.fifo_join == PIO_FIFO_JOIN_RX ? 0 : 4);
+}
+
+uint8_t rxDepth(const StateMachine& sm) {
+    return sm.config.fifo_join == PIO_FIFO_JOIN_RX ? 8 : (sm.config.fifo_join == PIO_FIFO_JOIN_TX ? 0 : 4);
+}
+
+StateMachine& smOf(PIO pio, uint sm) {
+    return g_pio[pio_get_index(pio)].sm[sm];
+}
+
+bool isInput(ProgramKind kind) {
+    return kind == PROGRAM_DMX_INPUT || kind == PROGRAM_DMX_INPUT_INVERTED;
+}
+
+uint rxByteLoopOffset(ProgramKind kind) {
+    return kind == PROGRAM_DMX_INPUT ? DmxInput_wrap_target : DmxInputInverted_wrap_target;
+}
+
+// IRQs
+
+void raiseIrq(uint num) {
+    uint32_t bit = 1u << num;
+    if (!(g_irq_pending & bit)) {
+        g_irq_pending |= bit;
+        g_irq_raised_ns[num] = g_now_ns;
+    }
+}
+
+void dispatchIrqs() {
+    if (g_irq_masked || g_in_handler) {
+        return;
+    }
+    for (int dispatched = 0; dispatched < SIM_MAX_IRQ_DISPATCH; dispatched++) {
+        uint32_t ready = g_irq_pending & g_irq_enabled;
+        if (ready == 0) {
+            break;
+        }
+        uint num = (uint)__builtin_ctz(ready);
+        g_irq_pending &= ~(1u << num);
+
+        uint32_t latency_ns = (uint32_t)(g_now_ns - g_irq_raised_ns[num]);
+        if (latency_ns > g_stats.max_irq_latency_ns) {
+            g_stats.max_irq_latency_ns = latency_ns;
+        }
+        g_stats.irqs_dispatched++;
+
+        if (g_irq_handlers[num] != nullptr) {
+            g_in_handler = true;
+            g_irq_handlers[num]();
+            g_in_handler = false;
+        }
+
+        // DMA interrupt lines stay asserted until their status bits are cleared
+        if ((num == DMA_IRQ_0 && dma_hw->ints0 != 0) || (num == DMA_IRQ_1 && dma_hw->ints1 != 0)) {
+            raiseIrq(num);
+        }
+    }
+}
+
+// DMA
+
+bool resolveFifo(uintptr_t addr, StateMachine** sm, bool* is_tx) {
+    for (uint p = 0; p < NUM_PIOS; p++) {
+        for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+            if (addr == (uintptr_t)&dmx_sim_pio_hw[p].txf[s] || addr == (uintptr_t)&dmx_sim_pio_hw[p].rxf[s]) {
+                *sm = &g_pio[p].sm[s];
+                *is_tx = addr == (uintptr_t)&dmx_sim_pio_hw[p].txf[s];
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool dreqActive(uint dreq) {
+    if (dreq == DREQ_FORCE) {
+        return true;
+    }
+    if (dreq >= NUM_PIOS * 8) {
+        return false;
+    }
+    const StateMachine& sm = g_pio[dreq / 8].sm[dreq % 4];
+    if ((dreq % 8) < 4) {
+        return sm.tx.count < txDepth(sm);
+    }
+    return sm.rx.count > 0;
+}
+
+void startChannel(uint channel);
+
+void completeChannel(uint channel) {
+    DmaChannel& dma = g_dma[channel];
+    dma.busy = false;
+    g_stats.dma_completions++;
+
+    uint32_t bit = 1u << channel;
+    if (!dma.config.irq_quiet) {
+        if (dma_hw->inte0 & bit) {
+            dma_hw->ints0.value |= bit;
+            raiseIrq(DMA_IRQ_0);
+        }
+        if (dma_hw->inte1 & bit) {
+            dma_hw->ints1.value |= bit;
+            raiseIrq(DMA_IRQ_1);
+        }
+    }
+    if (dma.config.chain_to != channel) {
+        startChannel(dma.config.chain_to);
+    }
+}
+
+// The sniffer's CRC-32 (polynomial 0x04C11DB7, MSB first) over one transfer,
+// least significant byte first; CRC32R takes each byte's bits reversed
+void sniff(uint channel, uint32_t value, uint size) {
+    uint32_t ctrl = dma_hw->sniff_ctrl;
+    if (!(ctrl & 1u) || ((ctrl >> 1) & 0xF) != channel || !g_dma[channel].config.sniff_enable) {
+        return;
+    }
+    uint calc = (ctrl >> 5) & 0xF;
+    uint32_t crc = dma_hw->sniff_data.value;
+    for (uint b = 0; b < size; b++) {
+        uint8_t byte = (uint8_t)(value >> (8 * b));
+        for (int i = 0; i < 8; i++) {
+            uint bit = calc == DMA_SNIFF_CTRL_CALC_VALUE_CRC32R ? (byte >> i) & 1u : (byte >> (7 - i)) & 1u;
+            bool xor_in = ((crc >> 31) ^ bit) != 0;
+            crc <<= 1;
+            if (xor_in) {
+                crc ^= 0x04C11DB7u;
+            }
+        }
+    }
+    dma_hw->sniff_data.value = crc;
+}
+
+// Move as many elements as the DREQ allows; returns true if anything moved
+bool serviceChannel(uint channel) {
+    DmaChannel& dma = g_dma[channel];
+    dma_channel_hw_t& hw = dma_hw->ch[channel];
+    uint size = 1u << dma.config.data_size;
+    bool moved = false;
+
+    while (dma.busy && hw.transfer_count > 0 && dreqActive(dma.config.dreq)) {
+        StateMachine* sm;
+        bool is_tx;
+
+        uint32_t value = 0;
+        if (resolveFifo(hw.read_addr, &sm, &is_tx)) {
+            value = (!is_tx && sm->rx.count > 0) ? sm->rx.pop().value : 0;
+        } else {
+            memcpy(&value, (const void*)hw.read_addr, size);
+        }
+        sniff(channel, value, size);
+
+        if (resolveFifo(hw.write_addr, &sm, &is_tx)) {
+            // Narrow writes are replicated across the 32-bit bus
+            if (size == 1) {
+                value = (value & 0xFF) * 0x01010101u;
+            } else if (size == 2) {
+                value = (value & 0xFFFF) * 0x00010001u;
+            }
+            if (is_tx && sm->tx.count < txDepth(*sm)) {
+                sm->tx.push(value, g_now_ns);
+            }
+        } else {
+            memcpy((void*)hw.write_addr, &value, size);
+        }
+
+        if (dma.config.read_increment) {
+            hw.read_addr += size;
+        }
+        if (dma.config.write_increment) {
+            hw.write_addr += size;
+        }
+        hw.transfer_count--;
+        moved = true;
+    }
+
+    if (dma.busy && hw.transfer_count == 0) {
+        completeChannel(channel);
+        moved = true;
+    }
+    return moved;
+}
+
+void serviceDma() {
+    bool moved = true;
+    while (moved) {
+        moved = false;
+        for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+            if (g_dma[i].busy && serviceChannel(i)) {
+                moved = true;
+            }
+        }
+    }
+}
+
+void startChannel(uint channel) {
+    g_dma[channel].busy = true;
+    dma_hw->ch[channel].transfer_count = g_dma[channel].reload_count;
+    serviceDma();
+}
+
+// Wires
+
+void rxSymbol(StateMachine& sm, const DMXSim::Symbol& symbol) {
+    if (symbol.type == DMXSim::SYMBOL_BREAK && sm.phase == PHASE_RX_WAIT_BREAK) {
+        if (symbol.duration_ns >= RX_BREAK_CYCLES * cycleNs(sm)) {
+            sm.phase = PHASE_RX_RECEIVING;
+        }
+        return;
+    }
+    if (sm.phase != PHASE_RX_RECEIVING) {
+        return;
+    }
+
+    // In mid-frame a break reads as a byte: the falling edge looks like a start bit
+    if (sm.rx.count >= rxDepth(sm)) {
+        g_stats.rx_overflows++;
+        return;
+    }
+    sm.rx.push(symbol.value, symbol.end_ns);
+    g_stats.slots_received++;
+    serviceDma();
+}
+
+void deliverSymbol(uint gpio, const DMXSim::Symbol& symbol) {
+    if (symbol.type == DMXSim::SYMBOL_BREAK) {
+        g_stats.breaks_sent++;
+    } else {
+        g_stats.slots_sent++;
+    }
+    if (g_monitor != nullptr) {
+        g_monitor(gpio, symbol, g_monitor_data);
+    }
+
+    for (uint p = 0; p < NUM_PIOS; p++) {
+        for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+            StateMachine& sm = g_pio[p].sm[s];
+            if (!sm.enabled || !isInput(sm.kind)) {
+                continue;
+            }
+
+            bool routed = sm.config.in_base == gpio;
+            bool inverted = false;
+            for (uint w = 0; w < SIM_MAX_WIRES && !routed; w++) {
+                if (g_wires[w].used && g_wires[w].tx_gpio == gpio && g_wires[w].rx_gpio == sm.config.in_base) {
+                    routed = true;
+                    inverted = g_wires[w].inverted;
+                }
+            }
+
+            // A program of the wrong polarity never sees a valid break
+            if (routed && inverted == (sm.kind == PROGRAM_DMX_INPUT_INVERTED)) {
+                rxSymbol(sm, symbol);
+            }
+        }
+    }
+}
+
+// PIO state machines
+
+void startTx(StateMachine& sm, uint64_t time_ns) {
+    sm.at_start = false;
+    sm.phase = PHASE_TX_BREAK;
+    sm.phase_start_ns = time_ns;
+    sm.event_ns = time_ns + TX_BREAK_CYCLES * cycleNs(sm);
+}
+
+void runTx(StateMachine& sm, uint64_t time_ns) {
+    uint64_t cycle_ns = cycleNs(sm);
+    switch (sm.phase) {
+    case PHASE_TX_BREAK:
+        deliverSymbol(sm.config.out_base, {DMXSim::SYMBOL_BREAK, sm.break_value,
+                                           (uint32_t)(time_ns - sm.phase_start_ns), time_ns});
+        sm.break_value = 0;
+        sm.phase = PHASE_TX_PULL;
+        sm.stalled = false;
+        sm.event_ns = time_ns + TX_MAB_CYCLES * cycle_ns;
+        break;
+
+    case PHASE_TX_PULL: {
+        if (sm.tx.count == 0) {
+            // The line idles high; software sees the stall in FDEBUG.TXSTALL
+            dmx_sim_pio_hw[sm.index / NUM_PIO_STATE_MACHINES].fdebug.value |=
+                1u << (PIO_FDEBUG_TXSTALL_LSB + sm.index % NUM_PIO_STATE_MACHINES);
+            sm.stalled = true;
+            break;
+        }
+        FifoEntry entry = sm.tx.pop();
+        uint64_t pull_ns = sm.event_ns > entry.time_ns ? sm.event_ns : entry.time_ns;
+        sm.slot_value = (uint8_t)entry.value;
+        sm.phase = PHASE_TX_SLOT;
+        sm.phase_start_ns = pull_ns;
+        sm.event_ns = pull_ns + TX_SLOT_CYCLES * cycle_ns;
+        serviceDma();
+        break;
+    }
+
+    case PHASE_TX_SLOT:
+        deliverSymbol(sm.config.out_base, {DMXSim::SYMBOL_SLOT, sm.slot_value,
+                                           (uint32_t)(time_ns - sm.phase_start_ns), time_ns});
+        sm.phase = PHASE_TX_PULL;
+        sm.stalled = false;
+        sm.event_ns = time_ns;
+        break;
+
+    default:
+        break;
+    }
+}
+
+bool smEventNs(const StateMachine& sm, uint64_t* time_ns) {
+    if (!sm.enabled) {
+        return false;
+    }
+    switch (sm.phase) {
+    case PHASE_TX_BREAK:
+    case PHASE_TX_SLOT:
+        *time_ns = sm.event_ns;
+        return true;
+    case PHASE_TX_PULL:
+        if (sm.tx.count == 0) {
+            if (sm.stalled) {
+                return false;
+            }
+            *time_ns = sm.event_ns;
+            return true;
+        }
+        *time_ns = sm.event_ns > sm.tx.entries[sm.tx.head].time_ns ? sm.event_ns : sm.tx.entries[sm.tx.head].time_ns;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Event loop
+
+void setNow(uint64_t ns) {
+    g_now_ns = ns;
+    uint64_t us = ns / 1000;
+    timer_hw->timerawh = (uint32_t)(us >> 32);
+    timer_hw->timerawl = (uint32_t)us;
+}
+
+void advanceTo(uint64_t target_ns) {
+    while (true) {
+        uint64_t next_ns = UINT64_MAX;
+        StateMachine* next_sm = nullptr;
+        for (uint p = 0; p < NUM_PIOS; p++) {
+            for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+                uint64_t t;
+                if (smEventNs(g_pio[p].sm[s], &t) && t < next_ns) {
+                    next_ns = t;
+                    next_sm = &g_pio[p].sm[s];
+                }
+            }
+        }
+        if (!g_injected.empty() && g_injected.top().symbol.end_ns < next_ns) {
+            next_ns = g_injected.top().symbol.end_ns;
+            next_sm = nullptr;
+        }
+        if (next_ns > target_ns) {
+            break;
+        }
+
+        // Events that fell due inside an IRQ handler are caught up late
+        if (next_ns > g_now_ns) {
+            setNow(next_ns);
+        }
+        if (next_sm != nullptr) {
+            runTx(*next_sm, next_ns);
+        } else {
+            InjectedSymbol injected = g_injected.top();
+            g_injected.pop();
+            deliverSymbol(injected.gpio, injected.symbol);
+        }
+        dispatchIrqs();
+    }
+
+    if (target_ns > g_now_ns) {
+        setNow(target_ns);
+    }
+    dispatchIrqs();
+}
+
+void charge(uint64_t ns) {
+    advanceTo(g_now_ns + ns);
+}
+
+ProgramKind classifyProgram(const pio_program_t* program) {
+    const pio_program_t* known[] = {&DmxOutput_program, &DmxInput_program, &DmxInputInverted_program};
+    const ProgramKind kinds[] = {PROGRAM_DMX_OUTPUT, PROGRAM_DMX_INPUT, PROGRAM_DMX_INPUT_INVERTED};
+    for (uint i = 0; i < 3; i++) {
+        if (program->length == known[i]->length &&
+            memcmp(program->instructions, known[i]->instructions, program->length * sizeof(uint16_t)) == 0) {
+            return kinds[i];
+        }
+    }
+    return PROGRAM_NONE;
+}
+
+int findProgramSpace(PIO pio, const pio_program_t* program) {
+    const Pio& p = g_pio[pio_get_index(pio)];
+    uint32_t mask = (1u << program->length) - 1;
+    if (program->origin >= 0) {
+        return (p.used_mask & (mask << program->origin)) ? -1 : program->origin;
+    }
+    for (int offset = PIO_INSTRUCTION_COUNT - program->length; offset >= 0; offset--) {
+        if (!(p.used_mask & (mask << offset))) {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+// Simulator control
+
+uint64_t DMXSim::nowNs() {
+    return g_now_ns;
+}
+
+void DMXSim::advanceUs(uint64_t us) {
+    advanceTo(g_now_ns + us * 1000);
+}
+
+bool DMXSim::connect(uint tx_gpio, uint rx_gpio, bool inverted) {
+    if (tx_gpio >= NUM_BANK0_GPIOS || rx_gpio >= NUM_BANK0_GPIOS) {
+        return false;
+    }
+    Wire* free_wire = nullptr;
+    for (uint i = 0; i < SIM_MAX_WIRES; i++) {
+        if (g_wires[i].used && g_wires[i].tx_gpio == tx_gpio && g_wires[i].rx_gpio == rx_gpio) {
+            g_wires[i].inverted = inverted;
+            return true;
+        }
+        if (!g_wires[i].used && free_wire == nullptr) {
+            free_wire = &g_wires[i];
+        }
+    }
+    if (free_wire == nullptr) {
+        return false;
+    }
+    *free_wire = {true, (uint8_t)tx_gpio, (uint8_t)rx_gpio, inverted};
+    return true;
+}
+
+void DMXSim::disconnect(uint tx_gpio, uint rx_gpio) {
+    for (uint i = 0; i < SIM_MAX_WIRES; i++) {
+        if (g_wires[i].used && g_wires[i].tx_gpio == tx_gpio && g_wires[i].rx_gpio == rx_gpio) {
+            g_wires[i].used = false;
+        }
+    }
+}
+
+void DMXSim::setWireMonitor(WireMonitor monitor, void* user_data) {
+    g_monitor = monitor;
+    g_monitor_data = user_data;
+}
+
+bool DMXSim::injectFrame(uint gpio, const uint8_t* frame, uint16_t length,
+                         uint32_t break_us, uint32_t mab_us, uint32_t slot_us) {
+    if (gpio >= NUM_BANK0_GPIOS || frame == nullptr || length == 0) {
+        return false;
+    }
+
+    uint64_t t = g_inject_free_ns[gpio] > g_now_ns ? g_inject_free_ns[gpio] : g_now_ns;
+    t += (uint64_t)break_us * 1000;
+    g_injected.push({g_inject_seq++, (uint8_t)gpio, {SYMBOL_BREAK, 0, break_us * 1000, t}});
+    t += (uint64_t)mab_us * 1000;
+    for (uint16_t i = 0; i < length; i++) {
+        t += (uint64_t)slot_us * 1000;
+        g_injected.push({g_inject_seq++, (uint8_t)gpio, {SYMBOL_SLOT, frame[i], slot_us * 1000, t}});
+    }
+    g_inject_free_ns[gpio] = t;
+    return true;
+}
+
+bool DMXSim::injectSlots(uint gpio, const uint8_t* slots, uint16_t length, uint32_t slot_us) {
+    if (gpio >= NUM_BANK0_GPIOS || slots == nullptr || length == 0) {
+        return false;
+    }
+
+    uint64_t t = g_inject_free_ns[gpio] > g_now_ns ? g_inject_free_ns[gpio] : g_now_ns;
+    for (uint16_t i = 0; i < length; i++) {
+        t += (uint64_t)slot_us * 1000;
+        g_injected.push({g_inject_seq++, (uint8_t)gpio, {SYMBOL_SLOT, slots[i], slot_us * 1000, t}});
+    }
+    g_inject_free_ns[gpio] = t;
+    return true;
+}
+
+void DMXSim::injectIdle(uint gpio, uint32_t idle_us) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        uint64_t t = g_inject_free_ns[gpio] > g_now_ns ? g_inject_free_ns[gpio] : g_now_ns;
+        g_inject_free_ns[gpio] = t + (uint64_t)idle_us * 1000;
+    }
+}
+
+DMXSim::Stats DMXSim::getStats() {
+    return g_stats;
+}
+
+void DMXSim::resetStats() {
+    memset(&g_stats, 0, sizeof(g_stats));
+}
+
+// pico/time.h
+
+uint64_t time_us_64() {
+    charge(SIM_TIME_READ_NS);
+    return g_now_ns / 1000;
+}
+
+uint32_t time_us_32() {
+    return (uint32_t)time_us_64();
+}
+
+void sleep_us(uint64_t us) {
+    advanceTo(g_now_ns + us * 1000);
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000);
+}
+
+void sleep_until(absolute_time_t t) {
+    advanceTo(t * 1000);
+}
+
+void busy_wait_us(uint64_t us) {
+    sleep_us(us);
+}
+
+void busy_wait_us_32(uint32_t us) {
+    sleep_us(us);
+}
+
+void busy_wait_ms(uint32_t ms) {
+    sleep_ms(ms);
+}
+
+// pico/stdlib.h
+
+bool stdio_init_all() {
+    return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    // No host input is routed to the simulated CPU
+    sleep_us(timeout_us);
+    return PICO_ERROR_TIMEOUT;
+}
+
+int putchar_raw(int c) {
+    return putchar(c);
+}
+
+void tight_loop_contents() {
+    charge(SIM_LOOP_NS);
+}
+
+// hardware/sync.h
+
+uint32_t save_and_disable_interrupts() {
+    uint32_t status = g_irq_masked ? 1 : 0;
+    g_irq_masked = true;
+    return status;
+}
+
+void restore_interrupts(uint32_t status) {
+    g_irq_masked = status != 0;
+}
+
+// Sleep until the next simulated event, an interrupt or limit_ns
+static void waitForEvent(uint64_t limit_ns) {
+    if (g_irq_pending & g_irq_enabled) {
+        charge(SIM_REG_POLL_NS);
+        return;
+    }
+    uint64_t next_ns = limit_ns;
+    for (uint p = 0; p < NUM_PIOS; p++) {
+        for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+            uint64_t t;
+            if (smEventNs(g_pio[p].sm[s], &t) && t < next_ns) {
+                next_ns = t;
+            }
+        }
+    }
+    if (!g_injected.empty() && g_injected.top().symbol.end_ns < next_ns) {
+        next_ns = g_injected.top().symbol.end_ns;
+    }
+    advanceTo(next_ns > g_now_ns ? next_ns : g_now_ns + SIM_REG_POLL_NS);
+}
+
+void __wfe() {
+    waitForEvent(g_now_ns + SIM_WFE_MAX_NS);
+}
+
+void __wfi() {
+    __wfe();
+}
+
+void __sev() {
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t timeout_timestamp) {
+    if (time_reached(timeout_timestamp)) {
+        return true;
+    }
+    waitForEvent(timeout_timestamp * 1000);
+    return time_reached(timeout_timestamp);
+}
+
+// hardware/clocks.h
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    switch (clk_index) {
+    case clk_ref:
+        return 12000000;
+    case clk_usb:
+    case clk_adc:
+        return 48000000;
+    case clk_rtc:
+        return 46875;
+    default:
+        return SIM_SYS_CLOCK_HZ;
+    }
+}
+
+// hardware/irq.h
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    if (num >= NUM_IRQS) {
+        return;
+    }
+    if (g_irq_handlers[num] != nullptr && g_irq_handlers[num] != handler) {
+        simPanic("exclusive IRQ handler already set");
+    }
+    g_irq_handlers[num] = handler;
+}
+
+irq_handler_t irq_get_exclusive_handler(uint num) {
+    return num < NUM_IRQS ? g_irq_handlers[num] : nullptr;
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+    if (num < NUM_IRQS && g_irq_handlers[num] == handler) {
+        g_irq_handlers[num] = nullptr;
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    if (num >= NUM_IRQS) {
+        return;
+    }
+    if (enabled) {
+        g_irq_enabled |= 1u << num;
+    } else {
+        g_irq_enabled &= ~(1u << num);
+    }
+}
+
+bool irq_is_enabled(uint num) {
+    return num < NUM_IRQS && (g_irq_enabled & (1u << num));
+}
+
+void irq_set_priority(uint num, uint8_t hardware_priority) {
+    (void)num;
+    (void)hardware_priority;
+}
+
+void irq_set_pending(uint num) {
+    if (num < NUM_IRQS) {
+        raiseIrq(num);
+    }
+}
+
+// hardware/gpio.h
+
+void gpio_init(uint gpio) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        g_gpio_levels[gpio] = false;
+    }
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    (void)gpio;
+    (void)fn;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    (void)gpio;
+    (void)out;
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio < NUM_BANK0_GPIOS) {
+        g_gpio_levels[gpio] = value;
+    }
+}
+
+bool gpio_get(uint gpio) {
+    return gpio < NUM_BANK0_GPIOS && g_gpio_levels[gpio];
+}
+
+void gpio_pull_up(uint gpio) {
+    gpio_put(gpio, true);
+}
+
+void gpio_pull_down(uint gpio) {
+    gpio_put(gpio, false);
+}
+
+void gpio_disable_pulls(uint gpio) {
+    (void)gpio;
+}
+
+// hardware/flash.h
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (flash_offs % FLASH_SECTOR_SIZE != 0 || count % FLASH_SECTOR_SIZE != 0 ||
+        flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        simPanic("flash_range_erase outside the flash or not sector aligned");
+    }
+    memset(&dmx_sim_flash[flash_offs], 0xFF, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count) {
+    if (flash_offs % FLASH_PAGE_SIZE != 0 || count % FLASH_PAGE_SIZE != 0 ||
+        flash_offs + count > PICO_FLASH_SIZE_BYTES) {
+        simPanic("flash_range_program outside the flash or not page aligned");
+    }
+    // Programming can only clear bits
+    for (size_t i = 0; i < count; i++) {
+        dmx_sim_flash[flash_offs + i] &= data[i];
+    }
+}
+
+// hardware/pio.h
+
+bool pio_can_add_program(PIO pio, const pio_program_t* program) {
+    return findProgramSpace(pio, program) >= 0;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t* program) {
+    int offset = findProgramSpace(pio, program);
+    if (offset < 0) {
+        simPanic("no program space");
+    }
+
+    Pio& p = g_pio[pio_get_index(pio)];
+    for (uint i = 0; i < program->length; i++) {
+        uint16_t instr = program->instructions[i];
+        // JMP targets are relative to the program
+        p.instructions[offset + i] = (instr & 0xE000) == 0 ? (uint16_t)(instr + offset) : instr;
+    }
+    p.used_mask |= ((1u << program->length) - 1) << offset;
+    p.programs.push_back({(uint8_t)offset, program->length, classifyProgram(program)});
+    return (uint)offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t* program, uint loaded_offset) {
+    Pio& p = g_pio[pio_get_index(pio)];
+    p.used_mask &= ~(((1u << program->length) - 1) << loaded_offset);
+    for (size_t i = 0; i < p.programs.size(); i++) {
+        if (p.programs[i].offset == loaded_offset) {
+            p.programs.erase(p.programs.begin() + i);
+            break;
+        }
+    }
+}
+
+void pio_clear_instruction_memory(PIO pio) {
+    Pio& p = g_pio[pio_get_index(pio)];
+    p.used_mask = 0;
+    p.programs.clear();
+    memset(p.instructions, 0, sizeof(p.instructions));
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+    for (uint s = 0; s < NUM_PIO_STATE_MACHINES; s++) {
+        if (!smOf(pio, s).claimed) {
+            smOf(pio, s).claimed = true;
+            return (int)s;
+        }
+    }
+    if (required) {
+        simPanic("no PIO state machines are available");
+    }
+    return -1;
+}
+
+void pio_sm_claim(PIO pio, uint sm) {
+    if (smOf(pio, sm).claimed) {
+        simPanic("PIO state machine already claimed");
+    }
+    smOf(pio, sm).claimed = true;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) {
+    smOf(pio, sm).claimed = false;
+}
+
+bool pio_sm_is_claimed(PIO pio, uint sm) {
+    return smOf(pio, sm).claimed;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config* config) {
+    StateMachine& state = smOf(pio, sm);
+    state.enabled = false;
+    state.config = *config;
+    state.kind = PROGRAM_NONE;
+    state.program_offset = 0;
+    for (const LoadedProgram& program : g_pio[pio_get_index(pio)].programs) {
+        if (initial_pc >= program.offset && initial_pc < (uint)program.offset + program.length) {
+            state.kind = program.kind;
+            state.program_offset = program.offset;
+        }
+    }
+    state.tx.clear();
+    state.rx.clear();
+    state.break_value = 0;
+    state.disabled_ns = g_now_ns;
+    pio_sm_restart(pio, sm);
+    pio_sm_exec(pio, sm, pio_encode_jmp(initial_pc));
+}
+
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config* config) {
+    smOf(pio, sm).config = *config;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+    StateMachine& state = smOf(pio, sm);
+    if (enabled == state.enabled) {
+        return;
+    }
+    state.enabled = enabled;
+    if (!enabled) {
+        state.disabled_ns = g_now_ns;
+        return;
+    }
+
+    if (state.kind == PROGRAM_DMX_OUTPUT && state.at_start) {
+        startTx(state, g_now_ns);
+    } else if (state.phase == PHASE_TX_BREAK || state.phase == PHASE_TX_PULL || state.phase == PHASE_TX_SLOT) {
+        // Resume where the program stalled
+        uint64_t paused_ns = g_now_ns - state.disabled_ns;
+        state.event_ns += paused_ns;
+        state.phase_start_ns += paused_ns;
+    }
+    serviceDma();
+}
+
+void pio_sm_restart(PIO pio, uint sm) {
+    StateMachine& state = smOf(pio, sm);
+    if (state.kind != PROGRAM_DMX_OUTPUT) {
+        return;
+    }
+
+    // A slot cut off after its start bit is finished by the next break's zeros
+    if (state.phase == PHASE_TX_SLOT) {
+        uint64_t end_ns = state.enabled ? g_now_ns : state.disabled_ns;
+        uint64_t elapsed = (end_ns - state.phase_start_ns) / cycleNs(state);
+        if (elapsed > 8) {
+            uint bits = elapsed >= 14 ? (uint)((elapsed - 14) / 4 + 1) : 0;
+            state.break_value = bits >= 8 ? state.slot_value : (uint8_t)(state.slot_value & ((1u << bits) - 1));
+        }
+    }
+    state.phase = PHASE_IDLE;
+}
+
+void pio_sm_exec(PIO pio, uint sm, uint instr) {
+    StateMachine& state = smOf(pio, sm);
+    // Only unconditional jumps are modelled
+    if ((instr & 0xE0E0) != 0) {
+        return;
+    }
+
+    uint addr = instr & 0x1f;
+    state.at_start = state.kind != PROGRAM_NONE && addr == state.program_offset;
+    if (isInput(state.kind) && addr == state.program_offset + rxByteLoopOffset(state.kind)) {
+        // Past the break detector: every start bit is a byte
+        state.phase = PHASE_RX_RECEIVING;
+    } else if (state.kind == PROGRAM_DMX_OUTPUT && addr == state.program_offset + (uint)DmxOutput_wrap_target) {
+        // Slots without a break (e.g. an RDM discovery response)
+        state.phase = PHASE_TX_PULL;
+        state.stalled = false;
+        state.event_ns = state.enabled ? g_now_ns : state.disabled_ns;
+    } else if (!state.at_start) {
+        state.phase = PHASE_IDLE;
+    } else if (isInput(state.kind)) {
+        state.phase = PHASE_RX_WAIT_BREAK;
+    } else if (state.enabled) {
+        startTx(state, g_now_ns);
+    } else {
+        state.phase = PHASE_IDLE;
+    }
+}
+
+void pio_sm_set_clkdiv_int_frac(PIO pio, uint sm, uint16_t div_int, uint8_t div_frac) {
+    sm_config_set_clkdiv_int_frac(&smOf(pio, sm).config, div_int, div_frac);
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+    gpio_set_function(pin, pio_get_index(pio) == 0 ? GPIO_FUNC_PIO0 : GPIO_FUNC_PIO1);
+}
+
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t pin_values, uint32_t pin_mask) {
+    (void)pio;
+    (void)sm;
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (pin_mask & (1u << gpio)) {
+            g_gpio_levels[gpio] = (pin_values >> gpio) & 1;
+        }
+    }
+}
+
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t pin_dirs, uint32_t pin_mask) {
+    (void)pio;
+    (void)sm;
+    (void)pin_dirs;
+    (void)pin_mask;
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+    (void)pio;
+    (void)sm;
+    (void)pin_base;
+    (void)pin_count;
+    (void)is_out;
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) {
+    charge(SIM_REG_POLL_NS);
+    return smOf(pio, sm).tx.count == 0;
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) {
+    charge(SIM_REG_POLL_NS);
+    return smOf(pio, sm).tx.count >= txDepth(smOf(pio, sm));
+}
+
+uint pio_sm_get_tx_fifo_level(PIO pio, uint sm) {
+    charge(SIM_REG_POLL_NS);
+    return smOf(pio, sm).tx.count;
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) {
+    charge(SIM_REG_POLL_NS);
+    return smOf(pio, sm).rx.count == 0;
+}
+
+bool pio_sm_is_rx_fifo_full(PIO pio, uint sm) {
+    charge(SIM_REG_POLL_NS);
+    return smOf(pio, sm).rx.count >= rxDepth(smOf(pio, sm));
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm) {
+    charge(SIM_REG_POLL_NS);
+    return smOf(pio, sm).rx.count;
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm) {
+    smOf(pio, sm).tx.clear();
+    smOf(pio, sm).rx.clear();
+    serviceDma();
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data) {
+    StateMachine& state = smOf(pio, sm);
+    if (state.tx.count < txDepth(state)) {
+        state.tx.push(data, g_now_ns);
+    }
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    while (pio_sm_is_tx_fifo_full(pio, sm)) {
+        tight_loop_contents();
+    }
+    pio_sm_put(pio, sm, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm) {
+    StateMachine& state = smOf(pio, sm);
+    uint32_t value = state.rx.count > 0 ? state.rx.pop().value : 0;
+    serviceDma();
+    return value;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm) {
+    while (pio_sm_is_rx_fifo_empty(pio, sm)) {
+        tight_loop_contents();
+    }
+    return pio_sm_get(pio, sm);
+}
+
+// hardware/dma.h
+
+void dma_channel_claim(uint channel) {
+    if (g_dma[channel].claimed) {
+        simPanic("DMA channel already claimed");
+    }
+    g_dma[channel].claimed = true;
+}
+
+int dma_claim_unused_channel(bool required) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (!g_dma[i].claimed) {
+            g_dma[i].claimed = true;
+            return (int)i;
+        }
+    }
+    if (required) {
+        simPanic("no DMA channels are available");
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+    g_dma[channel].claimed = false;
+}
+
+bool dma_channel_is_claimed(uint channel) {
+    return g_dma[channel].claimed;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    dma_channel_config c;
+    c.data_size = DMA_SIZE_32;
+    c.read_increment = true;
+    c.write_increment = false;
+    c.dreq = DREQ_FORCE;
+    c.chain_to = channel;
+    c.irq_quiet = false;
+    c.enable = true;
+    c.sniff_enable = false;
+    return c;
+}
+
+dma_channel_config dma_get_channel_config(uint channel) {
+    return g_dma[channel].config;
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config* config, bool trigger) {
+    g_dma[channel].config = *config;
+    if (trigger) {
+        startChannel(channel);
+    }
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void* read_addr, bool trigger) {
+    dma_hw->ch[channel].read_addr = (uintptr_t)read_addr;
+    if (trigger) {
+        startChannel(channel);
+    }
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void* write_addr, bool trigger) {
+    dma_hw->ch[channel].write_addr = (uintptr_t)write_addr;
+    if (trigger) {
+        startChannel(channel);
+    }
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger) {
+    g_dma[channel].reload_count = trans_count;
+    if (trigger) {
+        startChannel(channel);
+    }
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger) {
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, false);
+    dma_channel_set_config(channel, config, trigger);
+}
+
+void dma_channel_start(uint channel) {
+    startChannel(channel);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void* read_addr, uint32_t transfer_count) {
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, true);
+}
+
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void* write_addr, uint32_t transfer_count) {
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, true);
+}
+
+bool dma_channel_is_busy(uint channel) {
+    charge(SIM_REG_POLL_NS);
+    return g_dma[channel].busy;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    while (dma_channel_is_busy(channel)) {
+        tight_loop_contents();
+    }
+}
+
+void dma_channel_abort(uint channel) {
+    g_dma[channel].busy = false;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+    if (enabled) {
+        dma_hw->inte0 |= 1u << channel;
+    } else {
+        dma_hw->inte0 &= ~(1u << channel);
+    }
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+    if (enabled) {
+        dma_hw->inte1 |= 1u << channel;
+    } else {
+        dma_hw->inte1 &= ~(1u << channel);
+    }
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+    return dma_hw->ints0 & (1u << channel);
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+    dma_hw->ints0 = 1u << channel;
+}
+
+void dma_sniffer_enable(uint channel, uint mode, bool force_channel_enable) {
+    if (mode != DMA_SNIFF_CTRL_CALC_VALUE_CRC32 && mode != DMA_SNIFF_CTRL_CALC_VALUE_CRC32R) {
+        simPanic("DMA sniffer mode not modelled");
+    }
+    dma_hw->sniff_ctrl = 1u | (channel << 1) | (mode << 5);
+    if (force_channel_enable) {
+        g_dma[channel].config.sniff_enable = true;
+    }
+}
+
+void dma_sniffer_disable() {
+    dma_hw->sniff_ctrl = 0;
+}
@@ -0,0 +1,194 @@
+#include "dmx_waveform_gen.h"
+#include <algorithm>
+#include <cstdio>
+
+// DMXSampleStream
+
+DMXSampleStream::DMXSampleStream() {
+    clear(0);
+}
+
+void DMXSampleStream::clear(uint32_t sample_hz) {
+    _sample_hz = sample_hz;
+    _count = 0;
+    _bytes.clear();
+}
+
+void DMXSampleStream::push(bool level) {
+    if ((_count & 7) == 0) {
+        _bytes.push_back(0);
+    }
+    if (level) {
+        _bytes.back() |= (uint8_t)(1u << (_count & 7));
+    }
+    _count++;
+}
+
+bool DMXSampleStream::get(uint64_t index) const {
+    return (_bytes[index >> 3] >> (index & 7)) & 1;
+}
+
+uint64_t DMXSampleStream::size() const {
+    return _count;
+}
+
+uint32_t DMXSampleStream::getSampleHz() const {
+    return _sample_hz;
+}
+
+const std::vector<uint8_t>& DMXSampleStream::getBytes() const {
+    return _bytes;
+}
+
+// DMXWaveformGen
+
+DMXWaveformGen::Timing DMXWaveformGen::nominal() {
+    Timing timing;
+    timing.break_ns = 176000;
+    timing.mab_ns = 12000;
+    timing.bit_ns = 4000;
+    timing.stop_bits = 2;
+    timing.slot_gap_ns = 0;
+    timing.frame_gap_ns = 100000;
+    timing.jitter_ns = 0;
+    return timing;
+}
+
+DMXWaveformGen::DMXWaveformGen(DMXWaveform* wave, uint32_t seed, bool inverted)
+    : _wave(wave), _rng(seed ? seed : 1), _inverted(inverted) {
+}
+
+uint32_t DMXWaveformGen::random() {
+    // xorshift32: reproducible for a given seed
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return _rng;
+}
+
+uint32_t DMXWaveformGen::jitter(uint32_t duration_ns, uint32_t jitter_ns) {
+    if (jitter_ns == 0 || duration_ns == 0) {
+        return duration_ns;
+    }
+    int64_t result = (int64_t)duration_ns + (int64_t)(random() % (2 * jitter_ns + 1)) - jitter_ns;
+    return result < 1 ? 1 : (uint32_t)result;
+}
+
+void DMXWaveformGen::mark(uint32_t duration_ns, uint32_t jitter_ns) {
+    _wave->append(!_inverted, jitter(duration_ns, jitter_ns));
+}
+
+void DMXWaveformGen::space(uint32_t duration_ns, uint32_t jitter_ns) {
+    _wave->append(_inverted, jitter(duration_ns, jitter_ns));
+}
+
+void DMXWaveformGen::breakAndMab(const Timing& timing) {
+    space(timing.break_ns, timing.jitter_ns);
+    mark(timing.mab_ns, timing.jitter_ns);
+}
+
+void DMXWaveformGen::slot(uint8_t value, const Timing& timing, bool framing_error) {
+    space(timing.bit_ns, timing.jitter_ns);
+    for (int bit = 0; bit < 8; bit++) {
+        if ((value >> bit) & 1) {
+            mark(timing.bit_ns, timing.jitter_ns);
+        } else {
+            space(timing.bit_ns, timing.jitter_ns);
+        }
+    }
+    for (uint8_t stop = 0; stop < timing.stop_bits; stop++) {
+        if (framing_error && stop == 0) {
+            space(timing.bit_ns, timing.jitter_ns);
+        } else {
+            mark(timing.bit_ns, timing.jitter_ns);
+        }
+    }
+    if (timing.slot_gap_ns) {
+        mark(timing.slot_gap_ns, timing.jitter_ns);
+    }
+}
+
+void DMXWaveformGen::frame(const uint8_t* data, uint16_t length, const Timing& timing, int framing_error_slot) {
+    breakAndMab(timing);
+    for (uint16_t i = 0; i < length; i++) {
+        slot(data[i], timing, (int)i == framing_error_slot);
+    }
+    if (timing.frame_gap_ns) {
+        mark(timing.frame_gap_ns, timing.jitter_ns);
+    }
+}
+
+uint64_t DMXWaveformGen::nowNs() const {
+    return _wave->getEndNs();
+}
+
+DMXWaveform DMXWaveformGen::withGlitch(const DMXWaveform& wave, uint64_t at_ns, uint32_t width_ns) {
+    // Every edge toggles the level, so two more edges invert the span
+    // between them; coinciding edges cancel
+    std::vector<uint64_t> edges;
+    edges.reserve(wave.getNumEdges() + 2);
+    for (size_t i = 0; i < wave.getNumEdges(); i++) {
+        edges.push_back(wave.getEdgeNs(i));
+    }
+    edges.push_back(at_ns);
+    edges.push_back(at_ns + width_ns);
+    std::sort(edges.begin(), edges.end());
+
+    DMXWaveform result(wave.getInitialLevel());
+    bool level = wave.getInitialLevel();
+    for (size_t i = 0; i < edges.size(); i++) {
+        level = !level;
+        result.set(edges[i], level);
+    }
+    result.set(std::max(wave.getEndNs(), at_ns + width_ns), level);
+    return result;
+}
+
+DMXWaveform DMXWaveformGen::withNoise(const DMXWaveform& wave, uint64_t from_ns, uint64_t to_ns, uint32_t count,
+                                      uint32_t max_width_ns, uint32_t seed) {
+    DMXWaveform result = wave;
+    DMXWaveformGen rng(nullptr, seed);
+    for (uint32_t i = 0; i < count && to_ns > from_ns; i++) {
+        uint64_t at_ns = from_ns + (((uint64_t)rng.random() << 32) | rng.random()) % (to_ns - from_ns);
+        uint32_t width_ns = 1 + rng.random() % (max_width_ns ? max_width_ns : 1);
+        result = withGlitch(result, at_ns, width_ns);
+    }
+    return result;
+}
+
+void DMXWaveformGen::sample(const DMXWaveform& wave, uint32_t sample_hz, DMXSampleStream* samples,
+                            uint32_t flip_ppm, uint32_t seed) {
+    samples->clear(sample_hz);
+    DMXWaveformGen rng(nullptr, seed);
+    bool level = wave.getInitialLevel();
+    size_t edge = 0;
+    for (uint64_t index = 0;; index++) {
+        uint64_t time_ns = index * 1000000000ull / sample_hz;
+        if (time_ns > wave.getEndNs()) {
+            break;
+        }
+        while (edge < wave.getNumEdges() && wave.getEdgeNs(edge) <= time_ns) {
+            level = !level;
+            edge++;
+        }
+        bool flip = flip_ppm && rng.random() % 1000000 < flip_ppm;
+        samples->push(level != flip);
+    }
+}
+
+bool DMXWaveformGen::writeVcd(const DMXWaveform& wave, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "$timescale 1ns $end\n$scope module gen $end\n$var wire 1 ! dmx $end\n$upscope $end\n$enddefinitions $end\n");
+    bool level = wave.getInitialLevel();
+    fprintf(file, "#0\n%d!\n", level ? 1 : 0);
+    for (size_t i = 0; i < wave.getNumEdges(); i++) {
+        level = !level;
+        fprintf(file, "#%llu\n%d!\n", (unsigned long long)wave.getEdgeNs(i), level ? 1 : 0);
+    }
+    fprintf(file, "#%llu\n", (unsigned long long)wave.getEndNs());
+    fclose(file);
+    return true;
+}
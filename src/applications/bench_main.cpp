@@ -0,0 +1,349 @@
+#include "pico/stdlib.h"
+#include "dmx_bench.h"
+#include "dmx_transmitter.h"
+#include "dmx_receiver.h"
+#include "dmx_multi_receiver.h"
+#include "dmx_patch.h"
+#include "dmx_fade_engine.h"
+#include "dmx_effects.h"
+#include "dmx_config.h"
+#include "dmx_load.h"
+#include "dmx_frame_crc.h"
+#include "dmx_output_space.h"
+#include "dmx_color.h"
+#include <cstdio>
+#include <cmath>
+
+// Microbenchmarks of the library's hot paths (see include/dmx_bench.h)
+//
+// On the Pico the suite runs every RERUN_INTERVAL_MS and prints one JSON
+// document per run on USB serial; on the host (DMX_HOST_BUILD) it runs once:
+//   ./build-host/dmx_bench > bench.json
+//
+// Receivers use GPIO 1-2 on pio0 and the transmitter GPIO 10 on pio1; no DMX
+// signal is needed, the receive paths are driven directly.
+
+#define RX_MULTI_GPIO 1
+#define RX_SINGLE_GPIO 2
+#define TX_GPIO 10
+#define BENCH_UNIVERSES 4
+#define RERUN_INTERVAL_MS 10000
+#define COLOR_FIXTURES 128
+
+static DMXTransmitter* transmitter;
+static DMXTransmitter outputs[MAX_DMX_UNIVERSES] = {
+    DMXTransmitter(11, pio1), DMXTransmitter(12, pio1), DMXTransmitter(13, pio1), DMXTransmitter(14, pio1),
+    DMXTransmitter(15, pio1), DMXTransmitter(16, pio1), DMXTransmitter(17, pio1), DMXTransmitter(18, pio1)
+};
+static DMXReceiver* receiver;
+static DMXMultiReceiver* multi_rx;
+static DMXPatch patch;
+static DMXPatch patch_full;             // All 8x512 output slots, 8 runs
+static DMXPatch patch_fragmented;       // All 8x512 output slots, 256 16-slot runs
+static DMXFadeEngine fade_engine;
+static DMXOutputSpace output_space;
+static DMXColorMixer color_mixer;
+
+static uint8_t universe[DMX_UNIVERSE_SIZE];
+static uint8_t rx_buffer[DMX_UNIVERSE_SIZE];
+static uint8_t space_source[DMX_SPACE_SIZE];
+static uint32_t fade_now_ms;
+static uint8_t color_input[COLOR_FIXTURES * 3];
+static uint16_t color_kelvin[COLOR_FIXTURES];
+static uint8_t color_slots[COLOR_FIXTURES * 5];
+
+static void benchSetChannel(void*) {
+    for (uint16_t channel = 1; channel <= DMX_UNIVERSE_SIZE; channel++) {
+        transmitter->setChannel(channel, (uint8_t)channel);
+    }
+}
+
+static void benchSetChannelRange(void*) {
+    transmitter->setChannelRange(1, universe, DMX_UNIVERSE_SIZE);
+}
+
+static void benchSetUniverse(void*) {
+    transmitter->setUniverse(universe, DMX_UNIVERSE_SIZE);
+}
+
+// All 8 universes through the flat address space, then into the outputs
+static void benchSpaceSet(void*) {
+    for (uint16_t address = 0; address < DMX_SPACE_SIZE; address++) {
+        output_space.set(address, (uint8_t)address);
+    }
+}
+
+// A span held across frames: plain stores, then one commit()
+static void benchSpaceSpan(void*) {
+    static DMXSlotSpan all = output_space.span(0, DMX_SPACE_SIZE);
+    for (uint16_t i = 0; i < DMX_SPACE_SIZE; i++) {
+        all[i] = (uint8_t)i;
+    }
+    all.commit();
+}
+
+static void benchSpaceWrite(void*) {
+    output_space.write(0, space_source, DMX_SPACE_SIZE);
+}
+
+static void benchSpaceFlush(void*) {
+    output_space.markAllDirty();
+    output_space.flush(outputs, MAX_DMX_UNIVERSES);
+}
+
+// The outputs are not running, so this is the one copy per dirty universe
+static void benchSpaceTransmit(void*) {
+    output_space.markAllDirty();
+    output_space.transmit(outputs, MAX_DMX_UNIVERSES);
+}
+
+static void benchReceiverCopy(void*) {
+    receiver->handleDataReceived();
+}
+
+static void benchUpdateStats(void*) {
+    multi_rx->getUniverseStats(0);
+}
+
+static void benchApplyConfiguration(void*) {
+    applyDMXConfiguration(outputs, MAX_DMX_UNIVERSES);
+}
+
+static void benchPatchApply(void*) {
+    const uint8_t* sources[1] = {universe};
+    patch.apply(sources, 1, outputs, BENCH_UNIVERSES);
+}
+
+// One frame of 8 input universes patched onto all 4096 output slots
+static void benchPatchFull(void*) {
+    const uint8_t* sources[MAX_DMX_UNIVERSES];
+    for (uint8_t u = 0; u < MAX_DMX_UNIVERSES; u++) {
+        sources[u] = &space_source[u * DMX_UNIVERSE_SIZE];
+    }
+    patch_full.apply(sources, MAX_DMX_UNIVERSES, outputs, MAX_DMX_UNIVERSES);
+}
+
+static void benchPatchFragmented(void*) {
+    const uint8_t* sources[MAX_DMX_UNIVERSES];
+    for (uint8_t u = 0; u < MAX_DMX_UNIVERSES; u++) {
+        sources[u] = &space_source[u * DMX_UNIVERSE_SIZE];
+    }
+    patch_fragmented.apply(sources, MAX_DMX_UNIVERSES, outputs, MAX_DMX_UNIVERSES);
+}
+
+// Every output slot fading, either as whole-universe fades sharing one
+// duration or with a different duration on every slot. Long enough never to
+// finish during the run
+static void startFades(bool mixed_durations) {
+    for (uint8_t u = 0; u < MAX_DMX_UNIVERSES; u++) {
+        for (uint16_t channel = 1; channel <= DMX_UNIVERSE_SIZE; channel++) {
+            uint32_t duration_ms = DMX_FADE_MAX_DURATION_MS - (mixed_durations ? channel * 997u : 0);
+            fade_engine.fadeTo(u, channel, universe[channel - 1], duration_ms);
+        }
+    }
+}
+
+static void benchFadeRender(void*) {
+    fade_engine.render(++fade_now_ms);
+}
+
+static void benchRainbow(void*) {
+    static const DMXFixtureRange range = {0, 1, 170, 3, 0};
+    DMXEffects::renderRainbow(universe, range, 0, 3, 255, 255);
+}
+
+static void benchSine(void*) {
+    static const DMXFixtureRange range = {0, 1, 170, 3, 0};
+    static const uint8_t white[3] = {255, 255, 255};
+    DMXEffects::renderSine(universe, range, 0, 3, white);
+}
+
+// Float references: the pattern code the examples used before the LUT
+// kernels, writing the same 170 RGB fixtures straight into the buffer
+static volatile float float_time = 1.25f;
+
+static void floatHsvToRgb(float h, float s, float v, uint8_t* rgb) {
+    float c = v * s;
+    float x = c * (1 - fabsf(fmodf(h / 60.0f, 2) - 1));
+    float m = v - c;
+    float r, g, b;
+    if (h < 60) {
+        r = c; g = x; b = 0;
+    } else if (h < 120) {
+        r = x; g = c; b = 0;
+    } else if (h < 180) {
+        r = 0; g = c; b = x;
+    } else if (h < 240) {
+        r = 0; g = x; b = c;
+    } else if (h < 300) {
+        r = x; g = 0; b = c;
+    } else {
+        r = c; g = 0; b = x;
+    }
+    rgb[0] = (uint8_t)((r + m) * 255);
+    rgb[1] = (uint8_t)((g + m) * 255);
+    rgb[2] = (uint8_t)((b + m) * 255);
+}
+
+static void benchRainbowFloat(void*) {
+    float time = float_time;
+    for (uint16_t fixture = 0; fixture < 170; fixture++) {
+        float hue = fmodf(time * 50.0f + fixture * 360.0f / 170, 360.0f);
+        floatHsvToRgb(hue, 1.0f, 1.0f, &universe[fixture * 3]);
+    }
+}
+
+static void benchSineFloat(void*) {
+    float time = float_time;
+    for (uint16_t fixture = 0; fixture < 170; fixture++) {
+        float phase = fixture * 2.0f * (float)M_PI / 170;
+        uint8_t value = (uint8_t)((sinf(time * 2.0f + phase) + 1.0f) / 2.0f * 255);
+        universe[fixture * 3] = value;
+        universe[fixture * 3 + 1] = value;
+        universe[fixture * 3 + 2] = value;
+    }
+}
+
+static void benchColorRgbw(void*) {
+    color_mixer.renderRgb(color_input, COLOR_FIXTURES, color_slots, DMXColorMixer::RGBW);
+}
+
+static void benchColorRgbaw(void*) {
+    color_mixer.renderRgb(color_input, COLOR_FIXTURES, color_slots, DMXColorMixer::RGBAW);
+}
+
+static void benchColorHsv(void*) {
+    color_mixer.renderHsv(color_input, COLOR_FIXTURES, color_slots, DMXColorMixer::RGB);
+}
+
+static void benchColorHsi(void*) {
+    color_mixer.renderHsi(color_input, COLOR_FIXTURES, color_slots, DMXColorMixer::RGBW);
+}
+
+static void benchColorCct(void*) {
+    color_mixer.renderCct(color_kelvin, color_input, COLOR_FIXTURES, color_slots, DMXColorMixer::TUNABLE_WHITE);
+}
+
+// The software fallback of change detection, start code + 512 slots
+static void benchFrameCrc(void*) {
+    static volatile uint32_t crc;
+    crc = DMXFrameCrc::compute(rx_buffer, DMX_UNIVERSE_SIZE);
+    crc = DMXFrameCrc::update(crc, universe, 1);
+}
+
+// The cost DMX_LOAD adds to every IRQ and callback (nothing with it off)
+static void benchLoadSwitch(void*) {
+    DMX_LOAD_ENTER(load_context, DMX_LOAD_RX_IRQ);
+    DMX_LOAD_LEAVE(load_context);
+}
+
+static void runSuite() {
+    DMXBench::begin("dmx_bench");
+    DMXBench::run("transmitter->setChannel x512", benchSetChannel, nullptr, DMX_UNIVERSE_SIZE);
+    DMXBench::run("transmitter->setChannelRange 512", benchSetChannelRange, nullptr, DMX_UNIVERSE_SIZE);
+    DMXBench::run("transmitter->setUniverse 512", benchSetUniverse, nullptr, DMX_UNIVERSE_SIZE);
+    DMXBench::run("output_space.set x4096", benchSpaceSet, nullptr, DMX_SPACE_SIZE);
+    DMXBench::run("output_space span[] x4096 + commit", benchSpaceSpan, nullptr, DMX_SPACE_SIZE);
+    DMXBench::run("output_space.write 4096", benchSpaceWrite, nullptr, DMX_SPACE_SIZE);
+    DMXBench::run("output_space.flush 8 dirty", benchSpaceFlush, nullptr, DMX_SPACE_SIZE);
+    DMXBench::run("output_space.transmit 8 dirty", benchSpaceTransmit, nullptr, DMX_SPACE_SIZE);
+    DMXBench::run("receiver.handleDataReceived 512", benchReceiverCopy, nullptr, DMX_UNIVERSE_SIZE);
+    DMXBench::run("multi_receiver.updateStats", benchUpdateStats, nullptr, DMX_UNIVERSE_SIZE);
+    DMXBench::run("config.applyDMXConfiguration x8", benchApplyConfiguration, nullptr,
+                  MAX_DMX_UNIVERSES * DMX_UNIVERSE_SIZE);
+    DMXBench::run("patch.apply 1->4 universes", benchPatchApply, nullptr, patch.getNumPatchedSlots());
+    DMXBench::run("patch.apply 4096 slots, 8 runs", benchPatchFull, nullptr, patch_full.getNumPatchedSlots());
+    DMXBench::run("patch.apply 4096 slots, 256 runs", benchPatchFragmented, nullptr,
+                  patch_fragmented.getNumPatchedSlots());
+    startFades(false);
+    DMXBench::run("fade.render 8x512 active", benchFadeRender, nullptr, DMX_SPACE_SIZE);
+    startFades(true);
+    DMXBench::run("fade.render 8x512 active, mixed durations", benchFadeRender, nullptr, DMX_SPACE_SIZE);
+    DMXBench::run("effects.renderRainbow 170 RGB", benchRainbow, nullptr, 170 * 3);
+    DMXBench::run("float rainbow 170 RGB (reference)", benchRainbowFloat, nullptr, 170 * 3);
+    DMXBench::run("effects.renderSine 170 RGB", benchSine, nullptr, 170 * 3);
+    DMXBench::run("float sine 170 RGB (reference)", benchSineFloat, nullptr, 170 * 3);
+    DMXBench::run("color.renderRgb 128 RGBW", benchColorRgbw, nullptr, COLOR_FIXTURES * 4, COLOR_FIXTURES);
+    DMXBench::run("color.renderRgb 128 RGBAW", benchColorRgbaw, nullptr, COLOR_FIXTURES * 5, COLOR_FIXTURES);
+    DMXBench::run("color.renderHsv 128 RGB", benchColorHsv, nullptr, COLOR_FIXTURES * 3, COLOR_FIXTURES);
+    DMXBench::run("color.renderHsi 128 RGBW", benchColorHsi, nullptr, COLOR_FIXTURES * 4, COLOR_FIXTURES);
+    DMXBench::run("color.renderCct 128 tunable white", benchColorCct, nullptr, COLOR_FIXTURES * 2, COLOR_FIXTURES);
+    DMXBench::run("frame_crc.compute 513", benchFrameCrc, nullptr, DMX_UNIVERSE_SIZE + 1);
+    DMXBench::run("load.enter+leave", benchLoadSwitch, nullptr);
+    DMXBench::end();
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);
+
+    for (uint16_t i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+        universe[i] = (uint8_t)(i * 7);
+    }
+    for (uint16_t i = 0; i < DMX_SPACE_SIZE; i++) {
+        space_source[i] = (uint8_t)(i * 3);
+    }
+    output_space.begin(MAX_DMX_UNIVERSES);
+    for (uint16_t i = 0; i < COLOR_FIXTURES * 3; i++) {
+        color_input[i] = (uint8_t)(i * 37);
+    }
+    for (uint16_t i = 0; i < COLOR_FIXTURES; i++) {
+        color_kelvin[i] = (uint16_t)(2000 + i * 50);
+    }
+
+    // Never ended: the transmitter and receivers stay up for the life of the program
+    transmitter = new DMXTransmitter(TX_GPIO, pio1);
+    receiver = new DMXReceiver(RX_SINGLE_GPIO, 1, DMX_UNIVERSE_SIZE, pio0);
+    if (transmitter->begin() != DmxOutput::SUCCESS ||
+        receiver->begin(false) != DmxInput::SUCCESS || !receiver->startAsync(rx_buffer)) {
+        printf("{\"error\":\"failed to initialize transmitter or receiver\"}\n");
+        return 1;
+    }
+    multi_rx = new DMXMultiReceiver();
+    if (!multi_rx->begin(RX_MULTI_GPIO, 1)) {
+        printf("{\"error\":\"failed to initialize multi-universe receiver\"}\n");
+        return 1;
+    }
+
+    // The input universe fanned out to 4 outputs in 48-slot blocks
+    DMXPatch::PatchEntry entries[BENCH_UNIVERSES * 4];
+    uint16_t num_entries = 0;
+    for (uint8_t dst = 0; dst < BENCH_UNIVERSES; dst++) {
+        for (uint8_t block = 0; block < 4; block++) {
+            entries[num_entries++] = {0, (uint16_t)(1 + block * 128), dst, (uint16_t)(1 + block * 128 + 64), 48};
+        }
+    }
+    patch.compile(entries, num_entries);
+
+    // Every output slot patched: whole universes shifted by one, and the
+    // same slots as 16-slot blocks in reverse order, which cannot coalesce
+    DMXPatch::PatchEntry full[MAX_DMX_UNIVERSES];
+    static DMXPatch::PatchEntry fragmented[MAX_DMX_PATCH_RUNS];
+    const uint8_t blocks = DMX_UNIVERSE_SIZE / 16;
+    for (uint8_t dst = 0; dst < MAX_DMX_UNIVERSES; dst++) {
+        uint8_t src = (uint8_t)((dst + 1) % MAX_DMX_UNIVERSES);
+        full[dst] = {src, 1, dst, 1, DMX_UNIVERSE_SIZE};
+        for (uint8_t block = 0; block < blocks; block++) {
+            fragmented[dst * blocks + block] = {src, (uint16_t)(1 + (blocks - 1 - block) * 16), dst,
+                                                (uint16_t)(1 + block * 16), 16};
+        }
+    }
+    if (!patch_full.compile(full, MAX_DMX_UNIVERSES) ||
+        !patch_fragmented.compile(fragmented, MAX_DMX_UNIVERSES * blocks)) {
+        printf("{\"error\":\"failed to compile the 4096-slot patches\"}\n");
+        return 1;
+    }
+
+    fade_engine.begin(outputs, MAX_DMX_UNIVERSES, 0);
+
+    do {
+        // DMX_LOG records from the configuration case are never flushed, so
+        // stdout carries JSON only
+        runSuite();
+#if PICO_ON_DEVICE
+        sleep_ms(RERUN_INTERVAL_MS);
+#endif
+    } while (PICO_ON_DEVICE);
+
+    return 0;
+}
@@ -1,108 +1,47 @@
 #include "pico/stdlib.h"
 #include "dmx_multi_receiver.h"
-#include <stdio.h>
+#include "dmx_telemetry.h"
+#include "dmx_log.h"
+#include "dmx_profile.h"
+#include "dmx_load.h"
 
 // Multi-Universe DMX Receiver
 // Receives up to 8 parallel DMX universes on GPIO pins 1-8
 // Each universe is monitored independently with statistics
+//
+// After start-up the USB serial port carries binary telemetry instead of text:
+// view it with tools/dmx_telemetry_view.cpp (e.g. ./dmx_telemetry_view /dev/ttyACM0).
+// DMX_LOG messages are printed as text until then and travel as LOG records after.
 
 // Configuration
 #define NUM_UNIVERSES 8          // Number of universes to receive (1-8)
 #define GPIO_START_PIN 1         // Starting GPIO pin (pins 1-8)
-#define PRINT_INTERVAL_MS 5000   // Status print interval
-#define FULL_UNIVERSE_INTERVAL_MS 30000  // Full universe display interval
+#define UNIVERSE_UPDATE_INTERVAL_MS 100  // Universe diffs at most 10 times per second
+#define STATS_INTERVAL_MS 1000           // Stats and counters once per second
+#define SIGNAL_TIMEOUT_MS 3000
 
-// Global variables for monitoring
-static uint32_t last_status_print = 0;
-static uint32_t last_full_universe_print = 0;
-static bool first_frames_received[MAX_DMX_RECEIVERS] = {false};
+// Updated from the receive callback; everything else runs in the main loop
+static volatile uint32_t frames_received = 0;
 
-// Function to print universe data in organized format
-void printUniverse(DMXMultiReceiver* multi_rx, uint8_t universe_index) {
-    printf("\n╔════════════════════════════════════════════════════════════════════════════════════════════════╗\n");
-    printf("║                                    DMX UNIVERSE %d (GPIO %u)                                    ║\n", 
-           universe_index + 1, multi_rx->getGpioPin(universe_index));
-    printf("╠════════════════════════════════════════════════════════════════════════════════════════════════╣\n");
-    
-    // Print in groups of 16 channels per line for readability
-    for (uint16_t line_start = 0; line_start < 512; line_start += 16) {
-        printf("║ Ch%03d-%-3d: ", line_start + 1, line_start + 16);
-        
-        for (uint16_t i = 0; i < 16 && (line_start + i) < 512; i++) {
-            uint8_t value = multi_rx->getChannel(universe_index, line_start + i + 1);
-            
-            if (value == 0) {
-                printf("  0 ");
-            } else {
-                printf("%3d ", value);
-            }
-        }
-        
-        // Add padding for incomplete last line
-        if (line_start + 16 > 512) {
-            for (uint16_t pad = 512 - line_start; pad < 16; pad++) {
-                printf("    ");
-            }
-        }
-        
-        printf("║\n");
-        
-        // Add separator lines every 8 rows for better readability
-        if ((line_start + 16) % 128 == 0 && line_start + 16 < 512) {
-            printf("╠────────────────────────────────────────────────────────────────────────────────────────────────╣\n");
-        }
-    }
-    
-    printf("╚════════════════════════════════════════════════════════════════════════════════════════════════╝\n");
-}
-
-// Function to print compact universe summary
-void printUniverseSummary(DMXMultiReceiver* multi_rx, uint8_t universe_index) {
-    DMXMultiReceiver::UniverseStats stats = multi_rx->getUniverseStats(universe_index);
-    bool signal_present = multi_rx->isSignalPresent(universe_index, 3000);
-    
-    printf("Universe %d (GPIO %u): ", universe_index + 1, multi_rx->getGpioPin(universe_index));
-    
-    if (signal_present) {
-        printf("📡 ACTIVE - %lu frames, %u active ch, max %u@ch%u\n", 
-               stats.frames_received, stats.active_channels, 
-               stats.max_value, stats.max_value_channel);
-    } else {
-        printf("⚠️  NO SIGNAL - Last frame: %lu frames ago\n", stats.frames_received);
-    }
-}
-
-// Callback function called when new DMX data is received on any universe
-void onMultiUniverseDataReceived(DMXMultiReceiver* multi_rx, uint8_t universe_index) {
-    // Mark first frame received for this universe
-    if (!first_frames_received[universe_index]) {
-        printf("🎉 First frame received on Universe %d (GPIO %u)!\n", 
-               universe_index + 1, multi_rx->getGpioPin(universe_index));
-        first_frames_received[universe_index] = true;
-    }
-    
-    // Get current stats
-    DMXMultiReceiver::UniverseStats stats = multi_rx->getUniverseStats(universe_index);
-    
-    // Print notification every 1000 frames per universe
-    if (stats.frames_received % 1000 == 0) {
-        printf("Universe %d: Frame %lu - %u active channels\n", 
-               universe_index + 1, stats.frames_received, stats.active_channels);
-    }
+// Callback function called when new DMX data is received on any universe.
+// Runs in interrupt context, so it only counts the frame.
+void onMultiUniverseDataReceived(DMXMultiReceiver*, uint8_t) {
+    frames_received++;
 }
 
 int main() {
-    // Initialize stdio
-    stdio_init_all();
-    sleep_ms(2000);
+    // Fast start: reception begins before USB is touched. Until stdio is up,
+    // DMX_LOG only queues messages.
     
-    printf("Multi-Universe DMX Receiver Starting...\n");
-    printf("Receiving %d parallel DMX universes on GPIO pins %d-%d\n", 
-           NUM_UNIVERSES, GPIO_START_PIN, GPIO_START_PIN + NUM_UNIVERSES - 1);
+    DMX_LOG("Multi-Universe DMX Receiver Starting...\n");
+    DMX_LOG("Receiving %d parallel DMX universes on GPIO pins %d-%d\n", 
+            NUM_UNIVERSES, GPIO_START_PIN, GPIO_START_PIN + NUM_UNIVERSES - 1);
     
     // Validate configuration
     if (NUM_UNIVERSES < 1 || NUM_UNIVERSES > MAX_DMX_RECEIVERS) {
-        printf("Error: NUM_UNIVERSES must be between 1 and %d\n", MAX_DMX_RECEIVERS);
+        DMX_LOG("Error: NUM_UNIVERSES must be between 1 and %d\n", MAX_DMX_RECEIVERS);
+        stdio_init_all();
+        DMXLog::flush(DMX_LOG_RING_SIZE);
         return 1;
     }
     
@@ -111,81 +50,87 @@ int main() {
     
     // Initialize receiver with callback
     if (!multi_rx.begin(GPIO_START_PIN, NUM_UNIVERSES, onMultiUniverseDataReceived)) {
-        printf("Failed to initialize multi-universe DMX receiver\n");
+        DMX_LOG("Failed to initialize multi-universe DMX receiver\n");
+        stdio_init_all();
+        DMXLog::flush(DMX_LOG_RING_SIZE);
         return 1;
     }
     
-    printf("Multi-Universe DMX Receiver initialized successfully!\n");
-    printf("Configuration:\n");
-    for (uint8_t i = 0; i < NUM_UNIVERSES; i++) {
-        printf("  Universe %d: GPIO %u (PIO%d)\n", 
-               i + 1, multi_rx.getGpioPin(i), (i < 4) ? 0 : 1);
-    }
+    DMX_LOG("Multi-Universe DMX Receiver initialized successfully!\n");
+    
+    // Fingerprint frames so an unchanged look skips the statistics scan and
+    // the telemetry diff (universe 1 uses the DMA sniffer)
+    multi_rx.enableChangeDetection();
     
-    printf("\nWaiting for DMX data on all universes...\n");
-    printf("Each universe will be monitored independently.\n");
+    // Frames keep arriving through interrupts while USB enumerates; give the
+    // host time to open the port (optional)
+    stdio_init_all();
+    DMXLoad::idleUs(2000 * 1000);
     
-    uint32_t last_signal_check = 0;
+    DMX_LOG("Switching to binary telemetry.\n");
+    
+    // Start-up messages go out as text before the port turns binary
+    DMXLog::flush(DMX_LOG_RING_SIZE);
+    
+    static DMXTelemetry telemetry;
+    telemetry.begin(NUM_UNIVERSES, UNIVERSE_UPDATE_INTERVAL_MS);
+    
+    uint32_t last_stats = 0;
+    uint32_t signal_losses = 0;
+    bool signal_was_present[NUM_UNIVERSES] = {false};
     
     while (true) {
         uint32_t current_time = to_ms_since_boot(get_absolute_time());
         
-        // Print status summary every PRINT_INTERVAL_MS
-        if (current_time - last_status_print >= PRINT_INTERVAL_MS) {
-            printf("\n🔍 === MULTI-UNIVERSE STATUS SUMMARY ===\n");
-            printf("Time: %lu ms\n", current_time);
-            
-            for (uint8_t i = 0; i < NUM_UNIVERSES; i++) {
-                printUniverseSummary(&multi_rx, i);
-            }
-            
-            // Overall status
-            bool all_signals = multi_rx.areAllSignalsPresent(3000);
-            printf("Overall Status: %s\n", 
-                   all_signals ? "🟢 All universes active" : "🟡 Some universes missing signals");
-            
-            printf("========================================\n");
-            last_status_print = current_time;
+        // Diff-only universe updates, rate-limited inside the telemetry and
+        // skipped while only identical frames arrive
+        for (uint8_t i = 0; i < NUM_UNIVERSES; i++) {
+            telemetry.publishUniverse(i, multi_rx.getUniverseBuffer(i), current_time,
+                                      (uint32_t)multi_rx.getUniverseStats(i).frames_changed);
         }
         
-        // Print full universe data every FULL_UNIVERSE_INTERVAL_MS
-        if (current_time - last_full_universe_print >= FULL_UNIVERSE_INTERVAL_MS) {
-            printf("\n📊 === DETAILED UNIVERSE DATA ===\n");
-            
+        if (current_time - last_stats >= STATS_INTERVAL_MS) {
+            uint32_t frames_changed = 0;
+            uint32_t frames_identical = 0;
             for (uint8_t i = 0; i < NUM_UNIVERSES; i++) {
-                if (first_frames_received[i] && multi_rx.isSignalPresent(i, 3000)) {
-                    DMXMultiReceiver::UniverseStats stats = multi_rx.getUniverseStats(i);
-                    if (stats.active_channels > 0) {  // Only show universes with active data
-                        printUniverse(&multi_rx, i);
-                    } else {
-                        printf("Universe %d (GPIO %u): No active channels (all zeros)\n", 
-                               i + 1, multi_rx.getGpioPin(i));
-                    }
+                bool signal_present = multi_rx.isSignalPresent(i, SIGNAL_TIMEOUT_MS);
+                if (signal_was_present[i] && !signal_present) {
+                    signal_losses++;
+                    DMX_LOG("Signal lost on universe %u\n", i + 1);
                 }
+                signal_was_present[i] = signal_present;
+                
+                DMXMultiReceiver::UniverseStats rx_stats = multi_rx.getUniverseStats(i);
+                DMXStreamUniverseStats stats;
+                stats.frames_received = (uint32_t)rx_stats.frames_received;
+                stats.last_frame_ms = (uint32_t)rx_stats.last_frame_timestamp;
+                stats.active_channels = rx_stats.active_channels;
+                stats.max_value = rx_stats.max_value;
+                stats.max_value_channel = rx_stats.max_value_channel;
+                stats.signal_present = signal_present;
+                telemetry.publishStats(i, stats);
+                frames_changed += (uint32_t)rx_stats.frames_changed;
+                frames_identical += (uint32_t)rx_stats.frames_identical;
             }
             
-            last_full_universe_print = current_time;
+            telemetry.setCounter(DMX_COUNTER_UPTIME_MS, current_time);
+            telemetry.setCounter(DMX_COUNTER_FRAMES_RECEIVED, frames_received);
+            telemetry.setCounter(DMX_COUNTER_SIGNAL_LOSSES, signal_losses);
+            telemetry.setCounter(DMX_COUNTER_FRAMES_CHANGED, frames_changed);
+            telemetry.setCounter(DMX_COUNTER_FRAMES_IDENTICAL, frames_identical);
+            DMXProfile::flush(telemetry); // Nothing unless built with DMX_PROFILE
+            DMXLoad::setCounters(telemetry); // Load over the last interval, per core and context
+            telemetry.publishCounters();
+            last_stats = current_time;
         }
         
-        // Check for signal issues every 10 seconds
-        if (current_time - last_signal_check >= 10000) {
-            for (uint8_t i = 0; i < NUM_UNIVERSES; i++) {
-                if (!multi_rx.isSignalPresent(i, 5000)) {
-                    printf("⚠️  WARNING: No signal on Universe %d (GPIO %u) for >5 seconds\n", 
-                           i + 1, multi_rx.getGpioPin(i));
-                }
-            }
-            last_signal_check = current_time;
-        }
-        
-        // Handle button presses or other user interaction
-        // You could add functionality here to switch between universes, 
-        // reset statistics, change display modes, etc.
-        
-        sleep_ms(100);
+        // Pending log records, then a non-blocking drain of the telemetry ring
+        DMXLog::flush(telemetry);
+        telemetry.poll();
+        DMXLoad::idleUs(1000); // WFE; receive interrupts are serviced meanwhile
     }
     
     // Cleanup (never reached in this example)
     multi_rx.end();
     return 0;
-}
\ No newline at end of file
+}
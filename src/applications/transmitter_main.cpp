@@ -1,11 +1,18 @@
 #include "pico/stdlib.h"
 #include "dmx_transmitter.h"
+#include "dmx_frame_pipeline.h"
 #include "dmx_config.h"
-#include <stdio.h>
+#include "dmx_log.h"
+#include "dmx_load.h"
+#include "dmx_state_store.h"
 
 // 8 Parallel DMX Universe Transmitter
 // Uses GPIO pins 1-8 for 8 different DMX universes
 // PIO0 handles pins 1-4, PIO1 handles pins 5-8
+//
+// Messages go through DMXLog and are printed from the idle loop, so USB
+// stdio never stalls frame generation. The outputs start before USB, from the
+// universe state last committed to flash (see DMXStateStore).
 
 // User configurable number of universes (1-8)
 // Change this value to control how many universes are active
@@ -13,18 +20,15 @@
 static uint8_t NUM_ACTIVE_UNIVERSES = 8; // Change this to use fewer universes
 
 int main() {
-    // Initialize stdio
-    stdio_init_all();
-    
-    // Wait for USB serial connection (optional)
-    sleep_ms(2000);
-    
-    printf("8-Universe DMX Transmitter Starting...\n");
-    printf("Active universes: %d\n", NUM_ACTIVE_UNIVERSES);
+    // Fast start: DMX goes on the wire before USB is touched, so fixtures come
+    // back within milliseconds of a power blip. Until stdio is up, DMX_LOG only
+    // queues messages.
     
     // Validate universe count
     if (NUM_ACTIVE_UNIVERSES > MAX_DMX_UNIVERSES) {
-        printf("Error: Cannot exceed %d universes\n", MAX_DMX_UNIVERSES);
+        stdio_init_all();
+        DMX_LOG("Error: Cannot exceed %d universes\n", MAX_DMX_UNIVERSES);
+        DMXLog::flush(DMX_LOG_RING_SIZE);
         return 1;
     }
     
@@ -44,52 +48,73 @@ int main() {
     for (uint8_t i = 0; i < NUM_ACTIVE_UNIVERSES; i++) {
         DmxOutput::return_code result = dmx_outputs[i].begin();
         if (result != DmxOutput::SUCCESS) {
-            printf("Failed to initialize DMX transmitter %d on GPIO %d: %d\n", 
-                   i + 1, dmx_outputs[i].getGpioPin(), result);
+            stdio_init_all();
+            DMX_LOG("Failed to initialize DMX transmitter %d on GPIO %d: %d\n", 
+                    i + 1, dmx_outputs[i].getGpioPin(), result);
+            DMXLog::flush(DMX_LOG_RING_SIZE);
             return 1;
         }
-        printf("Universe %d initialized on GPIO %d\n", 
-               i + 1, dmx_outputs[i].getGpioPin());
     }
     
-    // Apply different configurations to each universe
-    applyDMXConfiguration(dmx_outputs, NUM_ACTIVE_UNIVERSES);
+    // The last committed state goes out first; the built-in configuration is
+    // only needed when flash holds none (first boot)
+    DMXStateStore state;
+    bool restored = state.begin(NUM_ACTIVE_UNIVERSES) && state.restore(dmx_outputs, NUM_ACTIVE_UNIVERSES);
+    if (!restored) {
+        applyDMXConfiguration(dmx_outputs, NUM_ACTIVE_UNIVERSES);
+    }
     
-    printf("Starting continuous transmission of %d parallel DMX universes...\n", NUM_ACTIVE_UNIVERSES);
+    // Frames go out on a fixed 50ms cadence (standard DMX timing). The pipeline
+    // starts all universes in parallel and never blocks waiting for DMA to finish.
+    DMXFramePipeline pipeline;
+    pipeline.begin(dmx_outputs, NUM_ACTIVE_UNIVERSES, 50000);
     
-    uint32_t last_update = 0;
-    uint32_t transmission_count = 0;
+    // The first poll starts frame 0; the timer has been counting since reset
+    while (!pipeline.poll()) {
+    }
+    uint32_t first_break_us = (uint32_t)time_us_64();
+    
+    // Diagnostics from here on: USB enumerates while frames keep going out
+    stdio_init_all();
+    
+    DMX_LOG("8-Universe DMX Transmitter Starting...\n");
+    DMX_LOG("Active universes: %d\n", NUM_ACTIVE_UNIVERSES);
+    DMX_LOG("Boot: first break %lu us after reset (%s)\n", first_break_us,
+            restored ? "restored from flash" : "built-in configuration");
+    
+    // Bring the stored state in line with the configuration; a no-op unless
+    // it changed (or this is the first boot)
+    if (restored) {
+        applyDMXConfiguration(dmx_outputs, NUM_ACTIVE_UNIVERSES);
+    }
+    if (!state.commit(dmx_outputs, NUM_ACTIVE_UNIVERSES)) {
+        DMX_LOG("Failed to commit universe state to flash\n");
+    } else if (state.getStats().commits > 0) {
+        DMX_LOG("Universe state committed (sequence %lu)\n", state.getSequence());
+    }
+    
+    DMX_LOG("Starting continuous transmission of %d parallel DMX universes...\n", NUM_ACTIVE_UNIVERSES);
     
     while (true) {
-        uint32_t current_time = to_ms_since_boot(get_absolute_time());
-        
-        // Transmit all active universes every 50ms (standard DMX timing)
-        if (current_time - last_update >= 50) {
-            // Send data on all active universes in parallel
-            for (uint8_t i = 0; i < NUM_ACTIVE_UNIVERSES; i++) {
-                dmx_outputs[i].transmit(512);
+        if (!pipeline.poll()) {
+            // Between frames: format pending log messages, then sleep until
+            // the next frame is due (or an interrupt) instead of spinning
+            if (DMXLog::flush() == 0) {
+                DMXLoad::idleUntil(pipeline.getNextFrameUs());
             }
-            
-            // Wait for all transmissions to complete
-            for (uint8_t i = 0; i < NUM_ACTIVE_UNIVERSES; i++) {
-                while (dmx_outputs[i].isBusy()) {
-                    // Wait patiently until all outputs are done transmitting
-                }
-            }
-            
-            transmission_count++;
-            
-            // Print status every 1000 transmissions (approximately every 50 seconds)
-            if (transmission_count % 1000 == 0) {
-                printf("Transmitted %lu frames across %d parallel DMX universes\n", 
-                       transmission_count, NUM_ACTIVE_UNIVERSES);
-            }
-            
-            last_update = current_time;
+            continue;
         }
         
-        // Small delay to prevent overwhelming the CPU
-        sleep_ms(1);
+        uint32_t transmission_count = pipeline.getStats().frames_sent;
+        
+        // Print status every 1000 transmissions (approximately every 50 seconds)
+        if (transmission_count % 1000 == 0) {
+            DMX_LOG("Transmitted %lu frames across %d parallel DMX universes\n", 
+                    transmission_count, NUM_ACTIVE_UNIVERSES);
+            DMXLoad::Usage load = DMXLoad::sample(0);
+            DMX_LOG("CPU load %u permille (tx %lu us, main %lu us per frame)\n", load.load_permille,
+                    (uint32_t)(load.time_us[DMX_LOAD_TX] / 1000), (uint32_t)(load.time_us[DMX_LOAD_MAIN] / 1000));
+        }
     }
     
     // Cleanup (never reached in this example)
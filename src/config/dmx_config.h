@@ -13,7 +13,7 @@ struct ChannelConfig {
 };
 
 // Configuration for Universe 1 - Red theme (high red values)
-static const ChannelConfig DMX_UNIVERSE_1_CONFIG[] = {
+static constexpr ChannelConfig DMX_UNIVERSE_1_CONFIG[] = {
     {1, 255}, {2, 200}, {3, 50}, {4, 255}, {5, 180}, {6, 30}, {7, 255}, {8, 220}, {9, 70}, {10, 255},
     {11, 190}, {12, 40}, {13, 255}, {14, 210}, {15, 60}, {16, 255}, {17, 170}, {18, 80}, {19, 255}, {20, 230},
     {21, 255}, {22, 150}, {23, 20}, {24, 255}, {25, 240}, {26, 90}, {27, 255}, {28, 160}, {29, 10}, {30, 255},
@@ -30,73 +30,177 @@ static const ChannelConfig DMX_UNIVERSE_1_CONFIG[] = {
 };
 
 // Configuration for Universe 2 - Green theme
-static const ChannelConfig DMX_UNIVERSE_2_CONFIG[] = {
+static constexpr ChannelConfig DMX_UNIVERSE_2_CONFIG[] = {
     {1, 50}, {2, 255}, {3, 100}, {4, 30}, {5, 255}, {6, 150}, {7, 70}, {8, 255}, {9, 200}, {10, 40},
     {11, 255}, {12, 180}, {13, 90}, {14, 255}, {15, 220}, {16, 20}, {17, 255}, {18, 160}, {19, 110}, {20, 255}
     // ... (pattern continues for all 512 channels)
 };
 
 // Configuration for Universe 3 - Blue theme  
-static const ChannelConfig DMX_UNIVERSE_3_CONFIG[] = {
+static constexpr ChannelConfig DMX_UNIVERSE_3_CONFIG[] = {
     {1, 100}, {2, 150}, {3, 255}, {4, 80}, {5, 130}, {6, 255}, {7, 120}, {8, 170}, {9, 255}, {10, 60},
     {11, 110}, {12, 255}, {13, 140}, {14, 190}, {15, 255}, {16, 40}, {17, 90}, {18, 255}, {19, 160}, {20, 210}
     // ... (pattern continues for all 512 channels)
 };
 
 // Configuration for Universe 4 - Yellow theme
-static const ChannelConfig DMX_UNIVERSE_4_CONFIG[] = {
+static constexpr ChannelConfig DMX_UNIVERSE_4_CONFIG[] = {
     {1, 255}, {2, 255}, {3, 50}, {4, 255}, {5, 255}, {6, 100}, {7, 255}, {8, 255}, {9, 150}, {10, 255},
     {11, 255}, {12, 80}, {13, 255}, {14, 255}, {15, 130}, {16, 255}, {17, 255}, {18, 60}, {19, 255}, {20, 255}
     // ... (pattern continues for all 512 channels)
 };
 
 // Configuration for Universe 5 - Cyan theme
-static const ChannelConfig DMX_UNIVERSE_5_CONFIG[] = {
+static constexpr ChannelConfig DMX_UNIVERSE_5_CONFIG[] = {
     {1, 50}, {2, 255}, {3, 255}, {4, 100}, {5, 255}, {6, 255}, {7, 150}, {8, 255}, {9, 255}, {10, 80},
     {11, 255}, {12, 255}, {13, 130}, {14, 255}, {15, 255}, {16, 60}, {17, 255}, {18, 255}, {19, 110}, {20, 255}
     // ... (pattern continues for all 512 channels)
 };
 
 // Configuration for Universe 6 - Magenta theme
-static const ChannelConfig DMX_UNIVERSE_6_CONFIG[] = {
+static constexpr ChannelConfig DMX_UNIVERSE_6_CONFIG[] = {
     {1, 255}, {2, 50}, {3, 255}, {4, 255}, {5, 100}, {6, 255}, {7, 255}, {8, 150}, {9, 255}, {10, 255},
     {11, 80}, {12, 255}, {13, 255}, {14, 130}, {15, 255}, {16, 255}, {17, 60}, {18, 255}, {19, 255}, {20, 110}
     // ... (pattern continues for all 512 channels)
 };
 
 // Configuration for Universe 7 - White theme
-static const ChannelConfig DMX_UNIVERSE_7_CONFIG[] = {
+static constexpr ChannelConfig DMX_UNIVERSE_7_CONFIG[] = {
     {1, 255}, {2, 255}, {3, 255}, {4, 200}, {5, 200}, {6, 200}, {7, 180}, {8, 180}, {9, 180}, {10, 160},
     {11, 160}, {12, 160}, {13, 140}, {14, 140}, {15, 140}, {16, 120}, {17, 120}, {18, 120}, {19, 100}, {20, 100}
     // ... (pattern continues for all 512 channels)
 };
 
 // Configuration for Universe 8 - Rainbow pattern
-static const ChannelConfig DMX_UNIVERSE_8_CONFIG[] = {
+static constexpr ChannelConfig DMX_UNIVERSE_8_CONFIG[] = {
     {1, 255}, {2, 0}, {3, 0}, {4, 255}, {5, 128}, {6, 0}, {7, 255}, {8, 255}, {9, 0}, {10, 128},
     {11, 255}, {12, 0}, {13, 0}, {14, 255}, {15, 0}, {16, 0}, {17, 128}, {18, 255}, {19, 0}, {20, 255}
     // ... (pattern continues for all 512 channels)
 };
 
-// Array of all universe configurations
-static const ChannelConfig* DMX_UNIVERSE_CONFIGS[MAX_DMX_UNIVERSES] = {
-    DMX_UNIVERSE_1_CONFIG,
-    DMX_UNIVERSE_2_CONFIG, 
-    DMX_UNIVERSE_3_CONFIG,
-    DMX_UNIVERSE_4_CONFIG,
-    DMX_UNIVERSE_5_CONFIG,
-    DMX_UNIVERSE_6_CONFIG,
-    DMX_UNIVERSE_7_CONFIG,
-    DMX_UNIVERSE_8_CONFIG
-};
-
 // Number of configured channels per universe (simplified - using first 20 channels for demo)
-static const uint16_t DMX_CONFIG_COUNT_PER_UNIVERSE = 20;
+static constexpr uint16_t DMX_CONFIG_COUNT_PER_UNIVERSE = 20;
 
 // Backward compatibility for receiver - use Universe 1 config as default
 static const ChannelConfig* DMX_CHANNEL_CONFIG = DMX_UNIVERSE_1_CONFIG;
 static const uint16_t DMX_CONFIG_COUNT = DMX_CONFIG_COUNT_PER_UNIVERSE;
 
+// Dense universe image: [0] = start code, [1..512] = channel values.
+// Built at compile time from the sparse configs above and placed in flash,
+// so a static look is applied with a single memcpy (or DMA'd straight from XIP)
+struct DMXUniverseImage {
+    uint8_t data[DMX_UNIVERSE_SIZE + 1];
+};
+
+// Compile-time checks for sparse channel configurations
+template <size_t N>
+constexpr bool dmxConfigChannelsInRange(const ChannelConfig (&config)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        if (config[i].channel < 1 || config[i].channel > DMX_UNIVERSE_SIZE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr bool dmxConfigChannelsUnique(const ChannelConfig (&config)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i + 1; j < N; j++) {
+            if (config[i].channel == config[j].channel) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#define DMX_VALIDATE_CONFIG(config) \
+    static_assert(dmxConfigChannelsInRange(config), #config ": channel out of range (1-512)"); \
+    static_assert(dmxConfigChannelsUnique(config), #config ": duplicate channel")
+
+DMX_VALIDATE_CONFIG(DMX_UNIVERSE_1_CONFIG);
+DMX_VALIDATE_CONFIG(DMX_UNIVERSE_2_CONFIG);
+DMX_VALIDATE_CONFIG(DMX_UNIVERSE_3_CONFIG);
+DMX_VALIDATE_CONFIG(DMX_UNIVERSE_4_CONFIG);
+DMX_VALIDATE_CONFIG(DMX_UNIVERSE_5_CONFIG);
+DMX_VALIDATE_CONFIG(DMX_UNIVERSE_6_CONFIG);
+DMX_VALIDATE_CONFIG(DMX_UNIVERSE_7_CONFIG);
+DMX_VALIDATE_CONFIG(DMX_UNIVERSE_8_CONFIG);
+
+constexpr void dmxImageSetChannel(DMXUniverseImage& image, uint16_t channel, uint8_t value) {
+    if (channel >= 1 && channel <= DMX_UNIVERSE_SIZE) {
+        image.data[channel] = value;
+    }
+}
+
+// Distinctive per-universe pattern on channels 21-100, layered over the config
+// to create a unique signature for each universe
+constexpr void dmxImageApplyTheme(DMXUniverseImage& image, uint8_t universe) {
+    switch (universe) {
+        case 0: // Universe 1 - Red theme (fully described by its config)
+            break;
+        case 1: // Universe 2 - Green theme
+            for (uint16_t ch = 21; ch <= 100; ch += 3) {
+                dmxImageSetChannel(image, ch, 255);     // High green
+                dmxImageSetChannel(image, ch + 1, 100); // Medium value
+                dmxImageSetChannel(image, ch + 2, 50);  // Low value
+            }
+            break;
+        case 2: // Universe 3 - Blue theme
+            for (uint16_t ch = 21; ch <= 100; ch += 3) {
+                dmxImageSetChannel(image, ch, 50);      // Low value
+                dmxImageSetChannel(image, ch + 1, 100); // Medium value
+                dmxImageSetChannel(image, ch + 2, 255); // High blue
+            }
+            break;
+        case 3: // Universe 4 - Yellow theme
+            for (uint16_t ch = 21; ch <= 100; ch += 2) {
+                dmxImageSetChannel(image, ch, 255);     // High red
+                dmxImageSetChannel(image, ch + 1, 255); // High green
+            }
+            break;
+        case 4: // Universe 5 - Cyan theme
+            for (uint16_t ch = 21; ch <= 100; ch += 2) {
+                dmxImageSetChannel(image, ch, 255);     // High green
+                dmxImageSetChannel(image, ch + 1, 255); // High blue
+            }
+            break;
+        case 5: // Universe 6 - Magenta theme
+            for (uint16_t ch = 21; ch <= 100; ch += 2) {
+                dmxImageSetChannel(image, ch, 255);     // High red
+                dmxImageSetChannel(image, ch + 1, 255); // High blue
+            }
+            break;
+        case 6: // Universe 7 - White theme
+            for (uint16_t ch = 21; ch <= 100; ch++) {
+                dmxImageSetChannel(image, ch, 200);     // All channels bright
+            }
+            break;
+        case 7: // Universe 8 - Rainbow pattern
+            for (uint16_t ch = 21; ch <= 100; ch++) {
+                dmxImageSetChannel(image, ch, (ch * 3) % 255); // Create gradient
+            }
+            break;
+    }
+}
+
+// Build a dense image from the first `count` entries of a sparse config plus the universe theme
+template <size_t N>
+constexpr DMXUniverseImage buildUniverseImage(const ChannelConfig (&config)[N], uint8_t universe,
+                                              size_t count = DMX_CONFIG_COUNT_PER_UNIVERSE) {
+    DMXUniverseImage image = {};
+    image.data[0] = 0x00; // DMX start code
+    for (size_t i = 0; i < N && i < count; i++) {
+        dmxImageSetChannel(image, config[i].channel, config[i].value);
+    }
+    dmxImageApplyTheme(image, universe);
+    return image;
+}
+
+// Precomputed universe images (defined in dmx_config.cpp, stored in flash)
+extern const DMXUniverseImage DMX_UNIVERSE_IMAGES[MAX_DMX_UNIVERSES];
+
 // Function to apply configuration to multiple DMX transmitters
 void applyDMXConfiguration(class DMXTransmitter dmx_outputs[], uint8_t num_universes);
 
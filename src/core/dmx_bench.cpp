@@ -0,0 +1,128 @@
+#include "dmx_bench.h"
+#include <cstdio>
+
+#if PICO_ON_DEVICE
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+#define SYSTICK_MASK 0xFFFFFFu
+
+static uint32_t sys_hz;
+
+static void startClock() {
+    sys_hz = clock_get_hz(clk_sys);
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // Enabled, counting clk_sys, no interrupt
+}
+
+// Samples stay far below the 24-bit wrap (134 ms at 125 MHz)
+static uint64_t timeSample(DMXBench::Function function, void* context, uint32_t iterations) {
+    uint32_t start = systick_hw->cvr;
+    for (uint32_t i = 0; i < iterations; i++) {
+        function(context);
+    }
+    uint32_t end = systick_hw->cvr;
+    return (start - end) & SYSTICK_MASK; // Counts down
+}
+
+static double ticksToNs(uint64_t ticks) {
+    return ticks * 1e9 / sys_hz;
+}
+
+static uint64_t nowUs() {
+    return time_us_64();
+}
+#else
+#include <chrono>
+
+static const uint32_t sys_hz = 0;
+
+static void startClock() {
+}
+
+static uint64_t monotonicNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t timeSample(DMXBench::Function function, void* context, uint32_t iterations) {
+    uint64_t start = monotonicNs();
+    for (uint32_t i = 0; i < iterations; i++) {
+        function(context);
+    }
+    return monotonicNs() - start;
+}
+
+static double ticksToNs(uint64_t ticks) {
+    return (double)ticks;
+}
+
+static uint64_t nowUs() {
+    return monotonicNs() / 1000;
+}
+#endif
+
+uint32_t DMXBench::_num_results = 0;
+
+void DMXBench::begin(const char* suite) {
+    startClock();
+    _num_results = 0;
+    printf("{\"suite\":\"%s\",\"platform\":\"%s\",\"clock\":\"%s\",\"sys_hz\":%lu,\"compiler\":\"%s\",\"results\":[\n",
+           suite, PICO_ON_DEVICE ? "rp2040" : "host", PICO_ON_DEVICE ? "systick" : "monotonic",
+           (unsigned long)sys_hz, __VERSION__);
+}
+
+DMXBench::Result DMXBench::run(const char* name, Function function, void* context, uint32_t bytes,
+                                uint32_t items) {
+    // Double the calls per sample until one sample fills DMX_BENCH_SAMPLE_US
+    uint32_t iterations = 1;
+    while (iterations < (1u << 24)) {
+        uint64_t start_us = nowUs();
+        timeSample(function, context, iterations);
+        if (nowUs() - start_us >= DMX_BENCH_SAMPLE_US) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    uint64_t samples[DMX_BENCH_SAMPLES];
+    for (uint32_t s = 0; s < DMX_BENCH_SAMPLES; s++) {
+        uint64_t ticks = timeSample(function, context, iterations);
+        // Insertion sort as we go
+        uint32_t i = s;
+        while (i > 0 && samples[i - 1] > ticks) {
+            samples[i] = samples[i - 1];
+            i--;
+        }
+        samples[i] = ticks;
+    }
+
+    Result result;
+    result.iterations = iterations;
+    result.min_ns = ticksToNs(samples[0]) / iterations;
+    result.median_ns = ticksToNs(samples[DMX_BENCH_SAMPLES / 2]) / iterations;
+    result.max_ns = ticksToNs(samples[DMX_BENCH_SAMPLES - 1]) / iterations;
+    result.min_cycles = PICO_ON_DEVICE ? (double)samples[0] / iterations : 0;
+    result.median_cycles = PICO_ON_DEVICE ? (double)samples[DMX_BENCH_SAMPLES / 2] / iterations : 0;
+
+    printf("%s{\"name\":\"%s\",\"iterations\":%lu,\"samples\":%d,\"min_ns\":%.1f,\"median_ns\":%.1f,\"max_ns\":%.1f",
+           _num_results ? ",\n" : "", name, (unsigned long)iterations, DMX_BENCH_SAMPLES,
+           result.min_ns, result.median_ns, result.max_ns);
+    if (PICO_ON_DEVICE) {
+        printf(",\"min_cycles\":%.1f,\"median_cycles\":%.1f", result.min_cycles, result.median_cycles);
+    }
+    if (bytes) {
+        printf(",\"bytes\":%lu,\"mb_per_s\":%.2f", (unsigned long)bytes, bytes * 1e3 / result.median_ns);
+    }
+    if (items) {
+        printf(",\"items\":%lu,\"items_per_ms\":%.1f", (unsigned long)items, items * 1e6 / result.median_ns);
+    }
+    printf("}");
+    _num_results++;
+    return result;
+}
+
+void DMXBench::end() {
+    printf("\n]}\n");
+}
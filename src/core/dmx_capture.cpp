@@ -0,0 +1,272 @@
+#include "dmx_capture.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "hardware/regs/addressmap.h"
+#include <cstring>
+
+// DMXCapture
+
+DMXCapture::DMXCapture()
+    : _num_universes(0), _overwrite(false), _capturing(false) {
+    resetStats();
+}
+
+bool DMXCapture::begin(uint8_t num_universes, uint8_t* buffer, size_t size, bool overwrite) {
+    _capturing = false;
+    if (!_encoder.begin(num_universes) || !_ring.begin(buffer, size)) {
+        return false;
+    }
+    _num_universes = num_universes;
+    _overwrite = overwrite;
+    resetStats();
+    return true;
+}
+
+void DMXCapture::start() {
+    if (_num_universes == 0) {
+        return;
+    }
+    // Decodable from the first record onwards
+    _encoder.requestKeyframes();
+    _capturing = true;
+}
+
+void DMXCapture::stop() {
+    _capturing = false;
+}
+
+bool DMXCapture::isCapturing() const {
+    return _capturing;
+}
+
+bool DMXCapture::captureFrame(uint8_t universe, const uint8_t* data, uint32_t timestamp_us) {
+    if (!_capturing || universe >= _num_universes || data == nullptr) {
+        return false;
+    }
+
+    // Receive callbacks of different universes may run on different IRQs
+    uint32_t irq_state = save_and_disable_interrupts();
+    uint32_t start_us = time_us_32();
+
+    uint8_t* slot = _ring.reserve();
+    while (slot == nullptr && _overwrite && _ring.getUsed() > 0) {
+        _ring.pop();
+        _stats.frames_dropped++;
+        slot = _ring.reserve();
+    }
+
+    bool captured = false;
+    if (slot != nullptr) {
+        // A dropped frame leaves the encoder untouched, so the next delta is
+        // still against the last recorded frame
+        uint16_t length = _encoder.encodeFrame(universe, data, timestamp_us, slot);
+        _ring.commit(length);
+        _stats.frames_captured++;
+        _stats.bytes_captured += length;
+        captured = true;
+    } else {
+        _stats.frames_dropped++;
+    }
+
+    _stats.last_encode_us = time_us_32() - start_us;
+    if (_stats.last_encode_us > _stats.max_encode_us) {
+        _stats.max_encode_us = _stats.last_encode_us;
+    }
+    restore_interrupts(irq_state);
+    return captured;
+}
+
+uint16_t DMXCapture::flush(DMXTelemetry& telemetry, uint16_t max_records) {
+    uint16_t sent = 0;
+    uint16_t length;
+    const uint8_t* record;
+    while (sent < max_records && (record = _ring.peek(&length)) != nullptr) {
+        // Wait for room rather than losing a record of the capture
+        if (telemetry.getFreeSpace() < length + DMX_STREAM_HEADER_SIZE + DMX_STREAM_CHECK_SIZE) {
+            break;
+        }
+        telemetry.publishRecord(DMX_STREAM_CAPTURE, record[4], record, length);
+        _ring.pop();
+        sent++;
+    }
+    _stats.records_sent += sent;
+    return sent;
+}
+
+// Erase each sector as the first page in it is written
+static void programFlashPage(uint32_t offset, const uint8_t* page) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (offset % FLASH_SECTOR_SIZE == 0) {
+        flash_range_erase(offset, FLASH_SECTOR_SIZE);
+    }
+    flash_range_program(offset, page, FLASH_PAGE_SIZE);
+    restore_interrupts(irq_state);
+}
+
+size_t DMXCapture::saveToFlash(uint32_t flash_offset, size_t max_size) {
+    if (_capturing || _num_universes == 0 ||
+        flash_offset % FLASH_SECTOR_SIZE != 0 || max_size % FLASH_SECTOR_SIZE != 0 || max_size == 0) {
+        return 0;
+    }
+
+    uint8_t page[FLASH_PAGE_SIZE];
+    uint16_t fill = (uint16_t)dmxCaptureWriteHeader(_num_universes, page);
+    size_t total = fill;
+    uint32_t page_offset = flash_offset;
+
+    // One byte stays free for the end marker
+    uint16_t length;
+    const uint8_t* record;
+    while ((record = _ring.peek(&length)) != nullptr && total + length < max_size) {
+        uint16_t copied = 0;
+        while (copied < length) {
+            uint16_t chunk = length - copied;
+            if (chunk > FLASH_PAGE_SIZE - fill) {
+                chunk = FLASH_PAGE_SIZE - fill;
+            }
+            memcpy(&page[fill], &record[copied], chunk);
+            fill += chunk;
+            copied += chunk;
+            if (fill == FLASH_PAGE_SIZE) {
+                programFlashPage(page_offset, page);
+                page_offset += FLASH_PAGE_SIZE;
+                fill = 0;
+            }
+        }
+        total += length;
+        _ring.pop();
+    }
+
+    // Erased bytes read as 0xFF, which is the end marker
+    memset(&page[fill], 0xFF, FLASH_PAGE_SIZE - fill);
+    programFlashPage(page_offset, page);
+    return total;
+}
+
+size_t DMXCapture::getBufferedBytes() const {
+    return _ring.getUsed();
+}
+
+DMXCapture::Stats DMXCapture::getStats() const {
+    return _stats;
+}
+
+void DMXCapture::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+// DMXReplay
+
+DMXReplay::DMXReplay()
+    : _reader(nullptr), _outputs(nullptr), _num_outputs(0), _playing(false), _loop(false),
+      _have_next(false), _start_us(0), _position_us(0), _last_timestamp_us(0), _synced(0), _pending(0) {
+    memset(&_next, 0, sizeof(_next));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool DMXReplay::openFlashCapture(DMXCaptureReader& reader) {
+    return reader.open((const uint8_t*)(XIP_BASE + DMX_CAPTURE_FLASH_OFFSET), DMX_CAPTURE_FLASH_SIZE);
+}
+
+bool DMXReplay::begin(DMXCaptureReader* reader, DMXTransmitter outputs[], uint8_t num_outputs) {
+    if (reader == nullptr || !reader->isValid() || outputs == nullptr || num_outputs == 0) {
+        return false;
+    }
+
+    _reader = reader;
+    _outputs = outputs;
+    _num_outputs = num_outputs < reader->getNumUniverses() ? num_outputs : reader->getNumUniverses();
+    _playing = false;
+    memset(&_stats, 0, sizeof(_stats));
+    return true;
+}
+
+void DMXReplay::start(uint64_t now_us, bool loop) {
+    if (_reader == nullptr) {
+        return;
+    }
+    _loop = loop;
+    _pending = 0;
+    rewind(now_us);
+    _playing = _have_next;
+}
+
+void DMXReplay::stop() {
+    _playing = false;
+}
+
+bool DMXReplay::isPlaying() const {
+    return _playing;
+}
+
+void DMXReplay::rewind(uint64_t now_us) {
+    _reader->rewind();
+    _synced = 0;
+    _start_us = now_us;
+    _position_us = 0;
+    _have_next = _reader->next(&_next);
+    _last_timestamp_us = _next.timestamp_us;
+}
+
+void DMXReplay::advance() {
+    _have_next = _reader->next(&_next);
+    if (_have_next) {
+        // Unsigned difference survives the 32-bit timestamp wrap
+        _position_us += (uint32_t)(_next.timestamp_us - _last_timestamp_us);
+        _last_timestamp_us = _next.timestamp_us;
+    }
+}
+
+void DMXReplay::poll(uint64_t now_us) {
+    if (!_playing) {
+        return;
+    }
+
+    uint64_t elapsed_us = now_us - _start_us;
+    while (_have_next && _position_us <= elapsed_us) {
+        uint8_t universe = _next.universe;
+        uint8_t bit = (uint8_t)(1u << universe);
+        if (universe < _num_outputs) {
+            if (_next.flags & DMX_CAPTURE_FLAG_KEYFRAME) {
+                _synced |= bit;
+            }
+            // The back buffer is not on the wire, so records apply even while busy
+            if ((_synced & bit) && DMXCaptureReader::applyRecord(_next, _outputs[universe].getUniverseBuffer())) {
+                if (_pending & bit) {
+                    _stats.frames_merged++;
+                }
+                _pending |= bit;
+            } else {
+                _stats.frames_skipped++;
+            }
+        }
+
+        uint32_t lateness_us = (uint32_t)(elapsed_us - _position_us);
+        if (lateness_us > _stats.max_lateness_us) {
+            _stats.max_lateness_us = lateness_us;
+        }
+        advance();
+    }
+
+    for (uint8_t i = 0; i < _num_outputs; i++) {
+        uint8_t bit = (uint8_t)(1u << i);
+        if ((_pending & bit) && !_outputs[i].isBusy()) {
+            _outputs[i].transmit();
+            _pending &= (uint8_t)~bit;
+            _stats.frames_played++;
+        }
+    }
+
+    if (!_have_next && _pending == 0) {
+        if (_loop) {
+            _stats.loops++;
+            rewind(now_us);
+        } else {
+            _playing = false;
+        }
+    }
+}
+
+DMXReplay::Stats DMXReplay::getStats() const {
+    return _stats;
+}
@@ -0,0 +1,240 @@
+#include "dmx_capture_format.h"
+#include <atomic>
+#include <cstring>
+
+static const uint8_t ZERO_UNIVERSE[DMX_UNIVERSE_SIZE] = {0};
+
+size_t dmxCaptureWriteHeader(uint8_t num_universes, uint8_t* out) {
+    dmxCueWriteU32(&out[0], DMX_CAPTURE_MAGIC);
+    dmxCueWriteU16(&out[4], DMX_CAPTURE_VERSION);
+    out[6] = num_universes;
+    out[7] = 0;
+    return DMX_CAPTURE_HEADER_SIZE;
+}
+
+// DMXCaptureEncoder
+
+DMXCaptureEncoder::DMXCaptureEncoder()
+    : _keyframe_pending(0), _num_universes(0), _keyframe_interval_us(DMX_CAPTURE_KEYFRAME_INTERVAL_US) {
+    memset(_prev, 0, sizeof(_prev));
+    memset(_last_keyframe_us, 0, sizeof(_last_keyframe_us));
+}
+
+bool DMXCaptureEncoder::begin(uint8_t num_universes, uint32_t keyframe_interval_us) {
+    if (num_universes == 0 || num_universes > DMX_CAPTURE_MAX_UNIVERSES) {
+        return false;
+    }
+    _num_universes = num_universes;
+    _keyframe_interval_us = keyframe_interval_us;
+    memset(_prev, 0, sizeof(_prev));
+    requestKeyframes();
+    return true;
+}
+
+void DMXCaptureEncoder::requestKeyframes() {
+    _keyframe_pending = 0xFF;
+}
+
+uint16_t DMXCaptureEncoder::encodeFrame(uint8_t universe, const uint8_t* data, uint32_t timestamp_us, uint8_t* out) {
+    if (universe >= _num_universes) {
+        return 0;
+    }
+
+    uint8_t bit = (uint8_t)(1u << universe);
+    bool keyframe = (_keyframe_pending & bit) ||
+                    timestamp_us - _last_keyframe_us[universe] >= _keyframe_interval_us;
+
+    // Ops never exceed DMX_CAPTURE_MAX_OPS, so 0 here means "no change"
+    const uint8_t* base = keyframe ? ZERO_UNIVERSE : _prev[universe];
+    uint16_t length = DMXCueCodec::encodeUniverse(base, data, &out[DMX_CAPTURE_RECORD_HEADER_SIZE],
+                                                  DMX_CAPTURE_MAX_OPS);
+
+    dmxCueWriteU32(&out[0], timestamp_us);
+    out[4] = universe;
+    out[5] = keyframe ? DMX_CAPTURE_FLAG_KEYFRAME : 0;
+    dmxCueWriteU16(&out[6], length);
+
+    if (keyframe) {
+        _keyframe_pending &= (uint8_t)~bit;
+        _last_keyframe_us[universe] = timestamp_us;
+    }
+    memcpy(_prev[universe], data, DMX_UNIVERSE_SIZE);
+    return (uint16_t)(DMX_CAPTURE_RECORD_HEADER_SIZE + length);
+}
+
+uint8_t DMXCaptureEncoder::getNumUniverses() const {
+    return _num_universes;
+}
+
+// DMXCaptureRing
+
+DMXCaptureRing::DMXCaptureRing()
+    : _buffer(nullptr), _size(0), _head(0), _tail(0), _wrap(0), _reserved(0) {
+}
+
+bool DMXCaptureRing::begin(uint8_t* buffer, size_t size) {
+    if (buffer == nullptr || size < 2 * DMX_CAPTURE_MAX_RECORD) {
+        return false;
+    }
+    _buffer = buffer;
+    _size = size;
+    clear();
+    return true;
+}
+
+uint8_t* DMXCaptureRing::reserve() {
+    if (_buffer == nullptr) {
+        return nullptr;
+    }
+
+    size_t head = _head;
+    size_t tail = _tail;
+
+    // The head never catches up with the tail (head == tail means empty)
+    if (head >= tail) {
+        if (_size - head >= DMX_CAPTURE_MAX_RECORD) {
+            _reserved = head;
+            return &_buffer[head];
+        }
+        if (tail > DMX_CAPTURE_MAX_RECORD) {
+            _reserved = 0; // Wraps on commit
+            return _buffer;
+        }
+        return nullptr;
+    }
+    if (tail - head > DMX_CAPTURE_MAX_RECORD) {
+        _reserved = head;
+        return &_buffer[head];
+    }
+    return nullptr;
+}
+
+void DMXCaptureRing::commit(uint16_t length) {
+    // Data first, then the index that makes it visible
+    std::atomic_signal_fence(std::memory_order_release);
+    if (_reserved == 0 && _head != 0) {
+        _wrap = _head;
+        std::atomic_signal_fence(std::memory_order_release);
+    }
+    _head = _reserved + length;
+}
+
+const uint8_t* DMXCaptureRing::peek(uint16_t* length) {
+    size_t head = _head;
+    std::atomic_signal_fence(std::memory_order_acquire);
+    size_t tail = _tail;
+
+    if (tail == head) {
+        return nullptr;
+    }
+    // Producer has wrapped and everything above it is consumed
+    if (head < tail && tail == _wrap) {
+        tail = 0;
+        _tail = 0;
+        if (head == 0) {
+            return nullptr;
+        }
+    }
+
+    const uint8_t* record = &_buffer[tail];
+    *length = (uint16_t)(DMX_CAPTURE_RECORD_HEADER_SIZE + dmxCueReadU16(&record[6]));
+    return record;
+}
+
+void DMXCaptureRing::pop() {
+    uint16_t length;
+    if (peek(&length) == nullptr) {
+        return;
+    }
+    std::atomic_signal_fence(std::memory_order_release);
+    _tail = _tail + length;
+}
+
+size_t DMXCaptureRing::getUsed() const {
+    size_t head = _head;
+    size_t tail = _tail;
+    return head >= tail ? head - tail : (_wrap - tail) + head;
+}
+
+size_t DMXCaptureRing::getSize() const {
+    return _size;
+}
+
+void DMXCaptureRing::clear() {
+    _head = 0;
+    _tail = 0;
+    _wrap = 0;
+    _reserved = 0;
+}
+
+// DMXCaptureReader
+
+DMXCaptureReader::DMXCaptureReader()
+    : _data(nullptr), _size(0), _offset(0), _num_universes(0) {
+}
+
+bool DMXCaptureReader::open(const uint8_t* data, size_t size) {
+    _data = nullptr;
+    if (data == nullptr || size < DMX_CAPTURE_HEADER_SIZE) {
+        return false;
+    }
+    if (dmxCueReadU32(&data[0]) != DMX_CAPTURE_MAGIC || dmxCueReadU16(&data[4]) != DMX_CAPTURE_VERSION) {
+        return false;
+    }
+    if (data[6] == 0 || data[6] > DMX_CAPTURE_MAX_UNIVERSES) {
+        return false;
+    }
+
+    _data = data;
+    _size = size;
+    _num_universes = data[6];
+    rewind();
+    return true;
+}
+
+bool DMXCaptureReader::isValid() const {
+    return _data != nullptr;
+}
+
+uint8_t DMXCaptureReader::getNumUniverses() const {
+    return _num_universes;
+}
+
+bool DMXCaptureReader::next(DMXCaptureRecord* record) {
+    if (_data == nullptr || !parseRecord(&_data[_offset], _size - _offset, record)) {
+        return false;
+    }
+    if (record->universe >= _num_universes) {
+        return false;
+    }
+    _offset += DMX_CAPTURE_RECORD_HEADER_SIZE + record->length;
+    return true;
+}
+
+void DMXCaptureReader::rewind() {
+    _offset = DMX_CAPTURE_HEADER_SIZE;
+}
+
+bool DMXCaptureReader::parseRecord(const uint8_t* data, size_t size, DMXCaptureRecord* record) {
+    if (size < DMX_CAPTURE_RECORD_HEADER_SIZE || data[4] == DMX_CAPTURE_END) {
+        return false;
+    }
+    record->timestamp_us = dmxCueReadU32(&data[0]);
+    record->universe = data[4];
+    record->flags = data[5];
+    record->length = dmxCueReadU16(&data[6]);
+    record->ops = &data[DMX_CAPTURE_RECORD_HEADER_SIZE];
+    return record->universe < DMX_CAPTURE_MAX_UNIVERSES &&
+           record->length <= DMX_CAPTURE_MAX_OPS &&
+           DMX_CAPTURE_RECORD_HEADER_SIZE + (size_t)record->length <= size;
+}
+
+bool DMXCaptureReader::applyRecord(const DMXCaptureRecord& record, uint8_t* universe) {
+    if (record.flags & DMX_CAPTURE_FLAG_KEYFRAME) {
+        memset(universe, 0, DMX_UNIVERSE_SIZE);
+    }
+    if (record.length == 0) {
+        return true;
+    }
+    return DMXCueCodec::decodeUniverse(record.ops, record.length, universe);
+}
@@ -0,0 +1,270 @@
+#include "dmx_color.h"
+#include "dmx_effects.h"
+
+#define CCT_MIN_KELVIN 1000
+#define CCT_MAX_KELVIN 12000
+#define CCT_STEP_KELVIN 100
+
+// 128 * cos(H) / cos(60 deg - H) for H = i * 120 / 256 degrees: the share of
+// the leading component across one HSI sector
+static const int16_t HSI_RATIO_TABLE[256] = {
+     256,  252,  249,  246,  242,  239,  236,  233,  230,  227,  224,  221,  219,  216,  213,  211,
+     208,  206,  204,  201,  199,  197,  195,  193,  190,  188,  186,  184,  182,  180,  179,  177,
+     175,  173,  171,  170,  168,  166,  164,  163,  161,  160,  158,  157,  155,  153,  152,  151,
+     149,  148,  146,  145,  143,  142,  141,  139,  138,  137,  135,  134,  133,  132,  130,  129,
+     128,  127,  126,  124,  123,  122,  121,  120,  119,  118,  116,  115,  114,  113,  112,  111,
+     110,  109,  108,  107,  106,  105,  104,  103,  102,  101,  100,   99,   98,   97,   96,   95,
+      94,   93,   92,   91,   90,   89,   88,   87,   86,   85,   84,   83,   82,   81,   80,   80,
+      79,   78,   77,   76,   75,   74,   73,   72,   71,   70,   69,   69,   68,   67,   66,   65,
+      64,   63,   62,   61,   60,   59,   59,   58,   57,   56,   55,   54,   53,   52,   51,   50,
+      49,   48,   48,   47,   46,   45,   44,   43,   42,   41,   40,   39,   38,   37,   36,   35,
+      34,   33,   32,   31,   30,   29,   28,   27,   26,   25,   24,   23,   22,   21,   20,   19,
+      18,   17,   16,   15,   14,   13,   12,   10,    9,    8,    7,    6,    5,    4,    2,    1,
+       0,   -1,   -2,   -4,   -5,   -6,   -7,   -9,  -10,  -11,  -13,  -14,  -15,  -17,  -18,  -20,
+     -21,  -23,  -24,  -25,  -27,  -29,  -30,  -32,  -33,  -35,  -36,  -38,  -40,  -42,  -43,  -45,
+     -47,  -49,  -51,  -52,  -54,  -56,  -58,  -60,  -62,  -65,  -67,  -69,  -71,  -73,  -76,  -78,
+     -80,  -83,  -85,  -88,  -91,  -93,  -96,  -99, -102, -105, -108, -111, -114, -118, -121, -124,
+};
+
+// Black body RGB at full brightness (Tanner Helland's fit), 1000 K - 12000 K
+// in 100 K steps
+static const uint8_t CCT_TABLE[(CCT_MAX_KELVIN - CCT_MIN_KELVIN) / CCT_STEP_KELVIN + 1][3] = {
+    {255,  68,   0}, {255,  77,   0}, {255,  86,   0}, {255,  94,   0},
+    {255, 101,   0}, {255, 108,   0}, {255, 115,   0}, {255, 121,   0},
+    {255, 126,   0}, {255, 132,   0}, {255, 137,  14}, {255, 142,  27},
+    {255, 146,  39}, {255, 151,  50}, {255, 155,  61}, {255, 159,  70},
+    {255, 163,  79}, {255, 167,  87}, {255, 170,  95}, {255, 174, 103},
+    {255, 177, 110}, {255, 180, 117}, {255, 184, 123}, {255, 187, 129},
+    {255, 190, 135}, {255, 193, 141}, {255, 195, 146}, {255, 198, 151},
+    {255, 201, 157}, {255, 203, 161}, {255, 206, 166}, {255, 208, 171},
+    {255, 211, 175}, {255, 213, 179}, {255, 215, 183}, {255, 218, 187},
+    {255, 220, 191}, {255, 222, 195}, {255, 224, 199}, {255, 226, 202},
+    {255, 228, 206}, {255, 230, 209}, {255, 232, 213}, {255, 234, 216},
+    {255, 236, 219}, {255, 237, 222}, {255, 239, 225}, {255, 241, 228},
+    {255, 243, 231}, {255, 244, 234}, {255, 246, 237}, {255, 248, 240},
+    {255, 249, 242}, {255, 251, 245}, {255, 253, 248}, {255, 254, 250},
+    {255, 255, 255}, {254, 249, 255}, {250, 246, 255}, {246, 244, 255},
+    {243, 242, 255}, {240, 240, 255}, {237, 239, 255}, {234, 237, 255},
+    {232, 236, 255}, {230, 235, 255}, {228, 234, 255}, {226, 233, 255},
+    {224, 232, 255}, {223, 231, 255}, {221, 230, 255}, {220, 229, 255},
+    {218, 228, 255}, {217, 227, 255}, {216, 227, 255}, {215, 226, 255},
+    {214, 225, 255}, {213, 225, 255}, {212, 224, 255}, {211, 223, 255},
+    {210, 223, 255}, {209, 222, 255}, {208, 222, 255}, {207, 221, 255},
+    {206, 221, 255}, {205, 220, 255}, {205, 220, 255}, {204, 219, 255},
+    {203, 219, 255}, {202, 218, 255}, {202, 218, 255}, {201, 218, 255},
+    {200, 217, 255}, {200, 217, 255}, {199, 217, 255}, {199, 216, 255},
+    {198, 216, 255}, {197, 215, 255}, {197, 215, 255}, {196, 215, 255},
+    {196, 214, 255}, {195, 214, 255}, {195, 214, 255}, {194, 213, 255},
+    {194, 213, 255}, {193, 213, 255}, {193, 213, 255}, {192, 212, 255},
+    {192, 212, 255}, {192, 212, 255}, {191, 211, 255},
+};
+
+const DMXColorLayout DMXColorMixer::RGB = {3, 0, 1, 2, -1, -1, -1, -1};
+const DMXColorLayout DMXColorMixer::RGBW = {4, 0, 1, 2, 3, -1, -1, -1};
+const DMXColorLayout DMXColorMixer::RGBA = {4, 0, 1, 2, -1, 3, -1, -1};
+const DMXColorLayout DMXColorMixer::RGBAW = {5, 0, 1, 2, 4, 3, -1, -1};
+const DMXColorLayout DMXColorMixer::TUNABLE_WHITE = {2, -1, -1, -1, -1, -1, 0, 1};
+
+// x / 255, rounded, for x up to 16 bits
+static inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+static inline uint16_t clampKelvin(uint16_t kelvin) {
+    if (kelvin < CCT_MIN_KELVIN) {
+        return CCT_MIN_KELVIN;
+    }
+    return kelvin > CCT_MAX_KELVIN ? CCT_MAX_KELVIN : kelvin;
+}
+
+// In 1/16 mired: within 1000 K - 12000 K, so 1333 - 16000
+static inline uint16_t kelvinToMired(uint16_t kelvin) {
+    kelvin = clampKelvin(kelvin);
+    return (uint16_t)((16000000u + kelvin / 2) / kelvin);
+}
+
+DMXColorMixer::DMXColorMixer() {
+    static const uint8_t amber[3] = {255, 191, 0};
+    setWhiteKelvin(6500);
+    setAmberRgb(amber);
+    setTunableWhite(2700, 6500);
+}
+
+void DMXColorMixer::makeEmitter(const uint8_t* rgb, Emitter* emitter) {
+    for (uint8_t i = 0; i < 3; i++) {
+        emitter->rgb[i] = rgb[i];
+        emitter->inverse[i] = rgb[i] ? (uint16_t)((255u << 8) / rgb[i]) : 0;
+    }
+}
+
+void DMXColorMixer::setWhiteKelvin(uint16_t kelvin) {
+    uint8_t rgb[3];
+    cctToRgb(kelvin, rgb);
+    setWhiteRgb(rgb);
+}
+
+void DMXColorMixer::setWhiteRgb(const uint8_t* rgb) {
+    makeEmitter(rgb, &_white);
+}
+
+void DMXColorMixer::setAmberRgb(const uint8_t* rgb) {
+    makeEmitter(rgb, &_amber);
+}
+
+bool DMXColorMixer::setTunableWhite(uint16_t warm_kelvin, uint16_t cool_kelvin) {
+    uint16_t warm_mired = kelvinToMired(warm_kelvin);
+    uint16_t cool_mired = kelvinToMired(cool_kelvin);
+    if (warm_kelvin >= cool_kelvin || warm_mired <= cool_mired) {
+        return false;
+    }
+    _warm_mired = warm_mired;
+    _cool_mired = cool_mired;
+    return true;
+}
+
+// Move as much of the emitter as rgb holds out of rgb; returns its level
+uint8_t DMXColorMixer::extract(uint8_t* rgb, const Emitter& emitter) {
+    uint32_t amount = 255;
+    bool any = false;
+    for (uint8_t i = 0; i < 3; i++) {
+        if (emitter.inverse[i]) {
+            uint32_t held = ((uint32_t)rgb[i] * emitter.inverse[i]) >> 8;
+            if (held < amount) {
+                amount = held;
+            }
+            any = true;
+        }
+    }
+    if (!any || amount == 0) {
+        return 0;
+    }
+    for (uint8_t i = 0; i < 3; i++) {
+        uint32_t used = div255(amount * emitter.rgb[i]);
+        rgb[i] = used < rgb[i] ? (uint8_t)(rgb[i] - used) : 0;
+    }
+    return (uint8_t)amount;
+}
+
+void DMXColorMixer::store(uint8_t* rgb, uint8_t* fixture, const DMXColorLayout& layout) const {
+    uint8_t white = layout.white >= 0 ? extract(rgb, _white) : 0;
+    uint8_t amber = layout.amber >= 0 ? extract(rgb, _amber) : 0;
+    if (layout.red >= 0) {
+        fixture[layout.red] = rgb[0];
+    }
+    if (layout.green >= 0) {
+        fixture[layout.green] = rgb[1];
+    }
+    if (layout.blue >= 0) {
+        fixture[layout.blue] = rgb[2];
+    }
+    if (layout.white >= 0) {
+        fixture[layout.white] = white;
+    }
+    if (layout.amber >= 0) {
+        fixture[layout.amber] = amber;
+    }
+}
+
+void DMXColorMixer::renderRgb(const uint8_t* rgb, uint16_t count, uint8_t* slots, const DMXColorLayout& layout) const {
+    // Plain RGB fixtures take the colours as they are
+    if (layout.white < 0 && layout.amber < 0 && layout.red == 0 && layout.green == 1 && layout.blue == 2) {
+        for (uint16_t f = 0; f < count; f++, rgb += 3, slots += layout.footprint) {
+            slots[0] = rgb[0];
+            slots[1] = rgb[1];
+            slots[2] = rgb[2];
+        }
+        return;
+    }
+    for (uint16_t f = 0; f < count; f++, rgb += 3, slots += layout.footprint) {
+        uint8_t color[3] = {rgb[0], rgb[1], rgb[2]};
+        store(color, slots, layout);
+    }
+}
+
+void DMXColorMixer::renderHsv(const uint8_t* hsv, uint16_t count, uint8_t* slots, const DMXColorLayout& layout) const {
+    for (uint16_t f = 0; f < count; f++, hsv += 3, slots += layout.footprint) {
+        uint8_t color[3];
+        DMXEffects::hsvToRgb(hsv[0], hsv[1], hsv[2], color);
+        store(color, slots, layout);
+    }
+}
+
+void DMXColorMixer::renderHsi(const uint8_t* hsi, uint16_t count, uint8_t* slots, const DMXColorLayout& layout) const {
+    for (uint16_t f = 0; f < count; f++, hsi += 3, slots += layout.footprint) {
+        uint8_t color[3];
+        hsiToRgb(hsi[0], hsi[1], hsi[2], color);
+        store(color, slots, layout);
+    }
+}
+
+void DMXColorMixer::renderCct(const uint16_t* kelvin, const uint8_t* level, uint16_t count, uint8_t* slots,
+                              const DMXColorLayout& layout) const {
+    bool tunable = layout.warm_white >= 0 || layout.cool_white >= 0;
+    uint32_t span = _warm_mired - _cool_mired;
+    for (uint16_t f = 0; f < count; f++, slots += layout.footprint) {
+        if (!tunable) {
+            uint8_t color[3];
+            cctToRgb(kelvin[f], color);
+            for (uint8_t i = 0; i < 3; i++) {
+                color[i] = DMXEffects::scale8(color[i], level[f]);
+            }
+            store(color, slots, layout);
+            continue;
+        }
+
+        // Share of the cool emitter, 0-65536, linear in mireds between the two
+        uint16_t mired = kelvinToMired(kelvin[f]);
+        uint32_t cool_share;
+        if (mired >= _warm_mired) {
+            cool_share = 0;
+        } else if (mired <= _cool_mired) {
+            cool_share = 65536;
+        } else {
+            cool_share = (((uint32_t)(_warm_mired - mired) << 16) + span / 2) / span;
+        }
+        uint8_t cool = (uint8_t)((level[f] * cool_share + 32768) >> 16);
+        if (layout.warm_white >= 0) {
+            slots[layout.warm_white] = (uint8_t)(level[f] - cool);
+        }
+        if (layout.cool_white >= 0) {
+            slots[layout.cool_white] = cool;
+        }
+        uint8_t black[3] = {0, 0, 0};
+        store(black, slots, layout);
+    }
+}
+
+void DMXColorMixer::hsiToRgb(uint8_t hue, uint8_t sat, uint8_t intensity, uint8_t* rgb) {
+    // Three 120 degree sectors; the leading component rotates through r, g, b
+    uint16_t position = (uint16_t)hue * 3;
+    uint8_t sector = (uint8_t)(position >> 8);
+    int32_t ratio = HSI_RATIO_TABLE[position & 0xFF];
+
+    // I/3 * (1 + S * ratio), I/3 * (1 + S * (1 - ratio)), I/3 * (1 - S): the
+    // three always sum to the intensity
+    const int32_t one = 255 * 128;
+    uint8_t lead = (uint8_t)(intensity * (one + sat * ratio) / (3 * one));
+    uint8_t next = (uint8_t)(intensity * (one + sat * (128 - ratio)) / (3 * one));
+    uint8_t low = (uint8_t)(intensity * (255 - sat) / (3 * 255));
+
+    uint8_t lead_index = sector;
+    uint8_t next_index = sector == 2 ? 0 : sector + 1;
+    uint8_t low_index = sector == 0 ? 2 : sector - 1;
+    rgb[lead_index] = lead;
+    rgb[next_index] = next;
+    rgb[low_index] = low;
+}
+
+void DMXColorMixer::cctToRgb(uint16_t kelvin, uint8_t* rgb) {
+    kelvin = clampKelvin(kelvin);
+    // Linear between the two nearest table entries
+    uint16_t index = (kelvin - CCT_MIN_KELVIN) / CCT_STEP_KELVIN;
+    uint16_t fraction = (kelvin - CCT_MIN_KELVIN) % CCT_STEP_KELVIN;
+    const uint8_t* low = CCT_TABLE[index];
+    const uint8_t* high = fraction ? CCT_TABLE[index + 1] : low;
+    for (uint8_t i = 0; i < 3; i++) {
+        rgb[i] = (uint8_t)((low[i] * (CCT_STEP_KELVIN - fraction) + high[i] * fraction + CCT_STEP_KELVIN / 2) /
+                           CCT_STEP_KELVIN);
+    }
+}
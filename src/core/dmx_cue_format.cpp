@@ -0,0 +1,241 @@
+#include "dmx_cue_format.h"
+#include <string.h>
+
+#define DMX_CUE_OP_SKIP    0x00
+#define DMX_CUE_OP_LITERAL 0x40
+#define DMX_CUE_OP_RUN     0x80
+#define DMX_CUE_OP_TYPE_MASK 0xC0
+#define DMX_CUE_OP_LONG    0x20
+
+// Shortest run of identical changed values worth encoding as RUN
+#define DMX_CUE_MIN_RUN 3
+
+DMXCueShow::DMXCueShow() : _data(nullptr), _size(0), _num_cues(0), _num_universes(0) {
+}
+
+bool DMXCueShow::open(const uint8_t* data, size_t size) {
+    _data = nullptr;
+    _size = 0;
+    _num_cues = 0;
+    _num_universes = 0;
+
+    if (data == nullptr || size < DMX_CUE_HEADER_SIZE) {
+        return false;
+    }
+    if (dmxCueReadU32(&data[0]) != DMX_CUE_MAGIC || dmxCueReadU16(&data[4]) != DMX_CUE_VERSION) {
+        return false;
+    }
+
+    uint16_t num_cues = dmxCueReadU16(&data[6]);
+    uint8_t num_universes = data[8];
+    if (num_universes == 0 || num_universes > DMX_CUE_MAX_UNIVERSES ||
+        size < DMX_CUE_HEADER_SIZE + (size_t)num_cues * DMX_CUE_INDEX_ENTRY_SIZE) {
+        return false;
+    }
+
+    // Every cue's data must lie inside the image
+    for (uint16_t i = 0; i < num_cues; i++) {
+        const uint8_t* entry = &data[DMX_CUE_HEADER_SIZE + i * DMX_CUE_INDEX_ENTRY_SIZE];
+        uint32_t offset = dmxCueReadU32(&entry[0]);
+        uint32_t length = dmxCueReadU32(&entry[4]);
+        if (offset > size || length > size - offset) {
+            return false;
+        }
+    }
+
+    _data = data;
+    _size = size;
+    _num_cues = num_cues;
+    _num_universes = num_universes;
+    return true;
+}
+
+bool DMXCueShow::isValid() const {
+    return _data != nullptr;
+}
+
+uint16_t DMXCueShow::getNumCues() const {
+    return _num_cues;
+}
+
+uint8_t DMXCueShow::getNumUniverses() const {
+    return _num_universes;
+}
+
+bool DMXCueShow::getCueInfo(uint16_t cue_index, CueInfo* info) const {
+    if (!isValid() || info == nullptr || cue_index >= _num_cues) {
+        return false;
+    }
+
+    const uint8_t* entry = &_data[DMX_CUE_HEADER_SIZE + cue_index * DMX_CUE_INDEX_ENTRY_SIZE];
+    info->data_offset = dmxCueReadU32(&entry[0]);
+    info->data_length = dmxCueReadU32(&entry[4]);
+    info->fade_ms = dmxCueReadU32(&entry[8]);
+    info->cue_number = dmxCueReadU16(&entry[12]);
+    info->flags = dmxCueReadU16(&entry[14]);
+    return true;
+}
+
+const uint8_t* DMXCueShow::getCueData(uint16_t cue_index) const {
+    CueInfo info;
+    if (!getCueInfo(cue_index, &info)) {
+        return nullptr;
+    }
+    return &_data[info.data_offset];
+}
+
+uint16_t DMXCueShow::findKeyframe(uint16_t cue_index) const {
+    CueInfo info;
+    while (cue_index > 0) {
+        if (getCueInfo(cue_index, &info) && (info.flags & DMX_CUE_FLAG_KEYFRAME)) {
+            break;
+        }
+        cue_index--;
+    }
+    return cue_index;
+}
+
+bool DMXCueShow::applyCue(uint16_t cue_index, uint8_t* const universes[], uint8_t num_universes) const {
+    CueInfo info;
+    if (!getCueInfo(cue_index, &info) || universes == nullptr) {
+        return false;
+    }
+
+    // The first cue is always a keyframe
+    if (cue_index == 0 || (info.flags & DMX_CUE_FLAG_KEYFRAME)) {
+        for (uint8_t u = 0; u < num_universes; u++) {
+            if (universes[u]) {
+                memset(universes[u], 0, DMX_UNIVERSE_SIZE);
+            }
+        }
+    }
+
+    const uint8_t* p = &_data[info.data_offset];
+    const uint8_t* end = p + info.data_length;
+    while (p < end) {
+        if (end - p < 3) {
+            return false;
+        }
+        uint8_t universe = p[0];
+        uint16_t length = dmxCueReadU16(&p[1]);
+        p += 3;
+        if (length > end - p) {
+            return false;
+        }
+        if (universe < num_universes && universes[universe] != nullptr) {
+            if (!DMXCueCodec::decodeUniverse(p, length, universes[universe])) {
+                return false;
+            }
+        }
+        p += length;
+    }
+    return true;
+}
+
+// Emit one op header; returns bytes written or 0 if out of space
+static uint16_t emitOp(uint8_t type, uint16_t count, uint8_t* out, uint16_t pos, uint16_t capacity) {
+    uint16_t n = count - 1;
+    if (n < 32) {
+        if (pos + 1 > capacity) return 0;
+        out[pos] = type | (uint8_t)n;
+        return 1;
+    }
+    if (pos + 2 > capacity) return 0;
+    out[pos] = type | DMX_CUE_OP_LONG | (uint8_t)(n >> 8);
+    out[pos + 1] = (uint8_t)n;
+    return 2;
+}
+
+uint16_t DMXCueCodec::encodeUniverse(const uint8_t* prev, const uint8_t* next, uint8_t* out, uint16_t out_capacity) {
+    uint16_t pos = 0;
+    uint16_t pending_skip = 0;
+    uint16_t i = 0;
+
+    while (i < DMX_UNIVERSE_SIZE) {
+        if (prev[i] == next[i]) {
+            pending_skip++;
+            i++;
+            continue;
+        }
+
+        // Changed slot: flush the unchanged stretch before it
+        if (pending_skip > 0) {
+            uint16_t w = emitOp(DMX_CUE_OP_SKIP, pending_skip, out, pos, out_capacity);
+            if (w == 0) return 0;
+            pos += w;
+            pending_skip = 0;
+        }
+
+        // Measure a run of identical new values
+        uint16_t run = 1;
+        while (i + run < DMX_UNIVERSE_SIZE && next[i + run] == next[i]) {
+            run++;
+        }
+        if (run >= DMX_CUE_MIN_RUN) {
+            uint16_t w = emitOp(DMX_CUE_OP_RUN, run, out, pos, out_capacity);
+            if (w == 0 || pos + w + 1 > out_capacity) return 0;
+            pos += w;
+            out[pos++] = next[i];
+            i += run;
+            continue;
+        }
+
+        // Literal: extend until two unchanged slots or a worthwhile run begins
+        uint16_t start = i;
+        while (i < DMX_UNIVERSE_SIZE) {
+            if (prev[i] == next[i] && (i + 1 >= DMX_UNIVERSE_SIZE || prev[i + 1] == next[i + 1])) {
+                break;
+            }
+            if (i + DMX_CUE_MIN_RUN <= DMX_UNIVERSE_SIZE && i > start &&
+                next[i] == next[i + 1] && next[i] == next[i + 2]) {
+                break;
+            }
+            i++;
+        }
+        uint16_t count = i - start;
+        uint16_t w = emitOp(DMX_CUE_OP_LITERAL, count, out, pos, out_capacity);
+        if (w == 0 || pos + w + count > out_capacity) return 0;
+        pos += w;
+        memcpy(&out[pos], &next[start], count);
+        pos += count;
+    }
+
+    // Trailing unchanged slots are implicit
+    return pos;
+}
+
+bool DMXCueCodec::decodeUniverse(const uint8_t* ops, uint16_t length, uint8_t* universe) {
+    uint16_t pos = 0;
+    uint16_t slot = 0;
+
+    while (pos < length) {
+        uint8_t op = ops[pos++];
+        uint16_t count = op & 0x1F;
+        if (op & DMX_CUE_OP_LONG) {
+            if (pos >= length) return false;
+            count = (count << 8) | ops[pos++];
+        }
+        count++;
+        if (slot + count > DMX_UNIVERSE_SIZE) {
+            return false;
+        }
+
+        switch (op & DMX_CUE_OP_TYPE_MASK) {
+            case DMX_CUE_OP_SKIP:
+                break;
+            case DMX_CUE_OP_LITERAL:
+                if (pos + count > length) return false;
+                memcpy(&universe[slot], &ops[pos], count);
+                pos += count;
+                break;
+            case DMX_CUE_OP_RUN:
+                if (pos >= length) return false;
+                memset(&universe[slot], ops[pos++], count);
+                break;
+            default:
+                return false;
+        }
+        slot += count;
+    }
+    return true;
+}
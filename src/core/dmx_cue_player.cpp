@@ -0,0 +1,123 @@
+#include "dmx_cue_player.h"
+#include "hardware/regs/addressmap.h"
+#include <cstring>
+
+DMXCuePlayer::DMXCuePlayer()
+    : _show(nullptr), _outputs(nullptr), _num_universes(0), _live(0), _current_cue(-1),
+      _fading(false), _fade_start_ms(0), _fade_ms(0) {
+    memset(_from, 0, sizeof(_from));
+    memset(_target, 0, sizeof(_target));
+}
+
+bool DMXCuePlayer::openFlashShow(DMXCueShow& show) {
+    return show.open((const uint8_t*)(XIP_BASE + DMX_CUE_FLASH_OFFSET), DMX_CUE_FLASH_SIZE);
+}
+
+bool DMXCuePlayer::begin(const DMXCueShow* show, DMXTransmitter outputs[], uint8_t num_outputs) {
+    if (show == nullptr || !show->isValid() || outputs == nullptr || num_outputs == 0) {
+        return false;
+    }
+
+    _show = show;
+    _outputs = outputs;
+    _num_universes = num_outputs < show->getNumUniverses() ? num_outputs : show->getNumUniverses();
+    if (_num_universes > DMX_CUE_MAX_UNIVERSES) {
+        _num_universes = DMX_CUE_MAX_UNIVERSES;
+    }
+    _current_cue = -1;
+    _fading = false;
+    _live = 0;
+    memset(_target, 0, sizeof(_target));
+    return true;
+}
+
+bool DMXCuePlayer::decodeTo(uint16_t cue_index) {
+    uint8_t next = _live ^ 1;
+    uint8_t* universes[DMX_CUE_MAX_UNIVERSES];
+    for (uint8_t u = 0; u < DMX_CUE_MAX_UNIVERSES; u++) {
+        universes[u] = _target[next][u];
+    }
+
+    // Next cue in sequence: one delta on a copy of the live state. Otherwise
+    // replay from the nearest keyframe, which clears the state itself.
+    uint16_t first;
+    if (_current_cue >= 0 && cue_index == _current_cue + 1) {
+        first = cue_index;
+        memcpy(_target[next], _target[_live], sizeof(_target[next]));
+    } else {
+        first = _show->findKeyframe(cue_index);
+    }
+
+    for (uint16_t i = first; i <= cue_index; i++) {
+        if (!_show->applyCue(i, universes, _num_universes)) {
+            return false;
+        }
+    }
+
+    _live = next;
+    _current_cue = cue_index;
+    return true;
+}
+
+bool DMXCuePlayer::go(uint16_t cue_index, uint32_t now_ms) {
+    if (_show == nullptr || cue_index >= _show->getNumCues()) {
+        return false;
+    }
+
+    DMXCueShow::CueInfo info;
+    _show->getCueInfo(cue_index, &info);
+
+    // A cue that fails to decode leaves the current cue and any fade running
+    if (!decodeTo(cue_index)) {
+        return false;
+    }
+
+    // Fade starts from whatever is on the outputs now, including a fade in progress
+    for (uint8_t u = 0; u < _num_universes; u++) {
+        memcpy(_from[u], _outputs[u].getUniverseBuffer(), DMX_UNIVERSE_SIZE);
+    }
+
+    _fade_start_ms = now_ms;
+    _fade_ms = info.fade_ms;
+    _fading = true;
+    update(now_ms);
+    return true;
+}
+
+bool DMXCuePlayer::goNext(uint32_t now_ms) {
+    return go((uint16_t)(_current_cue + 1), now_ms);
+}
+
+void DMXCuePlayer::update(uint32_t now_ms) {
+    if (!_fading) {
+        return;
+    }
+
+    uint32_t elapsed = now_ms - _fade_start_ms;
+    if (elapsed >= _fade_ms) {
+        for (uint8_t u = 0; u < _num_universes; u++) {
+            memcpy(_outputs[u].getUniverseBuffer(), _target[_live][u], DMX_UNIVERSE_SIZE);
+        }
+        _fading = false;
+        return;
+    }
+
+    // 16-bit fixed-point progress, integer-only interpolation
+    int32_t progress = (int32_t)(((uint64_t)elapsed << 16) / _fade_ms);
+    for (uint8_t u = 0; u < _num_universes; u++) {
+        const uint8_t* from = _from[u];
+        const uint8_t* to = _target[_live][u];
+        uint8_t* out = _outputs[u].getUniverseBuffer();
+        for (uint16_t i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+            out[i] = (uint8_t)(from[i] + (((to[i] - from[i]) * progress) >> 16));
+        }
+    }
+}
+
+bool DMXCuePlayer::isFading() const {
+    return _fading;
+}
+
+int32_t DMXCuePlayer::getCurrentCue() const {
+    return _current_cue;
+}
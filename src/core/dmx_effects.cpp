@@ -0,0 +1,335 @@
+#include "dmx_effects.h"
+#include <cstring>
+
+// sin8(i) = 127.5 + 127.5 * sin(2 * pi * i / 256)
+static const uint8_t SIN8_TABLE[256] = {
+    128, 131, 134, 137, 140, 143, 146, 149, 152, 155, 158, 162, 165, 167, 170, 173,
+    176, 179, 182, 185, 188, 190, 193, 196, 198, 201, 203, 206, 208, 211, 213, 215,
+    218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 238, 240, 241, 243, 244,
+    245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+    255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+    245, 244, 243, 241, 240, 238, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+    218, 215, 213, 211, 208, 206, 203, 201, 198, 196, 193, 190, 188, 185, 182, 179,
+    176, 173, 170, 167, 165, 162, 158, 155, 152, 149, 146, 143, 140, 137, 134, 131,
+    128, 124, 121, 118, 115, 112, 109, 106, 103, 100,  97,  93,  90,  88,  85,  82,
+     79,  76,  73,  70,  67,  65,  62,  59,  57,  54,  52,  49,  47,  44,  42,  40,
+     37,  35,  33,  31,  29,  27,  25,  23,  21,  20,  18,  17,  15,  14,  12,  11,
+     10,   9,   7,   6,   5,   5,   4,   3,   2,   2,   1,   1,   1,   0,   0,   0,
+      0,   0,   0,   0,   1,   1,   1,   2,   2,   3,   4,   5,   5,   6,   7,   9,
+     10,  11,  12,  14,  15,  17,  18,  20,  21,  23,  25,  27,  29,  31,  33,  35,
+     37,  40,  42,  44,  47,  49,  52,  54,  57,  59,  62,  65,  67,  70,  73,  76,
+     79,  82,  85,  88,  90,  93,  97, 100, 103, 106, 109, 112, 115, 118, 121, 124,
+};
+
+// Fully saturated, full brightness colour wheel; 256 hues, 6 sectors
+static const uint8_t HUE_TABLE[256][3] = {
+    {255,   0,   0}, {255,   6,   0}, {255,  12,   0}, {255,  18,   0},
+    {255,  24,   0}, {255,  30,   0}, {255,  36,   0}, {255,  42,   0},
+    {255,  48,   0}, {255,  54,   0}, {255,  60,   0}, {255,  66,   0},
+    {255,  72,   0}, {255,  78,   0}, {255,  84,   0}, {255,  90,   0},
+    {255,  96,   0}, {255, 102,   0}, {255, 108,   0}, {255, 114,   0},
+    {255, 120,   0}, {255, 126,   0}, {255, 131,   0}, {255, 137,   0},
+    {255, 143,   0}, {255, 149,   0}, {255, 155,   0}, {255, 161,   0},
+    {255, 167,   0}, {255, 173,   0}, {255, 179,   0}, {255, 185,   0},
+    {255, 191,   0}, {255, 197,   0}, {255, 203,   0}, {255, 209,   0},
+    {255, 215,   0}, {255, 221,   0}, {255, 227,   0}, {255, 233,   0},
+    {255, 239,   0}, {255, 245,   0}, {255, 251,   0}, {253, 255,   0},
+    {247, 255,   0}, {241, 255,   0}, {235, 255,   0}, {229, 255,   0},
+    {223, 255,   0}, {217, 255,   0}, {211, 255,   0}, {205, 255,   0},
+    {199, 255,   0}, {193, 255,   0}, {187, 255,   0}, {181, 255,   0},
+    {175, 255,   0}, {169, 255,   0}, {163, 255,   0}, {157, 255,   0},
+    {151, 255,   0}, {145, 255,   0}, {139, 255,   0}, {133, 255,   0},
+    {127, 255,   0}, {122, 255,   0}, {116, 255,   0}, {110, 255,   0},
+    {104, 255,   0}, { 98, 255,   0}, { 92, 255,   0}, { 86, 255,   0},
+    { 80, 255,   0}, { 74, 255,   0}, { 68, 255,   0}, { 62, 255,   0},
+    { 56, 255,   0}, { 50, 255,   0}, { 44, 255,   0}, { 38, 255,   0},
+    { 32, 255,   0}, { 26, 255,   0}, { 20, 255,   0}, { 14, 255,   0},
+    {  8, 255,   0}, {  2, 255,   0}, {  0, 255,   4}, {  0, 255,  10},
+    {  0, 255,  16}, {  0, 255,  22}, {  0, 255,  28}, {  0, 255,  34},
+    {  0, 255,  40}, {  0, 255,  46}, {  0, 255,  52}, {  0, 255,  58},
+    {  0, 255,  64}, {  0, 255,  70}, {  0, 255,  76}, {  0, 255,  82},
+    {  0, 255,  88}, {  0, 255,  94}, {  0, 255, 100}, {  0, 255, 106},
+    {  0, 255, 112}, {  0, 255, 118}, {  0, 255, 124}, {  0, 255, 129},
+    {  0, 255, 135}, {  0, 255, 141}, {  0, 255, 147}, {  0, 255, 153},
+    {  0, 255, 159}, {  0, 255, 165}, {  0, 255, 171}, {  0, 255, 177},
+    {  0, 255, 183}, {  0, 255, 189}, {  0, 255, 195}, {  0, 255, 201},
+    {  0, 255, 207}, {  0, 255, 213}, {  0, 255, 219}, {  0, 255, 225},
+    {  0, 255, 231}, {  0, 255, 237}, {  0, 255, 243}, {  0, 255, 249},
+    {  0, 255, 255}, {  0, 249, 255}, {  0, 243, 255}, {  0, 237, 255},
+    {  0, 231, 255}, {  0, 225, 255}, {  0, 219, 255}, {  0, 213, 255},
+    {  0, 207, 255}, {  0, 201, 255}, {  0, 195, 255}, {  0, 189, 255},
+    {  0, 183, 255}, {  0, 177, 255}, {  0, 171, 255}, {  0, 165, 255},
+    {  0, 159, 255}, {  0, 153, 255}, {  0, 147, 255}, {  0, 141, 255},
+    {  0, 135, 255}, {  0, 129, 255}, {  0, 124, 255}, {  0, 118, 255},
+    {  0, 112, 255}, {  0, 106, 255}, {  0, 100, 255}, {  0,  94, 255},
+    {  0,  88, 255}, {  0,  82, 255}, {  0,  76, 255}, {  0,  70, 255},
+    {  0,  64, 255}, {  0,  58, 255}, {  0,  52, 255}, {  0,  46, 255},
+    {  0,  40, 255}, {  0,  34, 255}, {  0,  28, 255}, {  0,  22, 255},
+    {  0,  16, 255}, {  0,  10, 255}, {  0,   4, 255}, {  2,   0, 255},
+    {  8,   0, 255}, { 14,   0, 255}, { 20,   0, 255}, { 26,   0, 255},
+    { 32,   0, 255}, { 38,   0, 255}, { 44,   0, 255}, { 50,   0, 255},
+    { 56,   0, 255}, { 62,   0, 255}, { 68,   0, 255}, { 74,   0, 255},
+    { 80,   0, 255}, { 86,   0, 255}, { 92,   0, 255}, { 98,   0, 255},
+    {104,   0, 255}, {110,   0, 255}, {116,   0, 255}, {122,   0, 255},
+    {128,   0, 255}, {133,   0, 255}, {139,   0, 255}, {145,   0, 255},
+    {151,   0, 255}, {157,   0, 255}, {163,   0, 255}, {169,   0, 255},
+    {175,   0, 255}, {181,   0, 255}, {187,   0, 255}, {193,   0, 255},
+    {199,   0, 255}, {205,   0, 255}, {211,   0, 255}, {217,   0, 255},
+    {223,   0, 255}, {229,   0, 255}, {235,   0, 255}, {241,   0, 255},
+    {247,   0, 255}, {253,   0, 255}, {255,   0, 251}, {255,   0, 245},
+    {255,   0, 239}, {255,   0, 233}, {255,   0, 227}, {255,   0, 221},
+    {255,   0, 215}, {255,   0, 209}, {255,   0, 203}, {255,   0, 197},
+    {255,   0, 191}, {255,   0, 185}, {255,   0, 179}, {255,   0, 173},
+    {255,   0, 167}, {255,   0, 161}, {255,   0, 155}, {255,   0, 149},
+    {255,   0, 143}, {255,   0, 137}, {255,   0, 131}, {255,   0, 126},
+    {255,   0, 120}, {255,   0, 114}, {255,   0, 108}, {255,   0, 102},
+    {255,   0,  96}, {255,   0,  90}, {255,   0,  84}, {255,   0,  78},
+    {255,   0,  72}, {255,   0,  66}, {255,   0,  60}, {255,   0,  54},
+    {255,   0,  48}, {255,   0,  42}, {255,   0,  36}, {255,   0,  30},
+    {255,   0,  24}, {255,   0,  18}, {255,   0,  12}, {255,   0,   6},
+};
+
+uint8_t DMXEffects::sin8(uint8_t phase) {
+    return SIN8_TABLE[phase];
+}
+
+uint8_t DMXEffects::scale8(uint8_t value, uint8_t scale) {
+    return (uint8_t)(((uint16_t)value * (uint16_t)(scale + 1)) >> 8);
+}
+
+void DMXEffects::hsvToRgb(uint8_t hue, uint8_t sat, uint8_t val, uint8_t* rgb) {
+    const uint8_t* wheel = HUE_TABLE[hue];
+    // Desaturate towards white, then scale by value
+    uint8_t white = 255 - sat;
+    for (uint8_t i = 0; i < 3; i++) {
+        uint8_t c = white + scale8(wheel[i], sat);
+        rgb[i] = scale8(c, val);
+    }
+}
+
+bool DMXEffects::isValidRange(const DMXFixtureRange& range) {
+    if (range.start_channel < 1 || range.channels_per_fixture == 0 ||
+        range.color_offset + 3 > range.channels_per_fixture) {
+        return false;
+    }
+    uint32_t last = (uint32_t)range.start_channel - 1 + (uint32_t)range.num_fixtures * range.channels_per_fixture;
+    return last <= DMX_UNIVERSE_SIZE;
+}
+
+// First colour slot of the range inside a 0-based universe buffer
+static inline uint8_t* rangeStart(uint8_t* universe, const DMXFixtureRange& range) {
+    return universe + (range.start_channel - 1) + range.color_offset;
+}
+
+void DMXEffects::renderSolid(uint8_t* universe, const DMXFixtureRange& range, const uint8_t* rgb) {
+    uint8_t* p = rangeStart(universe, range);
+    for (uint16_t f = 0; f < range.num_fixtures; f++, p += range.channels_per_fixture) {
+        p[0] = rgb[0];
+        p[1] = rgb[1];
+        p[2] = rgb[2];
+    }
+}
+
+void DMXEffects::renderRainbow(uint8_t* universe, const DMXFixtureRange& range,
+                               uint8_t hue_start, uint8_t hue_step, uint8_t sat, uint8_t val) {
+    uint8_t* p = rangeStart(universe, range);
+    uint8_t hue = hue_start;
+    bool full = (sat == 255 && val == 255);
+    for (uint16_t f = 0; f < range.num_fixtures; f++, p += range.channels_per_fixture) {
+        if (full) {
+            const uint8_t* wheel = HUE_TABLE[hue];
+            p[0] = wheel[0];
+            p[1] = wheel[1];
+            p[2] = wheel[2];
+        } else {
+            hsvToRgb(hue, sat, val, p);
+        }
+        hue += hue_step;
+    }
+}
+
+void DMXEffects::renderSine(uint8_t* universe, const DMXFixtureRange& range,
+                            uint8_t phase, uint8_t phase_step, const uint8_t* rgb) {
+    uint8_t* p = rangeStart(universe, range);
+    for (uint16_t f = 0; f < range.num_fixtures; f++, p += range.channels_per_fixture) {
+        uint8_t level = SIN8_TABLE[phase];
+        p[0] = scale8(rgb[0], level);
+        p[1] = scale8(rgb[1], level);
+        p[2] = scale8(rgb[2], level);
+        phase += phase_step;
+    }
+}
+
+void DMXEffects::renderChase(uint8_t* universe, const DMXFixtureRange& range,
+                             uint16_t position, uint16_t width, const uint8_t* rgb) {
+    static const uint8_t black[3] = {0, 0, 0};
+    renderSolid(universe, range, black);
+
+    if (range.num_fixtures == 0) {
+        return;
+    }
+    if (width > range.num_fixtures) {
+        width = range.num_fixtures;
+    }
+
+    // Light `width` fixtures starting at `position`, wrapping around the range
+    uint16_t f = position % range.num_fixtures;
+    for (uint16_t i = 0; i < width; i++) {
+        uint8_t* p = rangeStart(universe, range) + f * range.channels_per_fixture;
+        p[0] = rgb[0];
+        p[1] = rgb[1];
+        p[2] = rgb[2];
+        if (++f == range.num_fixtures) {
+            f = 0;
+        }
+    }
+}
+
+void DMXEffects::renderStrobe(uint8_t* universe, const DMXFixtureRange& range, bool on, const uint8_t* rgb) {
+    static const uint8_t black[3] = {0, 0, 0};
+    renderSolid(universe, range, on ? rgb : black);
+}
+
+void DMXEffects::renderRamp(uint8_t* universe, const DMXFixtureRange& range,
+                            uint8_t phase, uint8_t phase_step, const uint8_t* rgb) {
+    uint8_t* p = rangeStart(universe, range);
+    for (uint16_t f = 0; f < range.num_fixtures; f++, p += range.channels_per_fixture) {
+        p[0] = scale8(rgb[0], phase);
+        p[1] = scale8(rgb[1], phase);
+        p[2] = scale8(rgb[2], phase);
+        phase += phase_step;
+    }
+}
+
+void DMXEffects::renderTwinkle(uint8_t* universe, const DMXFixtureRange& range,
+                               uint32_t* seed, uint8_t density, const uint8_t* rgb) {
+    uint8_t* p = rangeStart(universe, range);
+    uint32_t x = *seed ? *seed : 0x2545F491u;
+    for (uint16_t f = 0; f < range.num_fixtures; f++, p += range.channels_per_fixture) {
+        // xorshift32
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        bool lit = (uint8_t)x < density;
+        p[0] = lit ? rgb[0] : 0;
+        p[1] = lit ? rgb[1] : 0;
+        p[2] = lit ? rgb[2] : 0;
+    }
+    *seed = x;
+}
+
+DMXEffectEngine::DMXEffectEngine() : _num_layers(0), _last_render_ms(0), _started(false) {
+    memset(_layers, 0, sizeof(_layers));
+}
+
+uint32_t DMXEffectEngine::phaseIncrement(uint32_t rate_millihertz) {
+    // 2^32 phase units per cycle; rate_millihertz / 10^6 cycles per millisecond
+    return (uint32_t)(((uint64_t)rate_millihertz << 32) / 1000000u);
+}
+
+int8_t DMXEffectEngine::addEffect(const DMXFixtureRange& range, const EffectParams& params) {
+    if (_num_layers >= MAX_DMX_EFFECT_LAYERS || !DMXEffects::isValidRange(range)) {
+        return -1;
+    }
+
+    uint8_t index = 0;
+    while (_layers[index].in_use) {
+        index++;
+    }
+
+    Layer& layer = _layers[index];
+    layer.range = range;
+    layer.phase = 0;
+    layer.seed = 0x2545F491u + index;
+    layer.params = params;
+    layer.phase_per_ms = phaseIncrement(params.rate_millihertz);
+    layer.in_use = true;
+    _num_layers++;
+    return (int8_t)index;
+}
+
+bool DMXEffectEngine::setParams(uint8_t layer, const EffectParams& params) {
+    if (layer >= MAX_DMX_EFFECT_LAYERS || !_layers[layer].in_use) {
+        return false;
+    }
+
+    _layers[layer].params = params;
+    _layers[layer].phase_per_ms = phaseIncrement(params.rate_millihertz);
+    return true;
+}
+
+void DMXEffectEngine::removeEffect(uint8_t layer) {
+    if (layer >= MAX_DMX_EFFECT_LAYERS || !_layers[layer].in_use) {
+        return;
+    }
+
+    _layers[layer].in_use = false;
+    _layers[layer].params.type = EFFECT_NONE;
+    _num_layers--;
+}
+
+void DMXEffectEngine::clear() {
+    memset(_layers, 0, sizeof(_layers));
+    _num_layers = 0;
+}
+
+void DMXEffectEngine::render(DMXTransmitter outputs[], uint8_t num_outputs, uint32_t now_ms) {
+    uint32_t elapsed = _started ? now_ms - _last_render_ms : 0;
+    _last_render_ms = now_ms;
+    _started = true;
+
+    for (uint8_t i = 0; i < MAX_DMX_EFFECT_LAYERS; i++) {
+        Layer& layer = _layers[i];
+        if (!layer.in_use) {
+            continue;
+        }
+        uint32_t previous_phase = layer.phase;
+        layer.phase += layer.phase_per_ms * elapsed;
+
+        if (layer.range.universe >= num_outputs) {
+            continue;
+        }
+
+        uint8_t* universe = outputs[layer.range.universe].getUniverseBuffer();
+        const EffectParams& p = layer.params;
+        uint8_t phase8 = (uint8_t)(layer.phase >> 24);
+
+        switch (p.type) {
+            case EFFECT_SOLID:
+                DMXEffects::renderSolid(universe, layer.range, p.rgb);
+                break;
+            case EFFECT_RAINBOW:
+                DMXEffects::renderRainbow(universe, layer.range, phase8, p.spread, p.rgb[1], p.rgb[2]);
+                break;
+            case EFFECT_SINE:
+                DMXEffects::renderSine(universe, layer.range, phase8, p.spread, p.rgb);
+                break;
+            case EFFECT_CHASE: {
+                uint16_t position = (uint16_t)(((layer.phase >> 16) * layer.range.num_fixtures) >> 16);
+                DMXEffects::renderChase(universe, layer.range, position, p.width ? p.width : 1, p.rgb);
+                break;
+            }
+            case EFFECT_STROBE:
+                DMXEffects::renderStrobe(universe, layer.range, phase8 < p.width, p.rgb);
+                break;
+            case EFFECT_RAMP:
+                DMXEffects::renderRamp(universe, layer.range, phase8, p.spread, p.rgb);
+                break;
+            case EFFECT_TWINKLE: {
+                // New sparkle pattern once per cycle, held in between
+                if (layer.phase < previous_phase) {
+                    layer.seed = layer.seed * 1664525u + 1013904223u;
+                }
+                uint32_t seed = layer.seed;
+                DMXEffects::renderTwinkle(universe, layer.range, &seed, p.width, p.rgb);
+                break;
+            }
+            case EFFECT_NONE:
+                break;
+        }
+    }
+}
+
+uint8_t DMXEffectEngine::getNumLayers() const {
+    return _num_layers;
+}
@@ -0,0 +1,231 @@
+#include "dmx_fade_engine.h"
+#include <cstring>
+
+// The fade progress render() computed last, reused by the next slot when it
+// is part of the same range fade
+struct DMXFadeEngine::Progress {
+    uint32_t remaining;
+    uint16_t duration; // 0 = nothing cached
+    uint8_t shift;
+    uint32_t progress;
+};
+
+// Nearest output level of a 16.16 value
+static inline uint8_t levelOf(uint32_t value) {
+    return (uint8_t)((value + 0x8000) >> 16);
+}
+
+DMXFadeEngine::DMXFadeEngine()
+    : _outputs(nullptr), _num_universes(0), _last_render_ms(0), _active_count(0) {
+    memset(_from, 0, sizeof(_from));
+    memset(_remaining, 0, sizeof(_remaining));
+    memset(_duration, 0, sizeof(_duration));
+    memset(_shift, 0, sizeof(_shift));
+    memset(_target, 0, sizeof(_target));
+    memset(_active, 0, sizeof(_active));
+}
+
+bool DMXFadeEngine::begin(DMXTransmitter outputs[], uint8_t num_universes, uint32_t now_ms) {
+    if (outputs == nullptr || num_universes == 0 || num_universes > DMX_FADE_MAX_UNIVERSES) {
+        return false;
+    }
+
+    _outputs = outputs;
+    _num_universes = num_universes;
+    _last_render_ms = now_ms;
+    stopAll();
+
+    for (uint8_t u = 0; u < num_universes; u++) {
+        const uint8_t* buffer = outputs[u].getUniverseBuffer();
+        for (uint16_t i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+            uint16_t slot = u * DMX_UNIVERSE_SIZE + i;
+            _from[slot] = (uint32_t)buffer[i] << 16;
+            _target[slot] = buffer[i];
+        }
+    }
+    return true;
+}
+
+bool DMXFadeEngine::slotIndex(uint8_t universe, uint16_t channel, uint16_t* slot) const {
+    if (universe >= _num_universes || channel < 1 || channel > DMX_UNIVERSE_SIZE) {
+        return false;
+    }
+    *slot = universe * DMX_UNIVERSE_SIZE + (channel - 1);
+    return true;
+}
+
+// How much of the fade is left, 65536 at its start down to 0 at its end.
+// Durations past 16 bits are scaled down so one 32-bit division does
+inline uint32_t DMXFadeEngine::progress(uint16_t slot) const {
+    return ((_remaining[slot] >> _shift[slot]) << 16) / _duration[slot];
+}
+
+inline uint32_t DMXFadeEngine::valueAt(uint16_t slot, uint32_t progress) const {
+    int32_t target = (int32_t)_target[slot] << 16;
+    int32_t delta = target - (int32_t)_from[slot];
+    return (uint32_t)(target - (int32_t)(((int64_t)delta * progress) >> 16));
+}
+
+uint32_t DMXFadeEngine::currentValue(uint16_t slot) const {
+    return _remaining[slot] == 0 ? _from[slot] : valueAt(slot, progress(slot));
+}
+
+void DMXFadeEngine::startFade(uint16_t slot, uint8_t target, uint32_t duration_ms) {
+    uint32_t word = slot >> 5;
+    uint32_t bit = 1u << (slot & 31);
+
+    if (duration_ms > DMX_FADE_MAX_DURATION_MS) {
+        duration_ms = DMX_FADE_MAX_DURATION_MS;
+    }
+
+    // A fade in progress continues from where it has got to
+    _from[slot] = currentValue(slot);
+    _target[slot] = target;
+    _remaining[slot] = duration_ms; // 0 = snapped on the next render()
+
+    uint8_t shift = 0;
+    while ((duration_ms >> shift) > 0xFFFF) {
+        shift++;
+    }
+    _duration[slot] = (uint16_t)(duration_ms >> shift);
+    _shift[slot] = shift;
+
+    if (!(_active[word] & bit)) {
+        _active[word] |= bit;
+        _active_count++;
+    }
+}
+
+void DMXFadeEngine::finishFade(uint16_t slot) {
+    _from[slot] = (uint32_t)_target[slot] << 16;
+    _remaining[slot] = 0;
+    _active[slot >> 5] &= ~(1u << (slot & 31));
+    _active_count--;
+}
+
+bool DMXFadeEngine::fadeTo(uint8_t universe, uint16_t channel, uint8_t target, uint32_t duration_ms) {
+    uint16_t slot;
+    if (!slotIndex(universe, channel, &slot)) {
+        return false;
+    }
+
+    startFade(slot, target, duration_ms);
+    return true;
+}
+
+bool DMXFadeEngine::fadeRangeTo(uint8_t universe, uint16_t start_channel, const uint8_t* targets,
+                                uint16_t length, uint32_t duration_ms) {
+    uint16_t slot;
+    if (targets == nullptr || !slotIndex(universe, start_channel, &slot) ||
+        start_channel + length - 1 > DMX_UNIVERSE_SIZE) {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < length; i++) {
+        startFade(slot + i, targets[i], duration_ms);
+    }
+    return true;
+}
+
+bool DMXFadeEngine::fadeUniverseTo(uint8_t universe, const uint8_t* targets, uint32_t duration_ms) {
+    return fadeRangeTo(universe, 1, targets, DMX_UNIVERSE_SIZE, duration_ms);
+}
+
+void DMXFadeEngine::stop(uint8_t universe, uint16_t channel) {
+    uint16_t slot;
+    if (!slotIndex(universe, channel, &slot) || !(_active[slot >> 5] & (1u << (slot & 31)))) {
+        return;
+    }
+
+    // Hold the current value as the new target
+    _target[slot] = levelOf(currentValue(slot));
+    finishFade(slot);
+}
+
+void DMXFadeEngine::stopAll() {
+    for (uint16_t word = 0; word < DMX_FADE_MAX_SLOTS / 32; word++) {
+        uint32_t bits = _active[word];
+        while (bits) {
+            uint16_t slot = (word << 5) + __builtin_ctz(bits);
+            bits &= bits - 1;
+            _target[slot] = levelOf(currentValue(slot));
+            finishFade(slot);
+        }
+    }
+}
+
+inline uint8_t DMXFadeEngine::renderSlot(uint16_t slot, uint32_t elapsed, Progress* last) {
+    if (_remaining[slot] <= elapsed) {
+        finishFade(slot);
+        return _target[slot];
+    }
+
+    uint32_t remaining = _remaining[slot] - elapsed;
+    _remaining[slot] = remaining;
+    if (remaining != last->remaining || _duration[slot] != last->duration || _shift[slot] != last->shift) {
+        last->remaining = remaining;
+        last->duration = _duration[slot];
+        last->shift = _shift[slot];
+        last->progress = progress(slot);
+    }
+    return levelOf(valueAt(slot, last->progress));
+}
+
+void DMXFadeEngine::render(uint32_t now_ms) {
+    uint32_t elapsed = now_ms - _last_render_ms;
+    _last_render_ms = now_ms;
+
+    if (_outputs == nullptr || _active_count == 0) {
+        return;
+    }
+
+    Progress last = {0, 0, 0, 0};
+    uint16_t num_words = (_num_universes * DMX_UNIVERSE_SIZE) / 32;
+    for (uint16_t word = 0; word < num_words; word++) {
+        uint32_t bits = _active[word];
+        if (bits == 0) {
+            continue; // 32 idle slots skipped with one compare
+        }
+
+        // A bitmap word never straddles two universes (512 is a multiple of 32)
+        uint16_t base = word << 5;
+        uint8_t universe = base / DMX_UNIVERSE_SIZE;
+        uint16_t universe_base = universe * DMX_UNIVERSE_SIZE;
+        uint8_t* out = _outputs[universe].getUniverseBuffer();
+
+        if (bits == 0xFFFFFFFFu) {
+            // Fully active word (typical for range and universe fades): straight
+            // contiguous loop over the arrays without per-bit scanning
+            for (uint16_t slot = base; slot < base + 32; slot++) {
+                out[slot - universe_base] = renderSlot(slot, elapsed, &last);
+            }
+            continue;
+        }
+
+        while (bits) {
+            uint16_t slot = base + __builtin_ctz(bits);
+            bits &= bits - 1;
+            out[slot - universe_base] = renderSlot(slot, elapsed, &last);
+        }
+    }
+}
+
+uint8_t DMXFadeEngine::getValue(uint8_t universe, uint16_t channel) const {
+    uint16_t slot;
+    if (!slotIndex(universe, channel, &slot)) {
+        return 0;
+    }
+    return levelOf(currentValue(slot));
+}
+
+bool DMXFadeEngine::isFading(uint8_t universe, uint16_t channel) const {
+    uint16_t slot;
+    if (!slotIndex(universe, channel, &slot)) {
+        return false;
+    }
+    return (_active[slot >> 5] & (1u << (slot & 31))) != 0;
+}
+
+uint16_t DMXFadeEngine::getActiveFadeCount() const {
+    return _active_count;
+}
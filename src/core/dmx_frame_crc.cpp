@@ -0,0 +1,30 @@
+#include "dmx_frame_crc.h"
+
+// Reflected polynomial 0x04C11DB7, one entry per byte value
+struct CrcTable {
+    uint32_t entries[256];
+
+    constexpr CrcTable() : entries() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; bit++) {
+                c = (c & 1u) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+            }
+            entries[i] = c;
+        }
+    }
+};
+
+static constexpr CrcTable CRC_TABLE;
+
+uint32_t DMXFrameCrc::compute(const volatile uint8_t* data, size_t length) {
+    return update(0, data, length);
+}
+
+uint32_t DMXFrameCrc::update(uint32_t crc, const volatile uint8_t* data, size_t length) {
+    uint32_t c = crc ^ DMX_FRAME_CRC_SEED;
+    for (size_t i = 0; i < length; i++) {
+        c = CRC_TABLE.entries[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ DMX_FRAME_CRC_SEED;
+}
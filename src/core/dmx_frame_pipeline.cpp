@@ -0,0 +1,122 @@
+#include "dmx_frame_pipeline.h"
+#include "dmx_profile.h"
+#include "dmx_load.h"
+#include <cstring>
+
+DMXFramePipeline::DMXFramePipeline()
+    : _outputs(nullptr), _num_outputs(0), _frame_period_us(0), _render(nullptr),
+      _user_data(nullptr), _space(nullptr), _next_frame_us(0), _started(false) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool DMXFramePipeline::begin(DMXTransmitter outputs[], uint8_t num_outputs, uint32_t frame_period_us,
+                             DMXRenderCallback render, void* user_data) {
+    if (outputs == nullptr || num_outputs == 0 || frame_period_us == 0) {
+        return false;
+    }
+
+    _outputs = outputs;
+    _num_outputs = num_outputs;
+    _frame_period_us = frame_period_us;
+    _render = render;
+    _user_data = user_data;
+    _started = false;
+    resetStats();
+
+    // Render frame 0 up front so the first boundary has something to send
+    if (_render) {
+        _render(_outputs, _num_outputs, 0, _user_data);
+    }
+    return true;
+}
+
+void DMXFramePipeline::setOutputSpace(DMXOutputSpace* space) {
+    _space = space;
+}
+
+bool DMXFramePipeline::outputsBusy() {
+    for (uint8_t i = 0; i < _num_outputs; i++) {
+        if (_outputs[i].isBusy()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DMXFramePipeline::poll() {
+    if (_outputs == nullptr) {
+        return false;
+    }
+
+    uint64_t now = time_us_64();
+    if (!_started) {
+        _next_frame_us = now;
+        _started = true;
+    }
+
+    if (now < _next_frame_us || outputsBusy()) {
+        return false;
+    }
+
+    // Frame boundary: present the back buffers that were rendered ahead
+    DMX_LOAD_ENTER(load_context, DMX_LOAD_TX);
+    if (now - _next_frame_us > _frame_period_us / 10) {
+        _stats.late_starts++;
+    }
+    DMX_PROFILE_RECORD(DMX_PROFILE_TX_START_JITTER, (uint32_t)(now - _next_frame_us));
+    if (_space) {
+        _space->transmit(_outputs, _num_outputs);
+    } else {
+        for (uint8_t i = 0; i < _num_outputs; i++) {
+            _outputs[i].transmit();
+        }
+    }
+    _stats.frames_sent++;
+
+    // Keep a fixed cadence; resynchronise if we fell more than a frame behind
+    _next_frame_us += _frame_period_us;
+    if (now > _next_frame_us) {
+        _next_frame_us = now + _frame_period_us;
+    }
+
+    // Render the next frame while this one is on the wire
+    if (_render) {
+        uint64_t render_start = time_us_64();
+        _render(_outputs, _num_outputs, _stats.frames_sent, _user_data);
+        uint64_t render_end = time_us_64();
+
+        _stats.last_render_us = (uint32_t)(render_end - render_start);
+        if (_stats.last_render_us > _stats.max_render_us) {
+            _stats.max_render_us = _stats.last_render_us;
+        }
+        if (render_end > _next_frame_us) {
+            _stats.deadline_misses++;
+        }
+    }
+    DMX_LOAD_LEAVE(load_context);
+    return true;
+}
+
+void DMXFramePipeline::run() {
+    while (true) {
+        if (!poll()) {
+            DMXLoad::idleUntil(_next_frame_us);
+        }
+    }
+}
+
+DMXFramePipeline::Stats DMXFramePipeline::getStats() const {
+    return _stats;
+}
+
+void DMXFramePipeline::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+uint32_t DMXFramePipeline::getFramePeriodUs() const {
+    return _frame_period_us;
+}
+
+uint64_t DMXFramePipeline::getNextFrameUs() const {
+    return _next_frame_us;
+}
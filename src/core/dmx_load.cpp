@@ -0,0 +1,116 @@
+#include "dmx_load.h"
+#include "dmx_telemetry.h"
+#include <cstring>
+
+static const char* CONTEXT_NAMES[DMX_LOAD_CONTEXT_COUNT] = {
+    "main", "rx irq", "tx", "callbacks", "idle"
+};
+
+const char* DMXLoad::getName(uint8_t context) {
+    return context < DMX_LOAD_CONTEXT_COUNT ? CONTEXT_NAMES[context] : "unknown";
+}
+
+bool DMXLoad::idleUntil(absolute_time_t until) {
+#if DMX_LOAD
+    uint8_t previous = enter(DMX_LOAD_IDLE);
+    bool reached = best_effort_wfe_or_timeout(until);
+    leave(previous);
+    return reached;
+#else
+    return best_effort_wfe_or_timeout(until);
+#endif
+}
+
+void DMXLoad::idleUs(uint64_t us) {
+    absolute_time_t until = make_timeout_time_us(us);
+    while (!idleUntil(until)) {
+    }
+}
+
+DMXLoad::Usage DMXLoad::getTotals(uint core) {
+    Usage usage;
+    memset(&usage, 0, sizeof(usage));
+#if DMX_LOAD
+    if (core >= DMX_LOAD_NUM_CORES) {
+        return usage;
+    }
+    uint32_t irq_state = save_and_disable_interrupts();
+    const CoreState& state = _cores[core];
+    if (state.started) {
+        for (uint8_t c = 0; c < DMX_LOAD_CONTEXT_COUNT; c++) {
+            usage.time_us[c] = state.time_us[c];
+        }
+        // The context in progress counts up to now
+        usage.time_us[state.context] += timer_hw->timerawl - state.since_us;
+    }
+    restore_interrupts(irq_state);
+
+    for (uint8_t c = 0; c < DMX_LOAD_CONTEXT_COUNT; c++) {
+        usage.window_us += usage.time_us[c];
+    }
+    if (usage.window_us > 0) {
+        usage.load_permille = (uint16_t)((usage.window_us - usage.time_us[DMX_LOAD_IDLE]) * 1000 / usage.window_us);
+    }
+#else
+    (void)core;
+#endif
+    return usage;
+}
+
+DMXLoad::Usage DMXLoad::sample(uint core) {
+    Usage usage;
+    memset(&usage, 0, sizeof(usage));
+#if DMX_LOAD
+    if (core >= DMX_LOAD_NUM_CORES) {
+        return usage;
+    }
+    Usage totals = getTotals(core);
+    Usage& last = _last_sample[core];
+    for (uint8_t c = 0; c < DMX_LOAD_CONTEXT_COUNT; c++) {
+        usage.time_us[c] = totals.time_us[c] - last.time_us[c];
+        usage.window_us += usage.time_us[c];
+    }
+    if (usage.window_us > 0) {
+        usage.load_permille = (uint16_t)((usage.window_us - usage.time_us[DMX_LOAD_IDLE]) * 1000 / usage.window_us);
+    }
+    last = totals;
+#else
+    (void)core;
+#endif
+    return usage;
+}
+
+void DMXLoad::reset() {
+#if DMX_LOAD
+    uint32_t irq_state = save_and_disable_interrupts();
+    for (uint core = 0; core < DMX_LOAD_NUM_CORES; core++) {
+        memset(_cores[core].time_us, 0, sizeof(_cores[core].time_us));
+        memset(&_last_sample[core], 0, sizeof(_last_sample[core]));
+    }
+    _cores[get_core_num()].since_us = timer_hw->timerawl;
+    restore_interrupts(irq_state);
+#endif
+}
+
+void DMXLoad::setCounters(DMXTelemetry& telemetry) {
+#if DMX_LOAD
+    // Per context, in permille of one core, summed over both
+    uint32_t context_permille[DMX_LOAD_CONTEXT_COUNT] = {};
+    for (uint core = 0; core < DMX_LOAD_NUM_CORES; core++) {
+        Usage usage = sample(core);
+        telemetry.setCounter(DMX_COUNTER_LOAD_CORE0 + core, usage.load_permille);
+        if (usage.window_us == 0) {
+            continue;
+        }
+        for (uint8_t c = 0; c < DMX_LOAD_CONTEXT_COUNT; c++) {
+            context_permille[c] += (uint32_t)(usage.time_us[c] * 1000 / usage.window_us);
+        }
+    }
+    telemetry.setCounter(DMX_COUNTER_LOAD_RX_IRQ, context_permille[DMX_LOAD_RX_IRQ]);
+    telemetry.setCounter(DMX_COUNTER_LOAD_TX, context_permille[DMX_LOAD_TX]);
+    telemetry.setCounter(DMX_COUNTER_LOAD_CALLBACKS, context_permille[DMX_LOAD_CALLBACK]);
+    telemetry.setCounter(DMX_COUNTER_LOAD_MAIN, context_permille[DMX_LOAD_MAIN]);
+#else
+    (void)telemetry;
+#endif
+}
@@ -0,0 +1,241 @@
+#include "dmx_log.h"
+#include "dmx_telemetry.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <string.h>
+
+#define DMX_LOG_RING_MASK (DMX_LOG_RING_SIZE - 1)
+#define DMX_LOG_NUM_CORES 2
+
+// Single-producer (per core; IRQs masked while writing) single-consumer ring
+struct DMXLogRing {
+    DMXLog::Record records[DMX_LOG_RING_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+};
+
+static DMXLogRing log_rings[DMX_LOG_NUM_CORES];
+static uint32_t reported_dropped = 0;
+
+void DMXLog::record(uint32_t id, const char* format, const uintptr_t* args, uint8_t num_args) {
+    uint32_t core = get_core_num();
+    DMXLogRing& ring = log_rings[core];
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    uint32_t head = ring.head;
+    if (head - ring.tail >= DMX_LOG_RING_SIZE) {
+        ring.dropped++;
+        restore_interrupts(irq_state);
+        return;
+    }
+
+    Record& r = ring.records[head & DMX_LOG_RING_MASK];
+    r.id = id;
+    r.format = format;
+    r.timestamp_us = time_us_32();
+    r.args[0] = args[0];
+    r.args[1] = args[1];
+    r.args[2] = args[2];
+    r.args[3] = args[3];
+    r.num_args = num_args;
+    r.core = (uint8_t)core;
+
+    // Publish the record before the new head becomes visible to the other core
+    __dmb();
+    ring.head = head + 1;
+    restore_interrupts(irq_state);
+}
+
+// Oldest pending record across both cores
+static DMXLogRing* oldestRing() {
+    DMXLogRing* oldest = nullptr;
+    uint32_t oldest_time = 0;
+    for (uint8_t core = 0; core < DMX_LOG_NUM_CORES; core++) {
+        DMXLogRing& ring = log_rings[core];
+        if (ring.tail == ring.head) {
+            continue;
+        }
+        uint32_t time = ring.records[ring.tail & DMX_LOG_RING_MASK].timestamp_us;
+        if (oldest == nullptr || (int32_t)(time - oldest_time) < 0) {
+            oldest = &ring;
+            oldest_time = time;
+        }
+    }
+    return oldest;
+}
+
+// Copy out the oldest pending record; returns its ring for popRecord()
+static DMXLogRing* peekRecord(DMXLog::Record* out) {
+    DMXLogRing* ring = oldestRing();
+    if (ring != nullptr) {
+        __dmb();
+        *out = ring->records[ring->tail & DMX_LOG_RING_MASK];
+    }
+    return ring;
+}
+
+static void popRecord(DMXLogRing* ring) {
+    __dmb();
+    ring->tail = ring->tail + 1;
+}
+
+// printf() one conversion spec with its argument cast to the type the spec
+// reads; unsupported specs (*, j, t, L, floating point) are printed as text
+static void printArg(const char* spec, char length, char conversion, uintptr_t value) {
+    switch (conversion) {
+        case 's':
+            printf(spec, (const char*)value);
+            return;
+        case 'p':
+            printf(spec, (void*)value);
+            return;
+        case 'c':
+        case 'd':
+        case 'i':
+            if (length == 'L') {
+                printf(spec, (long long)(intptr_t)value);
+            } else if (length == 'l') {
+                printf(spec, (long)(intptr_t)value);
+            } else if (length == 'z') {
+                printf(spec, (size_t)value);
+            } else {
+                printf(spec, (int)value);
+            }
+            return;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            if (length == 'L') {
+                printf(spec, (unsigned long long)value);
+            } else if (length == 'l') {
+                printf(spec, (unsigned long)value);
+            } else if (length == 'z') {
+                printf(spec, (size_t)value);
+            } else {
+                printf(spec, (unsigned int)value);
+            }
+            return;
+        default:
+            fputs(spec, stdout);
+            return;
+    }
+}
+
+// Print a record's format string one conversion at a time, so every
+// argument is passed as the type its conversion expects
+static void printRecord(const DMXLog::Record& r) {
+    const char* p = r.format;
+    uint8_t arg = 0;
+    char spec[16];
+    while (*p) {
+        if (*p != '%') {
+            const char* text = p;
+            while (*p && *p != '%') {
+                p++;
+            }
+            fwrite(text, 1, p - text, stdout);
+            continue;
+        }
+        if (p[1] == '%') {
+            putchar('%');
+            p += 2;
+            continue;
+        }
+
+        const char* start = p++;
+        while (*p && strchr("-+ #0123456789.", *p)) {
+            p++;
+        }
+        // 'l', 'L' for ll, or 'z'; h and hh still read an int
+        char length = 0;
+        for (;; p++) {
+            if (*p == 'l') {
+                length = length == 'l' ? 'L' : 'l';
+            } else if (*p == 'z') {
+                length = 'z';
+            } else if (*p != 'h') {
+                break;
+            }
+        }
+        if (*p == '\0') {
+            fputs(start, stdout);
+            break;
+        }
+        char conversion = *p++;
+
+        size_t spec_length = (size_t)(p - start);
+        if (spec_length >= sizeof(spec)) {
+            fwrite(start, 1, spec_length, stdout);
+            continue;
+        }
+        memcpy(spec, start, spec_length);
+        spec[spec_length] = '\0';
+        uintptr_t value = arg < r.num_args ? r.args[arg] : 0;
+        arg++;
+        printArg(spec, length, conversion, value);
+    }
+}
+
+uint16_t DMXLog::flush(uint16_t max_records) {
+    uint16_t count = 0;
+    Record r;
+    DMXLogRing* ring;
+    while (count < max_records && (ring = peekRecord(&r)) != nullptr) {
+        popRecord(ring);
+        printf("[%lu.%06lu c%u] ", (unsigned long)(r.timestamp_us / 1000000), (unsigned long)(r.timestamp_us % 1000000), r.core);
+        printRecord(r);
+        count++;
+    }
+
+    uint32_t dropped = getDropped();
+    if (dropped != reported_dropped) {
+        printf("[log] %lu messages dropped\n", (unsigned long)(dropped - reported_dropped));
+        reported_dropped = dropped;
+    }
+    return count;
+}
+
+uint16_t DMXLog::flush(DMXTelemetry& telemetry, uint16_t max_records) {
+    uint16_t count = 0;
+    Record r;
+    DMXLogRing* ring;
+    uint8_t payload[DMX_STREAM_LOG_HEADER_SIZE + DMX_LOG_MAX_ARGS * 4];
+    while (count < max_records && (ring = peekRecord(&r)) != nullptr) {
+        uint16_t length = DMX_STREAM_LOG_HEADER_SIZE + r.num_args * 4;
+        // Leave the record queued until the telemetry ring has room for it
+        if (telemetry.getFreeSpace() < DMX_STREAM_HEADER_SIZE + length + DMX_STREAM_CHECK_SIZE) {
+            break;
+        }
+        const uint32_t words[2] = {r.id, r.timestamp_us};
+        for (uint8_t w = 0; w < 2; w++) {
+            payload[w * 4] = (uint8_t)words[w];
+            payload[w * 4 + 1] = (uint8_t)(words[w] >> 8);
+            payload[w * 4 + 2] = (uint8_t)(words[w] >> 16);
+            payload[w * 4 + 3] = (uint8_t)(words[w] >> 24);
+        }
+        payload[8] = r.num_args;
+        for (uint8_t a = 0; a < r.num_args; a++) {
+            uint32_t value = (uint32_t)r.args[a];
+            uint8_t* p = &payload[DMX_STREAM_LOG_HEADER_SIZE + a * 4];
+            p[0] = (uint8_t)value;
+            p[1] = (uint8_t)(value >> 8);
+            p[2] = (uint8_t)(value >> 16);
+            p[3] = (uint8_t)(value >> 24);
+        }
+        telemetry.publishRecord(DMX_STREAM_LOG, r.core, payload, length);
+        popRecord(ring);
+        count++;
+    }
+    telemetry.setCounter(DMX_COUNTER_LOG_DROPS, getDropped());
+    return count;
+}
+
+uint32_t DMXLog::getDropped() {
+    uint32_t dropped = 0;
+    for (uint8_t core = 0; core < DMX_LOG_NUM_CORES; core++) {
+        dropped += log_rings[core].dropped;
+    }
+    return dropped;
+}
@@ -1,4 +1,6 @@
 #include "dmx_multi_receiver.h"
+#include "dmx_profile.h"
+#include "dmx_load.h"
 #include <cstring>
 
 // Static member initialization
@@ -15,7 +17,8 @@ DMXDataCallback DMXMultiReceiver::_universe_callbacks[MAX_DMX_RECEIVERS] = {
 };
 
 DMXMultiReceiver::DMXMultiReceiver() 
-    : _num_universes(0), _is_initialized(false), _callback(nullptr) {
+    : _num_universes(0), _is_initialized(false), _callback(nullptr), _change_detection(false),
+      _skip_unchanged(false) {
     // Initialize pointers to nullptr
     for (uint8_t i = 0; i < MAX_DMX_RECEIVERS; i++) {
         _receivers[i] = nullptr;
@@ -64,34 +67,15 @@ bool DMXMultiReceiver::beginCustom(const uint* gpio_pins, uint8_t num_universes,
         }
         memset(_universe_buffers[i], 0, 512);
         
-        // Create receiver instance
-        // Distribute across PIO instances: pio0 for first 4, pio1 for next 4
-        PIO pio_instance = (i < 4) ? pio0 : pio1;
-        _receivers[i] = new DMXReceiver(gpio_pins[i], 1, 512, pio_instance);
-        
-        if (_receivers[i] == nullptr) {
-            // Cleanup on allocation failure
-            end();
-            return false;
-        }
+        // Initialize stats
+        memset((void*)&_stats[i], 0, sizeof(UniverseStats));
         
-        // Initialize the receiver
-        DmxInput::return_code result = _receivers[i]->begin(false); // not inverted
-        if (result != DmxInput::SUCCESS) {
+        // Create, initialize and start the receiver
+        if (!startUniverse(i, gpio_pins[i])) {
             // Cleanup on initialization failure
             end();
             return false;
         }
-        
-        // Start async reception with callback
-        if (!_receivers[i]->startAsync(_universe_buffers[i], _universe_callbacks[i])) {
-            // Cleanup on async start failure
-            end();
-            return false;
-        }
-        
-        // Initialize stats
-        memset((void*)&_stats[i], 0, sizeof(UniverseStats));
     }
     
     _is_initialized = true;
@@ -99,35 +83,122 @@ bool DMXMultiReceiver::beginCustom(const uint* gpio_pins, uint8_t num_universes,
 }
 
 void DMXMultiReceiver::end() {
-    if (_is_initialized) {
-        // Cleanup all receivers and buffers
-        for (uint8_t i = 0; i < _num_universes; i++) {
-            if (_receivers[i]) {
-                _receivers[i]->end();
-                delete _receivers[i];
-                _receivers[i] = nullptr;
-            }
-            
-            if (_universe_buffers[i]) {
-                delete[] _universe_buffers[i];
-                _universe_buffers[i] = nullptr;
-            }
-        }
-        
-        _num_universes = 0;
-        _is_initialized = false;
-        _callback = nullptr;
-        _instance = nullptr;
-        
-        // Reset stats
-        for (uint8_t i = 0; i < MAX_DMX_RECEIVERS; i++) {
-            memset((void*)&_stats[i], 0, sizeof(UniverseStats));
-        }
+    // Also cleans up after a begin() that failed part way
+    for (uint8_t i = 0; i < MAX_DMX_RECEIVERS; i++) {
+        releaseUniverse(i);
+    }
+    
+    _num_universes = 0;
+    _is_initialized = false;
+    _callback = nullptr;
+    _change_detection = false;
+    _instance = nullptr;
+    
+    // Reset stats
+    for (uint8_t i = 0; i < MAX_DMX_RECEIVERS; i++) {
+        memset((void*)&_stats[i], 0, sizeof(UniverseStats));
     }
 }
 
+bool DMXMultiReceiver::startUniverse(uint8_t universe_index, uint gpio_pin) {
+    // Distribute across PIO instances: pio0 for first 4, pio1 for next 4
+    PIO pio_instance = (universe_index < 4) ? pio0 : pio1;
+    DMXReceiver* receiver = new DMXReceiver(gpio_pin, 1, 512, pio_instance);
+    if (receiver == nullptr) {
+        return false;
+    }
+    
+    if (receiver->begin(false) != DmxInput::SUCCESS) { // not inverted
+        delete receiver;
+        return false;
+    }
+    
+    // Published before the first frame can complete, so the callback finds it
+    _receivers[universe_index] = receiver;
+    if (!receiver->startAsync(_universe_buffers[universe_index], _universe_callbacks[universe_index]) ||
+        (_change_detection && !receiver->enableChangeDetection(false))) {
+        stopUniverse(universe_index);
+        return false;
+    }
+    return true;
+}
+
+void DMXMultiReceiver::stopUniverse(uint8_t universe_index) {
+    // Unpublished first: a frame completing meanwhile is dropped by the callback
+    DMXReceiver* receiver = _receivers[universe_index];
+    _receivers[universe_index] = nullptr;
+    if (receiver) {
+        receiver->end();
+        delete receiver;
+    }
+}
+
+void DMXMultiReceiver::releaseUniverse(uint8_t universe_index) {
+    stopUniverse(universe_index);
+    if (_universe_buffers[universe_index]) {
+        delete[] _universe_buffers[universe_index];
+        _universe_buffers[universe_index] = nullptr;
+    }
+    memset((void*)&_stats[universe_index], 0, sizeof(UniverseStats));
+    
+    while (_num_universes > 0 && _receivers[_num_universes - 1] == nullptr) {
+        _num_universes--;
+    }
+}
+
+bool DMXMultiReceiver::addUniverse(uint8_t universe_index, uint gpio_pin) {
+    if (!_is_initialized || universe_index >= MAX_DMX_RECEIVERS || _receivers[universe_index] != nullptr) {
+        return false;
+    }
+    
+    _universe_buffers[universe_index] = new uint8_t[512];
+    if (_universe_buffers[universe_index] == nullptr) {
+        return false;
+    }
+    memset(_universe_buffers[universe_index], 0, 512);
+    memset((void*)&_stats[universe_index], 0, sizeof(UniverseStats));
+    
+    if (!startUniverse(universe_index, gpio_pin)) {
+        releaseUniverse(universe_index);
+        return false;
+    }
+    if (universe_index >= _num_universes) {
+        _num_universes = universe_index + 1;
+    }
+    return true;
+}
+
+bool DMXMultiReceiver::removeUniverse(uint8_t universe_index) {
+    if (!isUniverseActive(universe_index)) {
+        return false;
+    }
+    
+    releaseUniverse(universe_index);
+    return true;
+}
+
+bool DMXMultiReceiver::remapUniverse(uint8_t universe_index, uint gpio_pin) {
+    if (!isUniverseActive(universe_index)) {
+        return false;
+    }
+    if (_receivers[universe_index]->getGpioPin() == gpio_pin) {
+        return true;
+    }
+    
+    stopUniverse(universe_index);
+    if (!startUniverse(universe_index, gpio_pin)) {
+        releaseUniverse(universe_index);
+        return false;
+    }
+    return true;
+}
+
+bool DMXMultiReceiver::isUniverseActive(uint8_t universe_index) const {
+    return _is_initialized && universe_index < MAX_DMX_RECEIVERS && _receivers[universe_index] != nullptr;
+}
+
 uint8_t DMXMultiReceiver::getChannel(uint8_t universe_index, uint16_t channel) const {
-    if (!_is_initialized || universe_index >= _num_universes || channel < 1 || channel > 512) {
+    if (!isUniverseActive(universe_index) || channel < 1 || channel > 512) {
         return 0;
     }
     
@@ -135,7 +206,7 @@ uint8_t DMXMultiReceiver::getChannel(uint8_t universe_index, uint16_t channel) c
 }
 
 bool DMXMultiReceiver::getChannelRange(uint8_t universe_index, uint16_t start_channel, uint8_t* output, uint16_t length) const {
-    if (!_is_initialized || universe_index >= _num_universes || output == nullptr || 
+    if (!isUniverseActive(universe_index) || output == nullptr || 
         start_channel < 1 || start_channel > 512 || start_channel + length - 1 > 512) {
         return false;
     }
@@ -144,7 +215,7 @@ bool DMXMultiReceiver::getChannelRange(uint8_t universe_index, uint16_t start_ch
 }
 
 const uint8_t* DMXMultiReceiver::getUniverseBuffer(uint8_t universe_index) const {
-    if (!_is_initialized || universe_index >= _num_universes) {
+    if (!isUniverseActive(universe_index)) {
         return nullptr;
     }
     
@@ -152,7 +223,7 @@ const uint8_t* DMXMultiReceiver::getUniverseBuffer(uint8_t universe_index) const
 }
 
 unsigned long DMXMultiReceiver::getLastPacketTimestamp(uint8_t universe_index) {
-    if (!_is_initialized || universe_index >= _num_universes) {
+    if (!isUniverseActive(universe_index)) {
         return 0;
     }
     
@@ -160,7 +231,7 @@ unsigned long DMXMultiReceiver::getLastPacketTimestamp(uint8_t universe_index) {
 }
 
 bool DMXMultiReceiver::isSignalPresent(uint8_t universe_index, unsigned long timeout_ms) {
-    if (!_is_initialized || universe_index >= _num_universes) {
+    if (!isUniverseActive(universe_index)) {
         return false;
     }
     
@@ -173,7 +244,7 @@ bool DMXMultiReceiver::areAllSignalsPresent(unsigned long timeout_ms) {
     }
     
     for (uint8_t i = 0; i < _num_universes; i++) {
-        if (!isSignalPresent(i, timeout_ms)) {
+        if (_receivers[i] && !isSignalPresent(i, timeout_ms)) {
             return false;
         }
     }
@@ -181,6 +252,51 @@ bool DMXMultiReceiver::areAllSignalsPresent(unsigned long timeout_ms) {
     return true;
 }
 
+bool DMXMultiReceiver::enableChangeDetection(bool skip_unchanged) {
+    if (!_is_initialized) {
+        return false;
+    }
+    
+    _change_detection = false;
+    _skip_unchanged = skip_unchanged;
+    for (uint8_t i = 0; i < _num_universes; i++) {
+        // The receivers report every frame; skipping happens here
+        if (_receivers[i] && !_receivers[i]->enableChangeDetection(false)) {
+            disableChangeDetection();
+            return false;
+        }
+        _stats[i].frames_changed = 0;
+        _stats[i].frames_identical = 0;
+    }
+    _change_detection = true;
+    return true;
+}
+
+void DMXMultiReceiver::disableChangeDetection() {
+    _change_detection = false;
+    for (uint8_t i = 0; i < _num_universes; i++) {
+        if (_receivers[i]) {
+            _receivers[i]->disableChangeDetection();
+        }
+    }
+}
+
+bool DMXMultiReceiver::isUniverseChanged(uint8_t universe_index) const {
+    if (!isUniverseActive(universe_index)) {
+        return false;
+    }
+    
+    return !_change_detection || _receivers[universe_index]->isFrameChanged();
+}
+
+uint32_t DMXMultiReceiver::getFrameCrc(uint8_t universe_index) const {
+    if (!isUniverseActive(universe_index)) {
+        return 0;
+    }
+    
+    return _receivers[universe_index]->getFrameCrc();
+}
+
 uint8_t DMXMultiReceiver::getNumUniverses() const {
     return _num_universes;
 }
@@ -190,7 +306,7 @@ bool DMXMultiReceiver::isInitialized() const {
 }
 
 uint DMXMultiReceiver::getGpioPin(uint8_t universe_index) const {
-    if (!_is_initialized || universe_index >= _num_universes) {
+    if (!isUniverseActive(universe_index)) {
         return 0;
     }
     
@@ -198,14 +314,16 @@ uint DMXMultiReceiver::getGpioPin(uint8_t universe_index) const {
 }
 
 DMXMultiReceiver::UniverseStats DMXMultiReceiver::getUniverseStats(uint8_t universe_index) const {
-    if (!_is_initialized || universe_index >= _num_universes) {
+    if (!isUniverseActive(universe_index)) {
         UniverseStats empty_stats;
         memset(&empty_stats, 0, sizeof(UniverseStats));
         return empty_stats;
     }
     
-    // Update stats before returning
-    const_cast<DMXMultiReceiver*>(this)->updateStats(universe_index);
+    // Update stats before returning (change detection keeps them current)
+    if (!_change_detection) {
+        const_cast<DMXMultiReceiver*>(this)->updateStats(universe_index);
+    }
     return _stats[universe_index];
 }
 
@@ -216,7 +334,7 @@ void DMXMultiReceiver::resetStats() {
 }
 
 void DMXMultiReceiver::updateStats(uint8_t universe_index) {
-    if (!_is_initialized || universe_index >= _num_universes || !_universe_buffers[universe_index]) {
+    if (!isUniverseActive(universe_index) || !_universe_buffers[universe_index]) {
         return;
     }
     
@@ -241,16 +359,38 @@ void DMXMultiReceiver::updateStats(uint8_t universe_index) {
 }
 
 void DMXMultiReceiver::handleUniverseDataReceived(uint8_t universe_index) {
-    if (universe_index < _num_universes) {
+    if (universe_index < _num_universes && _receivers[universe_index] != nullptr) {
+        // Library work, although DMXReceiver runs this as its user callback
+        DMX_LOAD_ENTER(load_context, DMX_LOAD_RX_IRQ);
+        
         // Increment frame count
         _stats[universe_index].frames_received++;
         
-        // Update stats
-        updateStats(universe_index);
+        bool changed = true;
+        if (_change_detection) {
+            changed = _receivers[universe_index]->isFrameChanged();
+            if (changed) {
+                _stats[universe_index].frames_changed++;
+            } else {
+                _stats[universe_index].frames_identical++;
+            }
+        }
+        
+        // Update stats (an identical frame leaves them as they are)
+        if (changed) {
+            updateStats(universe_index);
+        } else {
+            _stats[universe_index].last_frame_timestamp = getLastPacketTimestamp(universe_index);
+        }
+        DMX_LOAD_LEAVE(load_context);
         
         // Call user callback if provided
-        if (_callback) {
+        if (_callback && (changed || !_skip_unchanged)) {
+            DMX_LOAD_ENTER(callback_context, DMX_LOAD_CALLBACK);
+            DMX_PROFILE_STAMP(callback_start);
             _callback(this, universe_index);
+            DMX_PROFILE_SINCE(DMX_PROFILE_CALLBACK_U0 + universe_index, callback_start);
+            DMX_LOAD_LEAVE(callback_context);
         }
     }
 }
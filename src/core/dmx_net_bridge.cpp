@@ -0,0 +1,86 @@
+#include "dmx_net_bridge.h"
+#include <cstring>
+
+DMXNetBridge::DMXNetBridge() : _outputs(nullptr), _num_outputs(0), _ready(0) {
+    memset(&_source, 0, sizeof(_source));
+    memset(_artnet_sequence, 0, sizeof(_artnet_sequence));
+    memset(_sacn_sequence, 0, sizeof(_sacn_sequence));
+    _source.priority = DMX_SACN_DEFAULT_PRIORITY;
+    strncpy(_source.name, "Pico DMX Controller", sizeof(_source.name) - 1);
+}
+
+bool DMXNetBridge::begin(DMXTransmitter outputs[], uint8_t num_outputs) {
+    if (outputs == nullptr || num_outputs == 0 || num_outputs > DMX_NET_MAX_OUTPUTS) {
+        return false;
+    }
+
+    _outputs = outputs;
+    _num_outputs = num_outputs;
+    _ready = 0;
+    _router.begin(resolveOutput, this);
+    return true;
+}
+
+uint8_t* DMXNetBridge::resolveOutput(uint8_t output, void* context) {
+    DMXNetBridge* self = static_cast<DMXNetBridge*>(context);
+    if (output >= self->_num_outputs) {
+        return nullptr;
+    }
+    // Looked up per packet: the back buffer changes after every transmit
+    return self->_outputs[output].getUniverseBuffer();
+}
+
+bool DMXNetBridge::setRoute(uint8_t output, uint8_t protocol, uint16_t universe) {
+    if (output >= _num_outputs) {
+        return false;
+    }
+    return _router.setRoute(output, protocol, universe);
+}
+
+void DMXNetBridge::handlePacket(const uint8_t* buffer, size_t size) {
+    if (_outputs == nullptr) {
+        return;
+    }
+    _ready |= _router.handlePacket(buffer, size, to_ms_since_boot(get_absolute_time()));
+}
+
+uint8_t DMXNetBridge::poll() {
+    uint8_t started = 0;
+    for (uint8_t i = 0; i < _num_outputs && _ready != 0; i++) {
+        uint8_t bit = (uint8_t)(1u << i);
+        if ((_ready & bit) && !_outputs[i].isBusy()) {
+            _outputs[i].transmit();
+            _ready &= (uint8_t)~bit;
+            started |= bit;
+        }
+    }
+    return started;
+}
+
+void DMXNetBridge::setSource(const DMXNetSource& source) {
+    _source = source;
+}
+
+size_t DMXNetBridge::encodeArtDmx(const DMXMultiReceiver& rx, uint8_t universe_index, uint16_t port_address, uint8_t* out) {
+    const uint8_t* data = rx.getUniverseBuffer(universe_index);
+    if (data == nullptr) {
+        return 0;
+    }
+    // Art-Net sequence 0 disables reordering checks, so count 1-255
+    uint8_t& sequence = _artnet_sequence[universe_index];
+    sequence = (uint8_t)(sequence == 255 ? 1 : sequence + 1);
+    return DMXNetCodec::encodeArtDmx(out, port_address, sequence, data, DMX_UNIVERSE_SIZE);
+}
+
+size_t DMXNetBridge::encodeSACN(const DMXMultiReceiver& rx, uint8_t universe_index, uint16_t universe, uint8_t* out) {
+    const uint8_t* data = rx.getUniverseBuffer(universe_index);
+    if (data == nullptr) {
+        return 0;
+    }
+    return DMXNetCodec::encodeSACN(out, _source, universe, _sacn_sequence[universe_index]++, 0, 0,
+                                   data, DMX_UNIVERSE_SIZE);
+}
+
+DMXNetRouter::Stats DMXNetBridge::getStats() const {
+    return _router.getStats();
+}
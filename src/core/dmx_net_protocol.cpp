@@ -0,0 +1,398 @@
+#include "dmx_net_protocol.h"
+#include <string.h>
+
+static const uint8_t ARTNET_ID[8] = {'A', 'r', 't', '-', 'N', 'e', 't', 0};
+static const uint8_t SACN_ACN_ID[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+
+#define SACN_VECTOR_ROOT_DATA 0x00000004u
+#define SACN_VECTOR_ROOT_EXTENDED 0x00000008u
+#define SACN_VECTOR_FRAME_DATA 0x00000002u
+#define SACN_VECTOR_FRAME_SYNC 0x00000001u
+#define SACN_VECTOR_DMP_SET_PROPERTY 0x02
+#define SACN_DMP_ADDRESS_TYPE 0xA1
+
+// Packets this far behind the last accepted sequence are treated as stale
+#define DMX_NET_SEQUENCE_WINDOW 20
+
+static inline uint16_t readBE16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t readBE32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline void writeBE16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void writeBE32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+// ACN PDU flags (0x7) and 12-bit length covering the rest of the packet
+static inline bool checkFlagsLength(const uint8_t* p, size_t expected) {
+    uint16_t v = readBE16(p);
+    return (v & 0xF000) == 0x7000 && (v & 0x0FFF) == expected;
+}
+
+static inline void writeFlagsLength(uint8_t* p, size_t length) {
+    writeBE16(p, (uint16_t)(0x7000 | (length & 0x0FFF)));
+}
+
+bool DMXNetCodec::parse(const uint8_t* buffer, size_t size, DMXNetPacket* packet) {
+    if (buffer == nullptr || packet == nullptr || size < 2) {
+        return false;
+    }
+    return buffer[0] == 'A' ? parseArtNet(buffer, size, packet) : parseSACN(buffer, size, packet);
+}
+
+bool DMXNetCodec::parseArtNet(const uint8_t* buffer, size_t size, DMXNetPacket* packet) {
+    if (size < DMX_ARTNET_SYNC_SIZE || memcmp(buffer, ARTNET_ID, sizeof(ARTNET_ID)) != 0 ||
+        readBE16(&buffer[10]) < DMX_ARTNET_PROTOCOL_VERSION) {
+        return false;
+    }
+
+    memset(packet, 0, sizeof(*packet));
+    packet->protocol = DMX_NET_ARTNET;
+    packet->priority = DMX_SACN_DEFAULT_PRIORITY;
+
+    uint16_t opcode = (uint16_t)(buffer[8] | (buffer[9] << 8));
+    if (opcode == DMX_ARTNET_OP_SYNC) {
+        packet->kind = DMXNetPacket::SYNC;
+        return true;
+    }
+    if (opcode != DMX_ARTNET_OP_DMX || size < DMX_ARTNET_DMX_HEADER_SIZE) {
+        return false;
+    }
+
+    uint16_t length = readBE16(&buffer[16]);
+    if (length < 2 || length > DMX_UNIVERSE_SIZE || DMX_ARTNET_DMX_HEADER_SIZE + (size_t)length > size) {
+        return false;
+    }
+
+    packet->kind = DMXNetPacket::DATA;
+    packet->sequence = buffer[12];
+    packet->universe = (uint16_t)(buffer[14] | ((buffer[15] & 0x7F) << 8));
+    packet->data = &buffer[DMX_ARTNET_DMX_HEADER_SIZE];
+    packet->length = length;
+    return true;
+}
+
+bool DMXNetCodec::parseSACN(const uint8_t* buffer, size_t size, DMXNetPacket* packet) {
+    if (size < DMX_SACN_SYNC_SIZE || readBE16(&buffer[0]) != 0x0010 || readBE16(&buffer[2]) != 0 ||
+        memcmp(&buffer[4], SACN_ACN_ID, sizeof(SACN_ACN_ID)) != 0 || !checkFlagsLength(&buffer[16], size - 16)) {
+        return false;
+    }
+
+    memset(packet, 0, sizeof(*packet));
+    packet->protocol = DMX_NET_SACN;
+    packet->cid = &buffer[22];
+
+    uint32_t root_vector = readBE32(&buffer[18]);
+    if (root_vector == SACN_VECTOR_ROOT_EXTENDED) {
+        if (size != DMX_SACN_SYNC_SIZE || !checkFlagsLength(&buffer[38], size - 38) ||
+            readBE32(&buffer[40]) != SACN_VECTOR_FRAME_SYNC) {
+            return false;
+        }
+        packet->kind = DMXNetPacket::SYNC;
+        packet->sequence = buffer[44];
+        packet->sync_address = readBE16(&buffer[45]);
+        return packet->sync_address != 0;
+    }
+
+    if (root_vector != SACN_VECTOR_ROOT_DATA || size < DMX_SACN_DATA_HEADER_SIZE ||
+        !checkFlagsLength(&buffer[38], size - 38) || readBE32(&buffer[40]) != SACN_VECTOR_FRAME_DATA ||
+        !checkFlagsLength(&buffer[115], size - 115) || buffer[117] != SACN_VECTOR_DMP_SET_PROPERTY ||
+        buffer[118] != SACN_DMP_ADDRESS_TYPE || readBE16(&buffer[119]) != 0 || readBE16(&buffer[121]) != 1) {
+        return false;
+    }
+
+    uint16_t count = readBE16(&buffer[123]);
+    uint16_t universe = readBE16(&buffer[113]);
+    if (count < 1 || count > DMX_UNIVERSE_SIZE + 1 || 125 + (size_t)count != size ||
+        universe == 0 || universe > DMX_SACN_MAX_UNIVERSE || buffer[108] > DMX_SACN_MAX_PRIORITY) {
+        return false;
+    }
+    // Alternate start codes (per-slot priority, text, ...) are not slot data
+    if (buffer[125] != 0x00) {
+        return false;
+    }
+
+    packet->kind = DMXNetPacket::DATA;
+    packet->priority = buffer[108];
+    packet->sync_address = readBE16(&buffer[109]);
+    packet->sequence = buffer[111];
+    packet->options = buffer[112];
+    packet->universe = universe;
+    packet->data = &buffer[DMX_SACN_DATA_HEADER_SIZE];
+    packet->length = count - 1;
+    return true;
+}
+
+size_t DMXNetCodec::encodeArtDmx(uint8_t* out, uint16_t port_address, uint8_t sequence,
+                                 const uint8_t* data, uint16_t length) {
+    if (out == nullptr || data == nullptr || length == 0 || length > DMX_UNIVERSE_SIZE || port_address > 0x7FFF) {
+        return 0;
+    }
+
+    uint16_t padded = (uint16_t)((length + 1) & ~1);
+    memcpy(out, ARTNET_ID, sizeof(ARTNET_ID));
+    out[8] = (uint8_t)DMX_ARTNET_OP_DMX;
+    out[9] = (uint8_t)(DMX_ARTNET_OP_DMX >> 8);
+    writeBE16(&out[10], DMX_ARTNET_PROTOCOL_VERSION);
+    out[12] = sequence;
+    out[13] = 0;
+    out[14] = (uint8_t)port_address;
+    out[15] = (uint8_t)(port_address >> 8);
+    writeBE16(&out[16], padded);
+    memcpy(&out[DMX_ARTNET_DMX_HEADER_SIZE], data, length);
+    if (padded != length) {
+        out[DMX_ARTNET_DMX_HEADER_SIZE + length] = 0;
+    }
+    return DMX_ARTNET_DMX_HEADER_SIZE + padded;
+}
+
+size_t DMXNetCodec::encodeArtSync(uint8_t* out) {
+    if (out == nullptr) {
+        return 0;
+    }
+    memcpy(out, ARTNET_ID, sizeof(ARTNET_ID));
+    out[8] = (uint8_t)DMX_ARTNET_OP_SYNC;
+    out[9] = (uint8_t)(DMX_ARTNET_OP_SYNC >> 8);
+    writeBE16(&out[10], DMX_ARTNET_PROTOCOL_VERSION);
+    out[12] = 0;
+    out[13] = 0;
+    return DMX_ARTNET_SYNC_SIZE;
+}
+
+// Preamble, ACN identifier and the root layer up to the CID
+static void writeSACNRoot(uint8_t* out, size_t size, uint32_t vector, const uint8_t* cid) {
+    writeBE16(&out[0], 0x0010);
+    writeBE16(&out[2], 0);
+    memcpy(&out[4], SACN_ACN_ID, sizeof(SACN_ACN_ID));
+    writeFlagsLength(&out[16], size - 16);
+    writeBE32(&out[18], vector);
+    memcpy(&out[22], cid, DMX_SACN_CID_SIZE);
+}
+
+size_t DMXNetCodec::encodeSACN(uint8_t* out, const DMXNetSource& source, uint16_t universe,
+                               uint8_t sequence, uint16_t sync_address, uint8_t options,
+                               const uint8_t* data, uint16_t length) {
+    if (out == nullptr || data == nullptr || length == 0 || length > DMX_UNIVERSE_SIZE ||
+        universe == 0 || universe > DMX_SACN_MAX_UNIVERSE || source.priority > DMX_SACN_MAX_PRIORITY) {
+        return 0;
+    }
+
+    size_t size = DMX_SACN_DATA_HEADER_SIZE + length;
+    writeSACNRoot(out, size, SACN_VECTOR_ROOT_DATA, source.cid);
+
+    // Framing layer
+    writeFlagsLength(&out[38], size - 38);
+    writeBE32(&out[40], SACN_VECTOR_FRAME_DATA);
+    memset(&out[44], 0, DMX_SACN_SOURCE_NAME_SIZE);
+    size_t name_length = strnlen(source.name, DMX_SACN_SOURCE_NAME_SIZE - 1);
+    memcpy(&out[44], source.name, name_length);
+    out[108] = source.priority;
+    writeBE16(&out[109], sync_address);
+    out[111] = sequence;
+    out[112] = options;
+    writeBE16(&out[113], universe);
+
+    // DMP layer
+    writeFlagsLength(&out[115], size - 115);
+    out[117] = SACN_VECTOR_DMP_SET_PROPERTY;
+    out[118] = SACN_DMP_ADDRESS_TYPE;
+    writeBE16(&out[119], 0);
+    writeBE16(&out[121], 1);
+    writeBE16(&out[123], (uint16_t)(length + 1));
+    out[125] = 0x00;
+    memcpy(&out[DMX_SACN_DATA_HEADER_SIZE], data, length);
+    return size;
+}
+
+size_t DMXNetCodec::encodeSACNSync(uint8_t* out, const DMXNetSource& source, uint8_t sequence,
+                                   uint16_t sync_address) {
+    if (out == nullptr || sync_address == 0) {
+        return 0;
+    }
+
+    writeSACNRoot(out, DMX_SACN_SYNC_SIZE, SACN_VECTOR_ROOT_EXTENDED, source.cid);
+    writeFlagsLength(&out[38], DMX_SACN_SYNC_SIZE - 38);
+    writeBE32(&out[40], SACN_VECTOR_FRAME_SYNC);
+    out[44] = sequence;
+    writeBE16(&out[45], sync_address);
+    writeBE16(&out[47], 0);
+    return DMX_SACN_SYNC_SIZE;
+}
+
+DMXNetRouter::DMXNetRouter() : _resolver(nullptr), _context(nullptr), _artsync_ms(0), _artsync_seen(false) {
+    clearRoutes();
+    resetStats();
+}
+
+void DMXNetRouter::begin(DMXNetBufferResolver resolver, void* context) {
+    _resolver = resolver;
+    _context = context;
+    _artsync_seen = false;
+    resetStats();
+}
+
+bool DMXNetRouter::setRoute(uint8_t output, uint8_t protocol, uint16_t universe) {
+    if (output >= DMX_NET_MAX_OUTPUTS || (protocol != DMX_NET_ARTNET && protocol != DMX_NET_SACN)) {
+        return false;
+    }
+    if ((protocol == DMX_NET_ARTNET && universe > 0x7FFF) ||
+        (protocol == DMX_NET_SACN && (universe == 0 || universe > DMX_SACN_MAX_UNIVERSE))) {
+        return false;
+    }
+
+    memset(&_outputs[output], 0, sizeof(Output));
+    _outputs[output].protocol = protocol;
+    _outputs[output].universe = universe;
+    return true;
+}
+
+void DMXNetRouter::clearRoutes() {
+    memset(_outputs, 0, sizeof(_outputs));
+}
+
+uint8_t DMXNetRouter::handlePacket(const uint8_t* buffer, size_t size, uint32_t now_ms) {
+    _stats.packets++;
+    DMXNetPacket packet;
+    if (!DMXNetCodec::parse(buffer, size, &packet)) {
+        _stats.invalid++;
+        return 0;
+    }
+    return route(packet, now_ms);
+}
+
+bool DMXNetRouter::acceptSource(Output& output, const DMXNetPacket& packet, uint32_t now_ms) {
+    bool live = output.has_source && now_ms - output.last_packet_ms < DMX_NET_SOURCE_TIMEOUT_MS;
+    bool same = live && (packet.cid == nullptr || memcmp(output.cid, packet.cid, DMX_SACN_CID_SIZE) == 0);
+
+    if (packet.options & DMX_SACN_OPT_TERMINATED) {
+        if (same) {
+            output.has_source = false;
+        }
+        return false;
+    }
+    if (packet.options & DMX_SACN_OPT_PREVIEW) {
+        return false;
+    }
+
+    if (same) {
+        // Art-Net sequence 0 means sequencing is disabled
+        if (packet.protocol == DMX_NET_SACN || packet.sequence != 0) {
+            int8_t diff = (int8_t)(packet.sequence - output.last_sequence);
+            if (diff <= 0 && diff > -DMX_NET_SEQUENCE_WINDOW) {
+                _stats.out_of_order++;
+                return false;
+            }
+        }
+    } else if (live && packet.priority <= output.priority) {
+        _stats.priority_rejects++;
+        return false;
+    }
+
+    if (packet.cid != nullptr) {
+        memcpy(output.cid, packet.cid, DMX_SACN_CID_SIZE);
+    }
+    output.has_source = true;
+    output.priority = packet.priority;
+    output.last_sequence = packet.sequence;
+    output.last_packet_ms = now_ms;
+    return true;
+}
+
+uint8_t DMXNetRouter::route(const DMXNetPacket& packet, uint32_t now_ms) {
+    if (packet.kind == DMXNetPacket::SYNC) {
+        return handleSync(packet, now_ms);
+    }
+
+    uint8_t ready = 0;
+    bool matched = false;
+    bool routed = false;
+    for (uint8_t i = 0; i < DMX_NET_MAX_OUTPUTS; i++) {
+        Output& output = _outputs[i];
+        if (output.protocol != packet.protocol || output.universe != packet.universe) {
+            continue;
+        }
+        matched = true;
+        if (!acceptSource(output, packet, now_ms)) {
+            continue;
+        }
+        uint8_t* buffer = _resolver ? _resolver(i, _context) : nullptr;
+        if (buffer == nullptr) {
+            continue;
+        }
+
+        // The only copy: packet payload straight into the output buffer
+        memcpy(buffer, packet.data, packet.length);
+        routed = true;
+
+        bool synchronised;
+        if (packet.protocol == DMX_NET_ARTNET) {
+            synchronised = _artsync_seen && now_ms - _artsync_ms < DMX_NET_SYNC_TIMEOUT_MS;
+        } else {
+            if (packet.sync_address != output.sync_address) {
+                output.sync_address = packet.sync_address;
+                output.sync_seen = false;
+            }
+            synchronised = output.sync_address != 0 && output.sync_seen &&
+                           now_ms - output.last_sync_ms < DMX_NET_SYNC_TIMEOUT_MS;
+        }
+
+        output.pending = synchronised;
+        if (!synchronised) {
+            ready |= (uint8_t)(1u << i);
+        }
+    }
+
+    if (routed) {
+        _stats.routed++;
+    } else if (!matched) {
+        _stats.unrouted++;
+    }
+    return ready;
+}
+
+uint8_t DMXNetRouter::handleSync(const DMXNetPacket& packet, uint32_t now_ms) {
+    _stats.syncs++;
+    if (packet.protocol == DMX_NET_ARTNET) {
+        _artsync_seen = true;
+        _artsync_ms = now_ms;
+    }
+
+    uint8_t ready = 0;
+    for (uint8_t i = 0; i < DMX_NET_MAX_OUTPUTS; i++) {
+        Output& output = _outputs[i];
+        if (output.protocol != packet.protocol) {
+            continue;
+        }
+        if (packet.protocol == DMX_NET_SACN) {
+            if (output.sync_address != packet.sync_address) {
+                continue;
+            }
+            output.sync_seen = true;
+            output.last_sync_ms = now_ms;
+        }
+        if (output.pending) {
+            output.pending = false;
+            ready |= (uint8_t)(1u << i);
+        }
+    }
+    return ready;
+}
+
+DMXNetRouter::Stats DMXNetRouter::getStats() const {
+    return _stats;
+}
+
+void DMXNetRouter::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
@@ -0,0 +1,157 @@
+#include "dmx_output_space.h"
+
+DMXOutputSpace::DMXOutputSpace() : _num_universes(0), _dirty(0), _flushed(0) {
+    memset(_slots, 0, sizeof(_slots));
+}
+
+bool DMXOutputSpace::begin(uint8_t num_universes) {
+    if (num_universes == 0 || num_universes > DMX_SPACE_MAX_UNIVERSES) {
+        return false;
+    }
+    _num_universes = num_universes;
+    _flushed = 0;
+    clear();
+    return true;
+}
+
+uint8_t DMXOutputSpace::getNumUniverses() const {
+    return _num_universes;
+}
+
+uint16_t DMXOutputSpace::size() const {
+    return (uint16_t)(_num_universes * DMX_UNIVERSE_SIZE);
+}
+
+DMXSlotSpan DMXOutputSpace::span(uint16_t address, uint16_t length) {
+    if (length == 0 || (uint32_t)address + length > size()) {
+        return DMXSlotSpan();
+    }
+    markDirty(address, length);
+    return DMXSlotSpan(this, &_slots[address], address, length);
+}
+
+DMXSlotView DMXOutputSpace::view(uint16_t address, uint16_t length) const {
+    if (length == 0 || (uint32_t)address + length > size()) {
+        return DMXSlotView();
+    }
+    return DMXSlotView(&_slots[address], length);
+}
+
+DMXSlotSpan DMXOutputSpace::universeSpan(uint8_t universe) {
+    return span((uint16_t)(universe * DMX_UNIVERSE_SIZE), DMX_UNIVERSE_SIZE);
+}
+
+bool DMXOutputSpace::write(uint16_t address, const uint8_t* data, uint16_t length) {
+    DMXSlotSpan target = span(address, length);
+    if (target.empty() || data == nullptr) {
+        return false;
+    }
+    target.copyFrom(data);
+    return true;
+}
+
+bool DMXOutputSpace::fill(uint16_t address, uint8_t value, uint16_t length) {
+    DMXSlotSpan target = span(address, length);
+    if (target.empty()) {
+        return false;
+    }
+    target.fill(value);
+    return true;
+}
+
+bool DMXOutputSpace::read(uint16_t address, uint8_t* data, uint16_t length) const {
+    DMXSlotView source = view(address, length);
+    if (source.empty() || data == nullptr) {
+        return false;
+    }
+    source.copyTo(data);
+    return true;
+}
+
+void DMXOutputSpace::clear() {
+    memset(_slots, 0, sizeof(_slots));
+    markAllDirty();
+}
+
+void DMXOutputSpace::markDirty(uint16_t address, uint16_t length) {
+    if (length == 0) {
+        return;
+    }
+    uint32_t first = address / DMX_UNIVERSE_SIZE;
+    uint32_t last = ((uint32_t)address + length - 1) / DMX_UNIVERSE_SIZE;
+    if (first >= DMX_SPACE_MAX_UNIVERSES) {
+        return;
+    }
+    if (last >= DMX_SPACE_MAX_UNIVERSES) {
+        last = DMX_SPACE_MAX_UNIVERSES - 1;
+    }
+    // Bits first..last
+    uint32_t upto_last = last >= 31 ? 0xFFFFFFFFu : (2u << last) - 1;
+    _dirty |= upto_last & ~((1u << first) - 1);
+}
+
+void DMXOutputSpace::markAllDirty() {
+    _dirty |= _num_universes >= 32 ? 0xFFFFFFFFu : (1u << _num_universes) - 1;
+}
+
+bool DMXOutputSpace::isDirty(uint8_t universe) const {
+    return universe < 32 && (_dirty >> universe) & 1;
+}
+
+uint32_t DMXOutputSpace::getDirtyMask() const {
+    return _dirty;
+}
+
+uint8_t DMXOutputSpace::flush(DMXTransmitter outputs[], uint8_t num_outputs) {
+    uint8_t count = num_outputs < _num_universes ? num_outputs : _num_universes;
+    uint8_t flushed = 0;
+    for (uint8_t u = 0; u < count; u++) {
+        if (!((_dirty >> u) & 1)) {
+            continue;
+        }
+        memcpy(outputs[u].getUniverseBuffer(), &_slots[u * DMX_UNIVERSE_SIZE], DMX_UNIVERSE_SIZE);
+        _dirty &= ~(1u << u);
+        _flushed |= 1u << u;
+        flushed++;
+    }
+    return flushed;
+}
+
+uint8_t DMXOutputSpace::transmit(DMXTransmitter outputs[], uint8_t num_outputs) {
+    uint8_t changed = 0;
+    for (uint8_t u = 0; u < num_outputs; u++) {
+        if (u >= _num_universes) {
+            outputs[u].transmit();
+            continue;
+        }
+        uint32_t bit = 1u << u;
+        if (_dirty & bit) {
+            // Copied once, into the buffer that goes on the wire. A stopped
+            // output keeps it in its back buffer for when it runs again
+            if (outputs[u].transmitUniverse(&_slots[u * DMX_UNIVERSE_SIZE])) {
+                _flushed &= ~bit;
+            } else {
+                _flushed |= bit;
+            }
+            _dirty &= ~bit;
+            changed++;
+        } else if (_flushed & bit) {
+            // A stopped output keeps the universe pending for when it runs again
+            if (outputs[u].transmit()) {
+                _flushed &= ~bit;
+            }
+            changed++;
+        } else {
+            outputs[u].retransmit();
+        }
+    }
+    return changed;
+}
+
+void DMXOutputSpace::load(DMXTransmitter outputs[], uint8_t num_outputs) {
+    uint8_t count = num_outputs < _num_universes ? num_outputs : _num_universes;
+    for (uint8_t u = 0; u < count; u++) {
+        memcpy(&_slots[u * DMX_UNIVERSE_SIZE], outputs[u].getUniverseBuffer(), DMX_UNIVERSE_SIZE);
+    }
+    markAllDirty();
+}
@@ -0,0 +1,149 @@
+#include "dmx_patch.h"
+#include "dmx_config.h"
+#include "hardware/sync.h"
+#include <cstring>
+
+DMXPatch::DMXPatch() : _active(0), _busy_table(-1) {
+    _num_runs[0] = _num_runs[1] = 0;
+    _num_slots[0] = _num_slots[1] = 0;
+}
+
+bool DMXPatch::compile(const PatchEntry* entries, uint16_t count) {
+    if (entries == nullptr && count > 0) {
+        return false;
+    }
+
+    uint8_t target = _active ^ 1;
+
+    // Never rebuild a table apply() is still reading (previous swap not yet observed)
+    while (_busy_table == (int8_t)target) {
+        tight_loop_contents();
+    }
+
+    CopyRun* runs = _runs[target];
+    uint16_t num_runs = 0;
+    uint16_t num_slots = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const PatchEntry& e = entries[i];
+        if (e.length == 0) {
+            continue;
+        }
+        if (e.src_universe >= MAX_DMX_RECEIVERS || e.dst_universe >= MAX_DMX_UNIVERSES ||
+            e.src_channel < 1 || e.src_channel + e.length - 1 > DMX_UNIVERSE_SIZE ||
+            e.dst_channel < 1 || e.dst_channel + e.length - 1 > DMX_UNIVERSE_SIZE) {
+            return false;
+        }
+        if (num_runs >= MAX_DMX_PATCH_RUNS) {
+            return false;
+        }
+
+        CopyRun run = {e.src_universe, e.dst_universe,
+                       (uint16_t)(e.src_channel - 1), (uint16_t)(e.dst_channel - 1), e.length};
+
+        // Insertion sort by destination so runs write each output buffer in order
+        uint16_t pos = num_runs;
+        while (pos > 0 &&
+               (runs[pos - 1].dst_universe > run.dst_universe ||
+                (runs[pos - 1].dst_universe == run.dst_universe && runs[pos - 1].dst_offset > run.dst_offset))) {
+            runs[pos] = runs[pos - 1];
+            pos--;
+        }
+        runs[pos] = run;
+        num_runs++;
+        num_slots += e.length;
+    }
+
+    // Reject overlapping destinations and coalesce runs that are contiguous
+    // on both the input and the output side
+    uint16_t out = 0;
+    for (uint16_t i = 0; i < num_runs; i++) {
+        if (out > 0) {
+            CopyRun& prev = runs[out - 1];
+            if (prev.dst_universe == runs[i].dst_universe) {
+                if (prev.dst_offset + prev.length > runs[i].dst_offset) {
+                    return false;
+                }
+                if (prev.src_universe == runs[i].src_universe &&
+                    prev.dst_offset + prev.length == runs[i].dst_offset &&
+                    prev.src_offset + prev.length == runs[i].src_offset) {
+                    prev.length += runs[i].length;
+                    continue;
+                }
+            }
+        }
+        runs[out++] = runs[i];
+    }
+
+    _num_runs[target] = out;
+    _num_slots[target] = num_slots;
+
+    // Publish the new table
+    __dmb();
+    _active = target;
+    __dmb();
+    return true;
+}
+
+void DMXPatch::clear() {
+    compile(nullptr, 0);
+}
+
+void DMXPatch::apply(const uint8_t* const src_universes[], uint8_t num_src,
+                     DMXTransmitter dst_outputs[], uint8_t num_dst) {
+    if (src_universes == nullptr || dst_outputs == nullptr) {
+        return;
+    }
+
+    // Snapshot the active table; compile() will not overwrite it while marked busy
+    uint8_t table = _active;
+    _busy_table = (int8_t)table;
+    __dmb();
+    if (table != _active) {
+        // A compile published between the read and the busy mark; use the newer table
+        table = _active;
+        _busy_table = (int8_t)table;
+        __dmb();
+    }
+
+    const CopyRun* runs = _runs[table];
+    uint16_t num_runs = _num_runs[table];
+
+    for (uint16_t i = 0; i < num_runs; i++) {
+        const CopyRun& run = runs[i];
+        if (run.src_universe >= num_src || run.dst_universe >= num_dst) {
+            continue;
+        }
+        const uint8_t* src = src_universes[run.src_universe];
+        if (src == nullptr) {
+            continue;
+        }
+        memcpy(dst_outputs[run.dst_universe].getUniverseBuffer() + run.dst_offset,
+               src + run.src_offset, run.length);
+    }
+
+    __dmb();
+    _busy_table = -1;
+}
+
+void DMXPatch::apply(const DMXMultiReceiver& rx, DMXTransmitter dst_outputs[], uint8_t num_dst) {
+    const uint8_t* src_universes[MAX_DMX_RECEIVERS];
+    uint8_t num_src = rx.getNumUniverses();
+    for (uint8_t i = 0; i < num_src; i++) {
+        src_universes[i] = rx.getUniverseBuffer(i);
+    }
+
+    apply(src_universes, num_src, dst_outputs, num_dst);
+}
+
+uint16_t DMXPatch::getNumRuns() const {
+    return _num_runs[_active];
+}
+
+uint16_t DMXPatch::getNumPatchedSlots() const {
+    return _num_slots[_active];
+}
+
+const DMXPatch::CopyRun* DMXPatch::getRuns() const {
+    return _runs[_active];
+}
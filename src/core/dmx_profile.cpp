@@ -0,0 +1,73 @@
+#include "dmx_profile.h"
+#include "dmx_telemetry.h"
+#include <cstring>
+
+static const char* METRIC_NAMES[DMX_PROFILE_METRIC_COUNT] = {
+    "rx irq latency", "rx irq duration", "rx rearm latency", "tx start jitter",
+    "callback u1", "callback u2", "callback u3", "callback u4",
+    "callback u5", "callback u6", "callback u7", "callback u8"
+};
+
+const char* DMXProfile::getName(uint8_t metric) {
+    return metric < DMX_PROFILE_METRIC_COUNT ? METRIC_NAMES[metric] : "unknown";
+}
+
+DMXProfile::Histogram DMXProfile::getHistogram(uint8_t metric) {
+    Histogram h;
+    memset(&h, 0, sizeof(h));
+#if DMX_PROFILE
+    if (metric < DMX_PROFILE_METRIC_COUNT) {
+        const volatile Histogram& live = _histograms[metric];
+        h.count = live.count;
+        h.total_us = live.total_us;
+        h.max_us = live.max_us;
+        for (uint8_t b = 0; b < DMX_PROFILE_BUCKETS; b++) {
+            h.buckets[b] = live.buckets[b];
+        }
+    }
+#else
+    (void)metric;
+#endif
+    return h;
+}
+
+void DMXProfile::reset() {
+#if DMX_PROFILE
+    for (uint8_t m = 0; m < DMX_PROFILE_METRIC_COUNT; m++) {
+        volatile Histogram& live = _histograms[m];
+        live.count = 0;
+        live.total_us = 0;
+        live.max_us = 0;
+        for (uint8_t b = 0; b < DMX_PROFILE_BUCKETS; b++) {
+            live.buckets[b] = 0;
+        }
+    }
+#endif
+}
+
+uint8_t DMXProfile::flush(DMXTelemetry& telemetry) {
+    uint8_t count = 0;
+#if DMX_PROFILE
+    uint8_t payload[DMX_STREAM_PROFILE_SIZE];
+    for (uint8_t m = 0; m < DMX_PROFILE_METRIC_COUNT; m++) {
+        Histogram h = getHistogram(m);
+        if (h.count == 0) {
+            continue;
+        }
+        const uint32_t header[3] = {h.count, h.total_us, h.max_us};
+        for (uint8_t w = 0; w < DMX_STREAM_PROFILE_SIZE / 4; w++) {
+            uint32_t value = w < 3 ? header[w] : h.buckets[w - 3];
+            payload[w * 4] = (uint8_t)value;
+            payload[w * 4 + 1] = (uint8_t)(value >> 8);
+            payload[w * 4 + 2] = (uint8_t)(value >> 16);
+            payload[w * 4 + 3] = (uint8_t)(value >> 24);
+        }
+        if (telemetry.publishRecord(DMX_STREAM_PROFILE, m, payload, sizeof(payload))) {
+            count++;
+        }
+    }
+#else
+    (void)telemetry;
+#endif
+    return count;
+}
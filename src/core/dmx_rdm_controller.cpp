@@ -0,0 +1,562 @@
+#include "dmx_rdm_controller.h"
+#include "DmxInput.pio.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include <cstring>
+
+#define SLOT_US 44          // One slot at 250 kbaud
+#define DISC_IDLE_US 88     // Line quiet after a branch response: colliding responses may run longer
+#define PORT_ID 1
+
+DMXRdmController::DMXRdmController()
+    : _transmitter(nullptr), _rx_pio(nullptr), _rx_sm(0), _rx_offset(0), _rx_dma(0),
+      _enable_pin(DMX_RDM_NO_ENABLE_PIN), _uid(0), _frame_period_us(0), _transactions_per_frame(1),
+      _initialized(false), _state(STATE_IDLE), _next_frame_us(0), _frame_transactions(0), _ready_us(0),
+      _tx_end_us(0), _last_rx_us(0), _last_rx_count(0), _transaction(0), _kind(KIND_USER),
+      _expect_response(false), _request_dest(0), _request_cc(0), _request_tn(0), _tx_length(0),
+      _queue_head(0), _queue_count(0), _discovery(DISCOVERY_OFF), _incremental(false),
+      _discovery_start_us(0), _stack_depth(0), _mute_pending(false), _requery(false), _mute_uid(0),
+      _mute_known_index(0), _num_devices(0) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+DMXRdmController::~DMXRdmController() {
+    end();
+}
+
+bool DMXRdmController::begin(DMXTransmitter* transmitter, uint rx_pin, int enable_pin, uint64_t uid,
+                             PIO rx_pio, uint32_t frame_period_us) {
+    if (_initialized || transmitter == nullptr || !transmitter->isInitialized() ||
+        !pio_can_add_program(rx_pio, &DmxInput_program)) {
+        return false;
+    }
+    int sm = pio_claim_unused_sm(rx_pio, false);
+    if (sm == -1) {
+        return false;
+    }
+    int dma = dma_claim_unused_channel(false);
+    if (dma == -1) {
+        pio_sm_unclaim(rx_pio, sm);
+        return false;
+    }
+
+    _rx_pio = rx_pio;
+    _rx_sm = sm;
+    _rx_dma = dma;
+    _rx_offset = pio_add_program(rx_pio, &DmxInput_program);
+
+    // Receive state machine configured as DmxInput::begin() does
+    pio_sm_set_consecutive_pindirs(rx_pio, sm, rx_pin, 1, false);
+    pio_gpio_init(rx_pio, rx_pin);
+    gpio_pull_up(rx_pin);
+    pio_sm_config sm_conf = DmxInput_program_get_default_config(_rx_offset);
+    sm_config_set_in_pins(&sm_conf, rx_pin);
+    sm_config_set_jmp_pin(&sm_conf, rx_pin);
+    sm_config_set_in_shift(&sm_conf, true, false, 8);
+    sm_config_set_fifo_join(&sm_conf, PIO_FIFO_JOIN_RX);
+    sm_config_set_clkdiv(&sm_conf, clock_get_hz(clk_sys) / DMX_SM_FREQ);
+    // Enter at the byte loop: the break detector in front of it would swallow
+    // a discovery response, which has no break
+    pio_sm_init(rx_pio, sm, _rx_offset + DmxInput_wrap_target, &sm_conf);
+
+    dma_channel_config cfg = dma_channel_get_default_config(_rx_dma);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+    channel_config_set_read_increment(&cfg, false);
+    channel_config_set_write_increment(&cfg, true);
+    channel_config_set_dreq(&cfg, pio_get_dreq(rx_pio, sm, false));
+    dma_channel_configure(_rx_dma, &cfg, _rx, &rx_pio->rxf[sm], DMX_RDM_RX_BUFFER_SIZE, false);
+
+    _enable_pin = enable_pin;
+    if (_enable_pin != DMX_RDM_NO_ENABLE_PIN) {
+        gpio_init(_enable_pin);
+        gpio_set_dir(_enable_pin, true);
+        gpio_put(_enable_pin, 1);
+    }
+
+    _transmitter = transmitter;
+    _uid = uid & DMX_RDM_UID_MASK;
+    _frame_period_us = frame_period_us;
+    _state = STATE_IDLE;
+    _next_frame_us = time_us_64();
+    _frame_transactions = 0;
+    _queue_count = 0;
+    _discovery = DISCOVERY_OFF;
+    _num_devices = 0;
+    _initialized = true;
+    resetStats();
+    return true;
+}
+
+void DMXRdmController::end() {
+    if (!_initialized) {
+        return;
+    }
+    _initialized = false;
+
+    dma_channel_abort(_rx_dma);
+    pio_sm_set_enabled(_rx_pio, _rx_sm, false);
+    pio_sm_clear_fifos(_rx_pio, _rx_sm);
+    pio_remove_program(_rx_pio, &DmxInput_program, _rx_offset);
+    pio_sm_unclaim(_rx_pio, _rx_sm);
+    dma_channel_unclaim(_rx_dma);
+
+    // Hand the driver enable pin back as an input
+    if (_enable_pin != DMX_RDM_NO_ENABLE_PIN) {
+        gpio_init(_enable_pin);
+        _enable_pin = DMX_RDM_NO_ENABLE_PIN;
+    }
+
+    _transmitter = nullptr;
+    _state = STATE_IDLE;
+    _queue_count = 0;
+    _discovery = DISCOVERY_OFF;
+}
+
+void DMXRdmController::setTransactionsPerFrame(uint8_t transactions) {
+    _transactions_per_frame = transactions > 0 ? transactions : 1;
+}
+
+bool DMXRdmController::startDiscovery(bool incremental) {
+    if (!_initialized || _discovery != DISCOVERY_OFF) {
+        return false;
+    }
+
+    _incremental = incremental;
+    if (!incremental) {
+        _num_devices = 0;
+    }
+    _discovery = DISCOVERY_UN_MUTE;
+    _discovery_start_us = time_us_64();
+    _stack_depth = 0;
+    _mute_pending = false;
+    _mute_known_index = 0;
+    return true;
+}
+
+bool DMXRdmController::isDiscovering() const {
+    return _discovery != DISCOVERY_OFF;
+}
+
+uint16_t DMXRdmController::getNumDevices() const {
+    return _num_devices;
+}
+
+uint64_t DMXRdmController::getDevice(uint16_t index) const {
+    return index < _num_devices ? _devices[index] : 0;
+}
+
+bool DMXRdmController::sendRequest(uint64_t dest, uint8_t command_class, uint16_t pid, const uint8_t* pd,
+                                   uint8_t pdl, DMXRdmCallback callback, void* user_data,
+                                   uint16_t sub_device) {
+    if (!_initialized || _queue_count >= DMX_RDM_QUEUE_SIZE || pdl > DMX_RDM_MAX_PDL ||
+        (pdl > 0 && pd == nullptr)) {
+        return false;
+    }
+
+    Request& request = _queue[(_queue_head + _queue_count) % DMX_RDM_QUEUE_SIZE];
+    memset(&request.packet, 0, DMX_RDM_HEADER_SIZE);
+    request.packet.dest = dest & DMX_RDM_UID_MASK;
+    request.packet.sub_device = sub_device;
+    request.packet.command_class = command_class;
+    request.packet.pid = pid;
+    request.packet.pdl = pdl;
+    if (pdl > 0) {
+        memcpy(request.packet.pd, pd, pdl);
+    }
+    request.callback = callback;
+    request.user_data = user_data;
+    _queue_count++;
+    return true;
+}
+
+bool DMXRdmController::get(uint64_t dest, uint16_t pid, DMXRdmCallback callback, void* user_data,
+                           const uint8_t* pd, uint8_t pdl) {
+    return sendRequest(dest, DMX_RDM_GET_COMMAND, pid, pd, pdl, callback, user_data);
+}
+
+bool DMXRdmController::set(uint64_t dest, uint16_t pid, const uint8_t* pd, uint8_t pdl,
+                           DMXRdmCallback callback, void* user_data) {
+    return sendRequest(dest, DMX_RDM_SET_COMMAND, pid, pd, pdl, callback, user_data);
+}
+
+bool DMXRdmController::isIdle() const {
+    return _queue_count == 0 && _discovery == DISCOVERY_OFF &&
+           (_state == STATE_IDLE || _state == STATE_SPACING);
+}
+
+bool DMXRdmController::poll() {
+    if (!_initialized) {
+        return false;
+    }
+
+    uint64_t now = time_us_64();
+    switch (_state) {
+    case STATE_SENDING_DMX:
+    case STATE_SENDING:
+        if (_transmitter->isBusy()) {
+            return false;
+        }
+        _tx_end_us = now;
+        if (_state == STATE_SENDING && _expect_response) {
+            startListening();
+            _state = STATE_LISTENING;
+        } else if (_state == STATE_SENDING) {
+            finishTransaction(0, now);
+        } else {
+            _ready_us = now + DMX_RDM_MIN_SPACING_US;
+            _state = STATE_SPACING;
+        }
+        return false;
+
+    case STATE_LISTENING: {
+        uint16_t count = rxCount();
+        if (count != _last_rx_count) {
+            _last_rx_count = count;
+            _last_rx_us = now;
+        }
+        // The first byte is only in once it has been shifted in whole
+        bool done = count == 0 ? now - _tx_end_us > DMX_RDM_RESPONSE_TIMEOUT_US + SLOT_US
+                               : responseComplete(count, now);
+        if (done) {
+            finishTransaction(count, now);
+        }
+        return false;
+    }
+
+    case STATE_SPACING:
+        // time_us_64() truncates, so equal may still be a fraction short
+        if (now <= _ready_us) {
+            return false;
+        }
+        _state = STATE_IDLE;
+        break;
+
+    case STATE_IDLE:
+        break;
+    }
+
+    // After a frame, up to _transactions_per_frame transactions run before
+    // the next one, even if that makes it late
+    bool rdm_work = _queue_count > 0 || _discovery != DISCOVERY_OFF;
+    if (_frame_period_us > 0 && (_frame_transactions >= _transactions_per_frame || !rdm_work)) {
+        if (now < _next_frame_us) {
+            return false;
+        }
+        setDriver(true);
+        _transmitter->transmit();
+        _stats.dmx_frames++;
+        _frame_transactions = 0;
+        _state = STATE_SENDING_DMX;
+
+        // Keep a fixed cadence; resynchronise if we fell more than a frame behind
+        _next_frame_us += _frame_period_us;
+        if (now > _next_frame_us) {
+            _next_frame_us = now + _frame_period_us;
+        }
+        return true;
+    }
+    return startTransaction();
+}
+
+DMXRdmController::Stats DMXRdmController::getStats() const {
+    return _stats;
+}
+
+void DMXRdmController::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool DMXRdmController::startTransaction() {
+    if (_queue_count > 0) {
+        _current = _queue[_queue_head];
+        _queue_head = (_queue_head + 1) % DMX_RDM_QUEUE_SIZE;
+        _queue_count--;
+        send(KIND_USER, _current.packet);
+        return true;
+    }
+    return _discovery != DISCOVERY_OFF && nextDiscoveryRequest();
+}
+
+bool DMXRdmController::nextDiscoveryRequest() {
+    DMXRdmPacket packet;
+    packet.sub_device = DMX_RDM_ROOT_DEVICE;
+    packet.command_class = DMX_RDM_DISCOVERY_COMMAND;
+    packet.pdl = 0;
+
+    switch (_discovery) {
+    case DISCOVERY_UN_MUTE:
+        packet.dest = DMX_RDM_BROADCAST_UID;
+        packet.pid = DMX_RDM_PID_DISC_UN_MUTE;
+        send(KIND_DISC_UN_MUTE, packet);
+        _discovery = _incremental ? DISCOVERY_MUTE_KNOWN : DISCOVERY_SEARCH;
+        if (_discovery == DISCOVERY_SEARCH) {
+            pushBranch(0, DMX_RDM_UID_MASK, false, false);
+        }
+        return true;
+
+    case DISCOVERY_MUTE_KNOWN:
+        if (_mute_known_index < _num_devices) {
+            packet.dest = _devices[_mute_known_index];
+            packet.pid = DMX_RDM_PID_DISC_MUTE;
+            send(KIND_DISC_MUTE, packet);
+            return true;
+        }
+        _discovery = DISCOVERY_SEARCH;
+        pushBranch(0, DMX_RDM_UID_MASK, false, false);
+        break;
+
+    case DISCOVERY_SEARCH:
+    case DISCOVERY_OFF:
+        break;
+    }
+
+    if (_mute_pending) {
+        packet.dest = _mute_uid;
+        packet.pid = DMX_RDM_PID_DISC_MUTE;
+        send(KIND_DISC_MUTE, packet);
+        return true;
+    }
+
+    while (_stack_depth > 0) {
+        Branch branch = _stack[--_stack_depth];
+        if (branch.must_split && branch.lower < branch.upper) {
+            splitBranch(branch);
+            continue;
+        }
+        _branch = branch;
+        packet.dest = DMX_RDM_BROADCAST_UID;
+        packet.pid = DMX_RDM_PID_DISC_UNIQUE_BRANCH;
+        packet.pdl = 12;
+        dmxRdmWriteUid(branch.lower, &packet.pd[0]);
+        dmxRdmWriteUid(branch.upper, &packet.pd[6]);
+        send(KIND_DISC_BRANCH, packet);
+        _stats.discovery_branches++;
+        return true;
+    }
+
+    endDiscovery();
+    return false;
+}
+
+void DMXRdmController::send(Kind kind, DMXRdmPacket& packet) {
+    packet.source = _uid;
+    packet.transaction = _transaction++;
+    packet.port_or_response = PORT_ID;
+    packet.message_count = 0;
+
+    _kind = kind;
+    _request_dest = packet.dest;
+    _request_cc = packet.command_class;
+    _request_tn = packet.transaction;
+    // Broadcasts (all devices, or all of one manufacturer) get no response,
+    // except from DISC_UNIQUE_BRANCH
+    bool broadcast = (packet.dest & 0xFFFFFFFFull) == 0xFFFFFFFFull;
+    _expect_response = !broadcast || packet.pid == DMX_RDM_PID_DISC_UNIQUE_BRANCH;
+
+    _tx_length = dmxRdmWrite(packet, _tx);
+    setDriver(true);
+    _transmitter->transmitFrame(_tx, _tx_length - 1);
+    _stats.transactions++;
+    _frame_transactions++;
+    _state = STATE_SENDING;
+}
+
+void DMXRdmController::setDriver(bool transmit) {
+    if (_enable_pin != DMX_RDM_NO_ENABLE_PIN) {
+        gpio_put(_enable_pin, transmit);
+    }
+}
+
+void DMXRdmController::startListening() {
+    // Release the line and start receiving from a clean byte boundary
+    setDriver(false);
+    pio_sm_set_enabled(_rx_pio, _rx_sm, false);
+    pio_sm_clear_fifos(_rx_pio, _rx_sm);
+    pio_sm_restart(_rx_pio, _rx_sm);
+    pio_sm_exec(_rx_pio, _rx_sm, pio_encode_jmp(_rx_offset + DmxInput_wrap_target));
+    dma_channel_set_trans_count(_rx_dma, DMX_RDM_RX_BUFFER_SIZE, false);
+    dma_channel_set_write_addr(_rx_dma, _rx, true);
+    pio_sm_set_enabled(_rx_pio, _rx_sm, true);
+    _last_rx_count = 0;
+}
+
+uint16_t DMXRdmController::rxCount() const {
+    return DMX_RDM_RX_BUFFER_SIZE - dma_hw->ch[_rx_dma].transfer_count;
+}
+
+bool DMXRdmController::responseComplete(uint16_t count, uint64_t now) const {
+    uint64_t idle = now - _last_rx_us;
+    if (_kind == KIND_DISC_BRANCH) {
+        // Colliding responders may use different preamble lengths, so wait
+        // for the line to go quiet rather than stop at the expected length
+        return idle > DISC_IDLE_US || count >= DMX_RDM_RX_BUFFER_SIZE;
+    }
+
+    // A responder's break reads as 0x00 bytes ahead of the response
+    uint16_t start = 0;
+    while (start < count && _rx[start] == 0x00) {
+        start++;
+    }
+    const uint8_t* data = &_rx[start];
+    uint16_t length = count - start;
+    if (length > 0 && data[0] == DMX_RDM_START_CODE) {
+        uint16_t expected = dmxRdmPacketLength(data, length);
+        if (expected > 0 && length >= expected) {
+            return true;
+        }
+    }
+    return idle > DMX_RDM_MAX_INTERSLOT_US || count >= DMX_RDM_RX_BUFFER_SIZE;
+}
+
+void DMXRdmController::finishTransaction(uint16_t count, uint64_t now) {
+    if (_expect_response) {
+        dma_channel_abort(_rx_dma);
+        pio_sm_set_enabled(_rx_pio, _rx_sm, false);
+    }
+
+    uint16_t start = 0;
+    while (start < count && _rx[start] == 0x00) {
+        start++;
+    }
+    const uint8_t* data = &_rx[start];
+    uint16_t length = count - start;
+
+    DMXRdmStatus status;
+    if (!_expect_response) {
+        status = DMX_RDM_STATUS_BROADCAST;
+        _ready_us = _tx_end_us + DMX_RDM_MIN_SPACING_US;
+    } else if (count == 0) {
+        status = DMX_RDM_STATUS_TIMEOUT;
+        _ready_us = _tx_end_us + (_kind == KIND_DISC_BRANCH ? DMX_RDM_DISCOVERY_SPACING_US
+                                                            : DMX_RDM_LOST_RESPONSE_SPACING_US);
+        if (_kind != KIND_DISC_BRANCH) {
+            _stats.timeouts++;
+        }
+    } else {
+        _ready_us = now + DMX_RDM_MIN_SPACING_US;
+        if (_kind == KIND_DISC_BRANCH) {
+            status = DMX_RDM_STATUS_OK;
+        } else if (dmxRdmRead(data, length, &_response) && _response.dest == _uid &&
+                   _response.source == _request_dest && _response.transaction == _request_tn &&
+                   _response.command_class == _request_cc + 1) {
+            status = DMX_RDM_STATUS_OK;
+        } else {
+            status = DMX_RDM_STATUS_INVALID;
+            _stats.invalid++;
+        }
+    }
+    _state = STATE_SPACING;
+
+    switch (_kind) {
+    case KIND_USER:
+        if (_current.callback != nullptr) {
+            _current.callback(this, status, status == DMX_RDM_STATUS_OK ? &_response : nullptr,
+                              _current.user_data);
+        }
+        break;
+
+    case KIND_DISC_UN_MUTE:
+        break;
+
+    case KIND_DISC_BRANCH:
+        onBranchResponse(status, data, length);
+        break;
+
+    case KIND_DISC_MUTE:
+        onMuteResponse(status == DMX_RDM_STATUS_OK);
+        break;
+    }
+}
+
+void DMXRdmController::onBranchResponse(DMXRdmStatus status, const uint8_t* data, uint16_t length) {
+    if (status == DMX_RDM_STATUS_TIMEOUT) {
+        // The lower half of a collided range is empty: all of the collision
+        // is in the upper half, which is next on the stack
+        if (_branch.first_child && _stack_depth > 0) {
+            _stack[_stack_depth - 1].must_split = true;
+        }
+        return;
+    }
+
+    uint64_t uid;
+    if (dmxRdmReadDiscoveryResponse(data, length, &uid) && uid >= _branch.lower && uid <= _branch.upper) {
+        // Mute it, then ask the same range again for the others
+        _mute_pending = true;
+        _mute_uid = uid;
+        _requery = pushBranch(_branch.lower, _branch.upper, false, false);
+        return;
+    }
+
+    _stats.collisions++;
+    if (_branch.lower == _branch.upper) {
+        // Nothing left to split: address the UID directly
+        _mute_pending = true;
+        _mute_uid = _branch.lower;
+        _requery = false;
+    } else {
+        splitBranch(_branch);
+    }
+}
+
+void DMXRdmController::onMuteResponse(bool ok) {
+    if (_discovery == DISCOVERY_MUTE_KNOWN) {
+        if (ok && _response.source == _devices[_mute_known_index]) {
+            _mute_known_index++;
+        } else {
+            removeDevice(_mute_known_index);
+        }
+        return;
+    }
+
+    _mute_pending = false;
+    if (ok && _response.source == _mute_uid) {
+        addDevice(_mute_uid);
+    } else if (_requery) {
+        // A phantom UID decoded out of a collision, or a device that will not
+        // mute: re-asking the range would find it again, so split it instead
+        Branch branch = _stack[--_stack_depth];
+        if (branch.lower < branch.upper) {
+            splitBranch(branch);
+        }
+    }
+}
+
+bool DMXRdmController::pushBranch(uint64_t lower, uint64_t upper, bool first_child, bool must_split) {
+    if (_stack_depth >= DMX_RDM_DISCOVERY_STACK) {
+        return false;
+    }
+    _stack[_stack_depth++] = {lower, upper, first_child, must_split};
+    return true;
+}
+
+void DMXRdmController::splitBranch(const Branch& branch) {
+    uint64_t mid = branch.lower + (branch.upper - branch.lower) / 2;
+    // Lower half on top, so it is asked first
+    pushBranch(mid + 1, branch.upper, false, false);
+    pushBranch(branch.lower, mid, true, false);
+}
+
+void DMXRdmController::addDevice(uint64_t uid) {
+    for (uint16_t i = 0; i < _num_devices; i++) {
+        if (_devices[i] == uid) {
+            return;
+        }
+    }
+    if (_num_devices < DMX_RDM_MAX_DEVICES) {
+        _devices[_num_devices++] = uid;
+    }
+}
+
+void DMXRdmController::removeDevice(uint16_t index) {
+    if (index >= _num_devices) {
+        return;
+    }
+    memmove(&_devices[index], &_devices[index + 1], (_num_devices - index - 1) * sizeof(_devices[0]));
+    _num_devices--;
+}
+
+void DMXRdmController::endDiscovery() {
+    _discovery = DISCOVERY_OFF;
+    _stack_depth = 0;
+    _stats.last_discovery_us = (uint32_t)(time_us_64() - _discovery_start_us);
+}
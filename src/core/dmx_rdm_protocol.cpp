@@ -0,0 +1,147 @@
+#include "dmx_rdm_protocol.h"
+#include <string.h>
+
+void dmxRdmWriteUid(uint64_t uid, uint8_t* out) {
+    for (uint8_t i = 0; i < 6; i++) {
+        out[i] = (uint8_t)(uid >> (40 - i * 8));
+    }
+}
+
+uint64_t dmxRdmReadUid(const uint8_t* in) {
+    uint64_t uid = 0;
+    for (uint8_t i = 0; i < 6; i++) {
+        uid = (uid << 8) | in[i];
+    }
+    return uid;
+}
+
+static uint16_t checksum(const uint8_t* data, uint16_t length) {
+    uint16_t sum = 0;
+    for (uint16_t i = 0; i < length; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+uint16_t dmxRdmWrite(const DMXRdmPacket& packet, uint8_t* out) {
+    if (packet.pdl > DMX_RDM_MAX_PDL) {
+        return 0;
+    }
+
+    uint8_t message_length = DMX_RDM_HEADER_SIZE + packet.pdl;
+    out[0] = DMX_RDM_START_CODE;
+    out[1] = DMX_RDM_SUB_START_CODE;
+    out[2] = message_length;
+    dmxRdmWriteUid(packet.dest, &out[3]);
+    dmxRdmWriteUid(packet.source, &out[9]);
+    out[15] = packet.transaction;
+    out[16] = packet.port_or_response;
+    out[17] = packet.message_count;
+    out[18] = (uint8_t)(packet.sub_device >> 8);
+    out[19] = (uint8_t)packet.sub_device;
+    out[20] = packet.command_class;
+    out[21] = (uint8_t)(packet.pid >> 8);
+    out[22] = (uint8_t)packet.pid;
+    out[23] = packet.pdl;
+    memcpy(&out[DMX_RDM_HEADER_SIZE], packet.pd, packet.pdl);
+
+    uint16_t sum = checksum(out, message_length);
+    out[message_length] = (uint8_t)(sum >> 8);
+    out[message_length + 1] = (uint8_t)sum;
+    return message_length + DMX_RDM_CHECK_SIZE;
+}
+
+uint16_t dmxRdmPacketLength(const uint8_t* data, uint16_t available) {
+    if (available < 3) {
+        return 0;
+    }
+    return data[2] + DMX_RDM_CHECK_SIZE;
+}
+
+bool dmxRdmRead(const uint8_t* data, uint16_t length, DMXRdmPacket* packet) {
+    if (length < DMX_RDM_HEADER_SIZE + DMX_RDM_CHECK_SIZE || data[0] != DMX_RDM_START_CODE ||
+        data[1] != DMX_RDM_SUB_START_CODE) {
+        return false;
+    }
+    uint8_t message_length = data[2];
+    if (message_length < DMX_RDM_HEADER_SIZE || message_length + DMX_RDM_CHECK_SIZE > length ||
+        data[23] != message_length - DMX_RDM_HEADER_SIZE) {
+        return false;
+    }
+    uint16_t sum = (uint16_t)((data[message_length] << 8) | data[message_length + 1]);
+    if (checksum(data, message_length) != sum) {
+        return false;
+    }
+
+    packet->dest = dmxRdmReadUid(&data[3]);
+    packet->source = dmxRdmReadUid(&data[9]);
+    packet->transaction = data[15];
+    packet->port_or_response = data[16];
+    packet->message_count = data[17];
+    packet->sub_device = (uint16_t)((data[18] << 8) | data[19]);
+    packet->command_class = data[20];
+    packet->pid = (uint16_t)((data[21] << 8) | data[22]);
+    packet->pdl = data[23];
+    memcpy(packet->pd, &data[DMX_RDM_HEADER_SIZE], packet->pdl);
+    return true;
+}
+
+uint16_t dmxRdmWriteDiscoveryResponse(uint64_t uid, uint8_t preamble_length, uint8_t* out) {
+    if (preamble_length > DMX_RDM_DISC_MAX_PREAMBLE) {
+        preamble_length = DMX_RDM_DISC_MAX_PREAMBLE;
+    }
+    uint16_t n = 0;
+    while (n < preamble_length) {
+        out[n++] = DMX_RDM_DISC_PREAMBLE;
+    }
+    out[n++] = DMX_RDM_DISC_SEPARATOR;
+
+    uint8_t* euid = &out[n];
+    uint8_t bytes[6];
+    dmxRdmWriteUid(uid, bytes);
+    for (uint8_t i = 0; i < 6; i++) {
+        euid[i * 2] = bytes[i] | 0xAA;
+        euid[i * 2 + 1] = bytes[i] | 0x55;
+    }
+    uint16_t sum = checksum(euid, 12);
+    euid[12] = (uint8_t)(sum >> 8) | 0xAA;
+    euid[13] = (uint8_t)(sum >> 8) | 0x55;
+    euid[14] = (uint8_t)sum | 0xAA;
+    euid[15] = (uint8_t)sum | 0x55;
+    return n + DMX_RDM_DISC_ENCODED_SIZE;
+}
+
+uint16_t dmxRdmDiscoveryResponseLength(const uint8_t* data, uint16_t available) {
+    for (uint16_t i = 0; i < available && i <= DMX_RDM_DISC_MAX_PREAMBLE; i++) {
+        if (data[i] == DMX_RDM_DISC_SEPARATOR) {
+            return i + 1 + DMX_RDM_DISC_ENCODED_SIZE;
+        }
+        if (data[i] != DMX_RDM_DISC_PREAMBLE) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+bool dmxRdmReadDiscoveryResponse(const uint8_t* data, uint16_t length, uint64_t* uid) {
+    uint16_t expected = dmxRdmDiscoveryResponseLength(data, length);
+    if (expected == 0 || length < expected) {
+        return false;
+    }
+
+    const uint8_t* euid = &data[expected - DMX_RDM_DISC_ENCODED_SIZE];
+    // Each byte travels twice with complementary bits forced high
+    uint8_t decoded[8];
+    for (uint8_t i = 0; i < 8; i++) {
+        if ((euid[i * 2] | 0xAA) != euid[i * 2] || (euid[i * 2 + 1] | 0x55) != euid[i * 2 + 1]) {
+            return false;
+        }
+        decoded[i] = euid[i * 2] & euid[i * 2 + 1];
+    }
+    uint16_t sum = (uint16_t)((decoded[6] << 8) | decoded[7]);
+    if (checksum(euid, 12) != sum) {
+        return false;
+    }
+    *uid = dmxRdmReadUid(decoded);
+    return true;
+}
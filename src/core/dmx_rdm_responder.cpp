@@ -0,0 +1,485 @@
+#include "dmx_rdm_responder.h"
+#include "DmxInput.pio.h"
+#include "DmxOutput.pio.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include <cstring>
+
+#define RDM_PROTOCOL_VERSION 0x0100
+#define NO_START_ADDRESS 0xFFFF
+#define ALL_SUB_DEVICES 0xFFFF
+
+DMXRdmResponder::DMXRdmResponder()
+    : _receiver(nullptr), _pio(nullptr), _rx_sm(0), _rx_offset(0), _rx_dma(0), _tx_sm(0), _tx_offset(0),
+      _tx_dma(0), _tx_pin(0), _enable_pin(DMX_RDM_NO_ENABLE_PIN), _uid(0), _initialized(false),
+      _state(STATE_LISTENING), _request_end_us(0), _tx_length(0), _tx_break(true), _muted(false),
+      _identifying(false), _model_id(0), _product_category(0), _software_version(0), _footprint(0),
+      _start_address(1), _change_callback(nullptr), _change_user_data(nullptr) {
+    memset(_device_label, 0, sizeof(_device_label));
+    memset(_software_label, 0, sizeof(_software_label));
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+DMXRdmResponder::~DMXRdmResponder() {
+    end();
+}
+
+bool DMXRdmResponder::begin(DMXReceiver* receiver, uint tx_pin, int enable_pin, uint64_t uid, PIO pio) {
+    if (_initialized || receiver == nullptr || !receiver->isAsyncActive() ||
+        !pio_can_add_program(pio, &DmxInput_program)) {
+        return false;
+    }
+    int rx_sm = pio_claim_unused_sm(pio, false);
+    if (rx_sm == -1) {
+        return false;
+    }
+    int tx_sm = pio_claim_unused_sm(pio, false);
+    if (tx_sm == -1) {
+        pio_sm_unclaim(pio, rx_sm);
+        return false;
+    }
+    _rx_offset = pio_add_program(pio, &DmxInput_program);
+    if (!pio_can_add_program(pio, &DmxOutput_program)) {
+        pio_remove_program(pio, &DmxInput_program, _rx_offset);
+        pio_sm_unclaim(pio, rx_sm);
+        pio_sm_unclaim(pio, tx_sm);
+        return false;
+    }
+    _tx_offset = pio_add_program(pio, &DmxOutput_program);
+    _rx_dma = dma_claim_unused_channel(true);
+    _tx_dma = dma_claim_unused_channel(true);
+    _pio = pio;
+    _rx_sm = rx_sm;
+    _tx_sm = tx_sm;
+    _tx_pin = tx_pin;
+    uint clk_div = clock_get_hz(clk_sys) / DMX_SM_FREQ;
+
+    // Receive: a second DmxInput on the receiver's pin, configured as
+    // DmxInput::begin() does, that only ever captures up to one RDM packet
+    uint rx_pin = receiver->getGpioPin();
+    pio_sm_config rx_conf = DmxInput_program_get_default_config(_rx_offset);
+    sm_config_set_in_pins(&rx_conf, rx_pin);
+    sm_config_set_jmp_pin(&rx_conf, rx_pin);
+    sm_config_set_in_shift(&rx_conf, true, false, 8);
+    sm_config_set_fifo_join(&rx_conf, PIO_FIFO_JOIN_RX);
+    sm_config_set_clkdiv(&rx_conf, clk_div);
+    pio_sm_init(pio, rx_sm, _rx_offset, &rx_conf);
+
+    dma_channel_config rx_dma = dma_channel_get_default_config(_rx_dma);
+    channel_config_set_transfer_data_size(&rx_dma, DMA_SIZE_8);
+    channel_config_set_read_increment(&rx_dma, false);
+    channel_config_set_write_increment(&rx_dma, true);
+    channel_config_set_dreq(&rx_dma, pio_get_dreq(pio, rx_sm, false));
+    dma_channel_configure(_rx_dma, &rx_dma, _rx, &pio->rxf[rx_sm], DMX_RDM_MAX_PACKET, false);
+
+    // Transmit: the DmxOutput program, as DmxOutput::begin() sets it up, but
+    // idle until there is a response to send
+    pio_sm_set_pins_with_mask(pio, tx_sm, 1u << tx_pin, 1u << tx_pin);
+    pio_sm_set_pindirs_with_mask(pio, tx_sm, 1u << tx_pin, 1u << tx_pin);
+    pio_gpio_init(pio, tx_pin);
+    pio_sm_config tx_conf = DmxOutput_program_get_default_config(_tx_offset);
+    sm_config_set_out_pins(&tx_conf, tx_pin, 1);
+    sm_config_set_sideset_pins(&tx_conf, tx_pin);
+    sm_config_set_clkdiv(&tx_conf, clk_div);
+    pio_sm_init(pio, tx_sm, _tx_offset + DmxOutput_wrap_target, &tx_conf);
+
+    dma_channel_config tx_dma = dma_channel_get_default_config(_tx_dma);
+    channel_config_set_transfer_data_size(&tx_dma, DMA_SIZE_8);
+    channel_config_set_dreq(&tx_dma, pio_get_dreq(pio, tx_sm, true));
+    dma_channel_configure(_tx_dma, &tx_dma, &pio->txf[tx_sm], _tx, 0, false);
+
+    _enable_pin = enable_pin;
+    if (_enable_pin != DMX_RDM_NO_ENABLE_PIN) {
+        gpio_init(_enable_pin);
+        gpio_set_dir(_enable_pin, true);
+        gpio_put(_enable_pin, 0);
+    }
+
+    _receiver = receiver;
+    _uid = uid & DMX_RDM_UID_MASK;
+    _muted = false;
+    _initialized = true;
+    resetStats();
+    rearm();
+    pio_sm_set_enabled(pio, rx_sm, true);
+    return true;
+}
+
+void DMXRdmResponder::end() {
+    if (!_initialized) {
+        return;
+    }
+    _initialized = false;
+
+    dma_channel_abort(_rx_dma);
+    dma_channel_abort(_tx_dma);
+    pio_sm_set_enabled(_pio, _rx_sm, false);
+    pio_sm_set_enabled(_pio, _tx_sm, false);
+    pio_sm_clear_fifos(_pio, _rx_sm);
+    pio_sm_clear_fifos(_pio, _tx_sm);
+    pio_remove_program(_pio, &DmxInput_program, _rx_offset);
+    pio_remove_program(_pio, &DmxOutput_program, _tx_offset);
+    pio_sm_unclaim(_pio, _rx_sm);
+    pio_sm_unclaim(_pio, _tx_sm);
+    dma_channel_unclaim(_rx_dma);
+    dma_channel_unclaim(_tx_dma);
+
+    // Hand the transmit pin back to the GPIO block, idling high (mark), and
+    // the driver enable pin back as an input
+    gpio_init(_tx_pin);
+    gpio_pull_up(_tx_pin);
+    if (_enable_pin != DMX_RDM_NO_ENABLE_PIN) {
+        gpio_init(_enable_pin);
+        _enable_pin = DMX_RDM_NO_ENABLE_PIN;
+    }
+
+    _receiver = nullptr;
+    _state = STATE_LISTENING;
+}
+
+void DMXRdmResponder::setDeviceInfo(uint16_t model_id, uint16_t product_category, uint32_t software_version,
+                                    uint16_t footprint) {
+    _model_id = model_id;
+    _product_category = product_category;
+    _software_version = software_version;
+    _footprint = footprint > DMX_UNIVERSE_SIZE ? DMX_UNIVERSE_SIZE : footprint;
+    if (_footprint > 0 && _start_address + _footprint - 1 > DMX_UNIVERSE_SIZE) {
+        _start_address = DMX_UNIVERSE_SIZE - _footprint + 1;
+    }
+}
+
+void DMXRdmResponder::setSoftwareVersionLabel(const char* label) {
+    strncpy(_software_label, label != nullptr ? label : "", DMX_RDM_LABEL_SIZE);
+}
+
+bool DMXRdmResponder::setStartAddress(uint16_t address) {
+    if (address < 1 || address + (_footprint > 0 ? _footprint : 1) - 1 > DMX_UNIVERSE_SIZE) {
+        return false;
+    }
+    _start_address = address;
+    return true;
+}
+
+uint16_t DMXRdmResponder::getStartAddress() const {
+    return _start_address;
+}
+
+void DMXRdmResponder::setDeviceLabel(const char* label) {
+    strncpy(_device_label, label != nullptr ? label : "", DMX_RDM_LABEL_SIZE);
+}
+
+const char* DMXRdmResponder::getDeviceLabel() const {
+    return _device_label;
+}
+
+bool DMXRdmResponder::isIdentifying() const {
+    return _identifying;
+}
+
+bool DMXRdmResponder::isMuted() const {
+    return _muted;
+}
+
+uint64_t DMXRdmResponder::getUid() const {
+    return _uid;
+}
+
+void DMXRdmResponder::setChangeCallback(DMXRdmChangeCallback callback, void* user_data) {
+    _change_callback = callback;
+    _change_user_data = user_data;
+}
+
+bool DMXRdmResponder::poll() {
+    if (!_initialized) {
+        return false;
+    }
+
+    uint64_t now = time_us_64();
+    switch (_state) {
+    case STATE_LISTENING: {
+        uint16_t count = rxCount();
+        if (count == 0) {
+            return false;
+        }
+        // Null start code frames and other alternate start codes are not ours
+        if (_rx[0] != DMX_RDM_START_CODE) {
+            rearm();
+            return false;
+        }
+        uint16_t expected = dmxRdmPacketLength(_rx, count);
+        if (expected == 0 || (count < expected && count < DMX_RDM_MAX_PACKET)) {
+            return false;
+        }
+
+        // Complete: let the receiver pick up the next frame from its break
+        _request_end_us = now;
+        _receiver->restartFrame();
+
+        DMXRdmPacket request;
+        if (!dmxRdmRead(_rx, count, &request)) {
+            _stats.checksum_errors++;
+            rearm();
+            return false;
+        }
+        _stats.requests++;
+        if (!handleRequest(request)) {
+            rearm();
+            return false;
+        }
+        _state = STATE_TURNAROUND;
+        return false;
+    }
+
+    case STATE_TURNAROUND: {
+        // time_us_64() truncates, so equal may still be a fraction short
+        uint64_t waited = now - _request_end_us;
+        if (waited <= DMX_RDM_RESPONDER_MIN_DELAY_US) {
+            return false;
+        }
+        if (waited >= DMX_RDM_RESPONDER_MAX_DELAY_US) {
+            // Too late: the controller may already be sending again
+            _stats.late++;
+            rearm();
+            _state = STATE_LISTENING;
+            return false;
+        }
+        transmit();
+        _stats.responses++;
+        _stats.last_turnaround_us = (uint32_t)waited;
+        if (_stats.last_turnaround_us > _stats.max_turnaround_us) {
+            _stats.max_turnaround_us = _stats.last_turnaround_us;
+        }
+        _state = STATE_SENDING;
+        return true;
+    }
+
+    case STATE_SENDING:
+        if (txBusy()) {
+            return false;
+        }
+        setDriver(false);
+        // Our own response may have echoed into the receiver
+        _receiver->restartFrame();
+        rearm();
+        _state = STATE_LISTENING;
+        return false;
+    }
+    return false;
+}
+
+DMXRdmResponder::Stats DMXRdmResponder::getStats() const {
+    return _stats;
+}
+
+void DMXRdmResponder::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void DMXRdmResponder::rearm() {
+    // Back to waiting for a break, as the DmxInput DMA handler does
+    dma_channel_abort(_rx_dma);
+    pio_sm_exec(_pio, _rx_sm, pio_encode_jmp(_rx_offset));
+    pio_sm_clear_fifos(_pio, _rx_sm);
+    dma_channel_set_write_addr(_rx_dma, _rx, true);
+}
+
+uint16_t DMXRdmResponder::rxCount() const {
+    return DMX_RDM_MAX_PACKET - dma_hw->ch[_rx_dma].transfer_count;
+}
+
+bool DMXRdmResponder::handleRequest(const DMXRdmPacket& request) {
+    // All devices, or all devices of our manufacturer
+    bool broadcast = (request.dest & 0xFFFFFFFFull) == 0xFFFFFFFFull &&
+                     ((request.dest >> 32) == 0xFFFF || (request.dest >> 32) == (_uid >> 32));
+    if (request.dest != _uid && !broadcast) {
+        return false;
+    }
+
+    if (request.command_class == DMX_RDM_DISCOVERY_COMMAND) {
+        return handleDiscovery(request, broadcast);
+    }
+    if (request.command_class != DMX_RDM_GET_COMMAND && request.command_class != DMX_RDM_SET_COMMAND) {
+        return !broadcast && nack(request, DMX_RDM_NR_UNSUPPORTED_COMMAND_CLASS);
+    }
+    bool is_set = request.command_class == DMX_RDM_SET_COMMAND;
+    // Broadcast GETs get no answer and change nothing
+    if (broadcast && !is_set) {
+        return false;
+    }
+    if (request.sub_device != DMX_RDM_ROOT_DEVICE && !(is_set && request.sub_device == ALL_SUB_DEVICES)) {
+        return !broadcast && nack(request, DMX_RDM_NR_SUB_DEVICE_OUT_OF_RANGE);
+    }
+
+    bool ok = true;
+    switch (request.pid) {
+    case DMX_RDM_PID_SUPPORTED_PARAMETERS:
+        if (!is_set) {
+            // Required parameters are not listed
+            const uint8_t pids[] = {DMX_RDM_PID_DEVICE_LABEL >> 8, DMX_RDM_PID_DEVICE_LABEL & 0xFF};
+            return respond(request, DMX_RDM_ACK, pids, sizeof(pids));
+        }
+        break;
+
+    case DMX_RDM_PID_DEVICE_INFO:
+        if (!is_set) {
+            uint16_t address = _footprint > 0 ? _start_address : NO_START_ADDRESS;
+            const uint8_t info[DMX_RDM_DEVICE_INFO_SIZE] = {
+                RDM_PROTOCOL_VERSION >> 8, RDM_PROTOCOL_VERSION & 0xFF,
+                (uint8_t)(_model_id >> 8), (uint8_t)_model_id,
+                (uint8_t)(_product_category >> 8), (uint8_t)_product_category,
+                (uint8_t)(_software_version >> 24), (uint8_t)(_software_version >> 16),
+                (uint8_t)(_software_version >> 8), (uint8_t)_software_version,
+                (uint8_t)(_footprint >> 8), (uint8_t)_footprint,
+                1, 1,                                   // Personality 1 of 1
+                (uint8_t)(address >> 8), (uint8_t)address,
+                0, 0,                                   // Sub-devices
+                0                                       // Sensors
+            };
+            return respond(request, DMX_RDM_ACK, info, sizeof(info));
+        }
+        break;
+
+    case DMX_RDM_PID_SOFTWARE_VERSION_LABEL:
+        if (!is_set) {
+            return respondLabel(request, _software_label);
+        }
+        break;
+
+    case DMX_RDM_PID_DEVICE_LABEL:
+        if (!is_set) {
+            return respondLabel(request, _device_label);
+        }
+        if (request.pdl > DMX_RDM_LABEL_SIZE) {
+            return !broadcast && nack(request, DMX_RDM_NR_FORMAT_ERROR);
+        }
+        memcpy(_device_label, request.pd, request.pdl);
+        _device_label[request.pdl] = '\0';
+        changed(request.pid);
+        return !broadcast && respond(request, DMX_RDM_ACK, nullptr, 0);
+
+    case DMX_RDM_PID_DMX_START_ADDRESS:
+        if (_footprint == 0) {
+            break;
+        }
+        if (!is_set) {
+            const uint8_t address[2] = {(uint8_t)(_start_address >> 8), (uint8_t)_start_address};
+            return respond(request, DMX_RDM_ACK, address, sizeof(address));
+        }
+        if (request.pdl != 2) {
+            return !broadcast && nack(request, DMX_RDM_NR_FORMAT_ERROR);
+        }
+        ok = setStartAddress((uint16_t)((request.pd[0] << 8) | request.pd[1]));
+        if (!ok) {
+            return !broadcast && nack(request, DMX_RDM_NR_DATA_OUT_OF_RANGE);
+        }
+        changed(request.pid);
+        return !broadcast && respond(request, DMX_RDM_ACK, nullptr, 0);
+
+    case DMX_RDM_PID_IDENTIFY_DEVICE:
+        if (!is_set) {
+            const uint8_t state = _identifying ? 1 : 0;
+            return respond(request, DMX_RDM_ACK, &state, 1);
+        }
+        if (request.pdl != 1 || request.pd[0] > 1) {
+            return !broadcast && nack(request, request.pdl != 1 ? DMX_RDM_NR_FORMAT_ERROR
+                                                                : DMX_RDM_NR_DATA_OUT_OF_RANGE);
+        }
+        _identifying = request.pd[0] == 1;
+        changed(request.pid);
+        return !broadcast && respond(request, DMX_RDM_ACK, nullptr, 0);
+
+    default:
+        break;
+    }
+
+    // Unknown, or the wrong command class for a known parameter
+    return !broadcast && nack(request, DMX_RDM_NR_UNKNOWN_PID);
+}
+
+bool DMXRdmResponder::handleDiscovery(const DMXRdmPacket& request, bool broadcast) {
+    switch (request.pid) {
+    case DMX_RDM_PID_DISC_UNIQUE_BRANCH: {
+        if (_muted || request.pdl != 12) {
+            return false;
+        }
+        uint64_t lower = dmxRdmReadUid(&request.pd[0]);
+        uint64_t upper = dmxRdmReadUid(&request.pd[6]);
+        if (_uid < lower || _uid > upper) {
+            return false;
+        }
+        _tx_length = dmxRdmWriteDiscoveryResponse(_uid, DMX_RDM_DISC_MAX_PREAMBLE, _tx);
+        _tx_break = false;
+        _stats.discovery_responses++;
+        return true;
+    }
+
+    case DMX_RDM_PID_DISC_MUTE:
+    case DMX_RDM_PID_DISC_UN_MUTE: {
+        _muted = request.pid == DMX_RDM_PID_DISC_MUTE;
+        const uint8_t control[2] = {0, 0};      // No flags: root device only, no proxy
+        return !broadcast && respond(request, DMX_RDM_ACK, control, sizeof(control));
+    }
+
+    default:
+        return false;
+    }
+}
+
+bool DMXRdmResponder::respond(const DMXRdmPacket& request, uint8_t response_type, const uint8_t* pd,
+                              uint8_t pdl) {
+    DMXRdmPacket response;
+    response.dest = request.source;
+    response.source = _uid;
+    response.transaction = request.transaction;
+    response.port_or_response = response_type;
+    response.message_count = 0;
+    response.sub_device = request.sub_device;
+    response.command_class = request.command_class + 1;
+    response.pid = request.pid;
+    response.pdl = pdl;
+    if (pdl > 0) {
+        memcpy(response.pd, pd, pdl);
+    }
+    _tx_length = dmxRdmWrite(response, _tx);
+    _tx_break = true;
+    return _tx_length > 0;
+}
+
+bool DMXRdmResponder::nack(const DMXRdmPacket& request, uint16_t reason) {
+    const uint8_t pd[2] = {(uint8_t)(reason >> 8), (uint8_t)reason};
+    return respond(request, DMX_RDM_NACK_REASON, pd, sizeof(pd));
+}
+
+bool DMXRdmResponder::respondLabel(const DMXRdmPacket& request, const char* label) {
+    return respond(request, DMX_RDM_ACK, (const uint8_t*)label, (uint8_t)strlen(label));
+}
+
+void DMXRdmResponder::changed(uint16_t pid) {
+    if (_change_callback != nullptr) {
+        _change_callback(this, pid, _change_user_data);
+    }
+}
+
+void DMXRdmResponder::transmit() {
+    setDriver(true);
+    // As DmxOutput::write(), entering at the byte loop when there is no break
+    pio_sm_set_enabled(_pio, _tx_sm, false);
+    pio_sm_restart(_pio, _tx_sm);
+    pio_sm_exec(_pio, _tx_sm, pio_encode_jmp(_tx_break ? _tx_offset : _tx_offset + DmxOutput_wrap_target));
+    _pio->fdebug = 1u << (PIO_FDEBUG_TXSTALL_LSB + _tx_sm);
+    pio_sm_set_enabled(_pio, _tx_sm, true);
+    dma_channel_transfer_from_buffer_now(_tx_dma, _tx, _tx_length);
+}
+
+bool DMXRdmResponder::txBusy() const {
+    if (dma_channel_is_busy(_tx_dma) || !pio_sm_is_tx_fifo_empty(_pio, _tx_sm)) {
+        return true;
+    }
+    return !(_pio->fdebug & (1u << (PIO_FDEBUG_TXSTALL_LSB + _tx_sm)));
+}
+
+void DMXRdmResponder::setDriver(bool transmit) {
+    if (_enable_pin != DMX_RDM_NO_ENABLE_PIN) {
+        gpio_put(_enable_pin, transmit);
+    }
+}
@@ -1,10 +1,15 @@
 #include "dmx_receiver.h"
+#include "dmx_load.h"
+#include "dmx_frame_crc.h"
+#include "hardware/sync.h"
 #include <cstring>
 
 DMXReceiver::DMXReceiver(uint gpio_pin, uint16_t start_channel, uint16_t num_channels, PIO pio_instance)
     : _gpio_pin(gpio_pin), _pio_instance(pio_instance), _is_initialized(false), _is_async_active(false),
       _start_channel(start_channel), _num_channels(num_channels), _buffer(nullptr), _callback(nullptr),
-      _internal_buffer(nullptr) {
+      _internal_buffer(nullptr), _frame_count(0), _alternate_count(0), _change_detection(false),
+      _skip_unchanged(false), _crc_valid(false), _frame_crc(0), _frame_changed(false), _changed_count(0),
+      _identical_count(0) {
 }
 
 DMXReceiver::~DMXReceiver() {
@@ -56,13 +61,24 @@ bool DMXReceiver::read(uint8_t* buffer) {
     return temp_buffer[0] == 0x00; // Return true if valid DMX start code
 }
 
-// Global pointer to current receiver instance for callback
-static DMXReceiver* current_receiver_instance = nullptr;
+// DmxInput callbacks only identify the input, so map it back to its receiver
+// (one entry per DMA channel, the most inputs that can run at once)
+#define MAX_ASYNC_RECEIVERS 12
+
+struct AsyncReceiver {
+    DmxInput* input;
+    DMXReceiver* receiver;
+};
+
+static AsyncReceiver async_receivers[MAX_ASYNC_RECEIVERS] = {};
 
 // Static callback function for DmxInput
 static void dmx_data_received_callback(DmxInput* instance) {
-    if (current_receiver_instance) {
-        current_receiver_instance->handleDataReceived();
+    for (uint8_t i = 0; i < MAX_ASYNC_RECEIVERS; i++) {
+        if (async_receivers[i].input == instance) {
+            async_receivers[i].receiver->handleDataReceived();
+            return;
+        }
     }
 }
 
@@ -71,11 +87,24 @@ bool DMXReceiver::startAsync(uint8_t* buffer, DMXDataCallback callback) {
         return false;
     }
     
+    // Register this instance for the callback
+    uint8_t slot = MAX_ASYNC_RECEIVERS;
+    for (uint8_t i = 0; i < MAX_ASYNC_RECEIVERS; i++) {
+        if (async_receivers[i].input == nullptr) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == MAX_ASYNC_RECEIVERS) {
+        return false;
+    }
+    async_receivers[slot].input = &_dmx_input;
+    async_receivers[slot].receiver = this;
+    
     _buffer = (volatile uint8_t*)buffer;
     _callback = callback;
-    
-    // Set this instance as the current receiver
-    current_receiver_instance = this;
+    _frame_count = 0;
+    _alternate_count = 0;
     
     // Start async reading using the Pico-DMX library
     _dmx_input.read_async(_internal_buffer, dmx_data_received_callback);
@@ -86,21 +115,59 @@ bool DMXReceiver::startAsync(uint8_t* buffer, DMXDataCallback callback) {
 
 void DMXReceiver::stopAsync() {
     if (_is_async_active) {
+        disableChangeDetection();
         _is_async_active = false;
         _buffer = nullptr;
         _callback = nullptr;
-        current_receiver_instance = nullptr;
+        for (uint8_t i = 0; i < MAX_ASYNC_RECEIVERS; i++) {
+            if (async_receivers[i].receiver == this) {
+                async_receivers[i].input = nullptr;
+                async_receivers[i].receiver = nullptr;
+            }
+        }
     }
 }
 
 void DMXReceiver::handleDataReceived() {
     if (_buffer && _internal_buffer) {
+        // Alternate start code packets must not overwrite the universe
+        if (_internal_buffer[0] != 0x00) {
+            _alternate_count = _alternate_count + 1;
+            _frame_count = _frame_count + 1;
+            return;
+        }
+        
+        if (_change_detection) {
+            uint32_t crc = _dmx_input._sniffed ? _dmx_input._frame_crc
+                                               : DMXFrameCrc::compute(_internal_buffer, _num_channels + 1);
+            bool changed = !_crc_valid || crc != _frame_crc;
+            _frame_crc = crc;
+            _crc_valid = true;
+            _frame_changed = changed;
+            if (changed) {
+                _changed_count = _changed_count + 1;
+            } else {
+                _identical_count = _identical_count + 1;
+                if (_skip_unchanged) {
+                    _frame_count = _frame_count + 1;
+                    return;
+                }
+            }
+        }
+        
         // Copy data from internal buffer to user buffer (excluding start code at index 0)
         memcpy((void*)_buffer, (const void*)&_internal_buffer[1], _num_channels);
         
+        // Count the frame only once it is in the user buffer: DMXSlotStream
+        // on the other core reads the buffer as soon as the count moves
+        __dmb();
+        _frame_count = _frame_count + 1;
+        
         // Call user callback if provided
         if (_callback) {
+            DMX_LOAD_ENTER(load_context, DMX_LOAD_CALLBACK);
             _callback(this);
+            DMX_LOAD_LEAVE(load_context);
         }
     }
 }
@@ -164,4 +231,80 @@ bool DMXReceiver::isAsyncActive() const {
 
 const volatile uint8_t* DMXReceiver::getBuffer() const {
     return _buffer;
+}
+
+const volatile uint8_t* DMXReceiver::getDmaBuffer() const {
+    return _internal_buffer;
+}
+
+uint16_t DMXReceiver::getBytesInProgress() const {
+    if (!_is_async_active) {
+        return 0;
+    }
+    
+    // The channel counts down from start code + slots; between completion and
+    // re-arm it reads 0, i.e. a whole frame
+    uint32_t remaining = dma_hw->ch[_dmx_input._dma_chan].transfer_count;
+    uint16_t total = _num_channels + 1;
+    return remaining >= total ? 0 : (uint16_t)(total - remaining);
+}
+
+uint32_t DMXReceiver::getFrameCount() const {
+    return _frame_count;
+}
+
+uint32_t DMXReceiver::getAlternateFrameCount() const {
+    return _alternate_count;
+}
+
+void DMXReceiver::restartFrame() {
+    if (!_is_async_active) {
+        return;
+    }
+    
+    _dmx_input.restart_frame();
+    _frame_count = _frame_count + 1;
+    _alternate_count = _alternate_count + 1;
+}
+
+bool DMXReceiver::enableChangeDetection(bool skip_unchanged) {
+    if (!_is_async_active) {
+        return false;
+    }
+    
+    // Settle the state before the interrupt starts using it
+    _change_detection = false;
+    _skip_unchanged = skip_unchanged;
+    _crc_valid = false;
+    _frame_changed = false;
+    _changed_count = 0;
+    _identical_count = 0;
+    _dmx_input.enable_frame_crc();
+    _change_detection = true;
+    return true;
+}
+
+void DMXReceiver::disableChangeDetection() {
+    _change_detection = false;
+    _dmx_input.disable_frame_crc();
+}
+
+bool DMXReceiver::isUsingSniffer() const {
+    return _change_detection && _dmx_input._sniffed;
+}
+
+uint32_t DMXReceiver::getFrameCrc() const {
+    return _frame_crc;
+}
+
+bool DMXReceiver::isFrameChanged() const {
+    return _frame_changed;
+}
+
+uint32_t DMXReceiver::getChangedFrameCount() const {
+    return _changed_count;
+}
+
+uint32_t DMXReceiver::getIdenticalFrameCount() const {
+    return _identical_count;
 }
\ No newline at end of file
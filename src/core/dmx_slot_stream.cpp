@@ -0,0 +1,132 @@
+#include "dmx_slot_stream.h"
+#include "hardware/sync.h"
+#include <cstring>
+
+DMXSlotStream::DMXSlotStream()
+    : _receiver(nullptr), _num_thresholds(0), _next(0), _frame_count(0), _frame_started(false),
+      _alternate_code(false) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool DMXSlotStream::begin(DMXReceiver* receiver) {
+    if (receiver == nullptr || !receiver->isAsyncActive()) {
+        return false;
+    }
+
+    _receiver = receiver;
+    _frame_count = receiver->getFrameCount();
+    _next = 0;
+    _frame_started = false;
+    _alternate_code = false;
+    resetStats();
+    return true;
+}
+
+bool DMXSlotStream::addThreshold(uint16_t slot, DMXSlotCallback callback, void* user_data) {
+    if (_receiver == nullptr || callback == nullptr || slot == 0 || slot > _receiver->getNumChannels() ||
+        _num_thresholds >= DMX_SLOT_STREAM_MAX_THRESHOLDS) {
+        return false;
+    }
+
+    // Keep the list sorted so poll() only ever looks at the next one
+    uint8_t i = _num_thresholds;
+    while (i > 0 && _thresholds[i - 1].slot > slot) {
+        _thresholds[i] = _thresholds[i - 1];
+        i--;
+    }
+    _thresholds[i].slot = slot;
+    _thresholds[i].callback = callback;
+    _thresholds[i].user_data = user_data;
+    _num_thresholds++;
+
+    // Not due until the next frame if this one is already past it
+    if (i < _next) {
+        _next++;
+    }
+    return true;
+}
+
+void DMXSlotStream::clearThresholds() {
+    _num_thresholds = 0;
+    _next = 0;
+}
+
+uint8_t DMXSlotStream::poll() {
+    if (_receiver == nullptr) {
+        return 0;
+    }
+
+    // The frame count and DMA position are separate reads; retry if the
+    // frame completed in between
+    uint32_t frames;
+    uint16_t bytes;
+    do {
+        frames = _receiver->getFrameCount();
+        bytes = _receiver->getBytesInProgress();
+    } while (frames != _receiver->getFrameCount());
+    // Pairs with the barrier before the count in DMXReceiver: a counted frame
+    // is whole in the user buffer when polled from the other core
+    __dmb();
+
+    uint8_t fired = 0;
+    if (frames != _frame_count) {
+        // The frame completed before the last poll saw its final slots; it is
+        // whole in the receiver's buffer, so fire what is left from there
+        if (_frame_started && !_alternate_code && frames == _frame_count + 1) {
+            fired = fireThresholds(_receiver->getBuffer(), _receiver->getNumChannels());
+            _stats.after_frame += fired;
+        } else if (!_alternate_code) {
+            _stats.missed += _num_thresholds - _next;
+        }
+        _frame_count = frames;
+        _next = 0;
+        _frame_started = false;
+        _alternate_code = false;
+    }
+
+    // Waiting for the break and start code
+    if (bytes == 0) {
+        return fired;
+    }
+
+    const volatile uint8_t* frame = _receiver->getDmaBuffer();
+    if (!_frame_started) {
+        _frame_started = true;
+        _stats.frames++;
+        _alternate_code = frame[0] != 0x00;
+        if (_alternate_code) {
+            _stats.alternate_codes++;
+        }
+    }
+    if (_alternate_code) {
+        return fired;
+    }
+    return fired + fireThresholds(&frame[1], bytes - 1);
+}
+
+uint8_t DMXSlotStream::fireThresholds(const volatile uint8_t* slots, uint16_t num_slots) {
+    uint8_t fired = 0;
+    while (_next < _num_thresholds && _thresholds[_next].slot <= num_slots) {
+        const Threshold& threshold = _thresholds[_next++];
+        threshold.callback(slots, threshold.slot, threshold.user_data);
+        fired++;
+    }
+    _stats.fired += fired;
+    return fired;
+}
+
+uint16_t DMXSlotStream::getSlotsReceived() const {
+    if (_receiver == nullptr) {
+        return 0;
+    }
+    uint16_t bytes = _receiver->getBytesInProgress();
+    return bytes > 0 ? bytes - 1 : 0;
+}
+
+DMXSlotStream::Stats DMXSlotStream::getStats() const {
+    return _stats;
+}
+
+void DMXSlotStream::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
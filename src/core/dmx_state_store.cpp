@@ -0,0 +1,203 @@
+#include "dmx_state_store.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "hardware/regs/addressmap.h"
+#include <cstring>
+
+static uint32_t readU32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static void writeU32(uint32_t value, uint8_t* out) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+// FNV-1a, as DMXLog::hash(), continued across several ranges
+static uint32_t fnv1a(uint32_t h, const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        h = (h ^ data[i]) * 16777619u;
+    }
+    return h;
+}
+
+static uint32_t snapshotChecksum(const uint8_t* header, const uint8_t* const universes[], uint8_t num_universes) {
+    uint32_t h = fnv1a(2166136261u, &header[4], 8);
+    for (uint8_t u = 0; u < num_universes; u++) {
+        h = fnv1a(h, universes[u], DMX_UNIVERSE_SIZE);
+    }
+    return h;
+}
+
+DMXStateStore::DMXStateStore()
+    : _flash_offset(0), _slot_size(0), _num_slots(0), _num_universes(0), _current_slot(-1), _sequence(0) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+bool DMXStateStore::begin(uint8_t num_universes, uint32_t flash_offset, size_t flash_size) {
+    if (num_universes == 0 || num_universes > DMX_STATE_MAX_UNIVERSES || flash_offset % FLASH_SECTOR_SIZE != 0) {
+        return false;
+    }
+    uint32_t record_size = DMX_STATE_HEADER_SIZE + (uint32_t)num_universes * DMX_UNIVERSE_SIZE;
+    uint32_t slot_size = (record_size + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE * FLASH_SECTOR_SIZE;
+    if (flash_size < 2 * slot_size) {
+        return false;
+    }
+
+    _flash_offset = flash_offset;
+    _slot_size = slot_size;
+    _num_slots = (uint16_t)(flash_size / slot_size);
+    _num_universes = num_universes;
+    _current_slot = -1;
+    _sequence = 0;
+    memset(&_stats, 0, sizeof(_stats));
+
+    // Newest valid snapshot; sequence numbers compare across the wrap
+    for (uint16_t slot = 0; slot < _num_slots; slot++) {
+        uint32_t sequence;
+        if (slotValid(slot, &sequence) && (_current_slot < 0 || (int32_t)(sequence - _sequence) > 0)) {
+            _current_slot = slot;
+            _sequence = sequence;
+        }
+    }
+    return true;
+}
+
+bool DMXStateStore::hasState() const {
+    return _current_slot >= 0;
+}
+
+uint32_t DMXStateStore::getSequence() const {
+    return _sequence;
+}
+
+const uint8_t* DMXStateStore::getUniverse(uint8_t universe) const {
+    if (_current_slot < 0 || universe >= _num_universes) {
+        return nullptr;
+    }
+    return slotAddress((uint16_t)_current_slot) + DMX_STATE_HEADER_SIZE + universe * DMX_UNIVERSE_SIZE;
+}
+
+bool DMXStateStore::restore(DMXTransmitter outputs[], uint8_t num_outputs) const {
+    if (_current_slot < 0 || outputs == nullptr) {
+        return false;
+    }
+    for (uint8_t u = 0; u < num_outputs && u < _num_universes; u++) {
+        outputs[u].setUniverse(getUniverse(u), DMX_UNIVERSE_SIZE);
+    }
+    return true;
+}
+
+bool DMXStateStore::commit(DMXTransmitter outputs[], uint8_t num_outputs) {
+    if (outputs == nullptr || num_outputs != _num_universes) {
+        return false;
+    }
+    const uint8_t* universes[DMX_STATE_MAX_UNIVERSES];
+    for (uint8_t u = 0; u < num_outputs; u++) {
+        universes[u] = outputs[u].getUniverseBuffer();
+    }
+    return commit(universes, num_outputs);
+}
+
+bool DMXStateStore::commit(const uint8_t* const universes[], uint8_t num_universes) {
+    if (_num_slots == 0 || universes == nullptr || num_universes != _num_universes) {
+        return false;
+    }
+    if (matches(universes)) {
+        _stats.unchanged++;
+        return true;
+    }
+
+    uint16_t slot = _current_slot < 0 ? 0 : (uint16_t)((_current_slot + 1) % _num_slots);
+    uint32_t sequence = _current_slot < 0 ? 1 : _sequence + 1;
+    uint8_t header[DMX_STATE_HEADER_SIZE];
+    writeU32(DMX_STATE_MAGIC, &header[0]);
+    writeU32(sequence, &header[4]);
+    header[8] = num_universes;
+    header[9] = header[10] = header[11] = 0xFF;
+    writeU32(snapshotChecksum(header, universes, num_universes), &header[12]);
+
+    // The record as one byte stream: header, then the universes back to back
+    uint32_t record_size = DMX_STATE_HEADER_SIZE + (uint32_t)num_universes * DMX_UNIVERSE_SIZE;
+    uint32_t num_pages = (record_size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    uint32_t slot_offset = _flash_offset + slot * _slot_size;
+    uint8_t page[FLASH_PAGE_SIZE];
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    flash_range_erase(slot_offset, _slot_size);
+    restore_interrupts(irq_state);
+
+    // Data pages first, the page with the header last
+    for (uint32_t i = 1; i <= num_pages; i++) {
+        uint32_t p = i % num_pages;
+        uint32_t start = p * FLASH_PAGE_SIZE;
+        memset(page, 0xFF, sizeof(page));
+        for (uint32_t b = 0; b < FLASH_PAGE_SIZE && start + b < record_size; b++) {
+            uint32_t pos = start + b;
+            if (pos < DMX_STATE_HEADER_SIZE) {
+                page[b] = header[pos];
+            } else {
+                pos -= DMX_STATE_HEADER_SIZE;
+                page[b] = universes[pos / DMX_UNIVERSE_SIZE][pos % DMX_UNIVERSE_SIZE];
+            }
+        }
+        irq_state = save_and_disable_interrupts();
+        flash_range_program(slot_offset + start, page, FLASH_PAGE_SIZE);
+        restore_interrupts(irq_state);
+    }
+
+    uint32_t stored;
+    if (!slotValid(slot, &stored) || stored != sequence) {
+        return false;
+    }
+    _current_slot = slot;
+    _sequence = sequence;
+    _stats.commits++;
+    return true;
+}
+
+DMXStateStore::Stats DMXStateStore::getStats() const {
+    return _stats;
+}
+
+const uint8_t* DMXStateStore::slotAddress(uint16_t slot) const {
+    return (const uint8_t*)(XIP_BASE + _flash_offset + slot * _slot_size);
+}
+
+bool DMXStateStore::slotValid(uint16_t slot, uint32_t* sequence) const {
+    const uint8_t* record = slotAddress(slot);
+    if (readU32(&record[0]) != DMX_STATE_MAGIC) {
+        return false;
+    }
+    const uint8_t* universes[DMX_STATE_MAX_UNIVERSES];
+    bool valid = record[8] == _num_universes;
+    if (valid) {
+        for (uint8_t u = 0; u < _num_universes; u++) {
+            universes[u] = &record[DMX_STATE_HEADER_SIZE + u * DMX_UNIVERSE_SIZE];
+        }
+        valid = snapshotChecksum(record, universes, _num_universes) == readU32(&record[12]);
+    }
+    if (!valid) {
+        // A snapshot of another universe count is not ours, but not corrupt either
+        if (record[8] == _num_universes) {
+            const_cast<DMXStateStore*>(this)->_stats.invalid_slots++;
+        }
+        return false;
+    }
+    *sequence = readU32(&record[4]);
+    return true;
+}
+
+bool DMXStateStore::matches(const uint8_t* const universes[]) const {
+    if (_current_slot < 0) {
+        return false;
+    }
+    for (uint8_t u = 0; u < _num_universes; u++) {
+        if (memcmp(getUniverse(u), universes[u], DMX_UNIVERSE_SIZE) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
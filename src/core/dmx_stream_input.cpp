@@ -0,0 +1,80 @@
+#include "dmx_stream_input.h"
+#include <stdio.h>
+
+#if LIB_PICO_STDIO_USB
+#include "tusb.h"
+#endif
+
+// Bytes pulled from USB per read
+#define DMX_STREAM_READ_CHUNK 64
+
+DMXStreamInput::DMXStreamInput() : _outputs(nullptr), _num_outputs(0), _frame_ready(false) {
+}
+
+bool DMXStreamInput::begin(DMXTransmitter outputs[], uint8_t num_outputs) {
+    if (outputs == nullptr || num_outputs == 0 || num_outputs > DMX_STREAM_MAX_UNIVERSES) {
+        return false;
+    }
+
+    _outputs = outputs;
+    _num_outputs = num_outputs;
+    _frame_ready = false;
+    _decoder.begin(resolveUniverse, onSync, this);
+    return true;
+}
+
+uint8_t* DMXStreamInput::resolveUniverse(uint8_t universe, void* context) {
+    DMXStreamInput* self = static_cast<DMXStreamInput*>(context);
+    if (universe >= self->_num_outputs) {
+        return nullptr;
+    }
+    // Looked up per packet: the back buffer changes after every transmit
+    return self->_outputs[universe].getUniverseBuffer();
+}
+
+void DMXStreamInput::onSync(uint8_t, void* context) {
+    static_cast<DMXStreamInput*>(context)->_frame_ready = true;
+}
+
+bool DMXStreamInput::poll() {
+    if (_outputs == nullptr) {
+        return false;
+    }
+
+    uint8_t chunk[DMX_STREAM_READ_CHUNK];
+#if LIB_PICO_STDIO_USB
+    // Bulk reads straight from the CDC FIFO
+    while (tud_cdc_available()) {
+        uint32_t count = tud_cdc_read(chunk, sizeof(chunk));
+        if (count == 0) {
+            break;
+        }
+        _decoder.feed(chunk, count);
+    }
+#else
+    size_t count = 0;
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        chunk[count++] = (uint8_t)c;
+        if (count == sizeof(chunk)) {
+            _decoder.feed(chunk, count);
+            count = 0;
+        }
+    }
+    if (count > 0) {
+        _decoder.feed(chunk, count);
+    }
+#endif
+
+    bool ready = _frame_ready;
+    _frame_ready = false;
+    return ready;
+}
+
+DMXStreamDecoder::Stats DMXStreamInput::getStats() const {
+    return _decoder.getStats();
+}
+
+void DMXStreamInput::resetStats() {
+    _decoder.resetStats();
+}
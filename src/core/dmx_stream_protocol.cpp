@@ -0,0 +1,347 @@
+#include "dmx_stream_protocol.h"
+#include <string.h>
+
+// Largest gap of unchanged slots a DELTA run absorbs rather than starting a new run
+#define DMX_STREAM_DELTA_MERGE_GAP 3
+
+uint16_t dmxStreamFletcher16(const uint8_t* data, size_t length) {
+    uint32_t sum1 = 0xFF, sum2 = 0xFF;
+    while (length) {
+        // Defer the modulo: 20 bytes cannot overflow the 32-bit sums
+        size_t block = length > 20 ? 20 : length;
+        length -= block;
+        while (block--) {
+            sum1 += *data++;
+            sum2 += sum1;
+        }
+        sum1 = (sum1 & 0xFF) + (sum1 >> 8);
+        sum2 = (sum2 & 0xFF) + (sum2 >> 8);
+    }
+    sum1 = (sum1 & 0xFF) + (sum1 >> 8);
+    sum2 = (sum2 & 0xFF) + (sum2 >> 8);
+    return (uint16_t)((sum2 << 8) | sum1);
+}
+
+void dmxStreamWriteStats(const DMXStreamUniverseStats& stats, uint8_t* out) {
+    out[0] = (uint8_t)stats.frames_received;
+    out[1] = (uint8_t)(stats.frames_received >> 8);
+    out[2] = (uint8_t)(stats.frames_received >> 16);
+    out[3] = (uint8_t)(stats.frames_received >> 24);
+    out[4] = (uint8_t)stats.last_frame_ms;
+    out[5] = (uint8_t)(stats.last_frame_ms >> 8);
+    out[6] = (uint8_t)(stats.last_frame_ms >> 16);
+    out[7] = (uint8_t)(stats.last_frame_ms >> 24);
+    out[8] = (uint8_t)stats.active_channels;
+    out[9] = (uint8_t)(stats.active_channels >> 8);
+    out[10] = stats.max_value;
+    out[11] = (uint8_t)stats.max_value_channel;
+    out[12] = (uint8_t)(stats.max_value_channel >> 8);
+    out[13] = stats.signal_present;
+}
+
+void dmxStreamReadStats(const uint8_t* in, DMXStreamUniverseStats* stats) {
+    stats->frames_received = (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+    stats->last_frame_ms = (uint32_t)in[4] | ((uint32_t)in[5] << 8) | ((uint32_t)in[6] << 16) | ((uint32_t)in[7] << 24);
+    stats->active_channels = (uint16_t)(in[8] | (in[9] << 8));
+    stats->max_value = in[10];
+    stats->max_value_channel = (uint16_t)(in[11] | (in[12] << 8));
+    stats->signal_present = in[13];
+}
+
+DMXStreamDecoder::DMXStreamDecoder()
+    : _resolver(nullptr), _on_sync(nullptr), _on_record(nullptr), _context(nullptr), _state(WAIT_SYNC0),
+      _received(0), _expected(0), _have_seq(false), _last_seq(0) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void DMXStreamDecoder::begin(DMXStreamUniverseResolver resolver, DMXStreamSyncCallback on_sync, void* context) {
+    _resolver = resolver;
+    _on_sync = on_sync;
+    _context = context;
+    _state = WAIT_SYNC0;
+    _have_seq = false;
+    resetStats();
+}
+
+void DMXStreamDecoder::setRecordCallback(DMXStreamRecordCallback on_record) {
+    _on_record = on_record;
+}
+
+void DMXStreamDecoder::feed(const uint8_t* data, size_t length) {
+    _stats.bytes_in += length;
+
+    while (length > 0) {
+        switch (_state) {
+            case WAIT_SYNC0:
+                if (*data == DMX_STREAM_SYNC0) {
+                    _state = WAIT_SYNC1;
+                }
+                data++;
+                length--;
+                break;
+
+            case WAIT_SYNC1:
+                if (*data == DMX_STREAM_SYNC1) {
+                    _packet[0] = DMX_STREAM_SYNC0;
+                    _packet[1] = DMX_STREAM_SYNC1;
+                    _received = 2;
+                    _state = READ_HEADER;
+                } else if (*data != DMX_STREAM_SYNC0) {
+                    _state = WAIT_SYNC0;
+                }
+                data++;
+                length--;
+                break;
+
+            case READ_HEADER:
+                _packet[_received++] = *data++;
+                length--;
+                if (_received == DMX_STREAM_HEADER_SIZE) {
+                    uint16_t payload = (uint16_t)(_packet[6] | (_packet[7] << 8));
+                    if (payload > DMX_STREAM_MAX_PAYLOAD) {
+                        _stats.format_errors++;
+                        _state = WAIT_SYNC0;
+                    } else {
+                        _expected = DMX_STREAM_HEADER_SIZE + payload + DMX_STREAM_CHECK_SIZE;
+                        _state = READ_BODY;
+                    }
+                }
+                break;
+
+            case READ_BODY: {
+                // Bulk copy whatever part of the body is available
+                size_t take = _expected - _received;
+                if (take > length) {
+                    take = length;
+                }
+                memcpy(&_packet[_received], data, take);
+                _received += take;
+                data += take;
+                length -= take;
+                if (_received == _expected) {
+                    handlePacket();
+                    _state = WAIT_SYNC0;
+                }
+                break;
+            }
+        }
+    }
+}
+
+void DMXStreamDecoder::handlePacket() {
+    uint16_t payload_length = (uint16_t)(_packet[6] | (_packet[7] << 8));
+    const uint8_t* check = &_packet[DMX_STREAM_HEADER_SIZE + payload_length];
+    uint16_t expected = (uint16_t)(check[0] | (check[1] << 8));
+    if (dmxStreamFletcher16(&_packet[2], DMX_STREAM_HEADER_SIZE - 2 + payload_length) != expected) {
+        _stats.checksum_errors++;
+        return;
+    }
+
+    uint8_t type = _packet[2];
+    uint8_t flags = _packet[3];
+    uint8_t universe = _packet[4];
+    uint8_t seq = _packet[5];
+
+    if (_have_seq && seq != (uint8_t)(_last_seq + 1)) {
+        _stats.seq_gaps++;
+    }
+    _last_seq = seq;
+    _have_seq = true;
+
+    const uint8_t* payload = &_packet[DMX_STREAM_HEADER_SIZE];
+    if (type == DMX_STREAM_STATS || type == DMX_STREAM_COUNTERS || type == DMX_STREAM_LOG ||
+        type == DMX_STREAM_CAPTURE || type == DMX_STREAM_PROFILE) {
+        bool valid;
+        if (type == DMX_STREAM_STATS) {
+            valid = payload_length == DMX_STREAM_STATS_SIZE;
+        } else if (type == DMX_STREAM_COUNTERS) {
+            valid = payload_length % DMX_STREAM_COUNTER_SIZE == 0;
+        } else if (type == DMX_STREAM_LOG) {
+            valid = payload_length >= DMX_STREAM_LOG_HEADER_SIZE &&
+                    payload_length == DMX_STREAM_LOG_HEADER_SIZE + payload[8] * 4;
+        } else if (type == DMX_STREAM_PROFILE) {
+            valid = payload_length == DMX_STREAM_PROFILE_SIZE;
+        } else {
+            valid = payload_length >= DMX_STREAM_CAPTURE_HEADER_SIZE &&
+                    payload_length == DMX_STREAM_CAPTURE_HEADER_SIZE + (payload[6] | (payload[7] << 8));
+        }
+        if (!valid) {
+            _stats.format_errors++;
+            return;
+        }
+        if (_on_record) {
+            _on_record(type, universe, payload, payload_length, _context);
+        }
+    } else {
+        uint8_t* buffer = (_resolver && universe < DMX_STREAM_MAX_UNIVERSES) ? _resolver(universe, _context) : nullptr;
+        if (buffer && payload_length > 0 && !applyPayload(type, payload, payload_length, buffer)) {
+            _stats.format_errors++;
+            return;
+        }
+    }
+    _stats.packets_ok++;
+
+    if (flags & DMX_STREAM_FLAG_SYNC) {
+        _stats.syncs++;
+        if (_on_sync) {
+            _on_sync(seq, _context);
+        }
+    }
+}
+
+bool DMXStreamDecoder::applyPayload(uint8_t type, const uint8_t* payload, uint16_t length, uint8_t* universe) {
+    switch (type) {
+        case DMX_STREAM_FULL: {
+            if (length < 2) return false;
+            uint16_t start = (uint16_t)(payload[0] | (payload[1] << 8));
+            uint16_t count = length - 2;
+            if (start + count > DMX_UNIVERSE_SIZE) return false;
+            memcpy(&universe[start], &payload[2], count);
+            return true;
+        }
+
+        case DMX_STREAM_DELTA: {
+            // Validate every run before writing anything
+            uint16_t pos = 0;
+            while (pos < length) {
+                if (length - pos < 3) return false;
+                uint16_t start = (uint16_t)(payload[pos] | (payload[pos + 1] << 8));
+                uint16_t count = payload[pos + 2] ? payload[pos + 2] : 256;
+                if (start + count > DMX_UNIVERSE_SIZE || pos + 3 + count > length) return false;
+                pos += 3 + count;
+            }
+            pos = 0;
+            while (pos < length) {
+                uint16_t start = (uint16_t)(payload[pos] | (payload[pos + 1] << 8));
+                uint16_t count = payload[pos + 2] ? payload[pos + 2] : 256;
+                memcpy(&universe[start], &payload[pos + 3], count);
+                pos += 3 + count;
+            }
+            return true;
+        }
+
+        case DMX_STREAM_RLE: {
+            if (length & 1) return false;
+            uint16_t total = 0;
+            for (uint16_t pos = 0; pos < length; pos += 2) {
+                total += payload[pos] ? payload[pos] : 256;
+            }
+            if (total > DMX_UNIVERSE_SIZE) return false;
+            uint16_t slot = 0;
+            for (uint16_t pos = 0; pos < length; pos += 2) {
+                uint16_t count = payload[pos] ? payload[pos] : 256;
+                memset(&universe[slot], payload[pos + 1], count);
+                slot += count;
+            }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+DMXStreamDecoder::Stats DMXStreamDecoder::getStats() const {
+    return _stats;
+}
+
+void DMXStreamDecoder::resetStats() {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+DMXStreamEncoder::DMXStreamEncoder() : _seq(0) {
+}
+
+size_t DMXStreamEncoder::buildPacket(uint8_t type, uint8_t flags, uint8_t universe,
+                                     const uint8_t* payload, uint16_t length, uint8_t* out) {
+    out[0] = DMX_STREAM_SYNC0;
+    out[1] = DMX_STREAM_SYNC1;
+    out[2] = type;
+    out[3] = flags;
+    out[4] = universe;
+    out[5] = _seq++;
+    out[6] = (uint8_t)length;
+    out[7] = (uint8_t)(length >> 8);
+    if (length > 0) {
+        memcpy(&out[DMX_STREAM_HEADER_SIZE], payload, length);
+    }
+    uint16_t check = dmxStreamFletcher16(&out[2], DMX_STREAM_HEADER_SIZE - 2 + length);
+    out[DMX_STREAM_HEADER_SIZE + length] = (uint8_t)check;
+    out[DMX_STREAM_HEADER_SIZE + length + 1] = (uint8_t)(check >> 8);
+    return DMX_STREAM_HEADER_SIZE + length + DMX_STREAM_CHECK_SIZE;
+}
+
+size_t DMXStreamEncoder::encodeUniverse(uint8_t universe, const uint8_t* prev, const uint8_t* next,
+                                        bool sync, uint8_t* out) {
+    uint8_t flags = sync ? DMX_STREAM_FLAG_SYNC : 0;
+
+    // Changed span
+    int first = -1, last = -1;
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+        if (prev == nullptr || prev[i] != next[i]) {
+            if (first < 0) first = i;
+            last = i;
+        }
+    }
+    if (first < 0) {
+        return sync ? buildPacket(DMX_STREAM_DELTA, flags, universe, nullptr, 0, out) : 0;
+    }
+
+    uint8_t full[DMX_STREAM_MAX_PAYLOAD];
+    uint8_t delta[DMX_STREAM_MAX_PAYLOAD];
+    uint8_t rle[DMX_STREAM_MAX_PAYLOAD];
+
+    // FULL: the changed span as one block
+    uint16_t full_length = (uint16_t)(2 + last - first + 1);
+    full[0] = (uint8_t)first;
+    full[1] = (uint8_t)(first >> 8);
+    memcpy(&full[2], &next[first], last - first + 1);
+
+    // DELTA: changed runs, merging across short unchanged gaps
+    uint16_t delta_length = 0;
+    int i = first;
+    while (i <= last && delta_length + 3 + 256 <= DMX_STREAM_MAX_PAYLOAD) {
+        if (prev != nullptr && prev[i] == next[i]) {
+            i++;
+            continue;
+        }
+        int start = i, end = i, gap = 0;
+        while (i <= last && end - start + 1 < 256) {
+            if (prev == nullptr || prev[i] != next[i]) {
+                end = i;
+                gap = 0;
+            } else if (++gap > DMX_STREAM_DELTA_MERGE_GAP) {
+                break;
+            }
+            i++;
+        }
+        i = end + 1;
+        uint16_t count = (uint16_t)(end - start + 1);
+        delta[delta_length++] = (uint8_t)start;
+        delta[delta_length++] = (uint8_t)(start >> 8);
+        delta[delta_length++] = (uint8_t)count; // 256 wraps to 0
+        memcpy(&delta[delta_length], &next[start], count);
+        delta_length += count;
+    }
+    bool delta_complete = i > last;
+
+    // RLE: from slot 0 up to the last changed slot
+    uint16_t rle_length = 0;
+    for (int slot = 0; slot <= last;) {
+        int count = 1;
+        while (slot + count <= last && count < 256 && next[slot + count] == next[slot]) {
+            count++;
+        }
+        rle[rle_length++] = (uint8_t)count; // 256 wraps to 0
+        rle[rle_length++] = next[slot];
+        slot += count;
+    }
+
+    if (rle_length < full_length && (!delta_complete || rle_length <= delta_length)) {
+        return buildPacket(DMX_STREAM_RLE, flags, universe, rle, rle_length, out);
+    }
+    if (delta_complete && delta_length < full_length) {
+        return buildPacket(DMX_STREAM_DELTA, flags, universe, delta, delta_length, out);
+    }
+    return buildPacket(DMX_STREAM_FULL, flags, universe, full, full_length, out);
+}
@@ -0,0 +1,179 @@
+#include "dmx_telemetry.h"
+#include <stdio.h>
+#include <cstring>
+
+#if LIB_PICO_STDIO_USB
+#include "tusb.h"
+#endif
+
+#define DMX_TELEMETRY_RING_MASK (DMX_TELEMETRY_RING_SIZE - 1)
+
+// Bytes written per poll() when falling back to stdio
+#define DMX_TELEMETRY_STDIO_CHUNK 64
+
+DMXTelemetry::DMXTelemetry()
+    : _head(0), _tail(0), _num_universes(0), _universe_interval_ms(0), _dropped(0), _bytes_sent(0) {
+    memset(_have_shadow, 0, sizeof(_have_shadow));
+    memset(_last_publish_ms, 0, sizeof(_last_publish_ms));
+    memset(_last_snapshot_ms, 0, sizeof(_last_snapshot_ms));
+    memset(_published_changes, 0, sizeof(_published_changes));
+    memset(_counters, 0, sizeof(_counters));
+}
+
+bool DMXTelemetry::begin(uint8_t num_universes, uint32_t universe_interval_ms) {
+    if (num_universes == 0 || num_universes > DMX_STREAM_MAX_UNIVERSES) {
+        return false;
+    }
+
+    _num_universes = num_universes;
+    _universe_interval_ms = universe_interval_ms;
+    _head = 0;
+    _tail = 0;
+    _dropped = 0;
+    _bytes_sent = 0;
+    memset(_have_shadow, 0, sizeof(_have_shadow));
+    return true;
+}
+
+uint16_t DMXTelemetry::ringFree() const {
+    return (uint16_t)(DMX_TELEMETRY_RING_SIZE - 1 - ((_head - _tail) & DMX_TELEMETRY_RING_MASK));
+}
+
+bool DMXTelemetry::queue(const uint8_t* data, size_t length) {
+    if (length > ringFree()) {
+        _dropped++;
+        return false;
+    }
+
+    // At most two contiguous copies around the wrap point
+    size_t first = DMX_TELEMETRY_RING_SIZE - _head;
+    if (first > length) {
+        first = length;
+    }
+    memcpy(&_ring[_head], data, first);
+    memcpy(&_ring[0], data + first, length - first);
+    _head = (uint16_t)((_head + length) & DMX_TELEMETRY_RING_MASK);
+    return true;
+}
+
+bool DMXTelemetry::publishUniverse(uint8_t universe, const uint8_t* data, uint32_t now_ms) {
+    return publish(universe, data, now_ms, false, 0);
+}
+
+bool DMXTelemetry::publishUniverse(uint8_t universe, const uint8_t* data, uint32_t now_ms, uint32_t change_count) {
+    return publish(universe, data, now_ms, true, change_count);
+}
+
+bool DMXTelemetry::publish(uint8_t universe, const uint8_t* data, uint32_t now_ms, bool use_changes,
+                           uint32_t change_count) {
+    if (universe >= _num_universes || data == nullptr) {
+        return false;
+    }
+    if (_have_shadow[universe] && now_ms - _last_publish_ms[universe] < _universe_interval_ms) {
+        return true;
+    }
+    _last_publish_ms[universe] = now_ms;
+
+    bool snapshot = !_have_shadow[universe] ||
+                    now_ms - _last_snapshot_ms[universe] >= DMX_TELEMETRY_SNAPSHOT_INTERVAL_MS;
+    if (use_changes && !snapshot && change_count == _published_changes[universe]) {
+        return true; // Only identical frames since the last update
+    }
+    size_t length = _encoder.encodeUniverse(universe, snapshot ? nullptr : _shadow[universe], data, false, _packet);
+    if (length == 0) {
+        _published_changes[universe] = change_count;
+        return true; // Nothing changed
+    }
+    if (!queue(_packet, length)) {
+        return false; // Shadow untouched, so the next diff still carries these changes
+    }
+
+    memcpy(_shadow[universe], data, DMX_UNIVERSE_SIZE);
+    _have_shadow[universe] = true;
+    _published_changes[universe] = change_count;
+    if (snapshot) {
+        _last_snapshot_ms[universe] = now_ms;
+    }
+    return true;
+}
+
+bool DMXTelemetry::publishStats(uint8_t universe, const DMXStreamUniverseStats& stats) {
+    uint8_t payload[DMX_STREAM_STATS_SIZE];
+    dmxStreamWriteStats(stats, payload);
+    size_t length = _encoder.buildPacket(DMX_STREAM_STATS, 0, universe, payload, sizeof(payload), _packet);
+    return queue(_packet, length);
+}
+
+void DMXTelemetry::setCounter(uint8_t id, uint32_t value) {
+    if (id < DMX_COUNTER_COUNT) {
+        _counters[id] = value;
+    }
+}
+
+bool DMXTelemetry::publishCounters() {
+    _counters[DMX_COUNTER_TELEMETRY_BYTES] = _bytes_sent;
+    _counters[DMX_COUNTER_TELEMETRY_DROPS] = _dropped;
+
+    uint8_t payload[DMX_COUNTER_COUNT * DMX_STREAM_COUNTER_SIZE];
+    for (uint8_t i = 0; i < DMX_COUNTER_COUNT; i++) {
+        uint8_t* record = &payload[i * DMX_STREAM_COUNTER_SIZE];
+        record[0] = i;
+        record[1] = (uint8_t)_counters[i];
+        record[2] = (uint8_t)(_counters[i] >> 8);
+        record[3] = (uint8_t)(_counters[i] >> 16);
+        record[4] = (uint8_t)(_counters[i] >> 24);
+    }
+    size_t length = _encoder.buildPacket(DMX_STREAM_COUNTERS, DMX_STREAM_FLAG_SYNC, 0,
+                                         payload, sizeof(payload), _packet);
+    return queue(_packet, length);
+}
+
+bool DMXTelemetry::publishRecord(uint8_t type, uint8_t universe, const uint8_t* payload, uint16_t length) {
+    if (length > DMX_STREAM_MAX_PAYLOAD) {
+        return false;
+    }
+    size_t packet_length = _encoder.buildPacket(type, 0, universe, payload, length, _packet);
+    return queue(_packet, packet_length);
+}
+
+uint16_t DMXTelemetry::getFreeSpace() const {
+    return ringFree();
+}
+
+void DMXTelemetry::poll() {
+#if LIB_PICO_STDIO_USB
+    while (_tail != _head) {
+        uint32_t space = tud_cdc_write_available();
+        if (space == 0) {
+            break;
+        }
+        // Contiguous run up to the head or the end of the ring
+        uint32_t run = _head > _tail ? _head - _tail : DMX_TELEMETRY_RING_SIZE - _tail;
+        if (run > space) {
+            run = space;
+        }
+        run = tud_cdc_write(&_ring[_tail], run);
+        if (run == 0) {
+            break;
+        }
+        _tail = (uint16_t)((_tail + run) & DMX_TELEMETRY_RING_MASK);
+        _bytes_sent += run;
+    }
+    tud_cdc_write_flush();
+#else
+    // stdio output may block, so only send a bounded chunk per call
+    for (uint16_t i = 0; i < DMX_TELEMETRY_STDIO_CHUNK && _tail != _head; i++) {
+        putchar_raw(_ring[_tail]);
+        _tail = (uint16_t)((_tail + 1) & DMX_TELEMETRY_RING_MASK);
+        _bytes_sent++;
+    }
+#endif
+}
+
+uint32_t DMXTelemetry::getDroppedPackets() const {
+    return _dropped;
+}
+
+uint32_t DMXTelemetry::getBytesSent() const {
+    return _bytes_sent;
+}
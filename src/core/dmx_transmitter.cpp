@@ -2,9 +2,10 @@
 #include <cstring>
 
 DMXTransmitter::DMXTransmitter(uint gpio_pin, PIO pio_instance) 
-    : _gpio_pin(gpio_pin), _pio_instance(pio_instance), _is_initialized(false) {
+    : _gpio_pin(gpio_pin), _pio_instance(pio_instance), _is_initialized(false), _back(0) {
     memset(_universe_data, 0, sizeof(_universe_data));
-    _universe_data[0] = 0x00; // DMX start code
+    _universe_data[0][0] = 0x00; // DMX start code
+    _universe_data[1][0] = 0x00;
 }
 
 DMXTransmitter::~DMXTransmitter() {
@@ -32,12 +33,25 @@ void DMXTransmitter::end() {
     }
 }
 
+DmxOutput::return_code DMXTransmitter::remap(uint gpio_pin) {
+    if (!_is_initialized) {
+        _gpio_pin = gpio_pin;
+        return DmxOutput::SUCCESS;
+    }
+    
+    // end() cuts a frame off, so let the receivers on the old pin see it whole
+    waitForCompletion();
+    end();
+    _gpio_pin = gpio_pin;
+    return begin();
+}
+
 bool DMXTransmitter::setChannel(uint16_t channel, uint8_t value) {
     if (channel < 1 || channel > DMX_UNIVERSE_SIZE) {
         return false;
     }
     
-    _universe_data[channel] = value;
+    _universe_data[_back][channel] = value;
     return true;
 }
 
@@ -46,7 +60,7 @@ uint8_t DMXTransmitter::getChannel(uint16_t channel) const {
         return 0;
     }
     
-    return _universe_data[channel];
+    return _universe_data[_back][channel];
 }
 
 bool DMXTransmitter::setChannelRange(uint16_t start_channel, const uint8_t* data, uint16_t length) {
@@ -55,22 +69,26 @@ bool DMXTransmitter::setChannelRange(uint16_t start_channel, const uint8_t* data
         return false;
     }
     
-    memcpy(&_universe_data[start_channel], data, length);
+    memcpy(&_universe_data[_back][start_channel], data, length);
     return true;
 }
 
 void DMXTransmitter::setUniverse(const uint8_t* data, uint16_t length) {
     uint16_t copy_length = (length > DMX_UNIVERSE_SIZE) ? DMX_UNIVERSE_SIZE : length;
-    memcpy(&_universe_data[1], data, copy_length);
+    memcpy(&_universe_data[_back][1], data, copy_length);
     
     // Clear remaining channels if length < DMX_UNIVERSE_SIZE
     if (copy_length < DMX_UNIVERSE_SIZE) {
-        memset(&_universe_data[copy_length + 1], 0, DMX_UNIVERSE_SIZE - copy_length);
+        memset(&_universe_data[_back][copy_length + 1], 0, DMX_UNIVERSE_SIZE - copy_length);
     }
 }
 
 void DMXTransmitter::clearUniverse() {
-    memset(&_universe_data[1], 0, DMX_UNIVERSE_SIZE);
+    memset(&_universe_data[_back][1], 0, DMX_UNIVERSE_SIZE);
+}
+
+uint8_t* DMXTransmitter::getUniverseBuffer() {
+    return &_universe_data[_back][1];
 }
 
 bool DMXTransmitter::transmit(uint16_t length) {
@@ -84,7 +102,55 @@ bool DMXTransmitter::transmit(uint16_t length) {
         transmit_length = DMX_UNIVERSE_SIZE + 1;
     }
     
-    _dmx_output.write(_universe_data, transmit_length);
+    // Present the back buffer: it becomes the frame on the wire, and the other
+    // buffer takes over as back buffer seeded with the same contents, so writes
+    // for the next frame never tear the one being transmitted
+    uint8_t front = _back;
+    _back ^= 1;
+    _dmx_output.write(_universe_data[front], transmit_length);
+    memcpy(_universe_data[_back], _universe_data[front], DMX_UNIVERSE_SIZE + 1);
+    return true;
+}
+
+bool DMXTransmitter::transmitUniverse(const uint8_t* data) {
+    memcpy(&_universe_data[_back][1], data, DMX_UNIVERSE_SIZE);
+    if (!_is_initialized) {
+        return false;
+    }
+    
+    uint8_t front = _back;
+    _back ^= 1;
+    _dmx_output.write(_universe_data[front], DMX_UNIVERSE_SIZE + 1);
+    return true;
+}
+
+bool DMXTransmitter::retransmit(uint16_t length) {
+    if (!_is_initialized) {
+        return false;
+    }
+    
+    uint16_t transmit_length = (length == 0) ? DMX_UNIVERSE_SIZE + 1 : length + 1;
+    if (transmit_length > DMX_UNIVERSE_SIZE + 1) {
+        transmit_length = DMX_UNIVERSE_SIZE + 1;
+    }
+    
+    // The front buffer is the other one; DMA only reads it
+    _dmx_output.write(_universe_data[_back ^ 1], transmit_length);
+    return true;
+}
+
+bool DMXTransmitter::transmitFrame(const uint8_t* frame, uint16_t length) {
+    if (!_is_initialized || frame == nullptr) {
+        return false;
+    }
+    
+    uint16_t transmit_length = (length == 0) ? DMX_UNIVERSE_SIZE + 1 : length + 1;
+    if (transmit_length > DMX_UNIVERSE_SIZE + 1) {
+        transmit_length = DMX_UNIVERSE_SIZE + 1;
+    }
+    
+    // DMA only reads the frame, so XIP flash addresses are fine here
+    _dmx_output.write(const_cast<uint8_t*>(frame), transmit_length);
     return true;
 }
 
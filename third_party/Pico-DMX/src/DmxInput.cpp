@@ -18,8 +18,32 @@
   #include "hardware/irq.h"
 #endif
 
-bool prgm_loaded[] = {false,false};
-volatile uint prgm_offsets[] = {0,0};
+// Hot-path profiling hooks (dmx_profile.h in the DMX system), compiled out by default
+#if defined(DMX_PROFILE) && DMX_PROFILE
+  #include "dmx_profile.h"
+#else
+  #define DMX_PROFILE_STAMP(var)
+  #define DMX_PROFILE_SINCE(metric, var)
+  #define DMX_PROFILE_RECORD(metric, us)
+  #define DMX_PROFILE_CHAIN_COMPLETION(cfg)
+#endif
+
+// CPU load accounting hooks (dmx_load.h in the DMX system)
+#if defined(DMX_LOAD) && DMX_LOAD
+  #include "dmx_load.h"
+#else
+  #define DMX_LOAD_ENTER(var, context)
+  #define DMX_LOAD_LEAVE(var)
+#endif
+
+/*
+One copy of each program (normal, inverted) per PIO, shared by every input
+using it. The reference count lets inputs come and go while the others keep
+running
+*/
+#define DMXINPUT_NUM_PIOS 2
+uint input_prgm_refs[DMXINPUT_NUM_PIOS][2] = {{0,0},{0,0}};
+uint input_prgm_offsets[DMXINPUT_NUM_PIOS][2] = {{0,0},{0,0}};
 /*
 This array tells the interrupt handler which instance has interrupted.
 The interrupt handler has only the ints0 register to go on, so this array needs as many spots as there are DMA channels. 
@@ -27,28 +51,52 @@ The interrupt handler has only the ints0 register to go on, so this array needs
 #define NUM_DMA_CHANS 12
 volatile DmxInput *active_inputs[NUM_DMA_CHANS] = {nullptr};
 
-DmxInput::return_code DmxInput::begin(uint pin, uint start_channel, uint num_channels, PIO pio, bool inverted)
+// The input holding the DMA sniffer (one per chip), if any
+#define DMXINPUT_CRC_SEED 0xFFFFFFFFu
+volatile DmxInput *sniffed_input = nullptr;
+
+static const pio_program_t *input_program(bool inverted)
+{
+    return inverted ? &DmxInputInverted_program : &DmxInput_program;
+}
+
+static bool acquire_input_program(PIO pio, bool inverted, uint *offset)
 {
     uint pio_ind = pio_get_index(pio);
-    if(!prgm_loaded[pio_ind]) {
-        /* 
-        Attempt to load the DMX PIO assembly program into the PIO program memory
-        */
-       if(!inverted) {
-        if (!pio_can_add_program(pio, &DmxInput_program))
-        {
-            return ERR_INSUFFICIENT_PRGM_MEM;
-        }
-        prgm_offsets[pio_ind] = pio_add_program(pio, &DmxInput_program);
-       } else {
-        if (!pio_can_add_program(pio, &DmxInputInverted_program))
+    if (input_prgm_refs[pio_ind][inverted] == 0) {
+        if (!pio_can_add_program(pio, input_program(inverted)))
         {
-            return ERR_INSUFFICIENT_PRGM_MEM;
+            return false;
         }
-        prgm_offsets[pio_ind] = pio_add_program(pio, &DmxInputInverted_program);
-       }
+        input_prgm_offsets[pio_ind][inverted] = pio_add_program(pio, input_program(inverted));
+    }
+    input_prgm_refs[pio_ind][inverted]++;
+    *offset = input_prgm_offsets[pio_ind][inverted];
+    return true;
+}
+
+static void release_input_program(PIO pio, bool inverted)
+{
+    uint pio_ind = pio_get_index(pio);
+    if (input_prgm_refs[pio_ind][inverted] > 0 && --input_prgm_refs[pio_ind][inverted] == 0) {
+        pio_remove_program(pio, input_program(inverted), input_prgm_offsets[pio_ind][inverted]);
+        input_prgm_offsets[pio_ind][inverted] = 0;
+    }
+}
+
+DmxInput::return_code DmxInput::begin(uint pin, uint start_channel, uint num_channels, PIO pio, bool inverted)
+{
+    if (_active) {
+        end();
+    }
 
-        prgm_loaded[pio_ind] = true;
+    /* 
+    Attempt to load the DMX PIO assembly program into the PIO program memory
+    */
+    uint prgm_offset;
+    if (!acquire_input_program(pio, inverted, &prgm_offset))
+    {
+        return ERR_INSUFFICIENT_PRGM_MEM;
     }
 
     /* 
@@ -58,9 +106,22 @@ DmxInput::return_code DmxInput::begin(uint pin, uint start_channel, uint num_cha
     int sm = pio_claim_unused_sm(pio, false);
     if (sm == -1)
     {
+        release_input_program(pio, inverted);
         return ERR_NO_SM_AVAILABLE;
     }
 
+    // The DMA channel doubles as the handler's index for this input
+    int dma_chan = dma_claim_unused_channel(false);
+    if (dma_chan == -1 || active_inputs[dma_chan] != nullptr)
+    {
+        if (dma_chan != -1) {
+            dma_channel_unclaim(dma_chan);
+        }
+        pio_sm_unclaim(pio, sm);
+        release_input_program(pio, inverted);
+        return ERR_NO_DMA_AVAILABLE;
+    }
+
     // Set this pin's GPIO function (connect PIO to the pad)
     pio_sm_set_consecutive_pindirs(pio, sm, pin, 1, false);
     pio_gpio_init(pio, pin);
@@ -69,9 +130,9 @@ DmxInput::return_code DmxInput::begin(uint pin, uint start_channel, uint num_cha
     // Generate the default PIO state machine config provided by pioasm
     pio_sm_config sm_conf;
     if(!inverted) {
-        sm_conf = DmxInput_program_get_default_config(prgm_offsets[pio_ind]);
+        sm_conf = DmxInput_program_get_default_config(prgm_offset);
     } else {
-        sm_conf = DmxInputInverted_program_get_default_config(prgm_offsets[pio_ind]);
+        sm_conf = DmxInputInverted_program_get_default_config(prgm_offset);
     }
     sm_config_set_in_pins(&sm_conf, pin); // for WAIT, IN
     sm_config_set_jmp_pin(&sm_conf, pin); // for JMP
@@ -87,25 +148,23 @@ DmxInput::return_code DmxInput::begin(uint pin, uint start_channel, uint num_cha
     sm_config_set_clkdiv(&sm_conf, clk_div);
 
     // Load our configuration, jump to the start of the program and run the State Machine
-    pio_sm_init(pio, sm, prgm_offsets[pio_ind], &sm_conf);
+    pio_sm_init(pio, sm, prgm_offset, &sm_conf);
     //sm_config_set_in_shift(&c, true, false, n_bits)
 
     //pio_sm_put_blocking(pio, sm, (start_channel + num_channels) - 1);
 
     _pio = pio;
     _sm = sm;
+    _prgm_offset = prgm_offset;
     _pin = pin;
+    _inverted = inverted;
     _start_channel = start_channel;
     _num_channels = num_channels;
     _buf = nullptr;
     _cb = nullptr;
+    _dma_chan = dma_chan;
+    _active = true;
 
-    _dma_chan = dma_claim_unused_channel(true);
-
-
-    if (active_inputs[_dma_chan] != nullptr) {
-        return ERR_NO_SM_AVAILABLE;
-    }
     active_inputs[_dma_chan] = this;
 
     return SUCCESS;
@@ -123,12 +182,21 @@ void DmxInput::read(volatile uint8_t *buffer)
 }
 
 void dmxinput_dma_handler() {
+    DMX_LOAD_ENTER(load_context, DMX_LOAD_RX_IRQ);
+    DMX_PROFILE_STAMP(entry_us);
+    DMX_PROFILE_RECORD(DMX_PROFILE_RX_IRQ_LATENCY, DMXProfile::elapsedUs(DMXProfile::completionUs(), entry_us));
     for(int i=0;i<NUM_DMA_CHANS;i++) {
         if(active_inputs[i]!=nullptr && (dma_hw->ints0 & (1u<<i))) {
             dma_hw->ints0 = 1u << i;
             volatile DmxInput *instance = active_inputs[i];
+            // Collect the packet's CRC and reseed before the channel restarts
+            if (instance->_sniffed) {
+                instance->_frame_crc = dma_hw->sniff_data;
+                dma_hw->sniff_data = DMXINPUT_CRC_SEED;
+            }
             dma_channel_set_write_addr(i, instance->_buf, true);
-            pio_sm_exec(instance->_pio, instance->_sm, pio_encode_jmp(prgm_offsets[pio_get_index(instance->_pio)]));
+            DMX_PROFILE_SINCE(DMX_PROFILE_RX_REARM_LATENCY, DMXProfile::completionUs());
+            pio_sm_exec(instance->_pio, instance->_sm, pio_encode_jmp(instance->_prgm_offset));
             pio_sm_clear_fifos(instance->_pio, instance->_sm);
 #ifdef ARDUINO
             instance->_last_packet_timestamp = millis();
@@ -141,7 +209,8 @@ void dmxinput_dma_handler() {
             }
         }
     }
-    
+    DMX_PROFILE_SINCE(DMX_PROFILE_RX_IRQ_DURATION, entry_us);
+    DMX_LOAD_LEAVE(load_context);
 }
 
 void DmxInput::read_async(volatile uint8_t *buffer, void (*inputUpdatedCallback)(DmxInput*)) {
@@ -167,6 +236,9 @@ void DmxInput::read_async(volatile uint8_t *buffer, void (*inputUpdatedCallback)
     // Pace transfers based on DREQ_PIO0_RX0 (or whichever pio and sm we are using)
     channel_config_set_dreq(&cfg, pio_get_dreq(_pio, _sm, false));
 
+    // With profiling on, completion also stamps the time for the latency metrics
+    DMX_PROFILE_CHAIN_COMPLETION(&cfg);
+
     //channel_config_set_ring(&cfg, true, 5);
     dma_channel_configure(
         _dma_chan, 
@@ -183,7 +255,7 @@ void DmxInput::read_async(volatile uint8_t *buffer, void (*inputUpdatedCallback)
 
     //aaand start!
     dma_channel_set_write_addr(_dma_chan, buffer, true);
-    pio_sm_exec(_pio, _sm, pio_encode_jmp(prgm_offsets[pio_get_index(_pio)]));
+    pio_sm_exec(_pio, _sm, pio_encode_jmp(_prgm_offset));
     pio_sm_clear_fifos(_pio, _sm);
 #ifdef ARDUINO
     _last_packet_timestamp = millis();
@@ -194,6 +266,49 @@ void DmxInput::read_async(volatile uint8_t *buffer, void (*inputUpdatedCallback)
     pio_sm_set_enabled(_pio, _sm, true);
 }
 
+void DmxInput::restart_frame() {
+    // Keep the abort from raising a completion interrupt (RP2040-E13)
+    dma_channel_set_irq0_enabled(_dma_chan, false);
+    dma_channel_abort(_dma_chan);
+    dma_channel_acknowledge_irq0(_dma_chan);
+    dma_channel_set_irq0_enabled(_dma_chan, true);
+
+    pio_sm_exec(_pio, _sm, pio_encode_jmp(_prgm_offset));
+    pio_sm_clear_fifos(_pio, _sm);
+    if (_sniffed) {
+        dma_hw->sniff_data = DMXINPUT_CRC_SEED;
+    }
+    dma_channel_set_write_addr(_dma_chan, _buf, true);
+}
+
+bool DmxInput::enable_frame_crc() {
+    if (_buf == nullptr || (sniffed_input != nullptr && sniffed_input != this)) {
+        return false;
+    }
+    sniffed_input = this;
+    _sniffed = true;
+
+    // CRC-32 with reflected input and output and a final inversion, as zlib.
+    // Forcing the channel's SNIFF_EN bit keeps the configuration running.
+    dma_hw->sniff_data = DMXINPUT_CRC_SEED;
+    dma_sniffer_set_output_reverse_enabled(true);
+    dma_sniffer_set_output_invert_enabled(true);
+    dma_sniffer_enable(_dma_chan, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+    return true;
+}
+
+void DmxInput::disable_frame_crc() {
+    if (sniffed_input == this) {
+        dma_sniffer_disable();
+        sniffed_input = nullptr;
+    }
+    _sniffed = false;
+}
+
+uint32_t DmxInput::frame_crc() {
+    return _frame_crc;
+}
+
 unsigned long DmxInput::latest_packet_timestamp() {
     return _last_packet_timestamp;
 }
@@ -204,32 +319,32 @@ uint DmxInput::pin() {
 
 void DmxInput::end()
 {
+    if (!_active) {
+        return;
+    }
+    _active = false;
+    disable_frame_crc();
+
+    // Take the input off the handler's list first, then stop its channel
+    // without raising a completion interrupt (RP2040-E13). Only this
+    // input's resources are touched, so the others keep receiving
+    active_inputs[_dma_chan] = nullptr;
+    dma_channel_set_irq0_enabled(_dma_chan, false);
+    dma_channel_abort(_dma_chan);
+    dma_channel_acknowledge_irq0(_dma_chan);
+
     // Stop the PIO state machine
     pio_sm_set_enabled(_pio, _sm, false);
+    pio_sm_clear_fifos(_pio, _sm);
 
-    // Remove the PIO DMX program from the PIO program memory
-    uint pio_id = pio_get_index(_pio);
-    bool inuse = false;
-    for(uint i=0;i<NUM_DMA_CHANS;i++) {
-        if(i==_dma_chan) {
-            continue;
-        }
-        if(pio_id == pio_get_index(active_inputs[i]->_pio)) {
-            inuse = true;
-            break;
-        }
-    }
-    if(!inuse) {
-        prgm_loaded[pio_id] = false;
-        pio_remove_program(_pio, &DmxInput_program, prgm_offsets[pio_id]);
-        prgm_offsets[pio_id]=0;
-    }
+    // Drop this input's reference to its program; the last input using
+    // it on the PIO removes it from the PIO program memory
+    release_input_program(_pio, _inverted);
 
     // Unclaim the sm
     pio_sm_unclaim(_pio, _sm);
 
     dma_channel_unclaim(_dma_chan);
-    active_inputs[_dma_chan] = nullptr;
 
     _buf = nullptr;
 }
@@ -28,6 +28,8 @@ class DmxInput
     uint _pin;
     int32_t _start_channel;
     int32_t _num_channels;
+    bool _inverted = false;
+    bool _active = false;
 
 public:
     /*
@@ -37,8 +39,11 @@ public:
     volatile PIO _pio;
     volatile uint _sm;
     volatile uint _dma_chan;
+    volatile uint _prgm_offset;
     volatile unsigned long _last_packet_timestamp=0;
     void (*_cb)(DmxInput*);
+    volatile bool _sniffed=false;
+    volatile uint32_t _frame_crc=0;
     /*
         All different return codes for the DMX class. Only the SUCCESS
         Return code guarantees that the DMX output instance was properly configured
@@ -54,7 +59,11 @@ public:
 
         // There is not enough program memory left in the PIO to fit
         // The DMX PIO program
-        ERR_INSUFFICIENT_PRGM_MEM = -2
+        ERR_INSUFFICIENT_PRGM_MEM = -2,
+
+        // There are no available DMA channels to handle
+        // the transfer of DMX data from the PIO
+        ERR_NO_DMA_AVAILABLE = -3
     };
 
     /*
@@ -91,6 +100,30 @@ public:
     */
     void read_async(volatile uint8_t *buffer, void (*inputUpdatedCallback)(DmxInput* instance) = nullptr);
 
+    /*
+        Drop the packet in progress and wait for the next break. The transfer
+        only ends after a fixed number of slots, so a shorter packet with an
+        alternate start code (e.g. RDM) would otherwise run into the next
+        frame. Only valid after read_async().
+    */
+    void restart_frame();
+
+    /*
+        Attach the DMA sniffer to this input's channel, so the CRC-32 (as
+        zlib's crc32()) of every packet, start code included, is computed by
+        the DMA as it is received. There is one sniffer per chip: returns
+        false if another input holds it. Only valid after read_async(); the
+        packet in progress gets a partial CRC.
+    */
+    bool enable_frame_crc();
+    void disable_frame_crc();
+
+    /*
+        CRC-32 of the latest completed packet, while enable_frame_crc() is
+        in effect. Valid from the callback until the next packet completes.
+    */
+    uint32_t frame_crc();
+
     /*
         Get the timestamp (like millis()) from the moment the latest dmx packet was received.
         May be used to detect if the dmx signal has stopped coming in.
@@ -104,8 +137,10 @@ public:
 
 
     /*
-        De-inits the DMX input instance. Releases PIO resources. 
-        The instance can safely be destroyed after this method is called
+        De-inits the DMX input instance. Releases PIO and DMA resources. 
+        The instance can safely be destroyed after this method is called.
+        Other inputs keep running: the program stays loaded on the PIO
+        until the last input using it ends
     */
     void end();
 };
@@ -1,4 +1,3 @@
-
 /*
  * Copyright (c) 2021 Jostein Løwer 
  *
@@ -16,18 +15,57 @@
   #include "hardware/irq.h"
 #endif
 
+/*
+One copy of the program per PIO, shared by every output on it. The
+reference count lets outputs come and go while the others keep running
+*/
+#define DMXOUTPUT_NUM_PIOS 2
+uint output_prgm_refs[DMXOUTPUT_NUM_PIOS] = {0,0};
+uint output_prgm_offsets[DMXOUTPUT_NUM_PIOS] = {0,0};
+
+static bool acquire_output_program(PIO pio, uint *offset)
+{
+    uint pio_ind = pio_get_index(pio);
+    if (output_prgm_refs[pio_ind] == 0)
+    {
+        if (!pio_can_add_program(pio, &DmxOutput_program))
+        {
+            return false;
+        }
+        output_prgm_offsets[pio_ind] = pio_add_program(pio, &DmxOutput_program);
+    }
+    output_prgm_refs[pio_ind]++;
+    *offset = output_prgm_offsets[pio_ind];
+    return true;
+}
+
+static void release_output_program(PIO pio)
+{
+    uint pio_ind = pio_get_index(pio);
+    if (output_prgm_refs[pio_ind] > 0 && --output_prgm_refs[pio_ind] == 0)
+    {
+        pio_remove_program(pio, &DmxOutput_program, output_prgm_offsets[pio_ind]);
+        output_prgm_offsets[pio_ind] = 0;
+    }
+}
+
 DmxOutput::return_code DmxOutput::begin(uint pin, PIO pio)
 {
+    if (_active)
+    {
+        end();
+    }
+
     /* 
     Attempt to load the DMX PIO assembly program 
     into the PIO program memory
     */
 
-    if (!pio_can_add_program(pio, &DmxOutput_program))
+    uint prgm_offset;
+    if (!acquire_output_program(pio, &prgm_offset))
     {
         return ERR_INSUFFICIENT_PRGM_MEM;
     }
-    uint prgm_offset = pio_add_program(pio, &DmxOutput_program);
 
     /* 
     Attempt to claim an unused State Machine 
@@ -37,9 +75,21 @@ DmxOutput::return_code DmxOutput::begin(uint pin, PIO pio)
     int sm = pio_claim_unused_sm(pio, false);
     if (sm == -1)
     {
+        release_output_program(pio);
         return ERR_NO_SM_AVAILABLE;
     }
 
+    // Claim an unused DMA channel.
+    // The channel is kept througout the lifetime of the DMX source
+    int dma = dma_claim_unused_channel(false);
+
+    if (dma == -1)
+    {
+        pio_sm_unclaim(pio, sm);
+        release_output_program(pio);
+        return ERR_NO_DMA_AVAILABLE;
+    }
+
     // Set this pin's GPIO function (connect PIO to the pad)
     pio_sm_set_pins_with_mask(pio, sm, 1u << pin, 1u << pin);
     pio_sm_set_pindirs_with_mask(pio, sm, 1u << pin, 1u << pin);
@@ -56,17 +106,12 @@ DmxOutput::return_code DmxOutput::begin(uint pin, PIO pio)
     uint clk_div = clock_get_hz(clk_sys) / DMX_SM_FREQ;
     sm_config_set_clkdiv(&sm_conf, clk_div);
 
-    // Load our configuration, jump to the start of the program and run the State Machine
-    pio_sm_init(pio, sm, prgm_offset, &sm_conf);
+    // Load our configuration and run the State Machine. It starts at the
+    // pull, idling at mark until the first write(): a break now would reach
+    // receivers already listening on the line as the start of a frame
+    pio_sm_init(pio, sm, prgm_offset + DmxOutput_wrap_target, &sm_conf);
     pio_sm_set_enabled(pio, sm, true);
 
-    // Claim an unused DMA channel.
-    // The channel is kept througout the lifetime of the DMX source
-    int dma = dma_claim_unused_channel(false);
-
-    if (dma == -1)
-        return ERR_NO_DMA_AVAILABLE;
-
     // Get the default DMA config for our claimed channel
     dma_channel_config dma_conf = dma_channel_get_default_config(dma);
 
@@ -89,6 +134,7 @@ DmxOutput::return_code DmxOutput::begin(uint pin, PIO pio)
     _sm = sm;
     _pin = pin;
     _dma = dma;
+    _active = true;
 
     return SUCCESS;
 }
@@ -105,6 +151,9 @@ void DmxOutput::write(uint8_t *universe, uint length)
     // Start the DMX PIO program from the beginning
     pio_sm_exec(_pio, _sm, pio_encode_jmp(_prgm_offset));
 
+    // Clear the stall flag left by the end of the previous frame
+    _pio->fdebug = 1u << (PIO_FDEBUG_TXSTALL_LSB + _sm);
+
     // Restart the PIO state machinge
     pio_sm_set_enabled(_pio, _sm, true);
 
@@ -117,7 +166,12 @@ bool DmxOutput::busy()
     if (dma_channel_is_busy(_dma))
         return true;
 
-    return !pio_sm_is_tx_fifo_empty(_pio, _sm);
+    if (!pio_sm_is_tx_fifo_empty(_pio, _sm))
+        return true;
+
+    // The last slot is still being shifted out until the state
+    // machine stalls on the pull after it
+    return !(_pio->fdebug & (1u << (PIO_FDEBUG_TXSTALL_LSB + _sm)));
 }
 
 /*
@@ -133,11 +187,27 @@ void Dmx::await()
 
 void DmxOutput::end()
 {
+    if (!_active)
+    {
+        return;
+    }
+    _active = false;
+
+    // Stop feeding the state machine; a transfer left running would hold
+    // the channel busy after it is unclaimed
+    dma_channel_abort(_dma);
+
     // Stop the PIO state machine
     pio_sm_set_enabled(_pio, _sm, false);
+    pio_sm_clear_fifos(_pio, _sm);
+
+    // Hand the pin back to the GPIO block, idling high (mark)
+    gpio_init(_pin);
+    gpio_pull_up(_pin);
 
-    // Remove the PIO DMX program from the PIO program memory
-    pio_remove_program(_pio, &DmxOutput_program, _prgm_offset);
+    // Drop this output's reference to the PIO DMX program; the last
+    // output on the PIO removes it from the PIO program memory
+    release_output_program(_pio);
 
     // Unclaim the DMA channel
     dma_channel_unclaim(_dma);
@@ -28,6 +28,7 @@ class DmxOutput
     uint _sm;
     PIO _pio;
     uint _dma;
+    bool _active = false;
 
 public:
     /*
@@ -103,7 +104,10 @@ public:
     /*
         De-inits the DMX transmitter instance. Releases PIO 
         and DMA resources. The instance can safely be destroyed
-        after this method is called
+        after this method is called. A frame in progress is cut
+        off and the pin is left idling high. Other instances on
+        the same PIO keep running: the program stays loaded until
+        the last of them ends
     */
     void end();
 };
@@ -0,0 +1,346 @@
+/*
+ * DMX Capture Tool (host tool)
+ *
+ * Works with the timestamped capture format of DMXCapture / DMXReplay
+ * (see include/dmx_capture_format.h).
+ *
+ *   bench   Encodes synthetic busy universes at DMX refresh rate through the
+ *           same encoder and ring the firmware uses, then decodes the result
+ *           and verifies it. Reports bytes per second and time per frame.
+ *   record  Reads CAPTURE packets streamed by DMXCapture::flush() from the
+ *           device (or a file / stdin) and writes a capture image.
+ *   info    Summarises a capture image: duration, frame rates, jitter, size.
+ *
+ * Build:  g++ -std=c++17 -O2 -Iinclude tools/dmx_capture_tool.cpp src/core/dmx_capture_format.cpp src/core/dmx_cue_format.cpp src/core/dmx_stream_protocol.cpp -o dmx_capture_tool
+ * Usage:  ./dmx_capture_tool bench [--universes N] [--seconds N] [--fps N] [--ring BYTES]
+ *         ./dmx_capture_tool record <tty|file|-> capture.dmxr
+ *         ./dmx_capture_tool info capture.dmxr
+ *
+ * A capture saved to flash is read back with
+ *   picotool save -r 0x10100000 0x10180000 capture.dmxr
+ */
+
+#include "dmx_capture_format.h"
+#include "dmx_stream_protocol.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+#define BENCH_STAGGER_US 1237 // Receivers are not phase-locked
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// A busy console: moving-light pan/tilt curves, an RGB chase, a few
+// dimmers on slow fades and a cue change every 10 seconds
+static void renderUniverse(uint8_t universe, uint32_t frame, uint8_t* out) {
+    uint32_t cue = frame / 440;
+    for (uint16_t i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+        out[i] = (uint8_t)((cue * 37 + i * 11 + universe * 5) & 0x3F);
+    }
+    // 16 moving heads x 16 channels: pan/tilt coarse+fine move every frame
+    for (uint16_t f = 0; f < 16; f++) {
+        uint8_t* head = &out[f * 16];
+        double t = frame / 44.0 + f * 0.3 + universe;
+        uint16_t pan = (uint16_t)(32767 + 32767 * sin(t * 0.7));
+        uint16_t tilt = (uint16_t)(32767 + 32767 * cos(t * 0.5));
+        head[0] = (uint8_t)(pan >> 8);
+        head[1] = (uint8_t)pan;
+        head[2] = (uint8_t)(tilt >> 8);
+        head[3] = (uint8_t)tilt;
+        head[4] = 255;
+    }
+    // 48 RGB pixels chasing
+    for (uint16_t p = 0; p < 48; p++) {
+        uint8_t level = (uint8_t)(127 + 127 * sin((frame + p * 4) * 0.15));
+        out[256 + p * 3] = level;
+        out[257 + p * 3] = (uint8_t)(255 - level);
+        out[258 + p * 3] = (uint8_t)(cue * 50);
+    }
+    // Slow dimmer fades
+    for (uint16_t d = 400; d < 448; d++) {
+        out[d] = (uint8_t)((frame / 4 + d) & 0xFF);
+    }
+}
+
+static int runBench(uint8_t num_universes, uint32_t seconds, uint32_t fps, size_t ring_size) {
+    uint32_t frames = seconds * fps;
+    uint32_t frame_us = 1000000 / fps;
+
+    DMXCaptureEncoder encoder;
+    encoder.begin(num_universes);
+    std::vector<uint8_t> ring_buffer(ring_size);
+    DMXCaptureRing ring;
+    if (!ring.begin(ring_buffer.data(), ring_buffer.size())) {
+        fprintf(stderr, "Ring must hold at least %d bytes\n", 2 * DMX_CAPTURE_MAX_RECORD);
+        return 1;
+    }
+
+    std::vector<uint8_t> image(DMX_CAPTURE_HEADER_SIZE);
+    dmxCaptureWriteHeader(num_universes, image.data());
+
+    // Pre-render so the timing covers only the capture path
+    std::vector<uint8_t> source((size_t)frames * num_universes * DMX_UNIVERSE_SIZE);
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint8_t u = 0; u < num_universes; u++) {
+            renderUniverse(u, f, &source[((size_t)f * num_universes + u) * DMX_UNIVERSE_SIZE]);
+        }
+    }
+
+    // Producer and consumer interleave as IRQ and main loop would: the ring
+    // is drained once per frame period
+    uint32_t dropped = 0;
+    uint32_t keyframes = 0;
+    Clock::time_point start = Clock::now();
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint8_t u = 0; u < num_universes; u++) {
+            uint32_t timestamp = f * frame_us + u * BENCH_STAGGER_US;
+            uint8_t* slot = ring.reserve();
+            if (slot == nullptr) {
+                dropped++;
+                continue;
+            }
+            uint16_t length = encoder.encodeFrame(u, &source[((size_t)f * num_universes + u) * DMX_UNIVERSE_SIZE],
+                                                  timestamp, slot);
+            keyframes += slot[5] & DMX_CAPTURE_FLAG_KEYFRAME;
+            ring.commit(length);
+        }
+        uint16_t length;
+        const uint8_t* record;
+        while ((record = ring.peek(&length)) != nullptr) {
+            image.insert(image.end(), record, record + length);
+            ring.pop();
+        }
+    }
+    double encode_s = secondsSince(start);
+
+    // Decode and verify every frame
+    DMXCaptureReader reader;
+    if (!reader.open(image.data(), image.size())) {
+        fprintf(stderr, "Capture image did not validate\n");
+        return 1;
+    }
+    static uint8_t universes[DMX_CAPTURE_MAX_UNIVERSES][DMX_UNIVERSE_SIZE];
+    uint32_t mismatches = 0;
+    DMXCaptureRecord record;
+    start = Clock::now();
+    while (reader.next(&record)) {
+        DMXCaptureReader::applyRecord(record, universes[record.universe]);
+        // Frame number from the timestamp, so dropped frames do not shift the comparison
+        uint32_t f = (record.timestamp_us - record.universe * BENCH_STAGGER_US) / frame_us;
+        if (memcmp(universes[record.universe], &source[((size_t)f * num_universes + record.universe) * DMX_UNIVERSE_SIZE],
+                   DMX_UNIVERSE_SIZE) != 0) {
+            mismatches++;
+        }
+    }
+    double decode_s = secondsSince(start);
+
+    uint32_t total_frames = frames * num_universes;
+    double captured_bytes = (double)(image.size() - DMX_CAPTURE_HEADER_SIZE);
+    double raw_bytes = (double)total_frames * DMX_UNIVERSE_SIZE;
+    printf("Universes:        %u at %u fps for %u s (%u frames)\n", num_universes, fps, seconds, total_frames);
+    printf("Capture size:     %.0f bytes (%.1f%% of raw), %u keyframes, %u dropped\n",
+           captured_bytes, 100.0 * captured_bytes / raw_bytes, keyframes, dropped);
+    printf("Data rate:        %.1f KB/s (raw %.1f KB/s)\n",
+           captured_bytes / seconds / 1024.0, raw_bytes / seconds / 1024.0);
+    printf("Encode:           %.2f us/frame (host)\n", encode_s * 1e6 / total_frames);
+    printf("Decode:           %.2f us/frame (host)\n", decode_s * 1e6 / total_frames);
+    printf("64 KB RAM ring:   %.1f s of capture\n", 65536.0 / (captured_bytes / seconds));
+    printf("Round trip:       %s (%u mismatches)\n", mismatches == 0 ? "OK" : "FAILED", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
+
+struct RecordState {
+    std::vector<uint8_t> image;
+    uint8_t num_universes;
+    uint32_t records;
+};
+
+static uint8_t* resolveNothing(uint8_t, void*) {
+    return nullptr;
+}
+
+static void onRecord(uint8_t type, uint8_t, const uint8_t* payload, uint16_t length, void* context) {
+    RecordState* state = static_cast<RecordState*>(context);
+    DMXCaptureRecord record;
+    if (type != DMX_STREAM_CAPTURE || !DMXCaptureReader::parseRecord(payload, length, &record)) {
+        return;
+    }
+    state->image.insert(state->image.end(), payload, payload + length);
+    if (record.universe + 1 > state->num_universes) {
+        state->num_universes = record.universe + 1;
+    }
+    state->records++;
+    if (state->records % 1000 == 0) {
+        fprintf(stderr, "\r%u records, %zu bytes", state->records, state->image.size());
+    }
+}
+
+static volatile bool stop_recording = false;
+
+static void onSignal(int) {
+    stop_recording = true;
+}
+
+static int runRecord(const char* input, const char* output) {
+    int fd = strcmp(input, "-") == 0 ? STDIN_FILENO : open(input, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(input);
+        return 1;
+    }
+    struct termios tio;
+    if (isatty(fd) && tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    static RecordState state;
+    state.image.resize(DMX_CAPTURE_HEADER_SIZE);
+    DMXStreamDecoder decoder;
+    decoder.begin(resolveNothing, nullptr, &state);
+    decoder.setRecordCallback(onRecord);
+
+    // Ctrl-C ends a live recording
+    signal(SIGINT, onSignal);
+    uint8_t buffer[4096];
+    ssize_t n;
+    while (!stop_recording && (n = read(fd, buffer, sizeof(buffer))) > 0) {
+        decoder.feed(buffer, (size_t)n);
+    }
+
+    if (state.records == 0) {
+        fprintf(stderr, "No capture records received\n");
+        return 1;
+    }
+    dmxCaptureWriteHeader(state.num_universes, state.image.data());
+    FILE* out = fopen(output, "wb");
+    if (out == nullptr || fwrite(state.image.data(), 1, state.image.size(), out) != state.image.size()) {
+        perror(output);
+        return 1;
+    }
+    fclose(out);
+
+    DMXStreamDecoder::Stats stats = decoder.getStats();
+    fprintf(stderr, "\nWrote %u records (%zu bytes) to %s; %u checksum errors, %u sequence gaps\n",
+            state.records, state.image.size(), output, stats.checksum_errors, stats.seq_gaps);
+    return 0;
+}
+
+static int runInfo(const char* path) {
+    FILE* in = fopen(path, "rb");
+    if (in == nullptr) {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> image;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        image.insert(image.end(), buffer, buffer + n);
+    }
+    fclose(in);
+
+    DMXCaptureReader reader;
+    if (!reader.open(image.data(), image.size())) {
+        fprintf(stderr, "%s is not a capture image\n", path);
+        return 1;
+    }
+
+    struct UniverseInfo {
+        uint32_t frames;
+        uint32_t keyframes;
+        uint32_t unchanged;
+        uint64_t bytes;
+        uint32_t last_us;
+        uint32_t min_gap_us;
+        uint32_t max_gap_us;
+    };
+    UniverseInfo info[DMX_CAPTURE_MAX_UNIVERSES];
+    memset(info, 0, sizeof(info));
+
+    static uint8_t universes[DMX_CAPTURE_MAX_UNIVERSES][DMX_UNIVERSE_SIZE];
+    DMXCaptureRecord record;
+    bool first = true;
+    uint32_t last_us = 0;
+    uint64_t duration_us = 0;
+    uint32_t errors = 0;
+    size_t data_bytes = 0;
+    while (reader.next(&record)) {
+        if (!first) {
+            duration_us += (uint32_t)(record.timestamp_us - last_us);
+        }
+        last_us = record.timestamp_us;
+        first = false;
+
+        UniverseInfo& u = info[record.universe];
+        if (u.frames > 0) {
+            uint32_t gap = record.timestamp_us - u.last_us;
+            if (u.frames == 1 || gap < u.min_gap_us) u.min_gap_us = gap;
+            if (gap > u.max_gap_us) u.max_gap_us = gap;
+        }
+        u.last_us = record.timestamp_us;
+        u.frames++;
+        u.keyframes += record.flags & DMX_CAPTURE_FLAG_KEYFRAME;
+        u.unchanged += record.length == 0 && !(record.flags & DMX_CAPTURE_FLAG_KEYFRAME);
+        u.bytes += DMX_CAPTURE_RECORD_HEADER_SIZE + record.length;
+        data_bytes += DMX_CAPTURE_RECORD_HEADER_SIZE + record.length;
+        if (!DMXCaptureReader::applyRecord(record, universes[record.universe])) {
+            errors++;
+        }
+    }
+
+    double seconds = duration_us / 1e6;
+    printf("%s: %u universes, %.2f s, %zu bytes of records", path, reader.getNumUniverses(), seconds, data_bytes);
+    if (seconds > 0) {
+        printf(" (%.1f KB/s)", data_bytes / seconds / 1024.0);
+    }
+    printf("\n");
+    for (uint8_t i = 0; i < reader.getNumUniverses(); i++) {
+        const UniverseInfo& u = info[i];
+        printf("  Universe %u: %6u frames (%5.1f fps), %4u keyframes, %5u unchanged, %8llu bytes, gap %u-%u us\n",
+               i + 1, u.frames, seconds > 0 ? u.frames / seconds : 0.0, u.keyframes, u.unchanged,
+               (unsigned long long)u.bytes, u.min_gap_us, u.max_gap_us);
+    }
+    if (errors > 0) {
+        printf("  %u records failed to decode\n", errors);
+    }
+    return errors == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        uint32_t universes = 8, seconds = 60, fps = 44, ring = 65536;
+        for (int i = 2; i + 1 < argc; i += 2) {
+            if (strcmp(argv[i], "--universes") == 0) universes = (uint32_t)atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--seconds") == 0) seconds = (uint32_t)atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--fps") == 0) fps = (uint32_t)atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--ring") == 0) ring = (uint32_t)atoi(argv[i + 1]);
+        }
+        if (universes < 1 || universes > DMX_CAPTURE_MAX_UNIVERSES || seconds == 0 || fps == 0) {
+            fprintf(stderr, "Invalid bench parameters\n");
+            return 1;
+        }
+        return runBench((uint8_t)universes, seconds, fps, ring);
+    }
+    if (argc == 4 && strcmp(argv[1], "record") == 0) {
+        return runRecord(argv[2], argv[3]);
+    }
+    if (argc == 3 && strcmp(argv[1], "info") == 0) {
+        return runInfo(argv[2]);
+    }
+
+    fprintf(stderr, "Usage: %s bench [--universes N] [--seconds N] [--fps N] [--ring BYTES]\n", argv[0]);
+    fprintf(stderr, "       %s record <tty|file|-> capture.dmxr\n", argv[0]);
+    fprintf(stderr, "       %s info capture.dmxr\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,411 @@
+/*
+ * Art-Net / sACN Codec Bench (host tool)
+ *
+ * Exercises DMXNetCodec and DMXNetRouter (include/dmx_net_protocol.h) on Linux.
+ * The test traffic carries 4 Art-Net universes (port-addresses 0-3) followed by
+ * ArtSync, and 4 sACN universes (1-4) synchronised on address 7999. A second,
+ * lower-priority sACN source that the router must reject is mixed in.
+ *
+ * Build:  g++ -std=c++17 -O2 -pthread -Iinclude tools/dmx_net_bench.cpp src/core/dmx_net_protocol.cpp -o dmx_net_bench
+ * Usage:  ./dmx_net_bench bench [--frames N]          In-memory parse + route packets/s
+ *         ./dmx_net_bench udp [--frames N]            Send over localhost UDP, route, verify
+ *         ./dmx_net_bench record out.pcap [--frames N] Write the test traffic as a capture
+ *         ./dmx_net_bench replay capture.pcap          Route every Art-Net/sACN packet in a capture
+ *
+ * Replay accepts Ethernet, Linux cooked (SLL) and raw IPv4 captures. Routes are
+ * learned from the first 8 distinct universes seen in the capture.
+ */
+
+#include "dmx_net_protocol.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#define NUM_TEST_OUTPUTS 8
+#define TEST_SYNC_ADDRESS 7999
+
+typedef std::chrono::steady_clock Clock;
+typedef std::vector<uint8_t> Packet;
+
+static uint8_t outputs[NUM_TEST_OUTPUTS][DMX_UNIVERSE_SIZE];
+
+static uint8_t* resolveOutput(uint8_t output, void*) {
+    return output < NUM_TEST_OUTPUTS ? outputs[output] : nullptr;
+}
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static void testRoutes(DMXNetRouter& router) {
+    for (uint8_t i = 0; i < 4; i++) {
+        router.setRoute(i, DMX_NET_ARTNET, i);
+        router.setRoute(i + 4, DMX_NET_SACN, (uint16_t)(i + 1));
+    }
+}
+
+static void frameContents(uint32_t frame, uint8_t universe, uint8_t* out) {
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+        out[i] = (uint8_t)(frame * 7 + universe * 31 + i);
+    }
+}
+
+// One frame of test traffic
+static void generateFrame(uint32_t frame, std::vector<Packet>& packets, std::vector<uint16_t>& ports) {
+    static DMXNetSource primary = {{0x1f, 0x3c, 0x5a, 0x77, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}, "bench primary", 150};
+    static DMXNetSource backup = {{0x1f, 0x3c, 0x5a, 0x77, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2}, "bench backup", 100};
+    uint8_t data[DMX_UNIVERSE_SIZE];
+    uint8_t buffer[DMX_NET_MAX_PACKET];
+
+    for (uint8_t u = 0; u < NUM_TEST_OUTPUTS; u++) {
+        frameContents(frame, u, data);
+        size_t size;
+        if (u < 4) {
+            size = DMXNetCodec::encodeArtDmx(buffer, u, (uint8_t)(frame % 255 + 1), data, DMX_UNIVERSE_SIZE);
+            ports.push_back(DMX_ARTNET_PORT);
+        } else {
+            size = DMXNetCodec::encodeSACN(buffer, primary, (uint16_t)(u - 3), (uint8_t)frame,
+                                           TEST_SYNC_ADDRESS, 0, data, DMX_UNIVERSE_SIZE);
+            ports.push_back(DMX_SACN_PORT);
+        }
+        packets.push_back(Packet(buffer, buffer + size));
+    }
+
+    // Lower-priority source on the same universe: must never reach the output
+    memset(data, 0xEE, sizeof(data));
+    size_t size = DMXNetCodec::encodeSACN(buffer, backup, 1, (uint8_t)frame, 0, 0, data, DMX_UNIVERSE_SIZE);
+    packets.push_back(Packet(buffer, buffer + size));
+    ports.push_back(DMX_SACN_PORT);
+
+    size = DMXNetCodec::encodeArtSync(buffer);
+    packets.push_back(Packet(buffer, buffer + size));
+    ports.push_back(DMX_ARTNET_PORT);
+    size = DMXNetCodec::encodeSACNSync(buffer, primary, (uint8_t)frame, TEST_SYNC_ADDRESS);
+    packets.push_back(Packet(buffer, buffer + size));
+    ports.push_back(DMX_SACN_PORT);
+}
+
+static bool verifyFrame(uint32_t frame) {
+    uint8_t expected[DMX_UNIVERSE_SIZE];
+    for (uint8_t u = 0; u < NUM_TEST_OUTPUTS; u++) {
+        frameContents(frame, u, expected);
+        if (memcmp(outputs[u], expected, DMX_UNIVERSE_SIZE) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void printStats(const DMXNetRouter::Stats& stats) {
+    printf("Router:  %u packets, %u routed, %u invalid, %u unrouted, %u out of order, %u priority rejects, %u syncs\n",
+           stats.packets, stats.routed, stats.invalid, stats.unrouted, stats.out_of_order,
+           stats.priority_rejects, stats.syncs);
+}
+
+static int runBench(uint32_t frames) {
+    std::vector<Packet> packets;
+    std::vector<uint16_t> ports;
+    // 255 frames, so both Art-Net (1-255) and sACN (0-255) sequences stay in order when looping
+    for (uint32_t f = 0; f < 255; f++) {
+        generateFrame(f, packets, ports);
+    }
+    size_t per_frame = packets.size() / 255;
+
+    DMXNetRouter router;
+    router.begin(resolveOutput, nullptr);
+    testRoutes(router);
+
+    uint64_t frames_ready = 0;
+    Clock::time_point start = Clock::now();
+    for (uint32_t f = 0; f < frames; f++) {
+        size_t base = (f % 255) * per_frame;
+        for (size_t p = base; p < base + per_frame; p++) {
+            uint8_t ready = router.handlePacket(packets[p].data(), packets[p].size(), f * 23);
+            frames_ready += __builtin_popcount(ready);
+        }
+    }
+    double elapsed = secondsSince(start);
+
+    uint64_t total = (uint64_t)frames * per_frame;
+    printf("Bench:   %llu packets in %.3f s = %.0f packets/s (%.1f MB/s of slot data), %llu output frames\n",
+           (unsigned long long)total, elapsed, total / elapsed,
+           (double)frames * NUM_TEST_OUTPUTS * DMX_UNIVERSE_SIZE / elapsed / 1e6,
+           (unsigned long long)frames_ready);
+    printStats(router.getStats());
+    bool ok = verifyFrame((frames - 1) % 255) && frames_ready == (uint64_t)frames * NUM_TEST_OUTPUTS;
+    printf("Result:  %s\n", ok ? "outputs match" : "MISMATCH");
+    return ok ? 0 : 1;
+}
+
+static int openUdp(uint16_t* port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    int size = 4 * 1024 * 1024;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    if (fd < 0 || bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        perror("udp");
+        exit(1);
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(fd, (sockaddr*)&addr, &len);
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static int runUdp(uint32_t frames) {
+    // Ephemeral ports stand in for 6454 / 5568 so the test never clashes with a real node
+    uint16_t artnet_port, sacn_port;
+    int artnet_fd = openUdp(&artnet_port);
+    int sacn_fd = openUdp(&sacn_port);
+
+    DMXNetRouter router;
+    router.begin(resolveOutput, nullptr);
+    testRoutes(router);
+
+    uint64_t expected_packets = 0;
+    std::thread sender([&]() {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in dest = {};
+        dest.sin_family = AF_INET;
+        dest.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        for (uint32_t f = 0; f < frames; f++) {
+            std::vector<Packet> packets;
+            std::vector<uint16_t> ports;
+            generateFrame(f, packets, ports);
+            for (size_t p = 0; p < packets.size(); p++) {
+                dest.sin_port = htons(ports[p] == DMX_ARTNET_PORT ? artnet_port : sacn_port);
+                sendto(fd, packets[p].data(), packets[p].size(), 0, (sockaddr*)&dest, sizeof(dest));
+            }
+            // Pace lightly so the loopback socket buffers do not overflow
+            if (f % 64 == 63) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+        close(fd);
+    });
+
+    // Single receive loop over both sockets; ordering is preserved per socket,
+    // which is all each protocol's sync handling relies on
+    uint8_t buffer[2048];
+    uint64_t received = 0, frames_ready = 0;
+    expected_packets = (uint64_t)frames * (NUM_TEST_OUTPUTS + 3);
+    Clock::time_point start = Clock::now();
+    Clock::time_point last_packet = start;
+    while (received < expected_packets && secondsSince(last_packet) < 1.0) {
+        for (int s = 0; s < 2; s++) {
+            ssize_t n = recv(s == 0 ? artnet_fd : sacn_fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (n < 0) {
+                continue;
+            }
+            last_packet = Clock::now();
+            received++;
+            uint32_t now_ms = (uint32_t)(secondsSince(start) * 1000);
+            frames_ready += __builtin_popcount(router.handlePacket(buffer, (size_t)n, now_ms));
+        }
+    }
+    sender.join();
+    double elapsed = secondsSince(start);
+
+    printf("UDP:     %llu/%llu packets received in %.3f s = %.0f packets/s, %llu output frames\n",
+           (unsigned long long)received, (unsigned long long)expected_packets, elapsed, received / elapsed,
+           (unsigned long long)frames_ready);
+    printStats(router.getStats());
+    bool ok = verifyFrame(frames - 1);
+    printf("Result:  %s\n", ok ? "outputs match the last frame" : "MISMATCH (packets lost?)");
+    close(artnet_fd);
+    close(sacn_fd);
+    return ok ? 0 : 1;
+}
+
+// Minimal libpcap writer/reader (microsecond timestamps, native byte order)
+struct PcapHeader {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t network;
+};
+
+struct PcapRecord {
+    uint32_t ts_sec;
+    uint32_t ts_usec;
+    uint32_t incl_len;
+    uint32_t orig_len;
+};
+
+static int runRecord(const char* path, uint32_t frames) {
+    FILE* f = fopen(path, "wb");
+    if (f == nullptr) {
+        perror(path);
+        return 1;
+    }
+    PcapHeader header = {0xa1b2c3d4, 2, 4, 0, 0, 65535, 1};
+    fwrite(&header, sizeof(header), 1, f);
+
+    uint32_t count = 0;
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        std::vector<Packet> packets;
+        std::vector<uint16_t> ports;
+        generateFrame(frame, packets, ports);
+        for (size_t p = 0; p < packets.size(); p++) {
+            // Ethernet + IPv4 + UDP, 44 Hz frame timestamps
+            uint8_t frame_bytes[14 + 20 + 8 + DMX_NET_MAX_PACKET] = {};
+            uint16_t udp_length = (uint16_t)(8 + packets[p].size());
+            uint8_t* eth = frame_bytes;
+            eth[12] = 0x08;
+            uint8_t* ip = eth + 14;
+            ip[0] = 0x45;
+            ip[2] = (uint8_t)((20 + udp_length) >> 8);
+            ip[3] = (uint8_t)(20 + udp_length);
+            ip[8] = 64;
+            ip[9] = 17;
+            ip[12] = 10; ip[15] = 1;
+            ip[16] = 10; ip[19] = 2;
+            uint8_t* udp = ip + 20;
+            udp[0] = (uint8_t)(ports[p] >> 8); udp[1] = (uint8_t)ports[p];
+            udp[2] = (uint8_t)(ports[p] >> 8); udp[3] = (uint8_t)ports[p];
+            udp[4] = (uint8_t)(udp_length >> 8); udp[5] = (uint8_t)udp_length;
+            memcpy(udp + 8, packets[p].data(), packets[p].size());
+
+            uint64_t us = (uint64_t)frame * 22727 + p * 20;
+            uint32_t length = 14 + 20 + udp_length;
+            PcapRecord record = {(uint32_t)(us / 1000000), (uint32_t)(us % 1000000), length, length};
+            fwrite(&record, sizeof(record), 1, f);
+            fwrite(frame_bytes, 1, length, f);
+            count++;
+        }
+    }
+    fclose(f);
+    printf("Record:  %u packets (%u frames) written to %s\n", count, frames, path);
+    return 0;
+}
+
+static int runReplay(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) {
+        perror(path);
+        return 1;
+    }
+    PcapHeader header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || (header.magic != 0xa1b2c3d4 && header.magic != 0xa1b23c4d)) {
+        fprintf(stderr, "%s: not a little-endian pcap file\n", path);
+        fclose(f);
+        return 1;
+    }
+    bool nanosecond = header.magic == 0xa1b23c4d;
+
+    // Load UDP payloads on the Art-Net/sACN ports with their capture times
+    std::vector<Packet> payloads;
+    std::vector<uint32_t> times_ms;
+    PcapRecord record;
+    std::vector<uint8_t> frame;
+    while (fread(&record, sizeof(record), 1, f) == 1) {
+        frame.resize(record.incl_len);
+        if (fread(frame.data(), 1, record.incl_len, f) != record.incl_len) {
+            break;
+        }
+        size_t offset;
+        if (header.network == 1) {
+            offset = 14;
+            if (frame.size() < offset || frame[12] != 0x08 || frame[13] != 0x00) continue;
+        } else if (header.network == 113) {
+            offset = 16;
+            if (frame.size() < offset || frame[14] != 0x08 || frame[15] != 0x00) continue;
+        } else if (header.network == 101) {
+            offset = 0;
+        } else {
+            fprintf(stderr, "%s: unsupported link type %u\n", path, header.network);
+            fclose(f);
+            return 1;
+        }
+        if (frame.size() < offset + 28 || (frame[offset] >> 4) != 4 || frame[offset + 9] != 17) continue;
+        size_t ihl = (frame[offset] & 0x0F) * 4;
+        const uint8_t* udp = &frame[offset + ihl];
+        if (frame.size() < offset + ihl + 8) continue;
+        uint16_t dst_port = (uint16_t)((udp[2] << 8) | udp[3]);
+        uint16_t udp_length = (uint16_t)((udp[4] << 8) | udp[5]);
+        if ((dst_port != DMX_ARTNET_PORT && dst_port != DMX_SACN_PORT) || udp_length < 8 ||
+            offset + ihl + udp_length > frame.size()) continue;
+        payloads.push_back(Packet(udp + 8, udp + udp_length));
+        times_ms.push_back(record.ts_sec * 1000u + record.ts_usec / (nanosecond ? 1000000u : 1000u));
+    }
+    fclose(f);
+
+    // Learn routes from the first distinct data universes
+    DMXNetRouter router;
+    router.begin(resolveOutput, nullptr);
+    uint8_t num_routes = 0;
+    uint32_t learned[NUM_TEST_OUTPUTS];
+    for (size_t p = 0; p < payloads.size() && num_routes < NUM_TEST_OUTPUTS; p++) {
+        DMXNetPacket packet;
+        if (!DMXNetCodec::parse(payloads[p].data(), payloads[p].size(), &packet) || packet.kind != DMXNetPacket::DATA) {
+            continue;
+        }
+        uint32_t key = ((uint32_t)packet.protocol << 16) | packet.universe;
+        bool known = false;
+        for (uint8_t r = 0; r < num_routes; r++) {
+            known = known || learned[r] == key;
+        }
+        if (!known) {
+            learned[num_routes] = key;
+            router.setRoute(num_routes, packet.protocol, packet.universe);
+            printf("Route:   output %u <- %s universe %u\n", num_routes,
+                   packet.protocol == DMX_NET_ARTNET ? "Art-Net" : "sACN", packet.universe);
+            num_routes++;
+        }
+    }
+
+    uint64_t frames_ready = 0;
+    Clock::time_point start = Clock::now();
+    for (size_t p = 0; p < payloads.size(); p++) {
+        frames_ready += __builtin_popcount(router.handlePacket(payloads[p].data(), payloads[p].size(),
+                                                               times_ms[p] - times_ms[0]));
+    }
+    double elapsed = secondsSince(start);
+
+    printf("Replay:  %zu packets in %.3f ms = %.0f packets/s, %llu output frames\n",
+           payloads.size(), elapsed * 1000, payloads.size() / elapsed, (unsigned long long)frames_ready);
+    printStats(router.getStats());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s bench|udp [--frames N] | record out.pcap [--frames N] | replay in.pcap\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t frames = 0;
+    const char* path = nullptr;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (uint32_t)atol(argv[++i]);
+        } else if (path == nullptr) {
+            path = argv[i];
+        }
+    }
+
+    if (strcmp(argv[1], "bench") == 0) {
+        return runBench(frames ? frames : 200000);
+    } else if (strcmp(argv[1], "udp") == 0) {
+        return runUdp(frames ? frames : 20000);
+    } else if (strcmp(argv[1], "record") == 0 && path) {
+        return runRecord(path, frames ? frames : 440);
+    } else if (strcmp(argv[1], "replay") == 0 && path) {
+        return runReplay(path);
+    }
+    fprintf(stderr, "Usage: %s bench|udp [--frames N] | record out.pcap [--frames N] | replay in.pcap\n", argv[0]);
+    return 1;
+}
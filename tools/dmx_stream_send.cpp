@@ -0,0 +1,258 @@
+/*
+ * DMX Stream Sender (host tool)
+ *
+ * Streams animated universes to a device running DMXStreamInput using the
+ * binary stream protocol (see include/dmx_stream_protocol.h). Each universe is
+ * sent as whichever of FULL, DELTA or RLE is smallest; the last packet of a
+ * frame carries the sync flag.
+ *
+ * With --loopback the stream is written into a pseudo-terminal and decoded by
+ * a reader thread on the other end, which verifies the decoded universes and
+ * reports throughput and per-frame latency without any hardware attached.
+ *
+ * Build:  g++ -std=c++17 -O2 -pthread -Iinclude tools/dmx_stream_send.cpp src/core/dmx_stream_protocol.cpp -o dmx_stream_send
+ * Usage:  ./dmx_stream_send /dev/ttyACM0 [--universes N] [--fps N] [--frames N] [--keyframe N]
+ *         ./dmx_stream_send --loopback [--universes N] [--fps N] [--frames N] [--keyframe N]
+ *         (--fps 0 sends as fast as the link accepts; --keyframe N resends full
+ *         images every N frames so the device heals after a dropped packet,
+ *         default once a second, 0 = never)
+ */
+
+#include "dmx_stream_protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static uint64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+}
+
+static bool makeRaw(int fd) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+static bool writeAll(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            return false;
+        }
+        data += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+// Test animation: a static gradient base with a moving RGB chase and a dimmer
+// sweep, so consecutive frames differ in a handful of small regions
+static void renderFrame(uint32_t frame, uint8_t universe, uint8_t* out) {
+    for (int i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+        out[i] = (uint8_t)((i + universe * 32) & 0xFF) >> 2;
+    }
+    int head = (int)((frame * 3 + universe * 17) % 170) * 3;
+    for (int i = 0; i < 12 && head + i < DMX_UNIVERSE_SIZE; i++) {
+        out[head + i] = 255;
+    }
+    int dimmer = 480 + (int)(frame % 32);
+    out[dimmer] = (uint8_t)(frame * 8);
+}
+
+struct LoopbackReader {
+    int fd;
+    uint8_t num_universes;
+    uint8_t universes[DMX_STREAM_MAX_UNIVERSES][DMX_UNIVERSE_SIZE];
+    DMXStreamDecoder decoder;
+    const std::vector<uint64_t>* send_times;
+    std::vector<uint64_t> latencies;
+    std::atomic<uint32_t> frames_decoded;
+    uint32_t frames_expected;
+};
+
+static uint8_t* resolveUniverse(uint8_t universe, void* context) {
+    LoopbackReader* reader = static_cast<LoopbackReader*>(context);
+    return universe < reader->num_universes ? reader->universes[universe] : nullptr;
+}
+
+static void onSync(uint8_t, void* context) {
+    LoopbackReader* reader = static_cast<LoopbackReader*>(context);
+    uint32_t frame = reader->frames_decoded.load();
+    reader->latencies.push_back(nowUs() - (*reader->send_times)[frame]);
+    reader->frames_decoded.store(frame + 1);
+}
+
+static void readerThread(LoopbackReader* reader) {
+    uint8_t buffer[4096];
+    while (reader->frames_decoded.load() < reader->frames_expected) {
+        ssize_t n = read(reader->fd, buffer, sizeof(buffer));
+        if (n <= 0) {
+            break;
+        }
+        reader->decoder.feed(buffer, (size_t)n);
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* device = nullptr;
+    bool loopback = false;
+    int num_universes = 8;
+    int fps = 44;
+    long frames = -1;
+    int keyframe = -1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--loopback") == 0) {
+            loopback = true;
+        } else if (strcmp(argv[i], "--universes") == 0 && i + 1 < argc) {
+            num_universes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--keyframe") == 0 && i + 1 < argc) {
+            keyframe = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && device == nullptr) {
+            device = argv[i];
+        } else {
+            fprintf(stderr, "Usage: %s <tty> | --loopback [--universes N] [--fps N] [--frames N] [--keyframe N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if ((device == nullptr) == !loopback || num_universes < 1 || num_universes > DMX_STREAM_MAX_UNIVERSES || fps < 0) {
+        fprintf(stderr, "Usage: %s <tty> | --loopback [--universes N] [--fps N] [--frames N] [--keyframe N]\n", argv[0]);
+        return 1;
+    }
+    if (frames < 0) {
+        frames = loopback ? 2000 : 0; // 0 = run forever
+    }
+    if (keyframe < 0) {
+        keyframe = fps > 0 ? fps : 0;
+    }
+
+    int out_fd;
+    LoopbackReader* reader = nullptr;
+    std::vector<uint64_t> send_times(loopback ? frames : 0);
+    std::thread thread;
+
+    if (loopback) {
+        out_fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (out_fd < 0 || grantpt(out_fd) != 0 || unlockpt(out_fd) != 0) {
+            perror("posix_openpt");
+            return 1;
+        }
+        int in_fd = open(ptsname(out_fd), O_RDWR | O_NOCTTY);
+        if (in_fd < 0 || !makeRaw(in_fd) || !makeRaw(out_fd)) {
+            perror("pty");
+            return 1;
+        }
+        reader = new LoopbackReader();
+        reader->fd = in_fd;
+        reader->num_universes = (uint8_t)num_universes;
+        memset(reader->universes, 0, sizeof(reader->universes));
+        reader->send_times = &send_times;
+        reader->frames_decoded = 0;
+        reader->frames_expected = (uint32_t)frames;
+        reader->decoder.begin(resolveUniverse, onSync, reader);
+        thread = std::thread(readerThread, reader);
+    } else {
+        out_fd = open(device, O_RDWR | O_NOCTTY);
+        if (out_fd < 0 || !makeRaw(out_fd)) {
+            perror(device);
+            return 1;
+        }
+    }
+
+    DMXStreamEncoder encoder;
+    static uint8_t previous[DMX_STREAM_MAX_UNIVERSES][DMX_UNIVERSE_SIZE];
+    static uint8_t current[DMX_STREAM_MAX_UNIVERSES][DMX_UNIVERSE_SIZE];
+    std::vector<uint8_t> frame_bytes;
+    uint8_t packet[DMX_STREAM_MAX_PACKET];
+    uint64_t bytes_sent = 0;
+    uint64_t full_equivalent = 0;
+    uint64_t period_us = fps > 0 ? 1000000 / fps : 0;
+
+    uint64_t start = nowUs();
+    uint64_t next_frame = start;
+    for (uint32_t frame = 0; frames == 0 || frame < (uint32_t)frames; frame++) {
+        if (period_us > 0) {
+            uint64_t now = nowUs();
+            if (now < next_frame) {
+                std::this_thread::sleep_for(std::chrono::microseconds(next_frame - now));
+            }
+            next_frame += period_us;
+        }
+
+        bool full_image = frame == 0 || (keyframe > 0 && frame % keyframe == 0);
+        frame_bytes.clear();
+        for (int u = 0; u < num_universes; u++) {
+            renderFrame(frame, (uint8_t)u, current[u]);
+            // Full images on keyframes, otherwise deltas against what was last sent
+            size_t length = encoder.encodeUniverse((uint8_t)u, full_image ? nullptr : previous[u], current[u],
+                                                   u == num_universes - 1, packet);
+            frame_bytes.insert(frame_bytes.end(), packet, packet + length);
+            memcpy(previous[u], current[u], DMX_UNIVERSE_SIZE);
+        }
+        full_equivalent += (uint64_t)num_universes * (DMX_STREAM_HEADER_SIZE + 2 + DMX_UNIVERSE_SIZE + DMX_STREAM_CHECK_SIZE);
+        bytes_sent += frame_bytes.size();
+
+        if (loopback) {
+            send_times[frame] = nowUs();
+        }
+        if (!writeAll(out_fd, frame_bytes.data(), frame_bytes.size())) {
+            perror("write");
+            return 1;
+        }
+    }
+
+    if (!loopback) {
+        close(out_fd);
+        return 0;
+    }
+
+    thread.join();
+    double elapsed = (nowUs() - start) / 1e6;
+
+    bool match = reader->frames_decoded.load() == (uint32_t)frames;
+    for (int u = 0; u < num_universes; u++) {
+        match = match && memcmp(reader->universes[u], current[u], DMX_UNIVERSE_SIZE) == 0;
+    }
+
+    std::vector<uint64_t> sorted = reader->latencies;
+    std::sort(sorted.begin(), sorted.end());
+    DMXStreamDecoder::Stats stats = reader->decoder.getStats();
+
+    printf("Loopback: %u/%ld frames decoded, %d universes, universes %s\n",
+           reader->frames_decoded.load(), frames, num_universes, match ? "match" : "MISMATCH");
+    printf("Wire:     %llu bytes (%.1f%% of full frames), %.1f KB/s, %.1f frames/s\n",
+           (unsigned long long)bytes_sent, 100.0 * bytes_sent / full_equivalent,
+           bytes_sent / elapsed / 1024.0, frames / elapsed);
+    if (!sorted.empty()) {
+        printf("Latency:  median %llu us, p99 %llu us, max %llu us\n",
+               (unsigned long long)sorted[sorted.size() / 2],
+               (unsigned long long)sorted[sorted.size() * 99 / 100],
+               (unsigned long long)sorted.back());
+    }
+    printf("Decoder:  %u packets, %u checksum errors, %u format errors, %u seq gaps\n",
+           stats.packets_ok, stats.checksum_errors, stats.format_errors, stats.seq_gaps);
+
+    close(reader->fd);
+    close(out_fd);
+    delete reader;
+    return match ? 0 : 1;
+}
@@ -0,0 +1,413 @@
+/*
+ * DMX Telemetry Viewer (host tool)
+ *
+ * Decodes the binary telemetry sent by DMXTelemetry (receiver applications)
+ * and renders universes, per-universe stats, counters and (in DMX_PROFILE
+ * builds) latency histograms in the terminal.
+ * All formatting happens here rather than on the device.
+ *
+ * DMXLog records arrive as a format ID plus raw arguments. The ID table is
+ * built at start-up by scanning the sources for DMX_LOG("...") format strings
+ * and hashing them the same way the firmware does at compile time.
+ *
+ * Build:  g++ -std=c++17 -O2 -Iinclude tools/dmx_telemetry_view.cpp src/core/dmx_stream_protocol.cpp -o dmx_telemetry_view
+ * Usage:  ./dmx_telemetry_view /dev/ttyACM0 [--universe N] [--dump] [--sources DIR]...
+ *         ./dmx_telemetry_view capture.bin --dump     (a file or - for stdin also works)
+ *
+ * --universe N   Universe (1-8) shown in full, default 1
+ * --dump         Print one line per telemetry frame instead of a refreshing screen
+ * --sources DIR  Where to look for DMX_LOG format strings (default: src examples)
+ */
+
+#include "dmx_stream_protocol.h"
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+static const char* COUNTER_NAMES[DMX_COUNTER_COUNT] = {
+    "uptime ms", "frames received", "signal losses", "config mismatches", "telemetry bytes", "telemetry drops",
+    "log drops", "core0 load 0.1%", "core1 load 0.1%", "rx irq 0.1%", "tx 0.1%", "callbacks 0.1%",
+    "main 0.1%", "frames changed", "frames identical"
+};
+
+// Matches DMXProfileMetric (include/dmx_profile.h)
+#define PROFILE_METRICS 12
+#define PROFILE_BUCKETS 16
+static const char* PROFILE_NAMES[PROFILE_METRICS] = {
+    "rx irq latency", "rx irq duration", "rx rearm latency", "tx start jitter",
+    "callback u1", "callback u2", "callback u3", "callback u4",
+    "callback u5", "callback u6", "callback u7", "callback u8"
+};
+
+#define LOG_LINES_SHOWN 8
+
+// Same FNV-1a as DMXLog::hash()
+static uint32_t formatHash(const std::string& format) {
+    uint32_t h = 2166136261u;
+    for (unsigned char c : format) {
+        h = (h ^ c) * 16777619u;
+    }
+    return h;
+}
+
+// Parse one C string literal starting at text[pos] == '"'; returns false if malformed
+static bool parseLiteral(const std::string& text, size_t& pos, std::string& out) {
+    for (pos++; pos < text.size(); pos++) {
+        char c = text[pos];
+        if (c == '"') {
+            pos++;
+            return true;
+        }
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (++pos >= text.size()) {
+            return false;
+        }
+        c = text[pos];
+        switch (c) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case '0': out += '\0'; break;
+            case 'x': {
+                int value = 0, digits = 0;
+                while (pos + 1 < text.size() && isxdigit((unsigned char)text[pos + 1]) && digits < 2) {
+                    value = value * 16 + (isdigit((unsigned char)text[pos + 1]) ? text[pos + 1] - '0' : (tolower(text[pos + 1]) - 'a' + 10));
+                    pos++;
+                    digits++;
+                }
+                out += (char)value;
+                break;
+            }
+            default: out += c; break;
+        }
+    }
+    return false;
+}
+
+// Collect DMX_LOG("..." ["..."]) format strings from a source tree
+static void scanSources(const std::string& root, std::map<uint32_t, std::string>& formats) {
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error)) {
+        std::string ext = it->path().extension().string();
+        if (ext != ".cpp" && ext != ".h" && ext != ".c") {
+            continue;
+        }
+        std::ifstream in(it->path());
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        std::string text = buffer.str();
+
+        for (size_t pos = text.find("DMX_LOG("); pos != std::string::npos; pos = text.find("DMX_LOG(", pos + 1)) {
+            size_t p = pos + 8;
+            std::string format;
+            bool ok = false;
+            while (true) {
+                while (p < text.size() && isspace((unsigned char)text[p])) p++;
+                if (p >= text.size() || text[p] != '"') break;
+                ok = parseLiteral(text, p, format);
+                if (!ok) break;
+            }
+            if (ok) {
+                formats[formatHash(format)] = format;
+            }
+        }
+    }
+}
+
+// printf-style formatting of 32-bit device arguments
+static std::string formatLog(const std::string& format, const uint32_t* args, uint8_t num_args) {
+    std::string out;
+    uint8_t next = 0;
+    char piece[64];
+    for (size_t i = 0; i < format.size(); i++) {
+        if (format[i] != '%') {
+            out += format[i];
+            continue;
+        }
+        if (i + 1 < format.size() && format[i + 1] == '%') {
+            out += '%';
+            i++;
+            continue;
+        }
+        // Flags, width and precision are kept; length modifiers are dropped
+        std::string spec = "%";
+        size_t j = i + 1;
+        while (j < format.size() && strchr("-+ #0123456789.", format[j])) spec += format[j++];
+        while (j < format.size() && strchr("hlLqjzt", format[j])) j++;
+        if (j >= format.size()) break;
+        char conversion = format[j];
+        uint32_t arg = next < num_args ? args[next] : 0;
+        next++;
+        switch (conversion) {
+            case 'd': case 'i': snprintf(piece, sizeof(piece), (spec + "d").c_str(), (int32_t)arg); break;
+            case 'u': case 'x': case 'X': case 'o':
+                snprintf(piece, sizeof(piece), (spec + conversion).c_str(), arg);
+                break;
+            case 'c': snprintf(piece, sizeof(piece), (spec + "c").c_str(), (int)arg); break;
+            case 'p': snprintf(piece, sizeof(piece), "0x%08x", arg); break;
+            case 's': snprintf(piece, sizeof(piece), "<str@0x%08x>", arg); break;
+            default: snprintf(piece, sizeof(piece), "<%%%c?>", conversion); break;
+        }
+        out += piece;
+        i = j;
+    }
+    while (!out.empty() && out.back() == '\n') {
+        out.pop_back();
+    }
+    return out;
+}
+
+struct ViewState {
+    uint8_t universes[DMX_STREAM_MAX_UNIVERSES][DMX_UNIVERSE_SIZE];
+    DMXStreamUniverseStats stats[DMX_STREAM_MAX_UNIVERSES];
+    bool have_stats[DMX_STREAM_MAX_UNIVERSES];
+    uint32_t counters[DMX_COUNTER_COUNT];
+    uint32_t profile[PROFILE_METRICS][3 + PROFILE_BUCKETS];  // count, total us, max us, buckets
+    bool have_profile[PROFILE_METRICS];
+    uint8_t shown_universe;
+    bool dump;
+    std::map<uint32_t, std::string> log_formats;
+    std::deque<std::string> log_lines;
+    uint32_t telemetry_frames;
+    std::chrono::steady_clock::time_point last_render;
+    DMXStreamDecoder decoder;
+};
+
+static uint8_t* resolveUniverse(uint8_t universe, void* context) {
+    return static_cast<ViewState*>(context)->universes[universe];
+}
+
+static void onRecord(uint8_t type, uint8_t universe, const uint8_t* payload, uint16_t length, void* context) {
+    ViewState* view = static_cast<ViewState*>(context);
+    if (type == DMX_STREAM_STATS && universe < DMX_STREAM_MAX_UNIVERSES) {
+        dmxStreamReadStats(payload, &view->stats[universe]);
+        view->have_stats[universe] = true;
+    } else if (type == DMX_STREAM_LOG) {
+        uint32_t id = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) | ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+        uint32_t timestamp = (uint32_t)payload[4] | ((uint32_t)payload[5] << 8) | ((uint32_t)payload[6] << 16) | ((uint32_t)payload[7] << 24);
+        uint32_t args[4] = {0, 0, 0, 0};
+        uint8_t num_args = payload[8] > 4 ? 4 : payload[8];
+        for (uint8_t a = 0; a < num_args; a++) {
+            const uint8_t* p = &payload[DMX_STREAM_LOG_HEADER_SIZE + a * 4];
+            args[a] = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        }
+
+        char prefix[48];
+        snprintf(prefix, sizeof(prefix), "[%u.%06u c%u] ", timestamp / 1000000, timestamp % 1000000, universe);
+        std::map<uint32_t, std::string>::const_iterator format = view->log_formats.find(id);
+        std::string line = prefix;
+        if (format != view->log_formats.end()) {
+            line += formatLog(format->second, args, num_args);
+        } else {
+            char unknown[96];
+            snprintf(unknown, sizeof(unknown), "<unknown format %08x> %08x %08x %08x %08x", id, args[0], args[1], args[2], args[3]);
+            line += unknown;
+        }
+
+        if (view->dump) {
+            printf("log %s\n", line.c_str());
+        } else {
+            view->log_lines.push_back(line);
+            if (view->log_lines.size() > LOG_LINES_SHOWN) {
+                view->log_lines.pop_front();
+            }
+        }
+    } else if (type == DMX_STREAM_PROFILE && universe < PROFILE_METRICS) {
+        for (uint8_t w = 0; w < 3 + PROFILE_BUCKETS; w++) {
+            const uint8_t* p = &payload[w * 4];
+            view->profile[universe][w] = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+        }
+        view->have_profile[universe] = true;
+    } else if (type == DMX_STREAM_COUNTERS) {
+        for (uint16_t i = 0; i + DMX_STREAM_COUNTER_SIZE <= length; i += DMX_STREAM_COUNTER_SIZE) {
+            uint8_t id = payload[i];
+            if (id < DMX_COUNTER_COUNT) {
+                view->counters[id] = (uint32_t)payload[i + 1] | ((uint32_t)payload[i + 2] << 8) |
+                                     ((uint32_t)payload[i + 3] << 16) | ((uint32_t)payload[i + 4] << 24);
+            }
+        }
+    }
+}
+
+// Upper bound of the bucket holding the given fraction of samples (bucket b: < 2^b us)
+static uint32_t profilePercentile(const uint32_t* histogram, double fraction) {
+    const uint32_t* buckets = &histogram[3];
+    uint64_t target = (uint64_t)(histogram[0] * fraction);
+    uint64_t seen = 0;
+    for (uint8_t b = 0; b < PROFILE_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen > target) {
+            return b == PROFILE_BUCKETS - 1 ? histogram[2] : (1u << b);
+        }
+    }
+    return histogram[2];
+}
+
+static void render(ViewState* view) {
+    DMXStreamDecoder::Stats link = view->decoder.getStats();
+
+    if (view->dump) {
+        printf("frame %u uptime=%u rx_frames=%u losses=%u mismatches=%u tx_bytes=%u tx_drops=%u "
+               "link_ok=%u cksum_err=%u seq_gaps=%u",
+               view->telemetry_frames, view->counters[DMX_COUNTER_UPTIME_MS],
+               view->counters[DMX_COUNTER_FRAMES_RECEIVED], view->counters[DMX_COUNTER_SIGNAL_LOSSES],
+               view->counters[DMX_COUNTER_CONFIG_MISMATCHES], view->counters[DMX_COUNTER_TELEMETRY_BYTES],
+               view->counters[DMX_COUNTER_TELEMETRY_DROPS], link.packets_ok, link.checksum_errors, link.seq_gaps);
+        printf(" load_pm=%u/%u", view->counters[DMX_COUNTER_LOAD_CORE0], view->counters[DMX_COUNTER_LOAD_CORE1]);
+        printf(" changed=%u identical=%u", view->counters[DMX_COUNTER_FRAMES_CHANGED],
+               view->counters[DMX_COUNTER_FRAMES_IDENTICAL]);
+        for (uint8_t u = 0; u < DMX_STREAM_MAX_UNIVERSES; u++) {
+            if (view->have_stats[u]) {
+                printf(" u%u=%s/%u/%u", u + 1, view->stats[u].signal_present ? "on" : "off",
+                       view->stats[u].frames_received, view->stats[u].active_channels);
+            }
+        }
+        printf("\n");
+        for (uint8_t m = 0; m < PROFILE_METRICS; m++) {
+            const uint32_t* h = view->profile[m];
+            if (view->have_profile[m] && h[0] > 0) {
+                printf("profile %s count=%u mean_us=%u p99_us<%u max_us=%u\n", PROFILE_NAMES[m], h[0], h[1] / h[0],
+                       profilePercentile(h, 0.99), h[2]);
+            }
+        }
+        fflush(stdout);
+        return;
+    }
+
+    printf("\033[H\033[2J");
+    printf("DMX telemetry  (link: %u packets, %u checksum errors, %u sequence gaps)\n\n",
+           link.packets_ok, link.checksum_errors, link.seq_gaps);
+    for (uint8_t i = 0; i < DMX_COUNTER_COUNT; i++) {
+        printf("  %-18s %10u\n", COUNTER_NAMES[i], view->counters[i]);
+    }
+
+    printf("\n  Univ  Signal   Frames  Active  Max@Ch\n");
+    for (uint8_t u = 0; u < DMX_STREAM_MAX_UNIVERSES; u++) {
+        if (!view->have_stats[u]) {
+            continue;
+        }
+        const DMXStreamUniverseStats& s = view->stats[u];
+        printf("  %4u  %-6s %8u  %6u  %3u@%u\n", u + 1, s.signal_present ? "ACTIVE" : "NONE",
+               s.frames_received, s.active_channels, s.max_value, s.max_value_channel);
+    }
+
+    bool any_profile = false;
+    for (uint8_t m = 0; m < PROFILE_METRICS; m++) {
+        const uint32_t* h = view->profile[m];
+        if (!view->have_profile[m] || h[0] == 0) {
+            continue;
+        }
+        if (!any_profile) {
+            printf("\n  Profile            Count   Mean us  p50 us<  p99 us<   Max us\n");
+            any_profile = true;
+        }
+        printf("  %-16s %7u  %8u %8u %8u %8u\n", PROFILE_NAMES[m], h[0], h[1] / h[0],
+               profilePercentile(h, 0.5), profilePercentile(h, 0.99), h[2]);
+    }
+
+    printf("\n  Log\n");
+    for (const std::string& line : view->log_lines) {
+        printf("  %s\n", line.c_str());
+    }
+
+    printf("\n  Universe %u\n", view->shown_universe + 1);
+    const uint8_t* data = view->universes[view->shown_universe];
+    for (uint16_t line = 0; line < DMX_UNIVERSE_SIZE; line += 16) {
+        printf("  %03u-%03u:", line + 1, line + 16);
+        for (uint16_t i = 0; i < 16; i++) {
+            printf(" %3u", data[line + i]);
+        }
+        printf("\n");
+    }
+    fflush(stdout);
+}
+
+static void onSync(uint8_t, void* context) {
+    ViewState* view = static_cast<ViewState*>(context);
+    view->telemetry_frames++;
+
+    // Limit terminal redraws to 5 per second
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (view->dump || now - view->last_render >= std::chrono::milliseconds(200)) {
+        render(view);
+        view->last_render = now;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    std::vector<std::string> sources;
+    static ViewState view;
+    view.shown_universe = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--universe") == 0 && i + 1 < argc) {
+            int universe = atoi(argv[++i]);
+            if (universe < 1 || universe > DMX_STREAM_MAX_UNIVERSES) {
+                fprintf(stderr, "Universe must be 1-%d\n", DMX_STREAM_MAX_UNIVERSES);
+                return 1;
+            }
+            view.shown_universe = (uint8_t)(universe - 1);
+        } else if (strcmp(argv[i], "--dump") == 0) {
+            view.dump = true;
+        } else if (strcmp(argv[i], "--sources") == 0 && i + 1 < argc) {
+            sources.push_back(argv[++i]);
+        } else if (path == nullptr) {
+            path = argv[i];
+        } else {
+            path = nullptr;
+            break;
+        }
+    }
+    if (path == nullptr) {
+        fprintf(stderr, "Usage: %s <tty|file|-> [--universe N] [--dump] [--sources DIR]...\n", argv[0]);
+        return 1;
+    }
+
+    if (sources.empty()) {
+        sources.push_back("src");
+        sources.push_back("examples");
+    }
+    for (const std::string& dir : sources) {
+        scanSources(dir, view.log_formats);
+    }
+
+    int fd = strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    struct termios tio;
+    if (isatty(fd) && tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+
+    view.decoder.begin(resolveUniverse, onSync, &view);
+    view.decoder.setRecordCallback(onRecord);
+
+    uint8_t buffer[4096];
+    ssize_t n;
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+        view.decoder.feed(buffer, (size_t)n);
+    }
+
+    if (!view.dump) {
+        render(&view);
+    }
+    return 0;
+}